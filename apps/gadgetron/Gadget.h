@@ -16,6 +16,7 @@
 
 #include "gadgetbase_export.h"
 #include "GadgetContainerMessage.h"
+#include "GadgetMessageQueue.h"
 #include "GadgetronExport.h"
 #include "gadgetron_config.h"
 #include "log.h"
@@ -105,12 +106,19 @@ namespace Gadgetron{
     };
 
     Gadget()
-    : inherited()
+    : inherited(0, new GadgetMessageQueue())
     , desired_threads_(1)
     , pass_on_undesired_data_(false)
     , controller_(0)
     , parameter_mutex_("GadgetParameterMutex")
+    , use_thread_pool_(true)
+    , pooled_(false)
+    , failed_(false)
+    , drain_task_(this)
     {
+      //The task owns the queue we handed it
+      this->delete_msg_queue_ = true;
+      static_cast<GadgetMessageQueue*>(this->msg_queue())->wait_time_histogram(&instrumentation_.wait_time());
 
       gadgetron_version_ = std::string(GADGETRON_VERSION_STRING) + std::string(" (") +
       std::string(GADGETRON_GIT_SHA1_HASH) + std::string(")");
@@ -132,6 +140,13 @@ namespace Gadgetron{
 
     virtual int open(void* = 0)
     {
+      //With the server wide thread pool enabled, messages are processed by pool tasks instead of our own threads
+      GadgetMessageQueue* q = dynamic_cast<GadgetMessageQueue*>(this->msg_queue());
+      if (GadgetThreadPool::instance() && use_thread_pool_ && q) {
+        pooled_ = true;
+        q->attach_to_pool(&drain_task_, this->desired_threads());
+        return 0;
+      }
       return this->activate( THR_NEW_LWP | THR_JOINABLE, this->desired_threads() );
     }
 
@@ -160,6 +175,22 @@ namespace Gadgetron{
       pass_on_undesired_data_ = d;
     }
 
+    /**
+       Gadgets that block inside process() for long periods for reasons other than a full downstream queue
+       (e.g. waiting for results from remote nodes) should keep their own threads.
+       Shorter waits on a pool thread can be wrapped in a GadgetPoolBlockingScope instead.
+       Must be set before the Gadget is opened.
+     */
+    virtual void use_thread_pool(bool p)
+    {
+      use_thread_pool_ = p;
+    }
+
+    virtual bool use_thread_pool()
+    {
+      return use_thread_pool_;
+    }
+
     virtual void set_controller(GadgetStreamInterface* controller) {
       controller_ = controller;
     }
@@ -169,11 +200,57 @@ namespace Gadgetron{
       return controller_;
     }
 
+    /**
+       Limits for the input queue of this Gadget. When either limit is reached, putq blocks.
+       @param hwm High water mark in bytes
+       @param lwm Low water mark in bytes, blocked writers are woken up when the queue drains below it
+       @param max_messages Maximum number of queued messages, 0 for no limit
+     */
+    virtual void set_queue_limits(size_t hwm, size_t lwm, size_t max_messages = 0)
+    {
+      if (lwm > hwm) lwm = hwm;
+      GadgetMessageQueue* q = dynamic_cast<GadgetMessageQueue*>(this->msg_queue());
+      this->msg_queue()->high_water_mark(hwm);
+      this->msg_queue()->low_water_mark(lwm);
+      if (q) q->max_messages(max_messages);
+    }
+
+    GadgetInstrumentation& get_instrumentation()
+    {
+      return instrumentation_;
+    }
+
+    virtual GadgetQueueStatistics get_queue_statistics()
+    {
+      GadgetMessageQueue* q = dynamic_cast<GadgetMessageQueue*>(this->msg_queue());
+      if (q) return q->get_statistics();
+
+      GadgetQueueStatistics s = GadgetQueueStatistics();
+      s.message_count = this->msg_queue()->message_count();
+      s.message_bytes = this->msg_queue()->message_bytes();
+      s.high_water_mark = this->msg_queue()->high_water_mark();
+      s.low_water_mark = this->msg_queue()->low_water_mark();
+      return s;
+    }
+
     virtual int close(unsigned long flags)
     {
       GDEBUG("Gadget (%s) Close Called with flags = %d\n", this->module()->name(), flags);
       int rval = 0;
-      if (flags == 1) {
+      if (flags == 1 && pooled_) {
+        //Upstream Gadgets are closed first, so nothing is added to the queue once it has drained
+        GDEBUG("Gadget (%s) waiting for queue to drain\n", this->module()->name());
+        GadgetMessageQueue* q = static_cast<GadgetMessageQueue*>(this->msg_queue());
+        rval = q->wait_idle();
+        q->detach_from_pool();
+        GDEBUG("Gadget (%s) queue drained\n", this->module()->name());
+        controller_ = 0;
+        //As with our own threads, where the hang up message can no longer be queued after a failure
+        if (failed_) {
+          GDEBUG("Gadget (%s) closed after failure\n", this->module()->name());
+          return GADGET_FAIL;
+        }
+      } else if (flags == 1) {
         ACE_Message_Block *hangup = new ACE_Message_Block();
         hangup->msg_type( ACE_Message_Block::MB_HANGUP );
         if (this->putq(hangup) == -1) {
@@ -212,46 +289,7 @@ namespace Gadgetron{
         }
 
 
-        //Is this config info, if so call appropriate process function
-        if (m->flags() & GADGET_MESSAGE_CONFIG) {
-
-          int success;
-          try{ success = this->process_config(m); }
-          catch (std::runtime_error& err){
-            GEXCEPTION(err,"Gadget::process_config() failed\n");
-            success = -1;
-          }
-
-          if (success == -1) {
-            m->release();
-            this->flush();
-            GDEBUG("Gadget (%s) process config failed\n", this->module()->name());
-            return GADGET_FAIL;
-
-          }
-
-          //Push this onto next gadgets queue, other gadgets may need this configuration information
-          if (this->next()) {
-            if (this->next()->putq(m) == -1) {
-              m->release();
-              GDEBUG("Gadget (%s) process config failed to put config on dowstream gadget\n", this->module()->name());
-              return GADGET_FAIL;
-            }
-          }
-          continue;
-        }
-
-        int success;
-        try{ success = this->process(m); }
-        catch (std::runtime_error& err){
-          GEXCEPTION(err,"Gadget::process() failed\n");
-          success = -1;
-        }
-
-        if (success == -1) {
-          m->release();
-          this->flush();
-          GERROR("Gadget (%s) process failed\n", this->module()->name());
+        if (this->handle_message(m) == GADGET_FAIL) {
           return GADGET_FAIL;
         }
       }
@@ -351,6 +389,100 @@ namespace Gadgetron{
   protected:
     std::vector<GadgetPropertyBase*> properties_;
 
+    /**
+       Processes a single message taken off the queue. Used by svc() and, in thread pool mode, by the drain task.
+       Returns GADGET_FAIL when the Gadget cannot continue; the message has been released and the queue flushed.
+     */
+    virtual int handle_message(ACE_Message_Block* m)
+    {
+      //Is this config info, if so call appropriate process function
+      if (m->flags() & GADGET_MESSAGE_CONFIG) {
+
+        int success;
+        try{ success = this->process_config(m); }
+        catch (std::runtime_error& err){
+          GEXCEPTION(err,"Gadget::process_config() failed\n");
+          success = -1;
+        }
+
+        if (success == -1) {
+          m->release();
+          this->flush();
+          GDEBUG("Gadget (%s) process config failed\n", this->module()->name());
+          return GADGET_FAIL;
+
+        }
+
+        //Push this onto next gadgets queue, other gadgets may need this configuration information
+        if (this->next()) {
+          if (this->next()->putq(m) == -1) {
+            m->release();
+            GDEBUG("Gadget (%s) process config failed to put config on dowstream gadget\n", this->module()->name());
+            return GADGET_FAIL;
+          }
+        }
+        return GADGET_OK;
+      }
+
+      const bool instrument = GadgetInstrumentation::enabled();
+      size_t bytes_in = 0;
+      unsigned long long process_start = 0;
+      if (instrument) {
+        bytes_in = m->total_length();
+        process_start = GadgetInstrumentation::now();
+      }
+
+      int success;
+      try{ success = this->process(m); }
+      catch (std::runtime_error& err){
+        GEXCEPTION(err,"Gadget::process() failed\n");
+        success = -1;
+      }
+
+      if (instrument) {
+        instrumentation_.record_process(process_start, GadgetInstrumentation::now(), bytes_in);
+      }
+
+      if (success == -1) {
+        m->release();
+        this->flush();
+        GERROR("Gadget (%s) process failed\n", this->module()->name());
+        return GADGET_FAIL;
+      }
+      return GADGET_OK;
+    }
+
+    /**
+       Runs on a pool thread. Processes up to GADGET_POOL_DRAIN_QUANTUM messages and then yields,
+       the drainer stays registered with the queue so that the concurrency limit still holds.
+     */
+    void drain_queue()
+    {
+      GadgetMessageQueue* q = static_cast<GadgetMessageQueue*>(this->msg_queue());
+      for (size_t n = 0; n < GADGET_POOL_DRAIN_QUANTUM; n++) {
+        ACE_Message_Block* m = 0;
+        if (q->dequeue_or_retire(m) == -1) return;
+
+        if (m->msg_type() == ACE_Message_Block::MB_HANGUP) {
+          m->release();
+          continue;
+        }
+
+        //The failing drainer has flushed and deactivated the queue, so upstream Gadgets see the failure on their next put.
+        //Messages another drainer had already taken are not processed either.
+        if (failed_) {
+          GERROR("Gadget (%s) dropping message after failure\n", this->module()->name());
+          m->release();
+          continue;
+        }
+
+        if (this->handle_message(m) == GADGET_FAIL) {
+          failed_ = true;
+        }
+      }
+      GadgetThreadPool::instance()->submit(&drain_task_, true);
+    }
+
     virtual int next_step(ACE_Message_Block *m)
     {
       return this->put_next(m);//next()->putq(m);
@@ -367,6 +499,21 @@ namespace Gadgetron{
     bool pass_on_undesired_data_;
     GadgetStreamInterface* controller_;
     ACE_Thread_Mutex parameter_mutex_;
+    GadgetInstrumentation instrumentation_;
+
+    class DrainTask : public GadgetPoolTask
+    {
+    public:
+      DrainTask(Gadget* g) : gadget_(g) {}
+      virtual void run() { gadget_->drain_queue(); }
+    protected:
+      Gadget* gadget_;
+    };
+
+    bool use_thread_pool_;
+    bool pooled_;
+    std::atomic<bool> failed_;
+    DrainTask drain_task_;
   private:
     std::map<std::string, std::string> parameters_;
     std::string gadgetron_version_;
@@ -0,0 +1,43 @@
+#include "GadgetInstrumentation.h"
+#include "log.h"
+
+#include <cstdio>
+
+namespace Gadgetron
+{
+  std::atomic<bool> GadgetInstrumentation::enabled_(false);
+
+  std::string GadgetInstrumentation::format(const char* gadget_name, unsigned long long bytes_out)
+  {
+    double secs = this->active_seconds();
+    unsigned long long n = this->messages();
+
+    char line[1024];
+    std::string text;
+
+    snprintf(line, sizeof(line), "Gadget (%s): %llu messages, %llu bytes in, %llu bytes out, %.1f messages/s, %.2f MB/s in\n",
+	     gadget_name, n, this->bytes_in(), bytes_out,
+	     secs > 0 ? n/secs : 0.0,
+	     secs > 0 ? this->bytes_in()/(secs*1024*1024) : 0.0);
+    text += line;
+
+    snprintf(line, sizeof(line), "Gadget (%s): queue wait [us] p50 %.1f, p99 %.1f, max %.1f, mean %.1f\n",
+	     gadget_name,
+	     wait_time_.percentile(0.5)*1e-3, wait_time_.percentile(0.99)*1e-3,
+	     wait_time_.max()*1e-3, wait_time_.mean()*1e-3);
+    text += line;
+
+    snprintf(line, sizeof(line), "Gadget (%s): process [us] p50 %.1f, p99 %.1f, max %.1f, mean %.1f\n",
+	     gadget_name,
+	     process_time_.percentile(0.5)*1e-3, process_time_.percentile(0.99)*1e-3,
+	     process_time_.max()*1e-3, process_time_.mean()*1e-3);
+    text += line;
+
+    return text;
+  }
+
+  void GadgetInstrumentation::print(const char* gadget_name, unsigned long long bytes_out)
+  {
+    GINFO("%s", this->format(gadget_name, bytes_out).c_str());
+  }
+}
@@ -0,0 +1,205 @@
+#ifndef GADGETINSTRUMENTATION_H
+#define GADGETINSTRUMENTATION_H
+#pragma once
+
+#include "gadgetbase_export.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace Gadgetron{
+
+  /**
+     Histogram of durations in nanoseconds.
+
+     Buckets are log2 spaced with four sub-buckets per octave, so percentiles are
+     accurate to within 25%. Recording is lock free and can be done from any number of threads.
+   */
+  class GadgetLatencyHistogram
+  {
+  public:
+    enum {
+      SUB_BUCKET_BITS = 2,
+      SUB_BUCKETS = 1 << SUB_BUCKET_BITS,
+      NUMBER_OF_BUCKETS = 64 * SUB_BUCKETS
+    };
+
+    GadgetLatencyHistogram()
+    {
+      this->reset();
+    }
+
+    void record(unsigned long long ns)
+    {
+      buckets_[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+      count_.fetch_add(1, std::memory_order_relaxed);
+      sum_.fetch_add(ns, std::memory_order_relaxed);
+
+      unsigned long long m = max_.load(std::memory_order_relaxed);
+      while (ns > m && !max_.compare_exchange_weak(m, ns, std::memory_order_relaxed)) {}
+    }
+
+    void reset()
+    {
+      for (size_t b = 0; b < NUMBER_OF_BUCKETS; b++) buckets_[b] = 0;
+      count_ = 0;
+      sum_ = 0;
+      max_ = 0;
+    }
+
+    unsigned long long count() const { return count_.load(); }
+    unsigned long long max() const { return max_.load(); }
+
+    double mean() const
+    {
+      unsigned long long c = count_.load();
+      return c ? double(sum_.load())/c : 0.0;
+    }
+
+    /**
+       Upper bound of the bucket holding the p'th percentile, p in [0 1]
+     */
+    unsigned long long percentile(double p) const
+    {
+      unsigned long long c = count_.load();
+      if (!c) return 0;
+
+      unsigned long long target = (unsigned long long)(p*c + 0.5);
+      if (target < 1) target = 1;
+      if (target > c) target = c;
+
+      unsigned long long accumulated = 0;
+      for (size_t b = 0; b < NUMBER_OF_BUCKETS; b++) {
+        accumulated += buckets_[b].load(std::memory_order_relaxed);
+        if (accumulated >= target) {
+          unsigned long long v = bucket_upper_value(b);
+          unsigned long long m = max_.load();
+          return (v < m) ? v : m;
+        }
+      }
+      return max_.load();
+    }
+
+  protected:
+
+    static size_t bucket_index(unsigned long long v)
+    {
+      if (v < SUB_BUCKETS) return (size_t)v;
+
+      //Position of the most significant bit
+      size_t msb = 0;
+      unsigned long long x = v;
+      if (x >> 32) { x >>= 32; msb += 32; }
+      if (x >> 16) { x >>= 16; msb += 16; }
+      if (x >> 8)  { x >>= 8;  msb += 8; }
+      if (x >> 4)  { x >>= 4;  msb += 4; }
+      if (x >> 2)  { x >>= 2;  msb += 2; }
+      if (x >> 1)  { msb += 1; }
+
+      size_t sub = (size_t)((v >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+      return (msb - SUB_BUCKET_BITS + 1)*SUB_BUCKETS + sub;
+    }
+
+    static unsigned long long bucket_upper_value(size_t b)
+    {
+      if (b < SUB_BUCKETS) return b;
+
+      size_t msb = b/SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+      size_t sub = b%SUB_BUCKETS;
+      unsigned long long width = 1ULL << (msb - SUB_BUCKET_BITS);
+      return (1ULL << msb) + sub*width + width - 1;
+    }
+
+    std::atomic<unsigned long long> buckets_[NUMBER_OF_BUCKETS];
+    std::atomic<unsigned long long> count_;
+    std::atomic<unsigned long long> sum_;
+    std::atomic<unsigned long long> max_;
+  };
+
+  /**
+     Per Gadget message timing and throughput.
+
+     The wait time is the time a message spent in the input queue of the Gadget, the process time is
+     the wall time of the process() call. Instrumentation is switched on for the whole server, when it
+     is off the Gadgets only pay for checking the flag.
+   */
+  class EXPORTGADGETBASE GadgetInstrumentation
+  {
+  public:
+    GadgetInstrumentation()
+      : messages_(0)
+      , bytes_in_(0)
+      , first_message_ns_(0)
+      , last_message_ns_(0)
+    {
+    }
+
+    static bool enabled()
+    {
+      return enabled_.load(std::memory_order_relaxed);
+    }
+
+    static void enable(bool e = true)
+    {
+      enabled_.store(e, std::memory_order_relaxed);
+    }
+
+    static unsigned long long now()
+    {
+      return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void record_process(unsigned long long start_ns, unsigned long long end_ns, size_t bytes)
+    {
+      process_time_.record(end_ns - start_ns);
+      messages_.fetch_add(1, std::memory_order_relaxed);
+      bytes_in_.fetch_add(bytes, std::memory_order_relaxed);
+
+      unsigned long long zero = 0;
+      first_message_ns_.compare_exchange_strong(zero, start_ns);
+      last_message_ns_.store(end_ns, std::memory_order_relaxed);
+    }
+
+    GadgetLatencyHistogram& wait_time() { return wait_time_; }
+    GadgetLatencyHistogram& process_time() { return process_time_; }
+
+    unsigned long long messages() const { return messages_.load(); }
+    unsigned long long bytes_in() const { return bytes_in_.load(); }
+
+    /**
+       Seconds between the start of the first and the end of the last processed message
+     */
+    double active_seconds() const
+    {
+      unsigned long long f = first_message_ns_.load();
+      unsigned long long l = last_message_ns_.load();
+      return (f && l > f) ? (l - f)*1e-9 : 0.0;
+    }
+
+    /**
+       Summary as text, one line each for throughput, queue wait and process time.
+       bytes_out is the number of bytes the Gadget passed downstream
+     */
+    std::string format(const char* gadget_name, unsigned long long bytes_out);
+
+    /**
+       Log the summary returned by format
+     */
+    void print(const char* gadget_name, unsigned long long bytes_out);
+
+  protected:
+    GadgetLatencyHistogram wait_time_;
+    GadgetLatencyHistogram process_time_;
+    std::atomic<unsigned long long> messages_;
+    std::atomic<unsigned long long> bytes_in_;
+    std::atomic<unsigned long long> first_message_ns_;
+    std::atomic<unsigned long long> last_message_ns_;
+
+    static std::atomic<bool> enabled_;
+  };
+}
+
+#endif //GADGETINSTRUMENTATION_H
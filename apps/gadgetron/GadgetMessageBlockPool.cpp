@@ -0,0 +1,239 @@
+#include "GadgetMessageBlockPool.h"
+#include "log.h"
+
+#include <ace/Guard_T.h>
+
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+  #include <malloc.h>
+#endif
+
+namespace Gadgetron
+{
+  //Every buffer carries a small prefix recording its size class, so that free() knows where it belongs.
+  //The blocks are 64 byte aligned and so is the prefix, which keeps the buffers aligned for the AVX kernels
+  static const size_t POOL_BLOCK_ALIGNMENT = 64;
+  static const size_t POOL_BLOCK_PREFIX = 64;
+  static const int POOL_UNPOOLED_CLASS = -1;
+
+  static char* allocate_block(size_t bytes)
+  {
+    void* p = 0;
+#ifdef _WIN32
+    p = _aligned_malloc(bytes, POOL_BLOCK_ALIGNMENT);
+#else
+    if (posix_memalign(&p, POOL_BLOCK_ALIGNMENT, bytes) != 0) p = 0;
+#endif
+    return static_cast<char*>(p);
+  }
+
+  static void free_block(void* p)
+  {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+  }
+
+  size_t GadgetMessageBlockPool::max_cached_bytes_ = 256*1024*1024;
+
+  GadgetMessageBlockPool* GadgetMessageBlockPool::instance()
+  {
+    //Initialized once by the first reader thread; never destroyed, as message blocks may still be released during exit
+    static GadgetMessageBlockPool* pool = new GadgetMessageBlockPool();
+    return pool;
+  }
+
+  void GadgetMessageBlockPool::set_max_cached_bytes(size_t bytes)
+  {
+    max_cached_bytes_ = bytes;
+    if (bytes == 0) {
+      instance()->trim();
+    }
+  }
+
+  GadgetMessageBlockPool::GadgetMessageBlockPool()
+    : bytes_cached_(0)
+    , bytes_in_use_unpooled_(0)
+    , misses_unpooled_(0)
+  {
+    for (int c = 0; c < NUMBER_OF_SIZE_CLASSES; c++) {
+      classes_[c].hits_ = 0;
+      classes_[c].misses_ = 0;
+      classes_[c].in_use_ = 0;
+    }
+  }
+
+  GadgetMessageBlockPool::~GadgetMessageBlockPool()
+  {
+    this->trim();
+  }
+
+  int GadgetMessageBlockPool::size_class(size_t nbytes)
+  {
+    int c = 0;
+    size_t class_size = size_t(1) << MIN_SIZE_CLASS_BITS;
+    while (class_size < nbytes) {
+      class_size <<= 1;
+      c++;
+      if (c >= NUMBER_OF_SIZE_CLASSES) return POOL_UNPOOLED_CLASS;
+    }
+    return c;
+  }
+
+  void* GadgetMessageBlockPool::malloc(size_t nbytes)
+  {
+    int c = size_class(nbytes);
+
+    char* block = 0;
+    if (c == POOL_UNPOOLED_CLASS) {
+      block = allocate_block(nbytes + POOL_BLOCK_PREFIX);
+      if (!block) return 0;
+
+      ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, cached_mutex_, 0);
+      misses_unpooled_++;
+      bytes_in_use_unpooled_ += nbytes;
+      *reinterpret_cast<int*>(block) = c;
+      *reinterpret_cast<size_t*>(block + sizeof(size_t)) = nbytes;
+      return block + POOL_BLOCK_PREFIX;
+    }
+
+    size_t class_size = size_t(1) << (c + MIN_SIZE_CLASS_BITS);
+    SizeClass& sc = classes_[c];
+    {
+      ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, sc.mutex_, 0);
+      if (!sc.free_list_.empty()) {
+	block = static_cast<char*>(sc.free_list_.back());
+	sc.free_list_.pop_back();
+	sc.hits_++;
+      } else {
+	sc.misses_++;
+      }
+      sc.in_use_++;
+    }
+
+    if (block) {
+      ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, cached_mutex_, 0);
+      bytes_cached_ -= class_size;
+    } else {
+      block = allocate_block(class_size + POOL_BLOCK_PREFIX);
+      if (!block) {
+	ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, sc.mutex_, 0);
+	sc.in_use_--;
+	return 0;
+      }
+      *reinterpret_cast<int*>(block) = c;
+    }
+
+    return block + POOL_BLOCK_PREFIX;
+  }
+
+  void* GadgetMessageBlockPool::calloc(size_t nbytes, char initial_value)
+  {
+    void* ptr = this->malloc(nbytes);
+    if (ptr) std::memset(ptr, initial_value, nbytes);
+    return ptr;
+  }
+
+  void* GadgetMessageBlockPool::calloc(size_t n_elem, size_t elem_size, char initial_value)
+  {
+    return this->calloc(n_elem*elem_size, initial_value);
+  }
+
+  void GadgetMessageBlockPool::free(void* ptr)
+  {
+    if (!ptr) return;
+
+    char* block = static_cast<char*>(ptr) - POOL_BLOCK_PREFIX;
+    int c = *reinterpret_cast<int*>(block);
+
+    if (c == POOL_UNPOOLED_CLASS) {
+      size_t nbytes = *reinterpret_cast<size_t*>(block + sizeof(size_t));
+      {
+	ACE_GUARD(ACE_Thread_Mutex, guard, cached_mutex_);
+	bytes_in_use_unpooled_ -= nbytes;
+      }
+      free_block(block);
+      return;
+    }
+
+    size_t class_size = size_t(1) << (c + MIN_SIZE_CLASS_BITS);
+    bool cache_it = false;
+    {
+      ACE_GUARD(ACE_Thread_Mutex, guard, cached_mutex_);
+      if (bytes_cached_ + class_size <= max_cached_bytes_) {
+	bytes_cached_ += class_size;
+	cache_it = true;
+      }
+    }
+
+    SizeClass& sc = classes_[c];
+    {
+      ACE_GUARD(ACE_Thread_Mutex, guard, sc.mutex_);
+      sc.in_use_--;
+      if (cache_it) {
+	sc.free_list_.push_back(block);
+	return;
+      }
+    }
+
+    free_block(block);
+  }
+
+  void GadgetMessageBlockPool::trim()
+  {
+    for (int c = 0; c < NUMBER_OF_SIZE_CLASSES; c++) {
+      std::vector<void*> blocks;
+      {
+	ACE_GUARD(ACE_Thread_Mutex, guard, classes_[c].mutex_);
+	blocks.swap(classes_[c].free_list_);
+      }
+
+      size_t class_size = size_t(1) << (c + MIN_SIZE_CLASS_BITS);
+      {
+	ACE_GUARD(ACE_Thread_Mutex, guard, cached_mutex_);
+	bytes_cached_ -= class_size*blocks.size();
+      }
+
+      for (size_t i = 0; i < blocks.size(); i++) {
+	free_block(blocks[i]);
+      }
+    }
+  }
+
+  GadgetMessageBlockPool::Statistics GadgetMessageBlockPool::get_statistics()
+  {
+    Statistics s;
+    s.hits = 0;
+    s.misses = 0;
+    s.bytes_in_use = 0;
+
+    for (int c = 0; c < NUMBER_OF_SIZE_CLASSES; c++) {
+      ACE_Guard<ACE_Thread_Mutex> guard(classes_[c].mutex_);
+      s.hits += classes_[c].hits_;
+      s.misses += classes_[c].misses_;
+      s.bytes_in_use += classes_[c].in_use_ * (size_t(1) << (c + MIN_SIZE_CLASS_BITS));
+    }
+
+    {
+      ACE_Guard<ACE_Thread_Mutex> guard(cached_mutex_);
+      s.misses += misses_unpooled_;
+      s.bytes_in_use += bytes_in_use_unpooled_;
+      s.bytes_cached = bytes_cached_;
+    }
+
+    s.bytes_resident = s.bytes_in_use + s.bytes_cached;
+    s.max_cached_bytes = max_cached_bytes_;
+    return s;
+  }
+
+  void GadgetMessageBlockPool::print_statistics()
+  {
+    Statistics s = this->get_statistics();
+    GINFO("Message block pool: %llu hits, %llu misses, %llu bytes in use, %llu bytes cached (limit %llu), %llu bytes resident\n",
+	  s.hits, s.misses, s.bytes_in_use, s.bytes_cached, s.max_cached_bytes, s.bytes_resident);
+  }
+}
@@ -0,0 +1,138 @@
+#ifndef GADGETMESSAGEBLOCKPOOL_H
+#define GADGETMESSAGEBLOCKPOOL_H
+
+#include "gadgetbase_export.h"
+#include "GadgetContainerMessage.h"
+
+#include <ace/Malloc_Allocator.h>
+#include <ace/Message_Block.h>
+#include <ace/Thread_Mutex.h>
+
+#include <new>
+#include <vector>
+
+namespace Gadgetron{
+
+/**
+   Size-classed pool for message data blocks.
+
+   Buffers are grouped in power-of-two size classes and kept on per-class
+   free lists when the data block holding them is released, so that the readers
+   in the stream controller can receive acquisitions and images into recycled
+   memory instead of going through malloc/free for every message. Requests
+   larger than the biggest size class are passed straight to the heap.
+   All buffers, and the payload of create_message, are 64 byte aligned.
+
+   The pool is an ACE_Allocator, so it can be handed to ACE_Data_Block as the
+   allocator strategy; the buffer returns to the pool when the last message
+   block referencing it calls release().
+ */
+class EXPORTGADGETBASE GadgetMessageBlockPool : public ACE_New_Allocator
+{
+ public:
+
+  enum {
+    MIN_SIZE_CLASS_BITS = 8,   // 256 bytes
+    MAX_SIZE_CLASS_BITS = 26,  // 64 MB
+    NUMBER_OF_SIZE_CLASSES = MAX_SIZE_CLASS_BITS - MIN_SIZE_CLASS_BITS + 1
+  };
+
+  struct Statistics
+  {
+    unsigned long long hits;            // allocations served from a free list
+    unsigned long long misses;          // allocations that went to the heap
+    unsigned long long bytes_in_use;    // bytes handed out and not yet released
+    unsigned long long bytes_cached;    // bytes parked on the free lists
+    unsigned long long bytes_resident;  // bytes_in_use + bytes_cached
+    unsigned long long max_cached_bytes;
+  };
+
+  static GadgetMessageBlockPool* instance();
+
+  /**
+     Upper limit for the number of bytes kept on the free lists.
+     Buffers released while the pool is at the limit are returned to the heap.
+     Setting 0 disables caching.
+   */
+  static void set_max_cached_bytes(size_t bytes);
+
+  virtual void* malloc(size_t nbytes);
+  virtual void* calloc(size_t nbytes, char initial_value = '\0');
+  virtual void* calloc(size_t n_elem, size_t elem_size, char initial_value = '\0');
+  virtual void free(void* ptr);
+
+  Statistics get_statistics();
+  void print_statistics();
+
+  /**
+     Return all cached buffers to the heap
+   */
+  void trim();
+
+  /**
+     Create a container message whose data block is allocated from the pool.
+     Room for payload_bytes is reserved behind the contained object, use payload() to access it.
+   */
+  template <class T> GadgetContainerMessage<T>* create_message(size_t payload_bytes = 0)
+  {
+    size_t total = header_size<T>() + payload_bytes;
+
+    //The data block itself is released with data_block_allocator->free(), so it has to come from the same allocator
+    ACE_Allocator* data_block_allocator = ACE_Allocator::instance();
+    ACE_Data_Block* db = 0;
+    ACE_NEW_MALLOC_RETURN(db,
+			  static_cast<ACE_Data_Block*>(data_block_allocator->malloc(sizeof(ACE_Data_Block))),
+			  ACE_Data_Block(total, ACE_Message_Block::MB_DATA, 0, this, 0, 0, data_block_allocator),
+			  0);
+
+    if (!db->base()) {
+      db->release();
+      return 0;
+    }
+
+    new (db->base()) T();
+
+    GadgetContainerMessage<T>* m = new GadgetContainerMessage<T>(db);
+    m->wr_ptr(total);
+    return m;
+  }
+
+  template <class T> static char* payload(GadgetContainerMessage<T>* m)
+  {
+    return m->base() + header_size<T>();
+  }
+
+ protected:
+
+  GadgetMessageBlockPool();
+  virtual ~GadgetMessageBlockPool();
+
+  //Payload follows the object at a 64 byte boundary
+  template <class T> static size_t header_size()
+  {
+    return (sizeof(T) + 63) & ~size_t(63);
+  }
+
+  static int size_class(size_t nbytes);
+
+  struct SizeClass
+  {
+    ACE_Thread_Mutex mutex_;
+    std::vector<void*> free_list_;
+    unsigned long long hits_;
+    unsigned long long misses_;
+    unsigned long long in_use_;
+  };
+
+  SizeClass classes_[NUMBER_OF_SIZE_CLASSES];
+
+  ACE_Thread_Mutex cached_mutex_;
+  unsigned long long bytes_cached_;
+  unsigned long long bytes_in_use_unpooled_;
+  unsigned long long misses_unpooled_;
+
+  static size_t max_cached_bytes_;
+};
+
+}
+#endif //GADGETMESSAGEBLOCKPOOL_H
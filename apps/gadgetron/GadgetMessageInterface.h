@@ -7,7 +7,10 @@
 
 #include <ace/SOCK_Stream.h>
 #include <ace/Basic_Types.h>
+#include <ace/os_include/sys/os_uio.h>
 #include <map>
+#include <deque>
+#include <vector>
 
 namespace Gadgetron
 {
@@ -18,6 +21,7 @@ enum GadgetronMessageID {
   GADGET_MESSAGE_CONFIG_SCRIPT    =   2,
   GADGET_MESSAGE_PARAMETER_SCRIPT =   3,
   GADGET_MESSAGE_CLOSE            =   4,
+  GADGET_MESSAGE_STATISTICS       =   5, //Queue and Gadget statistics of a running stream, answered with the same id followed by GadgetMessageScript and the text
   GADGET_MESSAGE_INT_ID_MAX       = 999
 };
 
@@ -54,6 +58,126 @@ class GadgetMessageReader
 
 };
 
+/**
+   Scatter/gather list for sending several messages with a single system call.
+
+   Writers add pointers into the message blocks, which the caller keeps alive until the list has been sent.
+   Data that does not live in the message (identifiers, serialized attributes) is copied into scratch buffers
+   owned by the list.
+ */
+class GadgetMessageIOVector
+{
+ public:
+  GadgetMessageIOVector()
+    : bytes_(0)
+  {
+  }
+
+  void add(const void* data, size_t len)
+  {
+    if (!len) return;
+    iovec v;
+    v.iov_base = static_cast<char*>(const_cast<void*>(data));
+    v.iov_len = len;
+    iov_.push_back(v);
+    bytes_ += len;
+  }
+
+  void add_copy(const void* data, size_t len)
+  {
+    if (!len) return;
+    const char* d = static_cast<const char*>(data);
+    scratch_.push_back(std::vector<char>(d, d + len));
+    this->add(&scratch_.back()[0], len);
+  }
+
+  size_t count() const
+  {
+    return iov_.size();
+  }
+
+  size_t bytes() const
+  {
+    return bytes_;
+  }
+
+  const iovec* data() const
+  {
+    return iov_.empty() ? 0 : &iov_[0];
+  }
+
+  /**
+     Drop the entries added after the first n, used when a writer fails half way
+   */
+  void truncate(size_t n)
+  {
+    while (iov_.size() > n) {
+      bytes_ -= iov_.back().iov_len;
+      iov_.pop_back();
+    }
+  }
+
+  void clear()
+  {
+    iov_.clear();
+    scratch_.clear();
+    bytes_ = 0;
+  }
+
+  /**
+     Send the list with as few writes as possible, each of at most max_bytes_per_send bytes and ACE_IOV_MAX entries.
+     Entries are split where a write ends. Returns -1 on failure, sent is set to the number of bytes written
+     and writes to the number of sendv_n calls made.
+   */
+  int send_n(ACE_SOCK_Stream* stream, size_t max_bytes_per_send, size_t* sent = 0, size_t* writes = 0) const
+  {
+    std::vector<iovec> blocks;
+    size_t bytes = 0;
+    size_t total = 0;
+    if (sent) *sent = 0;
+    if (writes) *writes = 0;
+
+    for (size_t n = 0; n < iov_.size(); n++) {
+      char* ptr = static_cast<char*>(iov_[n].iov_base);
+      size_t len = iov_[n].iov_len;
+
+      while (len > 0) {
+	size_t block_len = max_bytes_per_send - bytes;
+	if (len < block_len) block_len = len;
+
+	iovec v;
+	v.iov_base = ptr;
+	v.iov_len = block_len;
+	blocks.push_back(v);
+
+	ptr += block_len;
+	len -= block_len;
+	bytes += block_len;
+
+	bool last = (n+1 == iov_.size()) && (len == 0);
+	if (last || bytes == max_bytes_per_send || blocks.size() == (size_t)ACE_IOV_MAX) {
+	  size_t block_sent = 0;
+	  ssize_t res = stream->sendv_n(&blocks[0], static_cast<int>(blocks.size()), 0, &block_sent);
+	  if (writes) (*writes)++;
+	  total += block_sent;
+	  if (sent) *sent = total;
+	  if (res <= 0) return -1;
+
+	  blocks.clear();
+	  bytes = 0;
+	}
+      }
+    }
+
+    return 0;
+  }
+
+ protected:
+  std::vector<iovec> iov_;
+  std::deque< std::vector<char> > scratch_;
+  size_t bytes_;
+};
+
 /**
    Interface for classes capable of writing for writing a specific message to a socket. 
    This is an abstract class, implementations need to be done for each message type.
@@ -67,6 +191,16 @@ class GadgetMessageWriter
      Function must be implemented to write a specific message.
    */
   virtual int write(ACE_SOCK_Stream* stream, ACE_Message_Block* mb) = 0;
+
+  /**
+     Optionally append the message to a scatter/gather list instead of writing it, so that
+     consecutive messages can be sent together. The message block stays alive until the list has been sent.
+     Returns -1 if not supported, the message is then sent with write().
+   */
+  virtual int gather(GadgetMessageIOVector& iov, ACE_Message_Block* mb)
+  {
+    return -1;
+  }
 };
 
 class GadgetMessageWriterContainer
@@ -213,6 +347,40 @@ class GadgetMessageScriptReader : public GadgetMessageReader
   }
 };
 
+/**
+   Sends the reply to GADGET_MESSAGE_STATISTICS, framed like a script:
+   the message identifier, GadgetMessageScript with the text length and the text in mb.
+ */
+class GadgetMessageStatisticsWriter : public GadgetMessageWriter
+{
+ public:
+  virtual int write(ACE_SOCK_Stream* stream, ACE_Message_Block* mb) {
+
+    GadgetMessageIdentifier id;
+    id.id = GADGET_MESSAGE_STATISTICS;
+
+    GadgetMessageScript ms;
+    ms.script_length = mb ? (ACE_UINT32)mb->length() : 0;
+
+    if (stream->send_n(&id, sizeof(GadgetMessageIdentifier)) <= 0) {
+      GERROR("Unable to send statistics message identifier\n");
+      return -1;
+    }
+
+    if (stream->send_n(&ms, sizeof(GadgetMessageScript)) <= 0) {
+      GERROR("Unable to send statistics length\n");
+      return -1;
+    }
+
+    if (ms.script_length && stream->send_n(mb->rd_ptr(), ms.script_length) <= 0) {
+      GERROR("Unable to send statistics\n");
+      return -1;
+    }
+
+    return 0;
+  }
+};
+
 /* Macros for handling dyamic linking */
 
 //#define GADGETRON_READER_DECLARE(READER) \
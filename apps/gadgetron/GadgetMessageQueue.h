@@ -0,0 +1,280 @@
+#ifndef GADGETMESSAGEQUEUE_H
+#define GADGETMESSAGEQUEUE_H
+#pragma once
+
+#include <ace/Message_Queue.h>
+#include <ace/Guard_T.h>
+#include <ace/Synch_Traits.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include "GadgetInstrumentation.h"
+#include "GadgetThreadPool.h"
+
+#include <deque>
+
+#define GADGET_QUEUE_DEFAULT_HWM (64*1024*1024)
+#define GADGET_QUEUE_DEFAULT_LWM (48*1024*1024)
+
+namespace Gadgetron{
+
+  struct GadgetQueueStatistics
+  {
+    size_t message_count;
+    size_t message_bytes;
+    size_t high_water_mark;
+    size_t low_water_mark;
+    size_t max_messages;
+    size_t peak_message_count;
+    size_t peak_message_bytes;
+    unsigned long long enqueued;
+    unsigned long long bytes_enqueued; // total length of all message blocks enqueued
+    unsigned long long blocked_puts;   // number of putq calls that had to wait for room
+  };
+
+  /**
+     Message queue used by the Gadgets.
+
+     Besides the byte based high/low water marks of ACE_Message_Queue, an optional limit on
+     the number of queued messages can be set. Many messages only account for the size of their
+     container objects, so the message limit is the more meaningful bound for those.
+     When the queue is full putq blocks, which propagates back up the stream to the socket reader.
+
+     While GadgetInstrumentation is enabled, the enqueue time of every message is kept and the
+     time it spent in the queue is recorded in the wait time histogram when it is dequeued.
+
+     When the queue is attached to the GadgetThreadPool, no thread waits on it. Instead a drain task is
+     submitted to the pool when a message arrives, as long as fewer than max_drainers are active.
+     A drainer keeps taking messages with dequeue_or_retire() until the queue is empty.
+     With max_drainers = 1 the messages are processed one at a time in queue order.
+   */
+  class GadgetMessageQueue : public ACE_Message_Queue<ACE_MT_SYNCH>
+  {
+  public:
+    typedef ACE_Message_Queue<ACE_MT_SYNCH> inherited;
+
+    GadgetMessageQueue(size_t hwm = GADGET_QUEUE_DEFAULT_HWM, size_t lwm = GADGET_QUEUE_DEFAULT_LWM, size_t max_messages = 0)
+      : inherited(hwm, lwm)
+      , max_messages_(max_messages)
+      , peak_count_(0)
+      , peak_bytes_(0)
+      , enqueued_(0)
+      , bytes_enqueued_(0)
+      , blocked_puts_(0)
+      , wait_time_(0)
+      , timestamping_(false)
+      , drain_task_(0)
+      , max_drainers_(0)
+      , drainers_(0)
+      , idle_(this->lock_)
+    {
+    }
+
+    virtual ~GadgetMessageQueue()
+    {
+    }
+
+    /**
+       Maximum number of queued messages, 0 means no limit
+     */
+    virtual void max_messages(size_t m)
+    {
+      ACE_GUARD(ACE_Thread_Mutex, guard, this->lock_);
+      max_messages_ = m;
+      this->signal_enqueue_waiters();
+    }
+
+    virtual size_t max_messages()
+    {
+      return max_messages_;
+    }
+
+    /**
+       Histogram receiving the time messages spend in this queue
+     */
+    void wait_time_histogram(GadgetLatencyHistogram* h)
+    {
+      ACE_GUARD(ACE_Thread_Mutex, guard, this->lock_);
+      wait_time_ = h;
+    }
+
+    /**
+       Have the messages of this queue processed by drain_task on the thread pool,
+       with at most max_drainers instances of the task running at the same time
+     */
+    void attach_to_pool(GadgetPoolTask* drain_task, size_t max_drainers)
+    {
+      ACE_GUARD(ACE_Thread_Mutex, guard, this->lock_);
+      drain_task_ = drain_task;
+      max_drainers_ = (max_drainers > 0) ? max_drainers : 1;
+      while (drainers_ < max_drainers_ && drainers_ < this->cur_count_) {
+        drainers_++;
+        GadgetThreadPool::instance()->submit(drain_task_);
+      }
+    }
+
+    void detach_from_pool()
+    {
+      ACE_GUARD(ACE_Thread_Mutex, guard, this->lock_);
+      drain_task_ = 0;
+    }
+
+    /**
+       Take the next message for a drain task. When the queue is empty the calling drainer retires and -1 is returned;
+       checking and retiring under the same lock ensures a message enqueued afterwards schedules a new drainer.
+     */
+    int dequeue_or_retire(ACE_Message_Block*& first_item)
+    {
+      ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, this->lock_, -1);
+      if (this->cur_count_ > 0 && this->dequeue_head_i(first_item) >= 0) return 0;
+
+      drainers_--;
+      if (drainers_ == 0) idle_.broadcast();
+      return -1;
+    }
+
+    /**
+       Wait until the queue is empty and all drainers have retired
+     */
+    int wait_idle()
+    {
+      ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, this->lock_, -1);
+      while (this->cur_count_ > 0 || drainers_ > 0) {
+        if (idle_.wait() == -1) return -1;
+      }
+      return 0;
+    }
+
+    GadgetQueueStatistics get_statistics()
+    {
+      GadgetQueueStatistics s;
+      ACE_Guard<ACE_Thread_Mutex> guard(this->lock_);
+      s.message_count = this->cur_count_;
+      s.message_bytes = this->cur_bytes_;
+      s.high_water_mark = this->high_water_mark_;
+      s.low_water_mark = this->low_water_mark_;
+      s.max_messages = max_messages_;
+      s.peak_message_count = peak_count_;
+      s.peak_message_bytes = peak_bytes_;
+      s.enqueued = enqueued_;
+      s.bytes_enqueued = bytes_enqueued_;
+      s.blocked_puts = blocked_puts_;
+      return s;
+    }
+
+  protected:
+
+    //All of the functions below are called by ACE_Message_Queue with lock_ held
+
+    virtual bool is_full_i(void)
+    {
+      if (max_messages_ && this->cur_count_ >= max_messages_) return true;
+      return inherited::is_full_i();
+    }
+
+    virtual int wait_not_full_cond(ACE_Time_Value* timeout)
+    {
+      if (!this->is_full_i()) return 0;
+      blocked_puts_++;
+
+      //A pool thread waiting here is replaced by a spare thread, the consumers of this queue may need one
+      GadgetThreadPool* pool = GadgetThreadPool::instance();
+      if (pool) pool->begin_blocking();
+      int res = inherited::wait_not_full_cond(timeout);
+      if (pool) pool->end_blocking();
+      return res;
+    }
+
+    virtual int enqueue_tail_i(ACE_Message_Block* new_item)
+    {
+      sync_timestamps();
+      int res = inherited::enqueue_tail_i(new_item);
+      if (res >= 0) {
+        update_peaks(new_item);
+        if (timestamping_) timestamps_.push_back(GadgetInstrumentation::now());
+        schedule_drainer();
+      }
+      return res;
+    }
+
+    virtual int enqueue_head_i(ACE_Message_Block* new_item)
+    {
+      sync_timestamps();
+      int res = inherited::enqueue_head_i(new_item);
+      if (res >= 0) {
+        update_peaks(new_item);
+        if (timestamping_) timestamps_.push_front(GadgetInstrumentation::now());
+        schedule_drainer();
+      }
+      return res;
+    }
+
+    virtual int dequeue_head_i(ACE_Message_Block*& first_item)
+    {
+      sync_timestamps();
+      int res = inherited::dequeue_head_i(first_item);
+
+      if (res >= 0 && timestamping_ && !timestamps_.empty()) {
+        unsigned long long t = timestamps_.front();
+        timestamps_.pop_front();
+        if (t && wait_time_) wait_time_->record(GadgetInstrumentation::now() - t);
+      }
+
+      //The base class only wakes up writers based on bytes
+      if (res >= 0 && max_messages_ && this->cur_count_ < max_messages_) {
+        this->signal_enqueue_waiters();
+      }
+      return res;
+    }
+
+    virtual int flush_i(void)
+    {
+      timestamps_.clear();
+      return inherited::flush_i();
+    }
+
+    //Messages queued before instrumentation was switched on get an empty time stamp
+    void sync_timestamps()
+    {
+      bool on = GadgetInstrumentation::enabled() && wait_time_;
+      if (on == timestamping_) return;
+
+      timestamps_.clear();
+      if (on) timestamps_.resize(this->cur_count_, 0);
+      timestamping_ = on;
+    }
+
+    void schedule_drainer()
+    {
+      if (drain_task_ && drainers_ < max_drainers_) {
+        drainers_++;
+        GadgetThreadPool::instance()->submit(drain_task_);
+      }
+    }
+
+    void update_peaks(ACE_Message_Block* new_item)
+    {
+      enqueued_++;
+      bytes_enqueued_ += new_item->total_length();
+      if (this->cur_count_ > peak_count_) peak_count_ = this->cur_count_;
+      if (this->cur_bytes_ > peak_bytes_) peak_bytes_ = this->cur_bytes_;
+    }
+
+    size_t max_messages_;
+    size_t peak_count_;
+    size_t peak_bytes_;
+    unsigned long long enqueued_;
+    unsigned long long bytes_enqueued_;
+    unsigned long long blocked_puts_;
+
+    GadgetLatencyHistogram* wait_time_;
+    std::deque<unsigned long long> timestamps_;
+    bool timestamping_;
+
+    GadgetPoolTask* drain_task_;
+    size_t max_drainers_;
+    size_t drainers_;
+    ACE_Condition_Thread_Mutex idle_;
+  };
+}
+
+#endif //GADGETMESSAGEQUEUE_H
@@ -6,6 +6,7 @@
 #include "GadgetStreamController.h"
 #include "GadgetContainerMessage.h"
 #include "GadgetMessageInterface.h"
+#include "GadgetMessageBlockPool.h"
 #include "GadgetronConnector.h"
 #include "Gadget.h"
 #include "EndGadget.h"
@@ -20,6 +21,15 @@
 
 using namespace Gadgetron;
 
+size_t GadgetStreamController::writer_flush_bytes_ = GADGET_WRITER_DEFAULT_FLUSH_BYTES;
+unsigned long GadgetStreamController::writer_max_latency_us_ = 0;
+
+void GadgetStreamController::set_writer_batching(size_t flush_bytes, unsigned long max_latency_us)
+{
+  writer_flush_bytes_ = flush_bytes;
+  writer_max_latency_us_ = max_latency_us;
+}
+
 GadgetStreamController::GadgetStreamController()
   : GadgetStreamInterface()
   , notifier_ (0, this, ACE_Event_Handler::WRITE_MASK)
@@ -57,6 +67,9 @@ int GadgetStreamController::open (void)
   readers_.insert(GADGET_MESSAGE_PARAMETER_SCRIPT,
 		  new GadgetMessageScriptReader());
 
+  writer_task_.register_writer(GADGET_MESSAGE_STATISTICS,
+			       new GadgetMessageStatisticsWriter());
+
   GadgetModule *head = 0;
   GadgetModule *tail = 0;
 
@@ -74,6 +87,7 @@ int GadgetStreamController::open (void)
     stream_.open(0,head,tail);
   }
 
+  this->writer_task_.set_batching(writer_flush_bytes_, writer_max_latency_us_);
   this->writer_task_.open();
 
   return this->activate( THR_NEW_LWP | THR_JOINABLE, 1);
@@ -90,12 +104,38 @@ int GadgetStreamController::svc(void)
       return -1;
     }
 
+    if (id.id == GADGET_MESSAGE_STATISTICS) {
+      //Log the statistics and return them to the client, behind the output already queued
+      std::string text = this->format_queue_statistics();
+      if (GadgetInstrumentation::enabled()) text += this->format_instrumentation_statistics();
+      if (!text.empty()) GINFO("%s", text.c_str());
+
+      GadgetContainerMessage<GadgetMessageIdentifier>* mid =
+	new GadgetContainerMessage<GadgetMessageIdentifier>();
+      mid->getObjectPtr()->id = GADGET_MESSAGE_STATISTICS;
+
+      ACE_Message_Block* mtext = new ACE_Message_Block(text.size());
+      ACE_OS::memcpy(mtext->wr_ptr(), text.c_str(), text.size());
+      mtext->wr_ptr(text.size());
+      mid->cont(mtext);
+
+      if (this->output_ready(mid) < 0) {
+	GERROR("Unable to queue statistics reply\n");
+	mid->release();
+      }
+      continue;
+    }
+
     if (id.id == GADGET_MESSAGE_CLOSE) {
+      this->print_queue_statistics();
+      if (GadgetInstrumentation::enabled()) this->print_instrumentation_statistics();
       stream_.close(1); //Shutdown gadgets and wait for them
       GDEBUG("Stream closed\n");
       GDEBUG("Closing writer task\n");
       this->writer_task_.close(1);
       GDEBUG("Writer task closed\n");
+      GadgetMessageBlockPool::instance()->print_statistics();
+      if (GadgetThreadPool::instance()) GadgetThreadPool::instance()->print_statistics();
       continue;
     }
 
@@ -376,6 +416,14 @@ int GadgetStreamController::configure(std::string config_xml_string)
 	  g->set_parameter(key.c_str(), value.c_str(), false);
         }
 
+      if (i->queue) {
+	size_t hwm = size_t(i->queue->highWaterMarkMegaBytes)*1024*1024;
+	size_t lwm = i->queue->lowWaterMarkMegaBytes ? size_t(i->queue->lowWaterMarkMegaBytes)*1024*1024 : hwm;
+	GINFO("  Gadget queue: high water mark %d MB, low water mark %d MB, max messages %d\n",
+	      i->queue->highWaterMarkMegaBytes, (int)(lwm/(1024*1024)), i->queue->maxMessages);
+	g->set_queue_limits(hwm, lwm, i->queue->maxMessages);
+      }
+
       if (stream_.push(m) < 0) {
 	GERROR("Failed to push Gadget %s onto stream\n", gadgetname.c_str());
 	delete m;
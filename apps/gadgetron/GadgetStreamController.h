@@ -37,7 +37,16 @@ public:
 
   virtual int output_ready(ACE_Message_Block* mb);
 
+  /**
+     Batching of the messages sent back to the client, applied to streams opened afterwards.
+     See WriterTask::set_batching.
+   */
+  static void set_writer_batching(size_t flush_bytes, unsigned long max_latency_us);
+
 private:
+  static size_t writer_flush_bytes_;
+  static unsigned long writer_max_latency_us_;
+
   WriterTask writer_task_;
   ACE_Reactor_Notification_Strategy notifier_;
   GadgetMessageReaderContainer readers_;
@@ -4,6 +4,7 @@
 #include "ace/Stream.h"
 #include "ace/DLL.h"
 #include "ace/DLL_Manager.h"
+#include "ace/OS_NS_stdio.h"
 
 #include "gadgetron_paths.h"
 #include "Gadget.h"
@@ -41,6 +42,86 @@ namespace Gadgetron {
       return 0;
     }
 
+    /**
+       Input queue statistics for all Gadgets in the stream, in stream order
+     */
+    virtual void get_queue_statistics(std::vector< std::pair<std::string, GadgetQueueStatistics> >& stats)
+    {
+      stats.clear();
+
+      ACE_Stream_Iterator<ACE_MT_SYNCH> it(stream_);
+      const GadgetModule* m = 0;
+      for (; it.next(m) != 0; it.advance()) {
+	Gadget* g = dynamic_cast<Gadget*>(const_cast<GadgetModule*>(m)->writer());
+	if (g) {
+	  stats.push_back(std::make_pair(std::string(m->name()), g->get_queue_statistics()));
+	}
+      }
+    }
+
+    /**
+       Queue statistics as text, one line per Gadget
+     */
+    virtual std::string format_queue_statistics()
+    {
+      std::vector< std::pair<std::string, GadgetQueueStatistics> > stats;
+      this->get_queue_statistics(stats);
+
+      std::string text;
+      char line[1024];
+      for (size_t i = 0; i < stats.size(); i++) {
+	const GadgetQueueStatistics& s = stats[i].second;
+	double occupancy = s.high_water_mark ? (100.0*s.peak_message_bytes)/s.high_water_mark : 0.0;
+	ACE_OS::snprintf(line, sizeof(line), "Queue (%s): %d messages (%d bytes) queued, peak %d messages (%d bytes, %.1f%% of high water mark), %llu enqueued, %llu blocked puts\n",
+			 stats[i].first.c_str(), (int)s.message_count, (int)s.message_bytes,
+			 (int)s.peak_message_count, (int)s.peak_message_bytes, occupancy, s.enqueued, s.blocked_puts);
+	text += line;
+      }
+      return text;
+    }
+
+    /**
+       Message timing and throughput for all Gadgets in the stream as text.
+       The bytes passed on by a Gadget are taken from the input queue of the next Gadget.
+     */
+    virtual std::string format_instrumentation_statistics()
+    {
+      std::vector<Gadget*> gadgets;
+      std::vector<std::string> names;
+
+      ACE_Stream_Iterator<ACE_MT_SYNCH> it(stream_);
+      const GadgetModule* m = 0;
+      for (; it.next(m) != 0; it.advance()) {
+	Gadget* g = dynamic_cast<Gadget*>(const_cast<GadgetModule*>(m)->writer());
+	if (g) {
+	  gadgets.push_back(g);
+	  names.push_back(std::string(m->name()));
+	}
+      }
+
+      std::string text;
+      for (size_t i = 0; i < gadgets.size(); i++) {
+	unsigned long long bytes_out = 0;
+	if (i+1 < gadgets.size()) {
+	  bytes_out = gadgets[i+1]->get_queue_statistics().bytes_enqueued;
+	}
+	text += gadgets[i]->get_instrumentation().format(names[i].c_str(), bytes_out);
+      }
+      return text;
+    }
+
+    virtual void print_queue_statistics()
+    {
+      std::string text = this->format_queue_statistics();
+      if (!text.empty()) GINFO("%s", text.c_str());
+    }
+
+    virtual void print_instrumentation_statistics()
+    {
+      std::string text = this->format_instrumentation_statistics();
+      if (!text.empty()) GINFO("%s", text.c_str());
+    }
+
     void set_global_gadget_parameters(const std::map<std::string, std::string>& globalGadgetPara)
     {
       global_gadget_parameters_ = globalGadgetPara;
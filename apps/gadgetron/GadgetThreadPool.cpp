@@ -0,0 +1,246 @@
+#include "GadgetThreadPool.h"
+#include "log.h"
+
+#include <ace/Guard_T.h>
+#include <ace/TSS_T.h>
+#include <ace/OS_NS_unistd.h>
+#include <ace/OS_NS_Thread.h>
+
+namespace Gadgetron
+{
+  //Identifies the pool and deque a thread belongs to
+  struct GadgetPoolThreadContext
+  {
+    GadgetPoolThreadContext()
+      : pool_(0)
+      , worker_(-1)
+    {
+    }
+
+    GadgetThreadPool* pool_;
+    int worker_;
+  };
+
+  static ACE_TSS<GadgetPoolThreadContext> pool_thread_context;
+
+  GadgetThreadPool* GadgetThreadPool::instance_ = 0;
+
+  GadgetThreadPool* GadgetThreadPool::instance()
+  {
+    return instance_;
+  }
+
+  int GadgetThreadPool::enable(size_t threads)
+  {
+    if (instance_) return 0;
+
+    if (threads == 0) {
+      long cpus = ACE_OS::num_processors_online();
+      threads = (cpus > 0) ? static_cast<size_t>(cpus) : 1;
+    }
+
+    GadgetThreadPool* pool = new GadgetThreadPool(threads);
+    pool->running_ = threads;
+    if (pool->activate(THR_NEW_LWP | THR_JOINABLE, static_cast<int>(threads)) == -1) {
+      GERROR("Failed to start Gadget thread pool with %d threads\n", static_cast<int>(threads));
+      pool->running_ = 0;
+      return -1;
+    }
+
+    instance_ = pool;
+    GINFO("Gadget thread pool started with %d threads\n", static_cast<int>(threads));
+    return 0;
+  }
+
+  bool GadgetThreadPool::on_pool_thread()
+  {
+    return instance_ && (pool_thread_context->pool_ == instance_);
+  }
+
+  GadgetThreadPool::GadgetThreadPool(size_t threads)
+    : threads_(threads)
+    , work_available_(mutex_)
+    , pending_(0)
+    , idle_(0)
+    , running_(0)
+    , blocked_threads_(0)
+    , next_worker_(0)
+    , executed_(0)
+    , local_(0)
+    , stolen_(0)
+    , blocked_(0)
+  {
+    for (size_t i = 0; i < threads_; i++) {
+      workers_.push_back(new WorkerQueue());
+    }
+  }
+
+  GadgetThreadPool::~GadgetThreadPool()
+  {
+    for (size_t i = 0; i < workers_.size(); i++) {
+      delete workers_[i];
+    }
+  }
+
+  void GadgetThreadPool::submit(GadgetPoolTask* task, bool yield)
+  {
+    int worker = -1;
+    if (!yield && pool_thread_context->pool_ == this) {
+      worker = pool_thread_context->worker_;
+    }
+
+    WorkerQueue* q = (worker >= 0) ? workers_[worker] : &injected_;
+    {
+      ACE_GUARD(ACE_Thread_Mutex, guard, q->mutex_);
+      q->tasks_.push_back(task);
+    }
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, mutex_);
+    pending_++;
+    if (idle_) work_available_.signal();
+  }
+
+  void GadgetThreadPool::begin_blocking()
+  {
+    if (pool_thread_context->pool_ != this) return;
+
+    {
+      ACE_GUARD(ACE_Thread_Mutex, guard, mutex_);
+      blocked_threads_++;
+      blocked_++;
+      if (running_ - blocked_threads_ >= threads_) return;
+      running_++;
+    }
+
+    //Add a spare thread to the pool (force_active) to take over for the blocked one
+    if (this->activate(THR_NEW_LWP | THR_JOINABLE, 1, 1) == -1) {
+      GERROR("Failed to start spare Gadget pool thread\n");
+      ACE_GUARD(ACE_Thread_Mutex, guard, mutex_);
+      running_--;
+    }
+  }
+
+  void GadgetThreadPool::end_blocking()
+  {
+    if (pool_thread_context->pool_ != this) return;
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, mutex_);
+    blocked_threads_--;
+
+    //Let an idle spare thread notice that it is no longer needed
+    if (idle_ && (running_ - blocked_threads_ > threads_)) work_available_.broadcast();
+  }
+
+  int GadgetThreadPool::svc(void)
+  {
+    int worker = -1;
+    {
+      ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, mutex_, -1);
+      if (next_worker_ < threads_) worker = static_cast<int>(next_worker_++);
+    }
+
+    pool_thread_context->pool_ = this;
+    pool_thread_context->worker_ = worker;
+
+    for (GadgetPoolTask* task = 0; (task = this->take(worker)) != 0; ) {
+      try {
+        task->run();
+      }
+      catch (...) {
+        GERROR("Unhandled exception in Gadget pool task\n");
+      }
+      executed_++;
+    }
+
+    return 0;
+  }
+
+  GadgetPoolTask* GadgetThreadPool::take(int worker)
+  {
+    {
+      ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, mutex_, 0);
+      for (;;) {
+        //Spare threads leave as soon as the regular threads can carry the load again
+        if (worker < 0 && (running_ - blocked_threads_ > threads_)) {
+          running_--;
+          return 0;
+        }
+        if (pending_) break;
+
+        idle_++;
+        work_available_.wait();
+        idle_--;
+      }
+      pending_--;
+    }
+
+    //A task has been reserved for this thread, it may take a moment until the submitter has pushed it
+    for (;;) {
+      GadgetPoolTask* task = this->find_task(worker);
+      if (task) return task;
+      ACE_OS::thr_yield();
+    }
+  }
+
+  GadgetPoolTask* GadgetThreadPool::find_task(int worker)
+  {
+    if (worker >= 0) {
+      WorkerQueue* q = workers_[worker];
+      ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, q->mutex_, 0);
+      if (!q->tasks_.empty()) {
+        GadgetPoolTask* task = q->tasks_.back();
+        q->tasks_.pop_back();
+        local_++;
+        return task;
+      }
+    }
+
+    {
+      ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, injected_.mutex_, 0);
+      if (!injected_.tasks_.empty()) {
+        GadgetPoolTask* task = injected_.tasks_.front();
+        injected_.tasks_.pop_front();
+        return task;
+      }
+    }
+
+    size_t n = workers_.size();
+    size_t start = (worker >= 0) ? static_cast<size_t>(worker) + 1 : 0;
+    for (size_t k = 0; k < n; k++) {
+      size_t victim = (start + k) % n;
+      if (static_cast<int>(victim) == worker) continue;
+
+      WorkerQueue* q = workers_[victim];
+      ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, q->mutex_, 0);
+      if (!q->tasks_.empty()) {
+        GadgetPoolTask* task = q->tasks_.front();
+        q->tasks_.pop_front();
+        stolen_++;
+        return task;
+      }
+    }
+
+    return 0;
+  }
+
+  GadgetThreadPool::Statistics GadgetThreadPool::get_statistics()
+  {
+    Statistics s;
+    s.threads = threads_;
+    s.executed = executed_.load();
+    s.local = local_.load();
+    s.stolen = stolen_.load();
+
+    ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
+    s.spare_threads = (running_ > threads_) ? running_ - threads_ : 0;
+    s.blocked = blocked_;
+    return s;
+  }
+
+  void GadgetThreadPool::print_statistics()
+  {
+    Statistics s = this->get_statistics();
+    GINFO("Gadget thread pool: %d threads (+%d spare), %llu tasks, %llu local, %llu stolen, %llu blocked\n",
+	  static_cast<int>(s.threads), static_cast<int>(s.spare_threads), s.executed, s.local, s.stolen, s.blocked);
+  }
+}
@@ -0,0 +1,152 @@
+#ifndef GADGETTHREADPOOL_H
+#define GADGETTHREADPOOL_H
+#pragma once
+
+#include "gadgetbase_export.h"
+
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include <atomic>
+#include <deque>
+#include <vector>
+
+//Number of messages a Gadget processes before it gives other Gadgets a turn on its pool thread
+#define GADGET_POOL_DRAIN_QUANTUM 32
+
+namespace Gadgetron{
+
+  /**
+     Unit of work for the GadgetThreadPool
+   */
+  class GadgetPoolTask
+  {
+  public:
+    virtual ~GadgetPoolTask() {}
+    virtual void run() = 0;
+  };
+
+  /**
+     Process wide work-stealing thread pool executing the Gadgets of all streams.
+
+     Every pool thread owns a task deque. Tasks submitted from a pool thread go to the back of its own
+     deque and are picked up from there first, so that a message handed to the next Gadget is usually
+     processed on the same core while it is still in cache. Idle threads take tasks submitted from
+     outside the pool (or yielded by a Gadget that used up its quantum) from a shared FIFO, and
+     otherwise steal the oldest task from the other threads.
+
+     A pool thread that blocks on a full Gadget queue reports it with begin_blocking()/end_blocking().
+     A spare thread is started for every blocked pool thread, so that the Gadgets that have to drain
+     the full queue always get to run. Spare threads exit again once the blocked threads have resumed.
+
+     The pool is only created when enabled in the server configuration; without it every Gadget
+     runs its own threads.
+   */
+  class EXPORTGADGETBASE GadgetThreadPool : public ACE_Task_Base
+  {
+  public:
+
+    struct Statistics
+    {
+      size_t threads;                  // regular pool threads
+      size_t spare_threads;            // extra threads currently running because workers are blocked
+      unsigned long long executed;     // tasks run
+      unsigned long long local;        // tasks taken from the thread's own deque
+      unsigned long long stolen;       // tasks taken from another thread's deque
+      unsigned long long blocked;      // number of times a pool thread waited for a full queue
+    };
+
+    /**
+       The pool, or 0 if it has not been enabled
+     */
+    static GadgetThreadPool* instance();
+
+    /**
+       Create and start the pool. 0 threads means one per online processor.
+     */
+    static int enable(size_t threads = 0);
+
+    /**
+       True when called from one of the pool threads
+     */
+    static bool on_pool_thread();
+
+    /**
+       Queue a task. Yielded tasks always go to the shared FIFO so that they do not run again
+       ahead of the tasks already waiting on this thread.
+     */
+    void submit(GadgetPoolTask* task, bool yield = false);
+
+    void begin_blocking();
+    void end_blocking();
+
+    size_t number_of_threads() const { return threads_; }
+
+    Statistics get_statistics();
+    void print_statistics();
+
+    virtual int svc(void);
+
+  protected:
+    GadgetThreadPool(size_t threads);
+    virtual ~GadgetThreadPool();
+
+    GadgetPoolTask* take(int worker);
+    GadgetPoolTask* find_task(int worker);
+
+    struct WorkerQueue
+    {
+      ACE_Thread_Mutex mutex_;
+      std::deque<GadgetPoolTask*> tasks_;
+    };
+
+    size_t threads_;
+    std::vector<WorkerQueue*> workers_;
+    WorkerQueue injected_;
+
+    //Protects the counters below and is used for waking up idle threads
+    ACE_Thread_Mutex mutex_;
+    ACE_Condition_Thread_Mutex work_available_;
+    size_t pending_;
+    size_t idle_;
+    size_t running_;
+    size_t blocked_threads_;
+    size_t next_worker_;
+
+    std::atomic<unsigned long long> executed_;
+    std::atomic<unsigned long long> local_;
+    std::atomic<unsigned long long> stolen_;
+    unsigned long long blocked_;
+
+    static GadgetThreadPool* instance_;
+  };
+
+  /**
+     Marks a wait inside a Gadget that does not depend on a Gadget queue, e.g. for results computed by
+     another thread. While the pool thread waits, a spare thread takes over its work, so that the Gadgets
+     it is waiting for still get to run. Has no effect outside of the pool.
+   */
+  class GadgetPoolBlockingScope
+  {
+  public:
+    GadgetPoolBlockingScope()
+      : pool_(GadgetThreadPool::on_pool_thread() ? GadgetThreadPool::instance() : 0)
+    {
+      if (pool_) pool_->begin_blocking();
+    }
+
+    ~GadgetPoolBlockingScope()
+    {
+      if (pool_) pool_->end_blocking();
+    }
+
+  private:
+    GadgetPoolBlockingScope(const GadgetPoolBlockingScope&);
+    GadgetPoolBlockingScope& operator=(const GadgetPoolBlockingScope&);
+
+    GadgetThreadPool* pool_;
+  };
+}
+
+#endif //GADGETTHREADPOOL_H
@@ -2,6 +2,7 @@
 #include "pugixml.hpp"
 #include <stdexcept>
 #include <cstdlib>
+#include <string>
 
 namespace GadgetronXML
 {
@@ -44,6 +45,38 @@ namespace GadgetronXML
       h.cloudBus = cb;
     }
 
+    pugi::xml_node mp = root.child("messagePool");
+    if (mp) {
+      MessagePool pool;
+      pool.maxCachedMegaBytes = static_cast<unsigned int>(std::atoi(mp.child_value("maxCachedMegaBytes")));
+      h.messagePool = pool;
+    }
+
+    pugi::xml_node instr = root.child("instrumentation");
+    if (instr) {
+      h.instrumentation = (std::string(instr.child_value()) == std::string("true"));
+    }
+
+    pugi::xml_node tp = root.child("threadPool");
+    if (tp) {
+      ThreadPool pool;
+      pool.threads = static_cast<unsigned int>(std::atoi(tp.child_value("threads")));
+      h.threadPool = pool;
+    }
+
+    pugi::xml_node sw = root.child("socketWriter");
+    if (sw) {
+      SocketWriter w;
+      w.flushKiloBytes = static_cast<unsigned int>(std::atoi(sw.child_value("flushKiloBytes")));
+      w.maxLatencyMicroseconds = static_cast<unsigned int>(std::atoi(sw.child_value("maxLatencyMicroseconds")));
+      h.socketWriter = w;
+    }
+
+    pugi::xml_node fw = root.child("fftwWisdom");
+    if (fw) {
+      h.fftwWisdom = std::string(fw.child_value());
+    }
+
   }
 
   void deserialize(const char* xml_config, GadgetStreamConfiguration& cfg)
@@ -92,6 +125,18 @@ namespace GadgetronXML
         property = property.next_sibling("property");
       }
 
+      pugi::xml_node queue = gadget.child("queue");
+      if (queue) {
+        GadgetQueue q;
+        q.highWaterMarkMegaBytes = static_cast<unsigned int>(std::atoi(queue.child_value("highWaterMarkMegaBytes")));
+        q.lowWaterMarkMegaBytes = static_cast<unsigned int>(std::atoi(queue.child_value("lowWaterMarkMegaBytes")));
+        q.maxMessages = static_cast<unsigned int>(std::atoi(queue.child_value("maxMessages")));
+        if (q.highWaterMarkMegaBytes == 0) {
+          throw std::runtime_error("Invalid Gadget queue configuration, highWaterMarkMegaBytes must be set.");
+        }
+        g.queue = q;
+      }
+
       cfg.gadget.push_back(g);
       gadget = gadget.next_sibling("gadget");
     }
@@ -111,6 +156,13 @@ namespace GadgetronXML
     return std::string(buffer);
   }
 
+  std::string to_string_val(const unsigned int& v)
+  {
+    char buffer[256];
+    sprintf(buffer,"%u",v);
+    return std::string(buffer);
+  }
+
   void serialize(const GadgetStreamConfiguration& cfg, std::ostream& o)
   {
     pugi::xml_document doc;
@@ -186,6 +238,13 @@ namespace GadgetronXML
         n3 = n2.append_child("value");
         n3.append_child(pugi::node_pcdata).set_value(it2->value.c_str());
       }
+
+      if (it->queue) {
+        n2 = n1.append_child("queue");
+        append_node(n2, "highWaterMarkMegaBytes", to_string_val(it->queue->highWaterMarkMegaBytes));
+        append_node(n2, "lowWaterMarkMegaBytes", to_string_val(it->queue->lowWaterMarkMegaBytes));
+        append_node(n2, "maxMessages", to_string_val(it->queue->maxMessages));
+      }
     }
 
     doc.save(o);
@@ -80,11 +80,32 @@ namespace GadgetronXML
   };
 
 
+  struct MessagePool
+  {
+    unsigned int maxCachedMegaBytes;
+  };
+
+  struct ThreadPool
+  {
+    unsigned int threads;
+  };
+
+  struct SocketWriter
+  {
+    unsigned int flushKiloBytes;
+    unsigned int maxLatencyMicroseconds;
+  };
+
   struct GadgetronConfiguration
   {
     std::string port;
     std::vector<GadgetronParameter> globalGadgetParameter;
     Optional<CloudBus> cloudBus;    
+    Optional<MessagePool> messagePool;
+    Optional<bool> instrumentation;
+    Optional<ThreadPool> threadPool;
+    Optional<SocketWriter> socketWriter;
+    Optional<std::string> fftwWisdom;
   };
 
   void EXPORTGADGETBASE deserialize(const char* xml_config, GadgetronConfiguration& h);
@@ -98,12 +119,20 @@ namespace GadgetronXML
 
   typedef Reader Writer;
   
+  struct GadgetQueue
+  {
+    unsigned int highWaterMarkMegaBytes;
+    unsigned int lowWaterMarkMegaBytes;
+    unsigned int maxMessages;
+  };
+
   struct Gadget
   {
     std::string name;
     std::string dll;
     std::string classname;
     std::vector<GadgetronParameter> property;
+    Optional<GadgetQueue> queue;
   };
 
   struct GadgetStreamConfiguration
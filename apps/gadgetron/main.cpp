@@ -5,12 +5,17 @@
 #include "gadgetron_config.h"
 #include "gadgetron_paths.h"
 #include "CloudBus.h"
+#include "GadgetMessageBlockPool.h"
+#include "GadgetInstrumentation.h"
+#include "GadgetThreadPool.h"
+#include "GadgetStreamController.h"
 
 #include <ace/Log_Msg.h>
 #include <ace/Service_Config.h>
 #include <ace/Reactor.h>
 #include <ace/Get_Opt.h>
 #include <ace/OS_NS_string.h>
+#include <ace/OS_NS_stdlib.h>
 #include <iostream>
 #include <string>
 #include <fstream>
@@ -167,6 +172,34 @@ int ACE_TMAIN(int argc, ACE_TCHAR *argv[])
   }
 
 
+  if (c.messagePool) {
+    GINFO("Message block pool caching up to %d MB\n", c.messagePool->maxCachedMegaBytes);
+    Gadgetron::GadgetMessageBlockPool::set_max_cached_bytes(size_t(c.messagePool->maxCachedMegaBytes)*1024*1024);
+  }
+
+  if (c.instrumentation && *c.instrumentation) {
+    GINFO("Gadget instrumentation enabled\n");
+    Gadgetron::GadgetInstrumentation::enable(true);
+  }
+
+  if (c.socketWriter) {
+    GINFO("Socket writer flushing at %d kB or after %d us\n", c.socketWriter->flushKiloBytes, c.socketWriter->maxLatencyMicroseconds);
+    Gadgetron::GadgetStreamController::set_writer_batching(size_t(c.socketWriter->flushKiloBytes)*1024, c.socketWriter->maxLatencyMicroseconds);
+  }
+
+  //The FFT toolbox loads and saves its wisdom files based on this prefix, an existing environment setting takes precedence
+  if (c.fftwWisdom && !ACE_OS::getenv("GADGETRON_FFTW_WISDOM")) {
+    GINFO("FFTW wisdom files: %s_[float|double].wisdom\n", c.fftwWisdom->c_str());
+    ACE_OS::setenv("GADGETRON_FFTW_WISDOM", c.fftwWisdom->c_str(), 1);
+  }
+
+  if (c.threadPool) {
+    if (Gadgetron::GadgetThreadPool::enable(c.threadPool->threads) != 0) {
+      GERROR("Unable to start the Gadget thread pool\n");
+      return -1;
+    }
+  }
+
   // if the working directory is not set, use the default path
   if ( !workingDirectorySet )
     {
@@ -1,6 +1,7 @@
 #include "../mri_core/GadgetIsmrmrdReadWrite.h"
 #include "GrappaWeights.h"
 #include "hoNDArray_fileio.h"
+#include "GadgetThreadPool.h"
 
 namespace Gadgetron{
 
@@ -49,7 +50,11 @@ apply(hoNDArray< std::complex<T> >* data_in,
   if (!weights_are_valid_) {
 	  GDEBUG("Releasing Mutex to Wait for result\n");
 	  mutex_.release();
-	  cond_.wait();
+	  {
+	    //The weights are computed on another thread, let a spare pool thread run meanwhile
+	    GadgetPoolBlockingScope blocking;
+	    cond_.wait();
+	  }
 	  mutex_.acquire();
  }
 
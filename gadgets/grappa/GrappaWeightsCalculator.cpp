@@ -62,6 +62,18 @@ template <class T> int GrappaWeightsCalculator<T>::svc(void)  {
             return -3;
         }
 
+        size_t ref_checksum = Gadgetron::grappa_checksum(*mb2->getObjectPtr());
+
+        if (calibration_unchanged(mb1->getObjectPtr(), mb2->getObjectPtr(), ref_checksum)) {
+            mb->release();
+            continue;
+        }
+
+        record_calibration(mb1->getObjectPtr(), mb2->getObjectPtr(), ref_checksum);
+
+        // the image domain kernels are kept per destination
+        size_t slot = reinterpret_cast<size_t>(mb1->getObjectPtr()->destination.get());
+
         hoNDArray<float_complext>* host_data =
                 reinterpret_cast< hoNDArray<float_complext>* >(mb2->getObjectPtr());
 
@@ -216,15 +228,33 @@ template <class T> int GrappaWeightsCalculator<T>::svc(void)  {
                     size_t startE1 = mb1->getObjectPtr()->sampled_region[1].first;
                     size_t endE1 = mb1->getObjectPtr()->sampled_region[1].second;
 
-                    Gadgetron::grappa2d_calib_convolution_kernel(acs, target_acs,
-                        (size_t)(mb1->getObjectPtr()->acceleration_factor),
-                        thres, kRO, kNE1, startRO, endRO, startE1, endE1, conv_ker_);
+                    GrappaImageDomainKernelKey key;
+                    key.RO = RO;
+                    key.E1 = E1;
+                    key.calibRO = endRO - startRO + 1;
+                    key.calibE1 = endE1 - startE1 + 1;
+                    key.acceFactorE1 = mb1->getObjectPtr()->acceleration_factor;
+                    key.kRO = kRO;
+                    key.kNE1 = kNE1;
+                    key.srcCHA = target_coils_;
+                    key.dstCHA = target_coils_;
+                    key.checksum = ref_checksum;
+
+                    kIm_ = kIm_cache_.find(slot, key);
+                    if (!kIm_)
+                    {
+                        Gadgetron::grappa2d_calib_convolution_kernel(acs, target_acs,
+                            (size_t)(mb1->getObjectPtr()->acceleration_factor),
+                            thres, kRO, kNE1, startRO, endRO, startE1, endE1, conv_ker_);
 
-                    Gadgetron::grappa2d_image_domain_kernel(conv_ker_, RO, E1, kIm_);
+                        boost::shared_ptr< hoNDArray< std::complex<float> > > kIm(new hoNDArray< std::complex<float> >());
+                        Gadgetron::grappa2d_image_domain_kernel(conv_ker_, RO, E1, *kIm);
+                        kIm_ = kIm_cache_.insert(slot, key, kIm);
+                    }
 
                     Gadgetron::clear(unmixing_);
 
-                    Gadgetron::grappa2d_unmixing_coeff(kIm_, coil_map_, (size_t)(mb1->getObjectPtr()->acceleration_factor), unmixing_, gFactor_);
+                    Gadgetron::grappa2d_unmixing_coeff(*kIm_, coil_map_, (size_t)(mb1->getObjectPtr()->acceleration_factor), unmixing_, gFactor_);
 
                     // GDEBUG_STREAM("cpu triggered - unmixing_ : " << Gadgetron::norm2(unmixing_));
                 }
@@ -317,22 +347,41 @@ template <class T> int GrappaWeightsCalculator<T>::svc(void)  {
                 }
                 else
                 {
-                    Gadgetron::grappa2d_calib_convolution_kernel(acs, target_acs_,
-                        (size_t)(mb1->getObjectPtr()->acceleration_factor),
-                        thres, kRO, kNE1, conv_ker_);
+                    // the selection of the target channels is part of the key
+                    GrappaImageDomainKernelKey key;
+                    key.RO = RO;
+                    key.E1 = E1;
+                    key.calibRO = RO;
+                    key.calibE1 = E1;
+                    key.acceFactorE1 = mb1->getObjectPtr()->acceleration_factor;
+                    key.kRO = kRO;
+                    key.kNE1 = kNE1;
+                    key.srcCHA = CHA;
+                    key.dstCHA = target_acs_.get_size(2);
+                    key.checksum = ref_checksum ^ (Gadgetron::grappa_checksum(target_acs_) * 31);
+
+                    kIm_ = kIm_cache_.find(slot, key);
+                    if (!kIm_)
+                    {
+                        Gadgetron::grappa2d_calib_convolution_kernel(acs, target_acs_,
+                            (size_t)(mb1->getObjectPtr()->acceleration_factor),
+                            thres, kRO, kNE1, conv_ker_);
 
-                    Gadgetron::grappa2d_image_domain_kernel(conv_ker_, RO, E1, kIm_);
+                        boost::shared_ptr< hoNDArray< std::complex<float> > > kIm(new hoNDArray< std::complex<float> >());
+                        Gadgetron::grappa2d_image_domain_kernel(conv_ker_, RO, E1, *kIm);
+                        kIm_ = kIm_cache_.insert(slot, key, kIm);
+                    }
 
                     Gadgetron::clear(unmixing_);
 
                     hoNDArray< std::complex<float> > unmixing_all_channels(RO, E1, CHA, unmixing_.begin());
-                    Gadgetron::grappa2d_unmixing_coeff(kIm_, coil_map_, (size_t)(mb1->getObjectPtr()->acceleration_factor), unmixing_all_channels, gFactor_);
+                    Gadgetron::grappa2d_unmixing_coeff(*kIm_, coil_map_, (size_t)(mb1->getObjectPtr()->acceleration_factor), unmixing_all_channels, gFactor_);
 
                     // set unmixing coefficients for uncombined channels
                     size_t ind = 1;
                     for (it = uncombined_channels_.begin(); it != uncombined_channels_.end(); it++)
                     {
-                        memcpy(unmixing_.begin() + ind*RO*E1*CHA, kIm_.begin() + (target_coils_ + ind - 1)*RO*E1*CHA, sizeof(std::complex<float>)*RO*E1*CHA);
+                        memcpy(unmixing_.begin() + ind*RO*E1*CHA, kIm_->begin() + (target_coils_ + ind - 1)*RO*E1*CHA, sizeof(std::complex<float>)*RO*E1*CHA);
                         ind++;
                     }
                 }
@@ -375,6 +424,57 @@ template <class T> int GrappaWeightsCalculator<T>::svc(void)  {
     return 0;
 }
 
+template <class T> bool GrappaWeightsCalculator<T>::
+calibration_unchanged(GrappaWeightsDescription<T>* description, hoNDArray< std::complex<T> >* ref_data, size_t ref_checksum)
+{
+    typename std::map< GrappaWeights<T>*, CalibrationRecord >::iterator it = calibration_records_.find(description->destination.get());
+    if (it == calibration_records_.end()) return false;
+
+    const CalibrationRecord& record = it->second;
+
+    // the address may have been reused by new weights
+    if (record.destination.expired() || record.destination.lock() != description->destination) return false;
+
+    if (record.acceleration_factor != description->acceleration_factor) return false;
+    if (record.sampled_region != description->sampled_region) return false;
+    if (record.uncombined_channels != uncombined_channels_) return false;
+    if (record.target_coils != target_coils_) return false;
+    if (record.use_gpu != use_gpu_) return false;
+
+    std::vector<size_t> ref_dimensions;
+    ref_data->get_dimensions(ref_dimensions);
+    if (ref_dimensions != record.ref_dimensions) return false;
+    return (record.ref_checksum == ref_checksum);
+}
+
+template <class T> void GrappaWeightsCalculator<T>::
+record_calibration(GrappaWeightsDescription<T>* description, hoNDArray< std::complex<T> >* ref_data, size_t ref_checksum)
+{
+    if (!description->destination) return;
+
+    // drop the records of weights that no longer exist
+    typename std::map< GrappaWeights<T>*, CalibrationRecord >::iterator it = calibration_records_.begin();
+    while (it != calibration_records_.end()) {
+        if (it->second.destination.expired()) {
+            kIm_cache_.erase(reinterpret_cast<size_t>(it->first));
+            calibration_records_.erase(it++);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    CalibrationRecord& record = calibration_records_[description->destination.get()];
+    record.destination = description->destination;
+    ref_data->get_dimensions(record.ref_dimensions);
+    record.ref_checksum = ref_checksum;
+    record.sampled_region = description->sampled_region;
+    record.acceleration_factor = description->acceleration_factor;
+    record.uncombined_channels = uncombined_channels_;
+    record.target_coils = target_coils_;
+    record.use_gpu = use_gpu_;
+}
+
 template <class T> int GrappaWeightsCalculator<T>::close(unsigned long flags) {
     int rval = 0;
     if (flags == 1) {
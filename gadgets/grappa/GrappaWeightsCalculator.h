@@ -2,12 +2,17 @@
 
 #include "gadgetron_grappa_export.h"
 #include "GrappaWeights.h"
+#include "mri_core_grappa.h"
 
 #include <ace/Task.h>
+#include <boost/weak_ptr.hpp>
 #include <list>
+#include <map>
 
 namespace Gadgetron{
 
+template <class T> class GrappaWeightsDescription;
+
 template <class T> class EXPORTGADGETSGRAPPA GrappaWeightsCalculator : public ACE_Task<ACE_MT_SYNCH>
 {
   typedef ACE_Task<ACE_MT_SYNCH> inherited;
@@ -69,6 +74,25 @@ template <class T> class EXPORTGADGETSGRAPPA GrappaWeightsCalculator : public AC
   }
 
  private:
+  /// the input of the last calculation for one destination
+  struct CalibrationRecord
+  {
+    boost::weak_ptr< GrappaWeights<T> > destination;
+    std::vector<size_t> ref_dimensions;
+    size_t ref_checksum;
+    std::vector< std::pair<unsigned int, unsigned int> > sampled_region;
+    unsigned int acceleration_factor;
+    std::list<unsigned int> uncombined_channels;
+    int target_coils;
+    bool use_gpu;
+  };
+
+  /// true if the weights of the destination were calculated from the same reference data and settings,
+  /// the calibration buffer submits a job whenever the calculator is idle, also when no new reference line arrived
+  /// the reference data is compared by its dimensions and grappa_checksum, it is not copied
+  bool calibration_unchanged(GrappaWeightsDescription<T>* description, hoNDArray< std::complex<T> >* ref_data, size_t ref_checksum);
+  void record_calibration(GrappaWeightsDescription<T>* description, hoNDArray< std::complex<T> >* ref_data, size_t ref_checksum);
+
   std::list<unsigned int> uncombined_channels_;
   int target_coils_;
   bool use_gpu_;
@@ -77,7 +101,10 @@ template <class T> class EXPORTGADGETSGRAPPA GrappaWeightsCalculator : public AC
 
   hoNDArray< std::complex<T> > complex_im_;
   hoNDArray< std::complex<T> > conv_ker_;
-  hoNDArray< std::complex<T> > kIm_;
+  /// image domain kernel of the current job, kept per destination in kIm_cache_
+  boost::shared_ptr< const hoNDArray< std::complex<T> > > kIm_;
+  GrappaImageDomainKernelCache< std::complex<T> > kIm_cache_;
+  std::map< GrappaWeights<T>*, CalibrationRecord > calibration_records_;
   hoNDArray< std::complex<T> > coil_map_;
   hoNDArray< std::complex<T> > unmixing_;
   hoNDArray< T > gFactor_;
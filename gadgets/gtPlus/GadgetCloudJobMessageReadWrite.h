@@ -205,6 +205,153 @@ namespace Gadgetron
 
     };
 
+    /// reads a cloud job in place, the job supports scatter(read, len)
+    /// the message is the same as for GadgetCloudJobMessageReader, but there is no intermediate job buffer
+    template <typename JobType> 
+    class GadgetCloudJobMessageScatterReader : public GadgetMessageReader
+    {
+
+    public:
+
+        struct StreamReader
+        {
+            StreamReader(ACE_SOCK_Stream* stream, size_t sizeOfJob) : stream_(stream), remainingBytes_(sizeOfJob) {}
+
+            size_t remaining() const
+            {
+                return remainingBytes_;
+            }
+
+            bool operator()(void* buf, size_t len)
+            {
+                if ( len > remainingBytes_ ) return false;
+
+                size_t maxBytesPerRecv = (size_t)(512.0*1024*1024);
+
+                char* ptr = static_cast<char*>(buf);
+                while ( len > 0 )
+                {
+                    size_t receivingBytes = (len < maxBytesPerRecv) ? len : maxBytesPerRecv;
+                    if ( stream_->recv_n(ptr, receivingBytes) <= 0 ) return false;
+
+                    ptr += receivingBytes;
+                    len -= receivingBytes;
+                    remainingBytes_ -= receivingBytes;
+                }
+
+                return true;
+            }
+
+            ACE_SOCK_Stream* stream_;
+            size_t remainingBytes_;
+        };
+
+        virtual ACE_Message_Block* read(ACE_SOCK_Stream* stream) 
+        {
+            GadgetContainerMessage<int>* jobID = new GadgetContainerMessage<int>();
+            GadgetContainerMessage<JobType>* job = new GadgetContainerMessage<JobType>();
+
+            jobID->cont(job);
+
+            int id = 0;
+            size_t sizeOfJob = 0;
+
+            if (stream->recv_n(&id, sizeof(int)) <= 0)
+            {
+	      GERROR("GadgetCloudJobMessageScatterReader, failed to read job id\n");
+	      jobID->release();
+	      return 0;
+            }
+
+            *(jobID->getObjectPtr()) = id;
+
+            if (stream->recv_n(&sizeOfJob, sizeof(size_t)) <= 0)
+            {
+	      GERROR("GadgetCloudJobMessageScatterReader, failed to read job size\n");
+	      jobID->release();
+	      return 0;
+            }
+
+            StreamReader reader(stream, sizeOfJob);
+
+            size_t len = 0;
+            if ( !job->getObjectPtr()->scatter(reader, len) || (len != sizeOfJob) )
+            {
+	      GERROR("GadgetCloudJobMessageScatterReader, failed to read the job\n");
+	      jobID->release();
+	      return 0;
+            }
+
+            return jobID;
+        }
+    };
+
+    /// writes a cloud job with vectored I/O, the job supports gather(iov)
+    /// the array contents are sent from the job itself instead of being serialized into one buffer first
+    template <typename JobType> 
+    class GadgetCloudJobMessageGatherWriter : public GadgetCloudJobMessageWriter<JobType>
+    {
+
+    public:
+
+        virtual int gather(GadgetMessageIOVector& iov, ACE_Message_Block* mb)
+        {
+            GadgetContainerMessage<int>* m1 = 
+                dynamic_cast< GadgetContainerMessage<int>* >(mb);
+
+            GadgetContainerMessage<JobType>* job = 
+                dynamic_cast< GadgetContainerMessage<JobType>* >(mb->cont());
+
+            if ( !m1 || !job )
+            {
+	      GERROR("GadgetCloudJobMessageGatherWriter invalid job message objects\n");
+	      return -1;
+            }
+
+            GadgetMessageIdentifier id;
+            id.id = this->msg_id_;
+
+            iov.add_copy(&id, sizeof(GadgetMessageIdentifier));
+            iov.add(m1->getObjectPtr(), sizeof(int));
+
+            // the job size goes in front of the job
+            size_t mark = iov.count();
+            size_t sizeOfJob = 0;
+            iov.add_copy(&sizeOfJob, sizeof(size_t));
+            size_t bytes = iov.bytes();
+
+            if ( !job->getObjectPtr()->gather(iov) )
+            {
+	      GERROR("GadgetCloudJobMessageGatherWriter, failed to gather the job\n");
+	      return -1;
+            }
+
+            sizeOfJob = iov.bytes() - bytes;
+            memcpy(iov.data()[mark].iov_base, &sizeOfJob, sizeof(size_t));
+
+            return 0;
+        }
+
+        virtual int write(ACE_SOCK_Stream* sock, ACE_Message_Block* mb) 
+        {
+            GadgetMessageIOVector iov;
+            if ( this->gather(iov, mb) < 0 ) return -1;
+
+            GDEBUG("--> send job, size of job : %f MBytes ... \n", iov.bytes()/1024.0/1024);
+
+            // keep every send below maxBytesPerSend, as for GadgetCloudJobMessageWriter
+            size_t maxBytesPerSend = (size_t)(512.0*1024*1024);
+
+            if ( iov.send_n(sock, maxBytesPerSend) < 0 )
+            {
+	      GERROR("Unable to send job data\n");
+	      return -1;
+            }
+
+            return 0;
+        }
+    };
+
     typedef Gadgetron::gtPlus::gtPlusReconJob2DT< std::complex<float> > GtPlusReconJobTypeCPFL;
 
     class EXPORTGTPLUSGADGET GtPlusCloudJobMessageReaderCPFL : public GadgetCloudJobMessageReader<GtPlusReconJobTypeCPFL>
@@ -221,17 +368,17 @@ namespace Gadgetron
 
     // gadget level cloud computing
 
-    class EXPORTGTPLUSGADGET GtPlus2DTGadgetCloudJobMessageReaderCPFL : public GadgetCloudJobMessageReader<GtPlusRecon2DTCloudPackageCPFL>
+    class EXPORTGTPLUSGADGET GtPlus2DTGadgetCloudJobMessageReaderCPFL : public GadgetCloudJobMessageScatterReader<GtPlusRecon2DTCloudPackageCPFL>
     {
     public:
         GADGETRON_WRITER_DECLARE(GtPlus2DTGadgetCloudJobMessageReaderCPFL);
     };
 
-    class EXPORTGTPLUSGADGET GtPlus2DTGadgetCloudJobMessageWriterCPFL : public GadgetCloudJobMessageWriter<GtPlusRecon2DTCloudPackageCPFL>
+    class EXPORTGTPLUSGADGET GtPlus2DTGadgetCloudJobMessageWriterCPFL : public GadgetCloudJobMessageGatherWriter<GtPlusRecon2DTCloudPackageCPFL>
     {
     public:
 
-        typedef GadgetCloudJobMessageWriter<GtPlusRecon2DTCloudPackageCPFL> BaseClass;
+        typedef GadgetCloudJobMessageGatherWriter<GtPlusRecon2DTCloudPackageCPFL> BaseClass;
 
         GtPlus2DTGadgetCloudJobMessageWriterCPFL() : BaseClass()
         {
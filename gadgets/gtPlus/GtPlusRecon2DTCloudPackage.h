@@ -94,6 +94,21 @@ struct GtPlusRecon2DTCloudPackage
 
     virtual bool serialize(char*& buf, size_t& len) const ;
     virtual bool deserialize(char* buf, size_t& len);
+
+    /// describe the serialized package as a list of memory blocks, iov.add(ptr, len) and iov.add_copy(ptr, len)
+    /// the array contents are not copied, the package must be kept alive until the blocks are sent
+    /// the bytes are the same as the serialize(...) buffer
+    template <typename Gather> bool gather(Gather& iov) const;
+
+    /// read the package with read(ptr, len), each array is allocated from its dimensions and filled in place
+    /// read.remaining() gives the bytes left in the package, an array that does not fit is rejected before it is allocated
+    /// len is the number of bytes consumed
+    template <typename Reader> bool scatter(Reader& read, size_t& len);
+
+protected:
+
+    template <typename T2, typename Gather> static void gatherArray(const hoNDArray<T2>& a, Gather& iov);
+    template <typename T2, typename Reader> static bool scatterArray(hoNDArray<T2>& a, Reader& read, size_t& len);
 };
 
 template <typename T> 
@@ -296,6 +311,114 @@ bool GtPlusRecon2DTCloudPackage<T>::deserialize(char* buf, size_t& len)
     return true;
 }
 
+template <typename T> 
+template <typename Gather> 
+bool GtPlusRecon2DTCloudPackage<T>::gather(Gather& iov) const
+{
+    try
+    {
+        iov.add(&para, sizeof(GtPlusRecon2DTPara));
+
+        gatherArray(kspace, iov);
+        gatherArray(timeStamp, iov);
+        gatherArray(physioTimeStamp, iov);
+        gatherArray(ref, iov);
+        gatherArray(complexIm, iov);
+        gatherArray(res, iov);
+        gatherArray(complexImSecond, iov);
+        gatherArray(resTimeStampSecond, iov);
+        gatherArray(resPhysioTimeStampSecond, iov);
+    }
+    catch (...)
+    {
+        GERROR_STREAM("Errors happened in GtPlusRecon2DTCloudPackage<T>::gather(...) ... ");
+        return false;
+    }
+
+    return true;
+}
+
+template <typename T> 
+template <typename Reader> 
+bool GtPlusRecon2DTCloudPackage<T>::scatter(Reader& read, size_t& len)
+{
+    try
+    {
+        len = 0;
+
+        GADGET_CHECK_RETURN_FALSE(read(&para, sizeof(GtPlusRecon2DTPara)));
+        len += sizeof(GtPlusRecon2DTPara);
+
+        GADGET_CHECK_RETURN_FALSE(scatterArray(kspace, read, len));
+        GADGET_CHECK_RETURN_FALSE(scatterArray(timeStamp, read, len));
+        GADGET_CHECK_RETURN_FALSE(scatterArray(physioTimeStamp, read, len));
+        GADGET_CHECK_RETURN_FALSE(scatterArray(ref, read, len));
+        GADGET_CHECK_RETURN_FALSE(scatterArray(complexIm, read, len));
+        GADGET_CHECK_RETURN_FALSE(scatterArray(res, read, len));
+        GADGET_CHECK_RETURN_FALSE(scatterArray(complexImSecond, read, len));
+        GADGET_CHECK_RETURN_FALSE(scatterArray(resTimeStampSecond, read, len));
+        GADGET_CHECK_RETURN_FALSE(scatterArray(resPhysioTimeStampSecond, read, len));
+    }
+    catch (...)
+    {
+        GERROR_STREAM("Errors happened in GtPlusRecon2DTCloudPackage<T>::scatter(...) ...");
+        return false;
+    }
+
+    return true;
+}
+
+template <typename T> 
+template <typename T2, typename Gather> 
+void GtPlusRecon2DTCloudPackage<T>::gatherArray(const hoNDArray<T2>& a, Gather& iov)
+{
+    // number of dimensions + dimension vector + contents, as in hoNDArray<T>::serialize
+    size_t NDim = a.get_number_of_dimensions();
+
+    std::vector<size_t> header(NDim+1, NDim);
+    for ( size_t d=0; d<NDim; d++ ) header[d+1] = a.get_size(d);
+
+    iov.add_copy(&header[0], sizeof(size_t)*header.size());
+    if ( NDim > 0 ) iov.add(a.begin(), sizeof(T2)*a.get_number_of_elements());
+}
+
+template <typename T> 
+template <typename T2, typename Reader> 
+bool GtPlusRecon2DTCloudPackage<T>::scatterArray(hoNDArray<T2>& a, Reader& read, size_t& len)
+{
+    size_t NDim(0);
+    GADGET_CHECK_RETURN_FALSE(read(&NDim, sizeof(size_t)));
+    len += sizeof(size_t);
+
+    if ( NDim == 0 )
+    {
+        a.clear();
+        return true;
+    }
+
+    // dimensions and contents must fit into the rest of the package, a corrupted header is not allocated
+    GADGET_CHECK_RETURN_FALSE(NDim <= read.remaining()/sizeof(size_t));
+
+    std::vector<size_t> dimensions(NDim);
+    GADGET_CHECK_RETURN_FALSE(read(&dimensions[0], sizeof(size_t)*NDim));
+    len += sizeof(size_t)*NDim;
+
+    size_t maxElements = read.remaining()/sizeof(T2);
+    size_t N = 1;
+    for ( size_t d=0; d<NDim; d++ )
+    {
+        GADGET_CHECK_RETURN_FALSE(dimensions[d]==0 || N <= maxElements/dimensions[d]);
+        N *= dimensions[d];
+    }
+
+    a.create(&dimensions);
+
+    GADGET_CHECK_RETURN_FALSE(read(a.begin(), sizeof(T2)*a.get_number_of_elements()));
+    len += sizeof(T2)*a.get_number_of_elements();
+
+    return true;
+}
+
 typedef GtPlusRecon2DTCloudPackage< std::complex<float> > GtPlusRecon2DTCloudPackageCPFL;
 
 }
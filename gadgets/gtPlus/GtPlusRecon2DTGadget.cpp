@@ -164,6 +164,8 @@ bool GtPlusRecon2DTGadget::setWorkOrder2DTParameters(WorkOrder2DTType* workOrder
     workOrder->no_acceleration_same_combinationcoeff_allS_ = para_.no_acceleration_same_combinationcoeff_allS_;
     workOrder->no_acceleration_whichS_combinationcoeff_ = para_.no_acceleration_whichS_combinationcoeff_;
 
+    workOrder->pipeline_calib_unwrapping_ = pipeline_calib_unwrapping.value();
+
     return true;
 }
 
@@ -283,6 +285,7 @@ int GtPlusRecon2DTGadget::process(Gadgetron::GadgetContainerMessage< GtPlusGadge
     workOrder->CloudComputing_ = CloudComputing_;
     workOrder->CloudSize_ = CloudSize_;
     workOrder->gt_cloud_ = gt_cloud_;
+    if ( CloudComputing_ ) this->getGTCloudNodeLoads(gt_cloud_, workOrder->gt_cloud_load_);
 
     // ---------------------------------------------------------
     // set the worker
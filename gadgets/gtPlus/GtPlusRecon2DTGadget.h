@@ -72,6 +72,8 @@ public:
 
     GADGET_PROPERTY(same_coil_compression_coeff_allS, bool, "Whether to use same coil compression coefficients for all S dimension", true);
 
+    GADGET_PROPERTY(pipeline_calib_unwrapping, bool, "Whether to overlap the calibration and unwrapping of different S dimension", true);
+
 protected:
 
     virtual bool readParameters();
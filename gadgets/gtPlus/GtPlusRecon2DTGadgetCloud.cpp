@@ -16,6 +16,9 @@ GtPlusRecon2DTGadgetCloud::GtPlusRecon2DTGadgetCloud() : BaseClass(), curr_node_
     packages_received_.resize(1024);
     packages_passed_to_next_gadget_.resize(1024);
     gt_timer_2DT_cloud_.set_timing_in_destruction(false);
+
+    // process() waits for the jobs sent to the cloud nodes, keep our own thread instead of a pool thread
+    this->use_thread_pool(false);
 }
 
 GtPlusRecon2DTGadgetCloud::~GtPlusRecon2DTGadgetCloud()
@@ -457,7 +460,10 @@ int GtPlusRecon2DTGadgetCloud::close(unsigned long flags)
             gadgetJobHandler.gadget_ = this;
             controller_.job_handler_ = &gadgetJobHandler;
 
-            controller_.waitForJobToComplete();
+            {
+                GadgetPoolBlockingScope blocking;
+                controller_.waitForJobToComplete();
+            }
 
             // if some jobs are not completed successfully, reprocess them; otherwise, send out images
             std::vector<DimensionRecordType> dataDimStartingIndexes;
@@ -141,6 +141,8 @@ bool GtPlusRecon3DTGadget::setWorkOrder3DTParameters(WorkOrder3DTType* workOrder
     workOrder->no_acceleration_same_combinationcoeff_allN_ = para_.no_acceleration_same_combinationcoeff_allN_;
     workOrder->no_acceleration_whichN_combinationcoeff_ = para_.no_acceleration_whichN_combinationcoeff_;
 
+    workOrder->kernelIm_max_Megabytes_ = (kernelIm_max_Megabytes.value()>0) ? (size_t)kernelIm_max_Megabytes.value() : 0;
+
     return true;
 }
 
@@ -249,6 +251,7 @@ int GtPlusRecon3DTGadget::process(Gadgetron::GadgetContainerMessage< GtPlusGadge
     workOrder->CloudComputing_ = CloudComputing_;
     workOrder->CloudSize_ = CloudSize_;
     workOrder->gt_cloud_ = gt_cloud_;
+    if ( CloudComputing_ ) this->getGTCloudNodeLoads(gt_cloud_, workOrder->gt_cloud_load_);
 
     // ---------------------------------------------------------
     // set the worker
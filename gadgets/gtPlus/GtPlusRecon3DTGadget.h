@@ -104,6 +104,8 @@ public:
 
     GADGET_PROPERTY(same_coil_compression_coeff_allN, bool, "Whether to use same coil compression coefficients for all N dimension", true);
 
+    GADGET_PROPERTY(kernelIm_max_Megabytes, int, "Maximal image domain kernel size in MegaBytes for kspace unwrapping, larger kernels are computed in chunks along RO; the budget bounds the kernel and images of one chunk only, the RO transformed kspace and the unwrapped kspace stay full size; 0 to disable", 0);
+
 protected:
 
     virtual bool readParameters();
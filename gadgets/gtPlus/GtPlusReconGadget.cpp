@@ -578,6 +578,38 @@ namespace Gadgetron
         return true;
     }
 
+    bool GtPlusReconGadget::getGTCloudNodeLoads(const CloudType& gtCloud, std::vector<unsigned int>& gtCloudLoad)
+    {
+        gtCloudLoad.clear();
+
+        if ( !this->using_cloudbus.value() ) return true;
+
+        std::vector<GadgetronNodeInfo> nodes;
+        CloudBus::instance()->get_node_info(nodes);
+
+        gtCloudLoad.resize(gtCloud.size(), 0);
+
+        unsigned int n, m;
+        for ( n=0; n<gtCloud.size(); n++ )
+        {
+            for ( m=0; m<nodes.size(); m++ )
+            {
+                std::stringstream ss;
+                ss << nodes[m].port;
+
+                if ( nodes[m].address==gtCloud[n].get<0>() && ss.str()==gtCloud[n].get<1>() )
+                {
+                    gtCloudLoad[n] = nodes[m].active_reconstructions;
+                    break;
+                }
+            }
+
+            GDEBUG_CONDITION_STREAM(verboseMode_, "Gadget Node " << n << " : active reconstructions " << gtCloudLoad[n]);
+        }
+
+        return true;
+    }
+
     int GtPlusReconGadget::process_config(ACE_Message_Block* mb)
     {
         // [Ro E1 Cha Slice E2 Con Phase Rep Set Seg Ave]
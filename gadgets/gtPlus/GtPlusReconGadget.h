@@ -178,6 +178,10 @@ protected:
     // parse the cloud file if any
     virtual bool parseGTCloudNodeFile(const std::string& filename, CloudType& gtCloud);
 
+    // get the number of reconstructions running on every cloud node from the cloud bus
+    // nodes not found on the cloud bus are assumed to be idle; gtCloudLoad is cleared if the cloud bus is not used
+    virtual bool getGTCloudNodeLoads(const CloudType& gtCloud, std::vector<unsigned int>& gtCloudLoad);
+
     // close call
     int close(unsigned long flags);
 
@@ -1,10 +1,27 @@
 #include "GadgetIsmrmrdReadWrite.h"
 #include "AcquisitionAccumulateTriggerGadget.h"
 #include "mri_core_data.h"
+#include "hoNDArray_elemwise.h"
 #include "log.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace Gadgetron{
 
+  namespace {
+
+    // The buffers of the accumulate_to_buffer mode start at counter 0, but in the sorting and trigger dimensions
+    void get_buffer_extent(IsmrmrdDataBuffered& dataBuffer, IsmrmrdBufferLayout::Extent& extent)
+    {
+      for (size_t d = 0; d < 5; d++) {
+        extent.first_[d] = 0;
+        extent.size_[d] = dataBuffer.headers_.get_size(d);
+      }
+    }
+
+  }
+
   AcquisitionAccumulateTriggerGadget::~AcquisitionAccumulateTriggerGadget()
   {
     //The buckets array should be empty but just in case, let's make sure all the stuff is released.
@@ -13,6 +30,12 @@ namespace Gadgetron{
 	it->second->release();
       }
     }
+
+    for (buffer_map_type_::iterator it = buffers_.begin(); it != buffers_.end(); it++) {
+      if (it->second) {
+	it->second->release();
+      }
+    }
   }
 
   int AcquisitionAccumulateTriggerGadget
@@ -110,6 +133,16 @@ namespace Gadgetron{
 
     trigger_events_ = 0;
 
+    accumulate_to_buffer_ = accumulate_to_buffer.value();
+    GDEBUG("ACCUMULATE TO BUFFER IS: %d\n", accumulate_to_buffer_);
+
+    if (accumulate_to_buffer_) {
+      layout_ = create_buffer_layout();
+
+      // the buffers are allocated from the encoding limits
+      ISMRMRD::deserialize(mb->rd_ptr(), hdr_);
+    }
+
     return GADGET_OK;
   }
 
@@ -306,6 +339,19 @@ namespace Gadgetron{
     //Now we can update the previous data item that we store for 
     //purposes of determining if trigger condition has occurred. 
     prev_ = d;
+
+    if (accumulate_to_buffer_) {
+      try {
+        addToBuffer(sorting_index, d);
+      } catch (std::exception& e) {
+        GERROR("AcquisitionAccumulateTriggerGadget, failed to add the acquisition to the buffer: %s\n", e.what());
+        m1->release();
+        return GADGET_FAIL;
+      }
+
+      m1->release();
+      return GADGET_OK;
+    }
     
     //Find the bucket the data should go in
     map_type_::iterator it = buckets_.find(sorting_index);
@@ -323,15 +369,7 @@ namespace Gadgetron{
         if (bucket->datastats_.size() < (espace+1)) {
             bucket->datastats_.resize(espace+1);
         }
-        bucket->datastats_[espace].kspace_encode_step_1.insert(m1->getObjectPtr()->idx.kspace_encode_step_1);
-        bucket->datastats_[espace].kspace_encode_step_2.insert(m1->getObjectPtr()->idx.kspace_encode_step_2);
-        bucket->datastats_[espace].slice.insert(m1->getObjectPtr()->idx.slice);
-        bucket->datastats_[espace].phase.insert(m1->getObjectPtr()->idx.phase);
-        bucket->datastats_[espace].contrast.insert(m1->getObjectPtr()->idx.contrast);
-        bucket->datastats_[espace].set.insert(m1->getObjectPtr()->idx.set);
-        bucket->datastats_[espace].segment.insert(m1->getObjectPtr()->idx.segment);
-        bucket->datastats_[espace].average.insert(m1->getObjectPtr()->idx.average);
-        bucket->datastats_[espace].repetition.insert(m1->getObjectPtr()->idx.repetition);
+        IsmrmrdBufferLayout::add_to_stats(bucket->datastats_[espace], m1->getObjectPtr()->idx);
       }
 
     if ( ISMRMRD::FlagBit(ISMRMRD::ISMRMRD_ACQ_IS_PARALLEL_CALIBRATION).isSet(m1->getObjectPtr()->flags) ||
@@ -341,15 +379,7 @@ namespace Gadgetron{
         if (bucket->refstats_.size() < (espace+1)) {
             bucket->refstats_.resize(espace+1);
         }
-        bucket->refstats_[espace].kspace_encode_step_1.insert(m1->getObjectPtr()->idx.kspace_encode_step_1);
-        bucket->refstats_[espace].kspace_encode_step_2.insert(m1->getObjectPtr()->idx.kspace_encode_step_2);
-        bucket->refstats_[espace].slice.insert(m1->getObjectPtr()->idx.slice);
-        bucket->refstats_[espace].phase.insert(m1->getObjectPtr()->idx.phase);
-        bucket->refstats_[espace].contrast.insert(m1->getObjectPtr()->idx.contrast);
-        bucket->refstats_[espace].set.insert(m1->getObjectPtr()->idx.set);
-        bucket->refstats_[espace].segment.insert(m1->getObjectPtr()->idx.segment);
-        bucket->refstats_[espace].average.insert(m1->getObjectPtr()->idx.average);
-        bucket->refstats_[espace].repetition.insert(m1->getObjectPtr()->idx.repetition);
+        IsmrmrdBufferLayout::add_to_stats(bucket->refstats_[espace], m1->getObjectPtr()->idx);
       }
 
     //We can release the data now. It is reference counted and counter have been incremented through operations above. 
@@ -379,6 +409,29 @@ namespace Gadgetron{
     }
 
     buckets_.clear();
+
+    //Pass the buffers in the order BucketToBufferGadget would send them
+    std::vector<buffer_key_type_> keys;
+    keys.reserve(buffers_.size());
+    for (buffer_map_type_::iterator it = buffers_.begin(); it != buffers_.end(); it++) {
+      keys.push_back(it->first);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    for (size_t k = 0; k < keys.size(); k++) {
+      GadgetContainerMessage<IsmrmrdReconData>* buffer = buffers_[keys[k]];
+      if (buffer) {
+	  finishBuffer(*buffer->getObjectPtr(), buffer_stats_[keys[k].first]);
+	  if (this->next()->putq(buffer) == -1) {
+	    buffer->release();
+	    GDEBUG("Failed to pass buffer down the chain\n");
+	    return GADGET_FAIL;
+	  }
+      }
+    }
+
+    buffers_.clear();
+    buffer_stats_.clear();
     prev_ = IsmrmrdAcquisitionData(); //Reset previous so that we don't end up triggering again
     return GADGET_OK;
   }
@@ -396,6 +449,119 @@ namespace Gadgetron{
   }
 
 
+  void AcquisitionAccumulateTriggerGadget::addToBuffer(unsigned short sorting_index, IsmrmrdAcquisitionData& d)
+  {
+    ISMRMRD::AcquisitionHeader& acqhdr = *d.head_->getObjectPtr();
+
+    //The storage is based on the encoding space
+    uint16_t espace = acqhdr.encoding_space_ref;
+    if (espace >= hdr_.encoding.size()) {
+      throw std::runtime_error("Encoding space of the acquisition is not in the ismrmrd header\n");
+    }
+    ISMRMRD::Encoding& encoding = hdr_.encoding[espace];
+
+    std::pair<unsigned short int, size_t> key(sorting_index, layout_.get_key(acqhdr.idx));
+    buffer_map_type_::iterator it = buffers_.find(key);
+    if (it == buffers_.end()) {
+      //Buffer does not exist, create it
+      it = buffers_.insert(std::make_pair(key, new GadgetContainerMessage<IsmrmrdReconData>)).first;
+    }
+
+    std::vector<IsmrmrdReconBit>& rbit = it->second->getObjectPtr()->rbit_;
+    if (rbit.size() < (espace+1)) {
+      rbit.resize(espace+1);
+    }
+
+    //The statistics of the bucket this readout would have gone to
+    IsmrmrdAcquisitionBucket& bucket = buffer_stats_[sorting_index];
+
+    if (!acqhdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PARALLEL_CALIBRATION)) {
+      if (bucket.datastats_.size() < (espace+1)) {
+        bucket.datastats_.resize(espace+1);
+      }
+      IsmrmrdBufferLayout::add_to_stats(bucket.datastats_[espace], acqhdr.idx);
+      stuff(d, rbit[espace].data_, encoding);
+    }
+
+    if (acqhdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PARALLEL_CALIBRATION) ||
+        acqhdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PARALLEL_CALIBRATION_AND_IMAGING)) {
+      if (bucket.refstats_.size() < (espace+1)) {
+        bucket.refstats_.resize(espace+1);
+      }
+      IsmrmrdBufferLayout::add_to_stats(bucket.refstats_[espace], acqhdr.idx);
+      stuff(d, rbit[espace].ref_, encoding);
+    }
+  }
+
+  void AcquisitionAccumulateTriggerGadget::stuff(IsmrmrdAcquisitionData& d, IsmrmrdDataBuffered& dataBuffer, ISMRMRD::Encoding& encoding)
+  {
+    ISMRMRD::AcquisitionHeader& acqhdr = *d.head_->getObjectPtr();
+
+    IsmrmrdBufferLayout::Extent extent;
+    size_t pos[5];
+
+    if (dataBuffer.data_.get_number_of_elements() == 0) {
+      //The first readout of a buffer allocates it for all the readouts to come, the sorting and trigger dimensions only get its value
+      layout_.get_limits_extent(encoding, extent);
+      restrictExtent(acqhdr.idx, extent);
+      layout_.include(acqhdr.idx, extent);
+      layout_.allocate(dataBuffer, acqhdr, encoding, extent);
+    } else {
+      get_buffer_extent(dataBuffer, extent);
+      restrictExtent(acqhdr.idx, extent);
+      if (!layout_.get_position(acqhdr.idx, extent, pos)) {
+        //The readout is beyond the encoding limits, grow the buffer
+        IsmrmrdBufferLayout::Extent grown = extent;
+        layout_.include(acqhdr.idx, grown);
+        GDEBUG("Acquisition is beyond the encoding limits, growing the buffer\n");
+        IsmrmrdBufferLayout::reshape(dataBuffer, extent, grown);
+        extent = grown;
+      }
+    }
+
+    layout_.stuff(d, dataBuffer, encoding, extent);
+  }
+
+  void AcquisitionAccumulateTriggerGadget::finishBuffer(IsmrmrdReconData& recon_data, IsmrmrdAcquisitionBucket& bucket)
+  {
+    //Cut the buffers to the layout BucketToBufferGadget gives the bucket, nothing is copied unless the readouts went beyond the encoding limits
+    for (size_t espace = 0; espace < recon_data.rbit_.size(); espace++) {
+      ISMRMRD::Encoding& encoding = hdr_.encoding[espace];
+      IsmrmrdBufferLayout::Extent from, to;
+
+      IsmrmrdDataBuffered& data = recon_data.rbit_[espace].data_;
+      if (data.data_.get_number_of_elements() > 0) {
+        get_buffer_extent(data, from);
+        restrictExtent(bucket.datastats_[espace], from);
+        layout_.get_extent(encoding, bucket.datastats_[espace], to);
+        restrictExtent(bucket.datastats_[espace], to);
+        if (from != to) IsmrmrdBufferLayout::reshape(data, from, to);
+      }
+
+      IsmrmrdDataBuffered& ref = recon_data.rbit_[espace].ref_;
+      if (ref.data_.get_number_of_elements() > 0) {
+        get_buffer_extent(ref, from);
+        restrictExtent(bucket.refstats_[espace], from);
+        layout_.get_extent(encoding, bucket.refstats_[espace], to);
+        restrictExtent(bucket.refstats_[espace], to);
+        if (from != to) IsmrmrdBufferLayout::reshape(ref, from, to);
+      }
+    }
+  }
+
+  void AcquisitionAccumulateTriggerGadget::restrictExtent(const ISMRMRD::ISMRMRD_EncodingCounters& idx, IsmrmrdBufferLayout::Extent& extent) const
+  {
+    //All readouts of a buffer share the sorting index and, until the next trigger, the trigger counter
+    layout_.restrict_extent(sort_, IsmrmrdBufferLayout::get_index(sort_, idx), extent);
+    layout_.restrict_extent(trigger_, IsmrmrdBufferLayout::get_index(trigger_, idx), extent);
+  }
+
+  void AcquisitionAccumulateTriggerGadget::restrictExtent(const IsmrmrdAcquisitionBucketStats& stats, IsmrmrdBufferLayout::Extent& extent) const
+  {
+    layout_.restrict_extent(sort_, stats, extent);
+    layout_.restrict_extent(trigger_, stats, extent);
+  }
+
   GADGET_FACTORY_DECLARE(AcquisitionAccumulateTriggerGadget)
 
 }
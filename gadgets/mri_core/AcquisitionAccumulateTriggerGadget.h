@@ -6,21 +6,33 @@
 #include "gadgetron_mricore_export.h"
 
 #include <ismrmrd/ismrmrd.h>
+#include <ismrmrd/xml.h>
 #include <complex>
 #include <map>
+#include <unordered_map>
+#include <utility>
+#include <boost/functional/hash.hpp>
 #include "mri_core_data.h"
+#include "IsmrmrdBufferLayout.h"
 
 namespace Gadgetron{
 
 
   class EXPORTGADGETSMRICORE AcquisitionAccumulateTriggerGadget : 
-  public Gadget2<ISMRMRD::AcquisitionHeader,hoNDArray< std::complex<float> > >
+  public IsmrmrdBufferLayoutGadget< Gadget2<ISMRMRD::AcquisitionHeader,hoNDArray< std::complex<float> > > >
     {
     public:
       GADGET_DECLARE(AcquisitionAccumulateTriggerGadget);
 
       typedef std::map< unsigned short int, GadgetContainerMessage<IsmrmrdAcquisitionBucket>* > map_type_;
 
+      // buffers of the accumulate_to_buffer mode, keyed by the sorting index and the BucketToBufferGadget key
+      typedef std::pair<unsigned short int, size_t> buffer_key_type_;
+      typedef std::unordered_map< buffer_key_type_, GadgetContainerMessage<IsmrmrdReconData>*, boost::hash<buffer_key_type_> > buffer_map_type_;
+
+      // statistics of the buckets the accumulate_to_buffer mode stands in for, the data_ and ref_ vectors stay empty
+      typedef std::map< unsigned short int, IsmrmrdAcquisitionBucket > stats_map_type_;
+
       virtual ~AcquisitionAccumulateTriggerGadget();
 
       int close(unsigned long flags);
@@ -68,12 +80,26 @@ namespace Gadgetron{
 			     "user_6",
 			     "user_7",
 			     "");
+
+      // In the accumulate_to_buffer mode the gadget replaces the AcquisitionAccumulateTriggerGadget/BucketToBufferGadget pair:
+      // the buffers are allocated from the encoding limits of the ismrmrd header and every readout is copied into its slot on arrival,
+      // on a trigger the buffers are sent down the chain instead of the buckets, in the BucketToBufferGadget layout of the bucket.
+      // The sorting and trigger dimensions only hold the one counter value of the buffer, a slice sorted buffer holds its slice only as with split_slices.
+      // The N_dimension, S_dimension, split_slices and ignore_segment properties are only used in this mode.
+      GADGET_PROPERTY(accumulate_to_buffer, bool, "Write the readouts directly into IsmrmrdReconData buffers", false);
+
       IsmrmrdCONDITION trigger_;
       IsmrmrdCONDITION sort_;
       map_type_  buckets_;
       IsmrmrdAcquisitionData prev_;
       unsigned long trigger_events_;
 
+      bool accumulate_to_buffer_;
+      IsmrmrdBufferLayout layout_;
+      ISMRMRD::IsmrmrdHeader hdr_;
+      buffer_map_type_ buffers_;
+      stats_map_type_ buffer_stats_;
+
       virtual int process_config(ACE_Message_Block* mb);
 
       virtual int process(GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1,
@@ -81,6 +107,15 @@ namespace Gadgetron{
 
       virtual int trigger();
 
+      // accumulate_to_buffer mode, same buffer layout as BucketToBufferGadget
+      void addToBuffer(unsigned short sorting_index, IsmrmrdAcquisitionData& d);
+      void stuff(IsmrmrdAcquisitionData& d, IsmrmrdDataBuffered& dataBuffer, ISMRMRD::Encoding& encoding);
+      void finishBuffer(IsmrmrdReconData& recon_data, IsmrmrdAcquisitionBucket& stats);
+
+      // restrict the sorting and trigger dimensions of a buffer extent to the value of the buffer
+      void restrictExtent(const ISMRMRD::ISMRMRD_EncodingCounters& idx, IsmrmrdBufferLayout::Extent& extent) const;
+      void restrictExtent(const IsmrmrdAcquisitionBucketStats& stats, IsmrmrdBufferLayout::Extent& extent) const;
+
     };
 
   
@@ -10,6 +10,7 @@
 #include <complex>
 #include <map>
 #include "mri_core_data.h"
+#include "IsmrmrdBufferLayout.h"
 
 namespace Gadgetron{
 
@@ -17,7 +18,7 @@ namespace Gadgetron{
     // should be fixed on the converter side.
 
   class EXPORTGADGETSMRICORE BucketToBufferGadget : 
-  public Gadget1<IsmrmrdAcquisitionBucket>
+  public IsmrmrdBufferLayoutGadget< Gadget1<IsmrmrdAcquisitionBucket> >
     {
     public:
       GADGET_DECLARE(BucketToBufferGadget);
@@ -27,48 +28,14 @@ namespace Gadgetron{
       int close(unsigned long flags);
       
     protected:
-      GADGET_PROPERTY_LIMITS(N_dimension, std::string, "N-Dimensions", "", 
-			     GadgetPropertyLimitsEnumeration,
-			     "average",
-			     "contrast",
-			     "phase",
-			     "repetition",
-			     "set",
-			     "segment",
-			     "slice",
-			     "");
-
-      GADGET_PROPERTY_LIMITS(S_dimension, std::string, "S-Dimensions", "", 
-			     GadgetPropertyLimitsEnumeration,
-			     "average",
-			     "contrast",
-			     "phase",
-			     "repetition",
-			     "set",
-			     "segment",
-			     "slice",
-			     "");
-
-      GADGET_PROPERTY(split_slices, bool, "Split slices", false);
-      GADGET_PROPERTY(ignore_segment, bool, "Ignore segment", false);
-
-      IsmrmrdCONDITION N_;
-      IsmrmrdCONDITION S_;
-      bool split_slices_;
-      bool ignore_segment_;
+      IsmrmrdBufferLayout layout_;
       ISMRMRD::IsmrmrdHeader hdr_;
       
       virtual int process_config(ACE_Message_Block* mb);
       virtual int process(GadgetContainerMessage<IsmrmrdAcquisitionBucket>* m1);
-      size_t getKey(ISMRMRD::ISMRMRD_EncodingCounters idx);
-      size_t getSlice(ISMRMRD::ISMRMRD_EncodingCounters idx);
-      size_t getN(ISMRMRD::ISMRMRD_EncodingCounters idx);
-      size_t getS(ISMRMRD::ISMRMRD_EncodingCounters idx);
 
       IsmrmrdReconBit & getRBit(std::map<size_t, GadgetContainerMessage<IsmrmrdReconData>* > & recon_data_buffers, size_t key, uint16_t espace);
-      void allocateDataArrays(IsmrmrdDataBuffered &  dataBuffer, ISMRMRD::AcquisitionHeader & acqhdr, ISMRMRD::Encoding encoding, IsmrmrdAcquisitionBucketStats & stats);
-      void fillSamplingDescription(SamplingDescription & sampling, ISMRMRD::Encoding & encoding, IsmrmrdAcquisitionBucketStats & stats);
-      void stuff(std::vector<IsmrmrdAcquisitionData>::iterator it, IsmrmrdDataBuffered & dataBuffer, ISMRMRD::Encoding encoding);
+      void stuff(IsmrmrdAcquisitionData & d, IsmrmrdDataBuffered & dataBuffer, IsmrmrdAcquisitionBucketStats & stats);
 
     };
 
@@ -4,6 +4,7 @@
 #include "GadgetMRIHeaders.h"
 #include "GadgetContainerMessage.h"
 #include "GadgetMessageInterface.h"
+#include "GadgetMessageBlockPool.h"
 #include "hoNDArray.h"
 #include "url_encode.h"
 #include "gadgetron_mricore_export.h"
@@ -51,7 +52,11 @@ namespace Gadgetron{
 	  auto d = AsContainerMessage< hoNDArray<std::complex<float> > >(h->cont());
 	  
 	  if (trajectory_elements) {
-	    auto t = AsContainerMessage< hoNDArray<float> >(h->cont());
+	    auto t = d ? AsContainerMessage< hoNDArray<float> >(d->cont()) : 0;
+	    if (!t) {
+	      GERROR("GadgetAcquisitionMessageWriter, trajectory missing\n");
+	      return -1;
+	    }
 	    if ((send_cnt = sock->send_n (t->getObjectPtr()->get_data_ptr(), sizeof(float)*trajectory_elements)) <= 0) {
 	      GERROR("Unable to send acquisition trajectory elements\n");
 	      return -1;
@@ -67,6 +72,37 @@ namespace Gadgetron{
 	  
 	  return 0;
         }
+
+        virtual int gather(GadgetMessageIOVector& iov, ACE_Message_Block* mb)
+        {
+	  auto h = AsContainerMessage<ISMRMRD::AcquisitionHeader>(mb);
+	  auto d = h ? AsContainerMessage< hoNDArray<std::complex<float> > >(h->cont()) : 0;
+
+	  if (!h || !d) {
+	    GERROR("GadgetAcquisitionMessageWriter, invalid acquisition message objects");
+	    return -1;
+	  }
+
+	  ISMRMRD::AcquisitionHeader* acqHead = h->getObjectPtr();
+	  size_t trajectory_elements = acqHead->trajectory_dimensions*acqHead->number_of_samples;
+	  size_t data_elements = acqHead->active_channels*acqHead->number_of_samples;
+
+	  auto t = AsContainerMessage< hoNDArray<float> >(d->cont());
+	  if (trajectory_elements && !t) {
+	    GERROR("GadgetAcquisitionMessageWriter, trajectory missing\n");
+	    return -1;
+	  }
+
+	  GadgetMessageIdentifier id;
+	  id.id = GADGET_MESSAGE_ISMRMRD_ACQUISITION;
+
+	  iov.add_copy(&id, sizeof(GadgetMessageIdentifier));
+	  iov.add(acqHead, sizeof(ISMRMRD::AcquisitionHeader));
+	  if (trajectory_elements) iov.add(t->getObjectPtr()->get_data_ptr(), sizeof(float)*trajectory_elements);
+	  if (data_elements) iov.add(d->getObjectPtr()->get_data_ptr(), 2*sizeof(float)*data_elements);
+
+	  return 0;
+        }
     };
 
     /**
@@ -80,44 +116,72 @@ namespace Gadgetron{
 
         virtual ACE_Message_Block* read(ACE_SOCK_Stream* stream)
         {
+            GadgetMessageBlockPool* pool = GadgetMessageBlockPool::instance();
 
-            GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1 =
-                new GadgetContainerMessage<ISMRMRD::AcquisitionHeader>();
-
-            GadgetContainerMessage<hoNDArray< std::complex<float> > >* m2 =
-                new GadgetContainerMessage< hoNDArray< std::complex<float> > >();
-
-            m1->cont(m2);
+            ISMRMRD::AcquisitionHeader h;
 
             ssize_t recv_count = 0;
 
-            if ((recv_count = stream->recv_n(m1->getObjectPtr(), sizeof(ISMRMRD::AcquisitionHeader))) <= 0) {
+            if ((recv_count = stream->recv_n(&h, sizeof(ISMRMRD::AcquisitionHeader))) <= 0) {
 	      GERROR("GadgetIsmrmrdAcquisitionMessageReader, failed to read ISMRMRDACQ Header\n");
 	      return 0;
             }
 
-            if (m1->getObjectPtr()->trajectory_dimensions) {
-                GadgetContainerMessage<hoNDArray< float > >* m3 =
-                    new GadgetContainerMessage< hoNDArray< float > >();
+            GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1 =
+                pool->create_message<ISMRMRD::AcquisitionHeader>();
 
-                m2->cont(m3);
+            if (!m1) {
+                GERROR("GadgetIsmrmrdAcquisitionMessageReader, failed to allocate ISMRMRDACQ Header\n");
+                return 0;
+            }
+
+            *m1->getObjectPtr() = h;
+
+            //Samples are received directly into a pooled buffer, which is recycled when the message is released
+            std::vector<size_t> adims;
+            adims.push_back(h.number_of_samples);
+            adims.push_back(h.active_channels);
+
+            size_t data_bytes = sizeof(std::complex<float>)*adims[0]*adims[1];
+
+            GadgetContainerMessage<hoNDArray< std::complex<float> > >* m2 =
+                pool->create_message< hoNDArray< std::complex<float> > >(data_bytes);
+
+            if (!m2) {
+                GERROR("GadgetIsmrmrdAcquisitionMessageReader, failed to allocate sample data\n");
+                m1->release();
+                return 0;
+            }
+
+            m1->cont(m2);
+
+            if (data_bytes) {
+                m2->getObjectPtr()->create(&adims, reinterpret_cast< std::complex<float>* >(GadgetMessageBlockPool::payload(m2)), false);
+            }
 
+            if (h.trajectory_dimensions) {
                 std::vector<size_t> tdims;
-                tdims.push_back(m1->getObjectPtr()->trajectory_dimensions);
-                tdims.push_back(m1->getObjectPtr()->number_of_samples);
+                tdims.push_back(h.trajectory_dimensions);
+                tdims.push_back(h.number_of_samples);
 
-                try { m3->getObjectPtr()->create(&tdims);}
-                catch (std::runtime_error &err){
-                    GEXCEPTION(err,"(%P|%t) Allocate trajectory data\n");
-                    m1->release();
+                size_t traj_bytes = sizeof(float)*tdims[0]*tdims[1];
+
+                GadgetContainerMessage<hoNDArray< float > >* m3 =
+                    pool->create_message< hoNDArray< float > >(traj_bytes);
 
+                if (!m3) {
+                    GERROR("GadgetIsmrmrdAcquisitionMessageReader, failed to allocate trajectory data\n");
+                    m1->release();
                     return 0;
                 }
 
+                m2->cont(m3);
+
+                m3->getObjectPtr()->create(&tdims, reinterpret_cast<float*>(GadgetMessageBlockPool::payload(m3)), false);
+
                 if ((recv_count =
 		     stream->recv_n
-		     (m3->getObjectPtr()->get_data_ptr(),
-		     sizeof(float)*tdims[0]*tdims[1])) <= 0) {
+		     (m3->getObjectPtr()->get_data_ptr(), traj_bytes)) <= 0) {
 		  
 		        GERROR("Unable to read trajectory data\n");
 		        m1->release();
@@ -126,22 +190,9 @@ namespace Gadgetron{
 
             }
 
-            std::vector<size_t> adims;
-            adims.push_back(m1->getObjectPtr()->number_of_samples);
-            adims.push_back(m1->getObjectPtr()->active_channels);
-
-            try{ m2->getObjectPtr()->create(&adims); }
-            catch (std::runtime_error &err ){
-                GEXCEPTION(err,"(%P|%t) Allocate sample data\n")
-                    m1->release();
-
-                return 0;
-            }
-
-            if ((recv_count =
+            if (data_bytes && (recv_count =
                 stream->recv_n
-                (m2->getObjectPtr()->get_data_ptr(),
-                sizeof(std::complex<float>)*adims[0]*adims[1])) <= 0) {
+                (m2->getObjectPtr()->get_data_ptr(), data_bytes)) <= 0) {
  
 	            GERROR("Unable to read Acq data\n");
                     m1->release();
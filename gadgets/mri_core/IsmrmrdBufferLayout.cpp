@@ -0,0 +1,441 @@
+#include "IsmrmrdBufferLayout.h"
+#include "hoNDArray_elemwise.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace Gadgetron{
+
+  namespace {
+
+    void set_range(IsmrmrdBufferLayout::Extent& extent, size_t d, size_t minimum, size_t maximum)
+    {
+      extent.first_[d] = minimum;
+      extent.size_[d] = maximum - minimum + 1;
+    }
+
+    void set_range(IsmrmrdBufferLayout::Extent& extent, size_t d, const IsmrmrdEncodingIndexSet& values)
+    {
+      set_range(extent, d, values.minimum(), values.maximum());
+    }
+
+    const IsmrmrdEncodingIndexSet* get_values(IsmrmrdCONDITION cond, const IsmrmrdAcquisitionBucketStats& stats)
+    {
+      switch (cond) {
+      case AVERAGE:
+        return &stats.average;
+      case CONTRAST:
+        return &stats.contrast;
+      case PHASE:
+        return &stats.phase;
+      case REPETITION:
+        return &stats.repetition;
+      case SET:
+        return &stats.set;
+      case SEGMENT:
+        return &stats.segment;
+      case SLICE:
+        return &stats.slice;
+      default:
+        return 0;
+      }
+    }
+
+    ISMRMRD::Optional<ISMRMRD::Limit> get_limit(IsmrmrdCONDITION cond, const ISMRMRD::Encoding& encoding)
+    {
+      switch (cond) {
+      case KSPACE_ENCODE_STEP_1:
+        return encoding.encodingLimits.kspace_encoding_step_1;
+      case KSPACE_ENCODE_STEP_2:
+        return encoding.encodingLimits.kspace_encoding_step_2;
+      case AVERAGE:
+        return encoding.encodingLimits.average;
+      case CONTRAST:
+        return encoding.encodingLimits.contrast;
+      case PHASE:
+        return encoding.encodingLimits.phase;
+      case REPETITION:
+        return encoding.encodingLimits.repetition;
+      case SET:
+        return encoding.encodingLimits.set;
+      case SEGMENT:
+        return encoding.encodingLimits.segment;
+      case SLICE:
+        return encoding.encodingLimits.slice;
+      default:
+        return ISMRMRD::Optional<ISMRMRD::Limit>();
+      }
+    }
+
+  }
+
+  bool IsmrmrdBufferLayout::Extent::operator==(const Extent& e) const
+  {
+    for (size_t d = 0; d < 5; d++) {
+      if ((first_[d] != e.first_[d]) || (size_[d] != e.size_[d])) return false;
+    }
+    return true;
+  }
+
+  IsmrmrdBufferLayout::IsmrmrdBufferLayout(IsmrmrdCONDITION N, IsmrmrdCONDITION S, bool split_slices, bool ignore_segment)
+    : N_(N)
+    , S_(S)
+    , split_slices_(split_slices)
+    , ignore_segment_(ignore_segment)
+  {
+  }
+
+  IsmrmrdCONDITION IsmrmrdBufferLayout::get_dimension(const std::string& dim)
+  {
+    if (dim.size() == 0) {
+      return NONE;
+    } else if (dim.compare("average") == 0) {
+      return AVERAGE;
+    } else if (dim.compare("contrast") == 0) {
+      return CONTRAST;
+    } else if (dim.compare("phase") == 0) {
+      return PHASE;
+    } else if (dim.compare("repetition") == 0) {
+      return REPETITION;
+    } else if (dim.compare("set") == 0) {
+      return SET;
+    } else if (dim.compare("segment") == 0) {
+      return SEGMENT;
+    } else if (dim.compare("slice") == 0) {
+      return SLICE;
+    }
+
+    GDEBUG("WARNING: Unknown buffer dimension (%s), set to NONE\n", dim.c_str());
+    return NONE;
+  }
+
+  size_t IsmrmrdBufferLayout::get_index(IsmrmrdCONDITION cond, const ISMRMRD::ISMRMRD_EncodingCounters& idx)
+  {
+    switch (cond) {
+    case KSPACE_ENCODE_STEP_1:
+      return idx.kspace_encode_step_1;
+    case KSPACE_ENCODE_STEP_2:
+      return idx.kspace_encode_step_2;
+    case AVERAGE:
+      return idx.average;
+    case CONTRAST:
+      return idx.contrast;
+    case PHASE:
+      return idx.phase;
+    case REPETITION:
+      return idx.repetition;
+    case SET:
+      return idx.set;
+    case SEGMENT:
+      return idx.segment;
+    case SLICE:
+      return idx.slice;
+    default:
+      return 0;
+    }
+  }
+
+  void IsmrmrdBufferLayout::add_to_stats(IsmrmrdAcquisitionBucketStats& stats, const ISMRMRD::ISMRMRD_EncodingCounters& idx)
+  {
+    stats.kspace_encode_step_1.insert(idx.kspace_encode_step_1);
+    stats.kspace_encode_step_2.insert(idx.kspace_encode_step_2);
+    stats.slice.insert(idx.slice);
+    stats.phase.insert(idx.phase);
+    stats.contrast.insert(idx.contrast);
+    stats.set.insert(idx.set);
+    stats.segment.insert(idx.segment);
+    stats.average.insert(idx.average);
+    stats.repetition.insert(idx.repetition);
+  }
+
+  size_t IsmrmrdBufferLayout::get_key(const ISMRMRD::ISMRMRD_EncodingCounters& idx) const
+  {
+    //[SLC, PHS, CON, REP, SET, SEG, AVE]
+    //collapse across two of them (N and S)
+    size_t slice = split_slices_ ? idx.slice : 0;
+    size_t phase = ((N_ == PHASE) || (S_ == PHASE)) ? 0 : idx.phase;
+    size_t contrast = ((N_ == CONTRAST) || (S_ == CONTRAST)) ? 0 : idx.contrast;
+    size_t repetition = ((N_ == REPETITION) || (S_ == REPETITION)) ? 0 : idx.repetition;
+    size_t set = ((N_ == SET) || (S_ == SET)) ? 0 : idx.set;
+    size_t segment = ((N_ == SEGMENT) || (S_ == SEGMENT) || ignore_segment_) ? 0 : idx.segment;
+    size_t average = ((N_ == AVERAGE) || (S_ == AVERAGE)) ? 0 : idx.average;
+
+    size_t key = 0;
+    key += slice      * 0x1;
+    key += phase      * 0x100;
+    key += contrast   * 0x10000;
+    key += repetition * 0x1000000;
+    key += set        * 0x100000000;
+    key += segment    * 0x10000000000;
+    key += average    * 0x1000000000000;
+
+    return key;
+  }
+
+  void IsmrmrdBufferLayout::get_extent(const ISMRMRD::Encoding& encoding, const IsmrmrdAcquisitionBucketStats& stats, Extent& extent) const
+  {
+    bool cartesian = (encoding.trajectory.compare("cartesian") == 0);
+
+    if (cartesian) {
+      set_range(extent, 0, 0, encoding.encodedSpace.matrixSize.y - 1);
+      set_range(extent, 1, 0, encoding.encodedSpace.matrixSize.z - 1);
+    } else {
+      if (encoding.encodingLimits.kspace_encoding_step_1.is_present()) {
+        set_range(extent, 0, encoding.encodingLimits.kspace_encoding_step_1->minimum, encoding.encodingLimits.kspace_encoding_step_1->maximum);
+      } else {
+        set_range(extent, 0, stats.kspace_encode_step_1);
+      }
+
+      if (encoding.encodingLimits.kspace_encoding_step_2.is_present()) {
+        set_range(extent, 1, encoding.encodingLimits.kspace_encoding_step_2->minimum, encoding.encodingLimits.kspace_encoding_step_2->maximum);
+      } else {
+        set_range(extent, 1, stats.kspace_encode_step_2);
+      }
+    }
+
+    const IsmrmrdEncodingIndexSet* n = get_values(N_, stats);
+    if (n) set_range(extent, 2, *n); else set_range(extent, 2, 0, 0);
+
+    const IsmrmrdEncodingIndexSet* s = get_values(S_, stats);
+    if (s) set_range(extent, 3, *s); else set_range(extent, 3, 0, 0);
+
+    if (split_slices_) {
+      set_range(extent, 4, 0, 0);
+    } else if (encoding.encodingLimits.slice.is_present()) {
+      set_range(extent, 4, encoding.encodingLimits.slice->minimum, encoding.encodingLimits.slice->maximum);
+    } else {
+      set_range(extent, 4, stats.slice);
+    }
+  }
+
+  void IsmrmrdBufferLayout::get_limits_extent(const ISMRMRD::Encoding& encoding, Extent& extent) const
+  {
+    IsmrmrdCONDITION dims[5] = { KSPACE_ENCODE_STEP_1, KSPACE_ENCODE_STEP_2, N_, S_, split_slices_ ? NONE : SLICE };
+
+    for (size_t d = 0; d < 5; d++) {
+      ISMRMRD::Optional<ISMRMRD::Limit> limit = get_limit(dims[d], encoding);
+      set_range(extent, d, 0, limit.is_present() ? limit->maximum : 0);
+    }
+
+    if (encoding.trajectory.compare("cartesian") == 0) {
+      set_range(extent, 0, 0, encoding.encodedSpace.matrixSize.y - 1);
+      set_range(extent, 1, 0, encoding.encodedSpace.matrixSize.z - 1);
+    }
+  }
+
+  void IsmrmrdBufferLayout::restrict_extent(IsmrmrdCONDITION cond, size_t value, Extent& extent) const
+  {
+    if (cond == NONE) return;
+
+    if (cond == N_) set_range(extent, 2, value, value);
+    if (cond == S_) set_range(extent, 3, value, value);
+    if ((cond == SLICE) && !split_slices_) set_range(extent, 4, value, value);
+  }
+
+  void IsmrmrdBufferLayout::restrict_extent(IsmrmrdCONDITION cond, const IsmrmrdAcquisitionBucketStats& stats, Extent& extent) const
+  {
+    const IsmrmrdEncodingIndexSet* values = get_values(cond, stats);
+    if (values && !values->empty()) restrict_extent(cond, values->minimum(), extent);
+  }
+
+  void IsmrmrdBufferLayout::get_counters(const ISMRMRD::ISMRMRD_EncodingCounters& idx, size_t counters[5]) const
+  {
+    counters[0] = idx.kspace_encode_step_1;
+    counters[1] = idx.kspace_encode_step_2;
+    counters[2] = get_index(N_, idx);
+    counters[3] = get_index(S_, idx);
+    counters[4] = split_slices_ ? 0 : idx.slice;
+  }
+
+  void IsmrmrdBufferLayout::include(const ISMRMRD::ISMRMRD_EncodingCounters& idx, Extent& extent) const
+  {
+    size_t counters[5];
+    get_counters(idx, counters);
+
+    for (size_t d = 0; d < 5; d++) {
+      size_t first = std::min(extent.first_[d], counters[d]);
+      size_t last = std::max(extent.first_[d] + extent.size_[d] - 1, counters[d]);
+      set_range(extent, d, first, last);
+    }
+  }
+
+  bool IsmrmrdBufferLayout::get_position(const ISMRMRD::ISMRMRD_EncodingCounters& idx, const Extent& extent, size_t pos[5]) const
+  {
+    size_t counters[5];
+    get_counters(idx, counters);
+
+    for (size_t d = 0; d < 5; d++) {
+      if ((counters[d] < extent.first_[d]) || (counters[d] >= extent.first_[d] + extent.size_[d])) return false;
+      pos[d] = counters[d] - extent.first_[d];
+    }
+
+    return true;
+  }
+
+  void IsmrmrdBufferLayout::allocate(IsmrmrdDataBuffered& dataBuffer, const ISMRMRD::AcquisitionHeader& acqhdr, const ISMRMRD::Encoding& encoding, const Extent& extent) const
+  {
+    fill_sampling_description(dataBuffer.sampling_, encoding);
+
+    size_t NE0;
+    if (encoding.trajectory.compare("cartesian") == 0) {
+      NE0 = encoding.reconSpace.matrixSize.x;
+    } else {
+      NE0 = acqhdr.number_of_samples - acqhdr.discard_pre - acqhdr.discard_post;
+    }
+
+    size_t NCHA = acqhdr.active_channels;
+    size_t NE1 = extent.size_[0];
+    size_t NE2 = extent.size_[1];
+    size_t NN = extent.size_[2];
+    size_t NS = extent.size_[3];
+    size_t NLOC = extent.size_[4];
+
+    dataBuffer.data_.create(NE0, NE1, NE2, NCHA, NN, NS, NLOC);
+    clear(&dataBuffer.data_);
+
+    dataBuffer.headers_.create(NE1, NE2, NN, NS, NLOC);
+
+    uint16_t TRAJDIM = acqhdr.trajectory_dimensions;
+    if (TRAJDIM > 0) {
+      dataBuffer.trajectory_.create(TRAJDIM, NE0, NE1, NE2, NN, NS, NLOC);
+      clear(&dataBuffer.trajectory_);
+    }
+  }
+
+  void IsmrmrdBufferLayout::stuff(const IsmrmrdAcquisitionData& d, IsmrmrdDataBuffered& dataBuffer, const ISMRMRD::Encoding& encoding, const Extent& extent) const
+  {
+    const ISMRMRD::AcquisitionHeader& acqhdr = *d.head_->getObjectPtr();
+    hoNDArray< std::complex<float> >& acqdata = *d.data_->getObjectPtr();
+
+    size_t pos[5];
+    uint16_t NCHA = dataBuffer.data_.get_size(3);
+    if (!get_position(acqhdr.idx, extent, pos) || (acqdata.get_size(1) < NCHA)) {
+      throw std::runtime_error("Acquisition does not fit into the data buffer.\n");
+    }
+
+    uint16_t npts_to_copy = acqhdr.number_of_samples - acqhdr.discard_pre - acqhdr.discard_post;
+    long long offset;
+    if (encoding.trajectory.compare("cartesian") == 0) {
+      offset = (long long) dataBuffer.sampling_.sampling_limits_[0].center_ - (long long) acqhdr.center_sample;
+    } else {
+      //TODO what about EPI with asymmetric readouts?
+      //TODO any other sort of trajectory?
+      offset = 0;
+    }
+    long long roffset = (long long) dataBuffer.data_.get_size(0) - npts_to_copy - offset;
+
+    if ((offset < 0) | (roffset < 0)) {
+      throw std::runtime_error("Acquired data does not fit into the data buffer.\n");
+    }
+
+    for (uint16_t cha = 0; cha < NCHA; cha++) {
+      memcpy(&dataBuffer.data_(offset, pos[0], pos[1], cha, pos[2], pos[3], pos[4]), &acqdata(acqhdr.discard_pre, cha), sizeof(std::complex<float>)*npts_to_copy);
+    }
+
+    dataBuffer.headers_(pos[0], pos[1], pos[2], pos[3], pos[4]) = acqhdr;
+
+    if (acqhdr.trajectory_dimensions > 0) {
+      if (!d.traj_ || (dataBuffer.trajectory_.get_size(0) != acqhdr.trajectory_dimensions)) {
+        throw std::runtime_error("Trajectory of the acquisition does not fit into the trajectory buffer\n");
+      }
+
+      hoNDArray< float >& acqtraj = *d.traj_->getObjectPtr();
+      memcpy(&dataBuffer.trajectory_(0, offset, pos[0], pos[1], pos[2], pos[3], pos[4]), &acqtraj(0, acqhdr.discard_pre), sizeof(float)*npts_to_copy*acqhdr.trajectory_dimensions);
+    }
+  }
+
+  void IsmrmrdBufferLayout::reshape(IsmrmrdDataBuffered& dataBuffer, const Extent& from, const Extent& to)
+  {
+    IsmrmrdDataBuffered reshaped;
+
+    size_t NE0 = dataBuffer.data_.get_size(0);
+    size_t NCHA = dataBuffer.data_.get_size(3);
+    size_t TRAJDIM = dataBuffer.trajectory_.get_number_of_elements() > 0 ? dataBuffer.trajectory_.get_size(0) : 0;
+
+    reshaped.data_.create(NE0, to.size_[0], to.size_[1], NCHA, to.size_[2], to.size_[3], to.size_[4]);
+    clear(&reshaped.data_);
+
+    reshaped.headers_.create(to.size_[0], to.size_[1], to.size_[2], to.size_[3], to.size_[4]);
+
+    if (TRAJDIM > 0) {
+      reshaped.trajectory_.create(TRAJDIM, NE0, to.size_[0], to.size_[1], to.size_[2], to.size_[3], to.size_[4]);
+      clear(&reshaped.trajectory_);
+    }
+
+    // the counter range kept, in counter values
+    size_t first[5], last[5];
+    for (size_t d = 0; d < 5; d++) {
+      first[d] = std::max(from.first_[d], to.first_[d]);
+      last[d] = std::max(first[d], std::min(from.first_[d] + from.size_[d], to.first_[d] + to.size_[d]));
+    }
+
+    for (size_t loc = first[4]; loc < last[4]; loc++) {
+      for (size_t s = first[3]; s < last[3]; s++) {
+        for (size_t n = first[2]; n < last[2]; n++) {
+          for (size_t e2 = first[1]; e2 < last[1]; e2++) {
+            for (size_t e1 = first[0]; e1 < last[0]; e1++) {
+              size_t f[5] = { e1 - from.first_[0], e2 - from.first_[1], n - from.first_[2], s - from.first_[3], loc - from.first_[4] };
+              size_t t[5] = { e1 - to.first_[0], e2 - to.first_[1], n - to.first_[2], s - to.first_[3], loc - to.first_[4] };
+
+              for (size_t cha = 0; cha < NCHA; cha++) {
+                memcpy(&reshaped.data_(0, t[0], t[1], cha, t[2], t[3], t[4]), &dataBuffer.data_(0, f[0], f[1], cha, f[2], f[3], f[4]), sizeof(std::complex<float>)*NE0);
+              }
+
+              reshaped.headers_(t[0], t[1], t[2], t[3], t[4]) = dataBuffer.headers_(f[0], f[1], f[2], f[3], f[4]);
+
+              if (TRAJDIM > 0) {
+                memcpy(&reshaped.trajectory_(0, 0, t[0], t[1], t[2], t[3], t[4]), &dataBuffer.trajectory_(0, 0, f[0], f[1], f[2], f[3], f[4]), sizeof(float)*TRAJDIM*NE0);
+              }
+            }
+          }
+        }
+      }
+    }
+
+    dataBuffer.data_ = std::move(reshaped.data_);
+    dataBuffer.headers_ = std::move(reshaped.headers_);
+    if (TRAJDIM > 0) dataBuffer.trajectory_ = std::move(reshaped.trajectory_);
+  }
+
+  void IsmrmrdBufferLayout::fill_sampling_description(SamplingDescription& sampling, const ISMRMRD::Encoding& encoding)
+  {
+    // For cartesian trajectories, assume that any oversampling has been removed.
+    if (encoding.trajectory.compare("cartesian") == 0) {
+      sampling.encoded_FOV_[0] = encoding.reconSpace.fieldOfView_mm.x;
+      sampling.encoded_matrix_[0] = encoding.reconSpace.matrixSize.x;
+      sampling.sampling_limits_[0].max_ = encoding.reconSpace.matrixSize.x - 1;
+      sampling.sampling_limits_[0].center_ = encoding.reconSpace.matrixSize.x / 2;
+    } else {
+      sampling.encoded_FOV_[0] = encoding.encodedSpace.fieldOfView_mm.x;
+      sampling.encoded_matrix_[0] = encoding.encodedSpace.matrixSize.x;
+      sampling.sampling_limits_[0].max_ = encoding.encodedSpace.matrixSize.x - 1;
+      sampling.sampling_limits_[0].center_ = encoding.encodedSpace.matrixSize.x / 2;
+    }
+    sampling.sampling_limits_[0].min_ = 0;
+
+    sampling.encoded_FOV_[1] = encoding.encodedSpace.fieldOfView_mm.y;
+    sampling.encoded_FOV_[2] = encoding.encodedSpace.fieldOfView_mm.z;
+
+    sampling.encoded_matrix_[1] = encoding.encodedSpace.matrixSize.y;
+    sampling.encoded_matrix_[2] = encoding.encodedSpace.matrixSize.z;
+
+    sampling.recon_FOV_[0] = encoding.reconSpace.fieldOfView_mm.x;
+    sampling.recon_FOV_[1] = encoding.reconSpace.fieldOfView_mm.y;
+    sampling.recon_FOV_[2] = encoding.reconSpace.fieldOfView_mm.z;
+
+    sampling.recon_matrix_[0] = encoding.reconSpace.matrixSize.x;
+    sampling.recon_matrix_[1] = encoding.reconSpace.matrixSize.y;
+    sampling.recon_matrix_[2] = encoding.reconSpace.matrixSize.z;
+
+    sampling.sampling_limits_[1].min_ = encoding.encodingLimits.kspace_encoding_step_1->minimum;
+    sampling.sampling_limits_[1].max_ = encoding.encodingLimits.kspace_encoding_step_1->maximum;
+    sampling.sampling_limits_[1].center_ = encoding.encodingLimits.kspace_encoding_step_1->center;
+
+    sampling.sampling_limits_[2].min_ = encoding.encodingLimits.kspace_encoding_step_2->minimum;
+    sampling.sampling_limits_[2].max_ = encoding.encodingLimits.kspace_encoding_step_2->maximum;
+    sampling.sampling_limits_[2].center_ = encoding.encodingLimits.kspace_encoding_step_2->center;
+  }
+
+}
@@ -0,0 +1,145 @@
+#ifndef ISMRMRDBUFFERLAYOUT_H
+#define ISMRMRDBUFFERLAYOUT_H
+
+#include "Gadget.h"
+#include "hoNDArray.h"
+#include "gadgetron_mricore_export.h"
+#include "log.h"
+
+#include <ismrmrd/ismrmrd.h>
+#include <ismrmrd/xml.h>
+#include <string>
+#include "mri_core_data.h"
+
+namespace Gadgetron{
+
+  /**
+     Layout of the IsmrmrdDataBuffered arrays, shared by the BucketToBufferGadget and the
+     accumulate_to_buffer mode of the AcquisitionAccumulateTriggerGadget so that both produce the same buffers.
+
+     data_ is 7D [E0, E1, E2, CHA, N, S, LOC], headers_ 5D [E1, E2, N, S, LOC] and trajectory_ 7D [TRAJ, E0, E1, E2, N, S, LOC].
+     E1/E2 cover the encoded matrix for cartesian data and the encoding limits otherwise, LOC covers the slice limit;
+     the bucket statistics are used where the header has no limit. N and S cover the range of counters found in the bucket.
+   */
+  class EXPORTGADGETSMRICORE IsmrmrdBufferLayout
+  {
+  public:
+
+    /**
+       Range of the [E1, E2, N, S, LOC] counters covered by a buffer, a readout with counter c
+       goes to index c - first_ of its dimension
+     */
+    struct Extent
+    {
+      size_t first_[5];
+      size_t size_[5];
+
+      bool operator==(const Extent& e) const;
+      bool operator!=(const Extent& e) const { return !(*this == e); }
+    };
+
+    IsmrmrdBufferLayout(IsmrmrdCONDITION N = NONE, IsmrmrdCONDITION S = NONE, bool split_slices = false, bool ignore_segment = false);
+
+    /// N or S dimension from its property value, "" for none
+    static IsmrmrdCONDITION get_dimension(const std::string& dim);
+
+    /// value of the counter of a dimension, 0 for NONE
+    static size_t get_index(IsmrmrdCONDITION cond, const ISMRMRD::ISMRMRD_EncodingCounters& idx);
+
+    /// add the counters of a readout to the statistics of its bucket
+    static void add_to_stats(IsmrmrdAcquisitionBucketStats& stats, const ISMRMRD::ISMRMRD_EncodingCounters& idx);
+
+    /// key of the IsmrmrdReconData a readout goes to, the N and S counters are collapsed
+    size_t get_key(const ISMRMRD::ISMRMRD_EncodingCounters& idx) const;
+
+    /// extent of a buffer holding the readouts of a bucket with these statistics
+    void get_extent(const ISMRMRD::Encoding& encoding, const IsmrmrdAcquisitionBucketStats& stats, Extent& extent) const;
+
+    /// extent from counter 0 up to the encoding limits, the dimensions without a limit have size 1
+    void get_limits_extent(const ISMRMRD::Encoding& encoding, Extent& extent) const;
+
+    /// restrict the dimensions holding cond to the counter value, for the dimensions all readouts of a buffer share; NONE leaves the extent unchanged
+    void restrict_extent(IsmrmrdCONDITION cond, size_t value, Extent& extent) const;
+
+    /// restrict the dimensions holding cond to the value found in the bucket statistics
+    void restrict_extent(IsmrmrdCONDITION cond, const IsmrmrdAcquisitionBucketStats& stats, Extent& extent) const;
+
+    /// grow an extent so that it holds the readout
+    void include(const ISMRMRD::ISMRMRD_EncodingCounters& idx, Extent& extent) const;
+
+    /// position of a readout in a buffer, false if it is outside of the extent
+    bool get_position(const ISMRMRD::ISMRMRD_EncodingCounters& idx, const Extent& extent, size_t pos[5]) const;
+
+    /// allocate the arrays of an empty buffer for the readouts like acqhdr and fill its sampling description
+    void allocate(IsmrmrdDataBuffered& dataBuffer, const ISMRMRD::AcquisitionHeader& acqhdr, const ISMRMRD::Encoding& encoding, const Extent& extent) const;
+
+    /// copy a readout into its slot of the buffer
+    void stuff(const IsmrmrdAcquisitionData& d, IsmrmrdDataBuffered& dataBuffer, const ISMRMRD::Encoding& encoding, const Extent& extent) const;
+
+    /// reallocate a buffer from one extent to another, the readouts inside both extents are kept
+    static void reshape(IsmrmrdDataBuffered& dataBuffer, const Extent& from, const Extent& to);
+
+    static void fill_sampling_description(SamplingDescription& sampling, const ISMRMRD::Encoding& encoding);
+
+  protected:
+
+    /// the [E1, E2, N, S, LOC] counters of a readout
+    void get_counters(const ISMRMRD::ISMRMRD_EncodingCounters& idx, size_t counters[5]) const;
+
+  public:
+
+    IsmrmrdCONDITION N_;
+    IsmrmrdCONDITION S_;
+    bool split_slices_;
+    bool ignore_segment_;
+  };
+
+  /**
+     Properties of the buffer layout, declared once for the gadgets producing IsmrmrdDataBuffered arrays
+   */
+  template <typename GadgetType> class IsmrmrdBufferLayoutGadget : public GadgetType
+  {
+  protected:
+    GADGET_PROPERTY_LIMITS(N_dimension, std::string, "N-Dimensions", "",
+			   GadgetPropertyLimitsEnumeration,
+			   "average",
+			   "contrast",
+			   "phase",
+			   "repetition",
+			   "set",
+			   "segment",
+			   "slice",
+			   "");
+
+    GADGET_PROPERTY_LIMITS(S_dimension, std::string, "S-Dimensions", "",
+			   GadgetPropertyLimitsEnumeration,
+			   "average",
+			   "contrast",
+			   "phase",
+			   "repetition",
+			   "set",
+			   "segment",
+			   "slice",
+			   "");
+
+    GADGET_PROPERTY(split_slices, bool, "Split slices", false);
+    GADGET_PROPERTY(ignore_segment, bool, "Ignore segment", false);
+
+    /// the layout set by the properties
+    IsmrmrdBufferLayout create_buffer_layout()
+    {
+      IsmrmrdCONDITION N = IsmrmrdBufferLayout::get_dimension(N_dimension.value());
+      GDEBUG("N DIMENSION IS: %s (%d)\n", N_dimension.value().c_str(), N);
+
+      IsmrmrdCONDITION S = IsmrmrdBufferLayout::get_dimension(S_dimension.value());
+      GDEBUG("S DIMENSION IS: %s (%d)\n", S_dimension.value().c_str(), S);
+
+      GDEBUG("SPLIT SLICES IS: %b\n", split_slices.value());
+      GDEBUG("IGNORE SEGMENT IS: %b\n", ignore_segment.value());
+
+      return IsmrmrdBufferLayout(N, S, split_slices.value(), ignore_segment.value());
+    }
+  };
+
+}
+#endif //ISMRMRDBUFFERLAYOUT_H
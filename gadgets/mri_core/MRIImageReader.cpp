@@ -1,4 +1,5 @@
 #include "MRIImageReader.h"
+#include "GadgetMessageBlockPool.h"
 #include <ismrmrd/ismrmrd.h>
 #include <ismrmrd/meta.h>
 
@@ -120,10 +121,34 @@ public:
 
 namespace Gadgetron{
 
+  /**
+     Image data is received directly into a buffer from the message block pool
+   */
+  template <typename T> static ACE_Message_Block* create_image_data_message(std::vector<size_t>& img_dims, char*& data_ptr, size_t& data_size)
+  {
+    data_size = sizeof(T);
+    for (size_t i = 0; i < img_dims.size(); i++) data_size *= img_dims[i];
+
+    auto d = GadgetMessageBlockPool::instance()->create_message< hoNDArray<T> >(data_size);
+    if (!d) {
+      throw std::runtime_error("Unable to allocate image data message");
+    }
+
+    data_ptr = GadgetMessageBlockPool::payload(d);
+    if (data_size) {
+      d->getObjectPtr()->create(img_dims, reinterpret_cast<T*>(data_ptr), false);
+    }
+    return d;
+  }
+
   ACE_Message_Block* MRIImageReader::read(ACE_SOCK_Stream* stream)
   {
 
-    auto h = new GadgetContainerMessage< ISMRMRD::ImageHeader >();
+    auto h = GadgetMessageBlockPool::instance()->create_message< ISMRMRD::ImageHeader >();
+    if (!h) {
+      GERROR("Failed to allocate ISMRMRD Image Header\n");
+      return 0;
+    }
     
     size_t recv_count = 0;
     if ((recv_count = stream->recv_n(h->getObjectPtr(), sizeof(ISMRMRD::ImageHeader))) <= 0) {
@@ -164,12 +189,6 @@ namespace Gadgetron{
     char* data_ptr;
     size_t data_size;
     
-    size_t elements =
-      h->getObjectPtr()->matrix_size[0] *
-      h->getObjectPtr()->matrix_size[1] *
-      h->getObjectPtr()->matrix_size[2] *
-      h->getObjectPtr()->channels;
-
     std::vector<size_t> img_dims{h->getObjectPtr()->matrix_size[0],
 	h->getObjectPtr()->matrix_size[1], h->getObjectPtr()->matrix_size[2], h->getObjectPtr()->channels};
 
@@ -177,68 +196,35 @@ namespace Gadgetron{
     try {
       if (h->getObjectPtr()->data_type == ISMRMRD::ISMRMRD_USHORT)
       {
-	auto d = new GadgetContainerMessage< hoNDArray<uint16_t> >();
-	d->getObjectPtr()->create(img_dims);
-	data_ptr = reinterpret_cast<char*>(d->getObjectPtr()->get_data_ptr());
-	data_size = elements * sizeof(uint16_t);
-	h->cont(d);
+	h->cont(create_image_data_message< uint16_t >(img_dims, data_ptr, data_size));
       }
       else if (h->getObjectPtr()->data_type == ISMRMRD::ISMRMRD_SHORT)
       {
-	auto d = new GadgetContainerMessage< hoNDArray<int16_t> >();
-	d->getObjectPtr()->create(img_dims);
-	data_ptr = reinterpret_cast<char*>(d->getObjectPtr()->get_data_ptr());
-	data_size = elements * sizeof(int16_t);
-	h->cont(d);
+	h->cont(create_image_data_message< int16_t >(img_dims, data_ptr, data_size));
       }
       else if (h->getObjectPtr()->data_type == ISMRMRD::ISMRMRD_UINT)
       {
-	auto d = new GadgetContainerMessage< hoNDArray<uint32_t> >();
-	d->getObjectPtr()->create(img_dims);
-	data_ptr = reinterpret_cast<char*>(d->getObjectPtr()->get_data_ptr());
-	data_size = elements * sizeof(uint32_t);
-	h->cont(d);
+	h->cont(create_image_data_message< uint32_t >(img_dims, data_ptr, data_size));
       }
       else if (h->getObjectPtr()->data_type == ISMRMRD::ISMRMRD_INT)
       {
-	auto d = new GadgetContainerMessage< hoNDArray<int32_t> >();
-	d->getObjectPtr()->create(img_dims);
-	data_ptr = reinterpret_cast<char*>(d->getObjectPtr()->get_data_ptr());
-	data_size = elements * sizeof(int32_t);
-	h->cont(d);
+	h->cont(create_image_data_message< int32_t >(img_dims, data_ptr, data_size));
       }
       else if (h->getObjectPtr()->data_type == ISMRMRD::ISMRMRD_FLOAT)
       {
-	auto d = new GadgetContainerMessage< hoNDArray<float> >();
-	d->getObjectPtr()->create(img_dims);
-	data_ptr = reinterpret_cast<char*>(d->getObjectPtr()->get_data_ptr());
-	data_size = elements * sizeof(float);
-	h->cont(d);
+	h->cont(create_image_data_message< float >(img_dims, data_ptr, data_size));
       }
       else if (h->getObjectPtr()->data_type == ISMRMRD::ISMRMRD_DOUBLE)
       {
-	auto d = new GadgetContainerMessage< hoNDArray<double> >();
-	d->getObjectPtr()->create(img_dims);
-	data_ptr = reinterpret_cast<char*>(d->getObjectPtr()->get_data_ptr());
-	data_size = elements * sizeof(double);
-	h->cont(d);
+	h->cont(create_image_data_message< double >(img_dims, data_ptr, data_size));
       }
       else if (h->getObjectPtr()->data_type == ISMRMRD::ISMRMRD_CXFLOAT)
       {
-	auto d = new GadgetContainerMessage< hoNDArray< std::complex<float> > >();
-	d->getObjectPtr()->create(img_dims);
-	data_ptr = reinterpret_cast<char*>(d->getObjectPtr()->get_data_ptr());
-	data_size = elements * sizeof(std::complex<float>);
-	h->cont(d);
-
+	h->cont(create_image_data_message< std::complex<float> >(img_dims, data_ptr, data_size));
       }
       else if (h->getObjectPtr()->data_type == ISMRMRD::ISMRMRD_CXDOUBLE)
       {
-	auto d = new GadgetContainerMessage< hoNDArray< std::complex<double> > >();
-	d->getObjectPtr()->create(img_dims);
-	data_ptr = reinterpret_cast<char*>(d->getObjectPtr()->get_data_ptr());
-	data_size = elements * sizeof(std::complex<double>);
-	h->cont(d);
+	h->cont(create_image_data_message< std::complex<double> >(img_dims, data_ptr, data_size));
       }
       else
       {
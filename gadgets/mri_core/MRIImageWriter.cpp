@@ -144,6 +144,40 @@ namespace Gadgetron{
         return 0;
     }
 
+    int MRIImageWriter::gather(GadgetMessageIOVector& iov, ACE_Message_Block* mb)
+    {
+        GadgetContainerMessage<ISMRMRD::ImageHeader>* imagemb =
+            AsContainerMessage<ISMRMRD::ImageHeader>(mb);
+
+        if (!imagemb)
+        {
+            GERROR("MRIImageWriter::gather, invalid image message objects, 1\n");
+            return -1;
+        }
+
+        switch (imagemb->getObjectPtr()->data_type)
+        {
+        case ISMRMRD::ISMRMRD_USHORT:
+            return this->gather_data_attrib< unsigned short >(iov, imagemb);
+        case ISMRMRD::ISMRMRD_SHORT:
+            return this->gather_data_attrib< short >(iov, imagemb);
+        case ISMRMRD::ISMRMRD_UINT:
+            return this->gather_data_attrib< unsigned int >(iov, imagemb);
+        case ISMRMRD::ISMRMRD_INT:
+            return this->gather_data_attrib< int >(iov, imagemb);
+        case ISMRMRD::ISMRMRD_FLOAT:
+            return this->gather_data_attrib< float >(iov, imagemb);
+        case ISMRMRD::ISMRMRD_DOUBLE:
+            return this->gather_data_attrib< double >(iov, imagemb);
+        case ISMRMRD::ISMRMRD_CXFLOAT:
+            return this->gather_data_attrib< std::complex<float> >(iov, imagemb);
+        case ISMRMRD::ISMRMRD_CXDOUBLE:
+            return this->gather_data_attrib< std::complex<double> >(iov, imagemb);
+        }
+
+        return -1;
+    }
+
     GADGETRON_WRITER_FACTORY_DECLARE(MRIImageWriter)
 
 }
@@ -20,6 +20,59 @@ namespace Gadgetron{
     {
     public:
         virtual int write(ACE_SOCK_Stream* sock, ACE_Message_Block* mb);
+        virtual int gather(GadgetMessageIOVector& iov, ACE_Message_Block* mb);
+
+        /// same wire format as write_data_attrib, with the header and pixels referenced in place
+        template <typename T>
+        int gather_data_attrib(GadgetMessageIOVector& iov, GadgetContainerMessage<ISMRMRD::ImageHeader>* header)
+        {
+            typedef unsigned long long size_t_type;
+
+            GadgetContainerMessage< hoNDArray<T> >* data = AsContainerMessage< hoNDArray<T> >(header->cont());
+            if (!data)
+            {
+                GERROR("MRIImageWriter::gather, invalid image message objects\n");
+                return -1;
+            }
+
+            // inconsistent images are left to write_data_attrib, which reports the details
+            size_t expected_elements = (size_t)header->getObjectPtr()->matrix_size[0]*header->getObjectPtr()->matrix_size[1]*header->getObjectPtr()->matrix_size[2];
+            if (expected_elements != data->getObjectPtr()->get_number_of_elements()) return -1;
+
+            GadgetContainerMessage<ISMRMRD::MetaContainer>* attribmb = AsContainerMessage<ISMRMRD::MetaContainer>(data->cont());
+
+            std::string attribContent;
+            size_t_type len(0);
+
+            if (attribmb)
+            {
+                try
+                {
+                    std::stringstream str;
+                    ISMRMRD::serialize(*attribmb->getObjectPtr(), str);
+                    attribContent = str.str();
+                    len = attribContent.length() + 1;
+                }
+                catch (...)
+                {
+                    GERROR("Unable to serialize image meta attributes \n");
+                    return -1;
+                }
+            }
+
+            header->getObjectPtr()->attribute_string_len = (uint32_t)len;
+
+            GadgetMessageIdentifier id;
+            id.id = GADGET_MESSAGE_ISMRMRD_IMAGE;
+
+            iov.add_copy(&id, sizeof(GadgetMessageIdentifier));
+            iov.add(header->getObjectPtr(), sizeof(ISMRMRD::ImageHeader));
+            iov.add_copy(&len, sizeof(size_t_type));
+            if (len > 0) iov.add_copy(attribContent.c_str(), len);
+            iov.add(data->getObjectPtr()->get_data_ptr(), sizeof(T)*data->getObjectPtr()->get_number_of_elements());
+
+            return 0;
+        }
 
         template <typename T>
         int write_data_attrib(ACE_SOCK_Stream* sock, GadgetContainerMessage<ISMRMRD::ImageHeader>* header, GadgetContainerMessage< hoNDArray<T> >* data)
@@ -16,9 +16,73 @@
 
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <map>
+#include <sstream>
 
 namespace Gadgetron{
 
+  namespace {
+
+    // Noise dependencies are shared by all connections of the server, so a series of scans
+    // referring to the same noise scan reads and factorizes the covariance matrix only once.
+    // An entry is valid as long as the noise dependency file is not modified.
+    struct NoiseDependencyCacheEntry
+    {
+      std::time_t modified;
+      unsigned long long last_used;
+      float noise_dwell_time_us;
+      ISMRMRD::IsmrmrdHeader noise_header;
+      hoNDArray< std::complex<float> > noise_covariance;
+      hoNDArray< std::complex<float> > noise_prewhitener; // without the bandwidth scaling, empty until computed
+    };
+
+    const size_t noise_dependency_cache_capacity = 16;
+
+    boost::mutex noise_dependency_cache_mutex;
+    std::map<std::string, NoiseDependencyCacheEntry> noise_dependency_cache;
+    unsigned long long noise_dependency_cache_clock = 0;
+
+    std::time_t noise_dependency_modified(const std::string& filename)
+    {
+      boost::system::error_code ec;
+      std::time_t t = boost::filesystem::last_write_time(filename, ec);
+      return ec ? (std::time_t)(-1) : t;
+    }
+
+    // called with the cache mutex held
+    NoiseDependencyCacheEntry& noise_dependency_cache_insert(const std::string& key)
+    {
+      if ( (noise_dependency_cache.find(key) == noise_dependency_cache.end()) && (noise_dependency_cache.size() >= noise_dependency_cache_capacity) ) {
+        std::map<std::string, NoiseDependencyCacheEntry>::iterator lru = noise_dependency_cache.begin();
+        for (std::map<std::string, NoiseDependencyCacheEntry>::iterator iter = noise_dependency_cache.begin(); iter != noise_dependency_cache.end(); iter++) {
+          if ( iter->second.last_used < lru->second.last_used ) lru = iter;
+        }
+        noise_dependency_cache.erase(lru);
+      }
+
+      NoiseDependencyCacheEntry& entry = noise_dependency_cache[key];
+      entry.last_used = ++noise_dependency_cache_clock;
+      return entry;
+    }
+
+    bool ends_prewhitening_block(ISMRMRD::AcquisitionHeader& acqhdr)
+    {
+      return acqhdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_LAST_IN_ENCODE_STEP1)
+        || acqhdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_LAST_IN_ENCODE_STEP2)
+        || acqhdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_LAST_IN_AVERAGE)
+        || acqhdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_LAST_IN_SLICE)
+        || acqhdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_LAST_IN_CONTRAST)
+        || acqhdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_LAST_IN_PHASE)
+        || acqhdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_LAST_IN_REPETITION)
+        || acqhdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_LAST_IN_SET)
+        || acqhdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_LAST_IN_SEGMENT)
+        || acqhdr.isFlagSet(ISMRMRD::ISMRMRD_ACQ_LAST_IN_MEASUREMENT);
+    }
+  }
+
   NoiseAdjustGadget::NoiseAdjustGadget()
     : noise_decorrelation_calculated_(false)
     , number_of_noise_samples_(0)
@@ -27,6 +91,8 @@ namespace Gadgetron{
     , noise_dwell_time_us_(-1.0f)
     , noiseCovarianceLoaded_(false)
     , saved_(false)
+    , prewhitening_block_size_(1)
+    , noise_dependency_modified_(-1)
   {
     noise_dependency_prefix_ = "GadgetronNoiseCovarianceMatrix";
     measurement_id_.clear();
@@ -38,7 +104,9 @@ namespace Gadgetron{
 
   NoiseAdjustGadget::~NoiseAdjustGadget()
   {
-
+    for (size_t n = 0; n < prewhitening_block_.size(); n++) {
+      prewhitening_block_[n]->release();
+    }
   }
 
   int NoiseAdjustGadget::process_config(ACE_Message_Block* mb)
@@ -65,6 +133,10 @@ namespace Gadgetron{
     GDEBUG("NoiseAdjustGadget::pass_nonconformant_data_ is %d\n", pass_nonconformant_data_);
 
     noise_dwell_time_us_preset_ = noise_dwell_time_us_preset.value();
+
+    prewhitening_block_size_ = prewhitening_block_size.value() > 1 ? (size_t)prewhitening_block_size.value() : 1;
+    GDEBUG("NoiseAdjustGadget::prewhitening_block_size_ is %d\n", (int)prewhitening_block_size_);
+
     ISMRMRD::deserialize(mb->rd_ptr(),current_ismrmrd_header_);
     
     if ( current_ismrmrd_header_.acquisitionSystemInformation ) {
@@ -74,6 +146,25 @@ namespace Gadgetron{
       GDEBUG("receiver_noise_bandwidth_ is %f\n", receiver_noise_bandwidth_);
     }
 
+    //Let's figure out if some channels are "scale_only"
+    std::string uncomb_str = scale_only_channels_by_name.value();
+    std::vector<std::string> uncomb;
+    if (uncomb_str.size()) {
+      GDEBUG("SCALE ONLY: %s\n",  uncomb_str.c_str());
+      boost::split(uncomb, uncomb_str, boost::is_any_of(","));
+      for (unsigned int i = 0; i < uncomb.size(); i++) {
+	std::string ch = boost::algorithm::trim_copy(uncomb[i]);
+	if (current_ismrmrd_header_.acquisitionSystemInformation) {
+	  for (size_t i = 0; i < current_ismrmrd_header_.acquisitionSystemInformation->coilLabel.size(); i++) {
+	    if (ch == current_ismrmrd_header_.acquisitionSystemInformation->coilLabel[i].coilName) {
+	      scale_only_channels_.push_back(i);//This assumes that the channels are sorted in the header
+	      break;
+	    }
+	  }
+	}
+      }
+    }
+
     // find the measurementID of this scan
     if ( current_ismrmrd_header_.measurementInformation )
       {
@@ -153,25 +244,6 @@ namespace Gadgetron{
       }
 
 
-    //Let's figure out if some channels are "scale_only"
-    std::string uncomb_str = scale_only_channels_by_name.value();
-    std::vector<std::string> uncomb;
-    if (uncomb_str.size()) {
-      GDEBUG("SCALE ONLY: %s\n",  uncomb_str.c_str());
-      boost::split(uncomb, uncomb_str, boost::is_any_of(","));
-      for (unsigned int i = 0; i < uncomb.size(); i++) {
-	std::string ch = boost::algorithm::trim_copy(uncomb[i]);
-	if (current_ismrmrd_header_.acquisitionSystemInformation) {
-	  for (size_t i = 0; i < current_ismrmrd_header_.acquisitionSystemInformation->coilLabel.size(); i++) {
-	    if (ch == current_ismrmrd_header_.acquisitionSystemInformation->coilLabel[i].coilName) {
-	      scale_only_channels_.push_back(i);//This assumes that the channels are sorted in the header
-	      break;
-	    }
-	  }
-	}
-      }
-    }
-
 #ifdef USE_OMP
     omp_set_num_threads(1);
 #endif // USE_OMP
@@ -206,8 +278,47 @@ namespace Gadgetron{
     return full_name_stored_noise_dependency;
   }
 
+  std::string NoiseAdjustGadget::generateNoiseCacheKey(const std::string& noise_dependency_filename)
+  {
+    // the prewhitener depends on the coil layout and on the scale only channels
+    std::ostringstream key;
+    key << noise_dependency_filename;
+
+    if ( current_ismrmrd_header_.acquisitionSystemInformation ) {
+      for (size_t l = 0; l < current_ismrmrd_header_.acquisitionSystemInformation->coilLabel.size(); l++) {
+	key << "|" << current_ismrmrd_header_.acquisitionSystemInformation->coilLabel[l].coilNumber
+	    << ":" << current_ismrmrd_header_.acquisitionSystemInformation->coilLabel[l].coilName;
+      }
+    }
+
+    key << "|";
+    for (size_t ch = 0; ch < scale_only_channels_.size(); ch++) {
+      key << scale_only_channels_[ch] << ",";
+    }
+
+    return key.str();
+  }
+
   bool NoiseAdjustGadget::loadNoiseCovariance()
   {
+    std::string key = this->generateNoiseCacheKey(full_name_stored_noise_dependency_);
+    noise_dependency_modified_ = noise_dependency_modified(full_name_stored_noise_dependency_);
+
+    if ( noise_dependency_modified_ != (std::time_t)(-1) ) {
+      boost::mutex::scoped_lock lock(noise_dependency_cache_mutex);
+
+      std::map<std::string, NoiseDependencyCacheEntry>::iterator iter = noise_dependency_cache.find(key);
+      if ( (iter != noise_dependency_cache.end()) && (iter->second.modified == noise_dependency_modified_) ) {
+	GDEBUG("Noise dependency is found in the cache : %s\n", full_name_stored_noise_dependency_.c_str());
+
+	iter->second.last_used = ++noise_dependency_cache_clock;
+	noise_ismrmrd_header_ = iter->second.noise_header;
+	noise_dwell_time_us_ = iter->second.noise_dwell_time_us;
+	noise_covariance_matrixf_ = iter->second.noise_covariance;
+	return true;
+      }
+    }
+
     std::ifstream infile;
     infile.open (full_name_stored_noise_dependency_.c_str(), std::ios::in|std::ios::binary);
 
@@ -242,6 +353,17 @@ namespace Gadgetron{
       return false;
     }
 
+    if ( noise_dependency_modified_ != (std::time_t)(-1) ) {
+      boost::mutex::scoped_lock lock(noise_dependency_cache_mutex);
+
+      NoiseDependencyCacheEntry& entry = noise_dependency_cache_insert(key);
+      entry.modified = noise_dependency_modified_;
+      entry.noise_dwell_time_us = noise_dwell_time_us_;
+      entry.noise_header = noise_ismrmrd_header_;
+      entry.noise_covariance = noise_covariance_matrixf_;
+      entry.noise_prewhitener.clear();
+    }
+
     return true;
   }
 
@@ -286,6 +408,19 @@ namespace Gadgetron{
 	outfile.write(buf, len);
 	outfile.close();
 
+	// the next scans with this noise dependency find it in the cache
+	std::time_t modified = noise_dependency_modified(filename);
+	if ( modified != (std::time_t)(-1) ) {
+	  boost::mutex::scoped_lock lock(noise_dependency_cache_mutex);
+
+	  NoiseDependencyCacheEntry& entry = noise_dependency_cache_insert(this->generateNoiseCacheKey(filename));
+	  entry.modified = modified;
+	  entry.noise_dwell_time_us = noise_dwell_time_us_;
+	  entry.noise_header = current_ismrmrd_header_;
+	  entry.noise_covariance = covf;
+	  entry.noise_prewhitener.clear();
+	}
+
 	// set the permission for the noise file to be rewritable
 #ifndef _WIN32
 	int res = chmod(filename.c_str(), S_IRUSR|S_IWUSR|S_IXUSR|S_IRGRP|S_IWGRP|S_IXGRP|S_IROTH|S_IWOTH|S_IXOTH);
@@ -311,6 +446,18 @@ namespace Gadgetron{
     if (!noise_decorrelation_calculated_) {
       
       if (number_of_noise_samples_ > 0 ) {
+	if ( noiseCovarianceLoaded_ ) {
+	  boost::mutex::scoped_lock lock(noise_dependency_cache_mutex);
+
+	  std::map<std::string, NoiseDependencyCacheEntry>::iterator iter = noise_dependency_cache.find(this->generateNoiseCacheKey(full_name_stored_noise_dependency_));
+	  if ( (iter != noise_dependency_cache.end()) && (iter->second.modified == noise_dependency_modified_) && (iter->second.noise_prewhitener.get_number_of_elements() > 0) ) {
+	    GDEBUG("Noise decorrelation is found in the cache\n");
+	    noise_prewhitener_matrixf_ = iter->second.noise_prewhitener;
+	    noise_decorrelation_calculated_ = true;
+	    return;
+	  }
+	}
+
 	GDEBUG("Calculating noise decorrelation\n");
 	
 	noise_prewhitener_matrixf_ = noise_covariance_matrixf_;
@@ -333,6 +480,15 @@ namespace Gadgetron{
 	noise_covf = arma::inv(arma::trimatu(arma::chol(noise_covf)));
       
 	noise_decorrelation_calculated_ = true;
+
+	if ( noiseCovarianceLoaded_ ) {
+	  boost::mutex::scoped_lock lock(noise_dependency_cache_mutex);
+
+	  std::map<std::string, NoiseDependencyCacheEntry>::iterator iter = noise_dependency_cache.find(this->generateNoiseCacheKey(full_name_stored_noise_dependency_));
+	  if ( (iter != noise_dependency_cache.end()) && (iter->second.modified == noise_dependency_modified_) ) {
+	    iter->second.noise_prewhitener = noise_prewhitener_matrixf_;
+	  }
+	}
       } else {
 	noise_decorrelation_calculated_ = false;
       }
@@ -427,10 +583,13 @@ namespace Gadgetron{
       }
 
       if (noise_decorrelation_calculated_) {
-          //Apply prewhitener
+          //Apply prewhitener, the readouts are buffered and prewhitened together
           if ( noise_prewhitener_matrixf_.get_size(0) == m2->getObjectPtr()->get_size(1) ) {
-               hoNDArray<std::complex<float> > tmp(*m2->getObjectPtr());
-               gemm(*m2->getObjectPtr(), tmp, noise_prewhitener_matrixf_);
+               prewhitening_block_.push_back(m1);
+               if ( (prewhitening_block_.size() >= prewhitening_block_size_) || ends_prewhitening_block(*m1->getObjectPtr()) ) {
+                    return this->prewhitenBlock();
+               }
+               return GADGET_OK;
           } else {
                if (!pass_nonconformant_data_) {
                      m1->release();
@@ -441,6 +600,12 @@ namespace Gadgetron{
       }
     }
 
+    //Keep the order of the readouts
+    if (this->prewhitenBlock() != GADGET_OK) {
+      m1->release();
+      return GADGET_FAIL;
+    }
+
     if (this->next()->putq(m1) == -1) {
       GDEBUG("Error passing on data to next gadget\n");
       return GADGET_FAIL;
@@ -450,10 +615,70 @@ namespace Gadgetron{
 
   }
 
+  int NoiseAdjustGadget::prewhitenBlock()
+  {
+    if ( prewhitening_block_.empty() ) return GADGET_OK;
+
+    size_t CHA = noise_prewhitener_matrixf_.get_size(0);
+
+    size_t N = 0;
+    for (size_t n = 0; n < prewhitening_block_.size(); n++) {
+      N += AsContainerMessage< hoNDArray< std::complex<float> > >(prewhitening_block_[n]->cont())->getObjectPtr()->get_size(0);
+    }
+
+    // the buffers only grow, the block is a [N CHA] view at their start
+    if ( prewhitening_block_data_.get_number_of_elements() < N*CHA ) {
+      prewhitening_block_data_.create(N*CHA);
+      prewhitening_block_whitened_.create(N*CHA);
+    }
+
+    hoNDArray< std::complex<float> > data(N, CHA, prewhitening_block_data_.begin());
+    hoNDArray< std::complex<float> > whitened(N, CHA, prewhitening_block_whitened_.begin());
+
+    size_t offset = 0;
+    for (size_t n = 0; n < prewhitening_block_.size(); n++) {
+      hoNDArray< std::complex<float> >& readout = *AsContainerMessage< hoNDArray< std::complex<float> > >(prewhitening_block_[n]->cont())->getObjectPtr();
+      size_t samples = readout.get_size(0);
+      for (size_t c = 0; c < CHA; c++) {
+	memcpy(data.begin() + c*N + offset, readout.begin() + c*samples, sizeof(std::complex<float>)*samples);
+      }
+      offset += samples;
+    }
+
+    gemm(whitened, data, noise_prewhitener_matrixf_);
+
+    int ret = GADGET_OK;
+
+    offset = 0;
+    for (size_t n = 0; n < prewhitening_block_.size(); n++) {
+      hoNDArray< std::complex<float> >& readout = *AsContainerMessage< hoNDArray< std::complex<float> > >(prewhitening_block_[n]->cont())->getObjectPtr();
+      size_t samples = readout.get_size(0);
+      for (size_t c = 0; c < CHA; c++) {
+	memcpy(readout.begin() + c*samples, whitened.begin() + c*N + offset, sizeof(std::complex<float>)*samples);
+      }
+      offset += samples;
+
+      if ( ret != GADGET_OK ) {
+	prewhitening_block_[n]->release();
+      } else if (this->next()->putq(prewhitening_block_[n]) == -1) {
+	GDEBUG("Error passing on data to next gadget\n");
+	prewhitening_block_[n]->release();
+	ret = GADGET_FAIL;
+      }
+    }
+
+    prewhitening_block_.clear();
+    return ret;
+  }
+
   int NoiseAdjustGadget::close(unsigned long flags)
   {
     if ( BaseClass::close(flags) != GADGET_OK ) return GADGET_FAIL;
 
+    if ( flags != 0 ) {
+      if ( this->prewhitenBlock() != GADGET_OK ) return GADGET_FAIL;
+    }
+
     if ( !noiseCovarianceLoaded_  && !saved_ ){
       saveNoiseCovariance();
       saved_ = true;
@@ -8,6 +8,7 @@
 #include <ismrmrd/ismrmrd.h>
 #include <ismrmrd/xml.h>
 #include <complex>
+#include <ctime>
 
 namespace Gadgetron {
 
@@ -30,6 +31,7 @@ namespace Gadgetron {
       GADGET_PROPERTY(pass_nonconformant_data, bool, "Whether to pass data that does not conform", false);
       GADGET_PROPERTY(noise_dwell_time_us_preset, float, "Preset dwell time for noise measurement", 0.0);
       GADGET_PROPERTY(scale_only_channels_by_name, std::string, "List of named channels that should only be scaled", "");
+      GADGET_PROPERTY(prewhitening_block_size, int, "Number of readouts prewhitened together in one matrix multiplication, 1 prewhitens every readout as it arrives", 1);
 
       bool noise_decorrelation_calculated_;
       hoNDArray< std::complex<float> > noise_covariance_matrixf_;
@@ -49,11 +51,18 @@ namespace Gadgetron {
       bool pass_nonconformant_data_;
       bool saved_;
 
+      // readouts waiting to be prewhitened together
+      size_t prewhitening_block_size_;
+      std::vector< GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* > prewhitening_block_;
+      hoNDArray< std::complex<float> > prewhitening_block_data_;
+      hoNDArray< std::complex<float> > prewhitening_block_whitened_;
+
       std::string noise_dependency_folder_;
       std::string noise_dependency_prefix_;
       std::string measurement_id_;
       std::string measurement_id_of_noise_dependency_;
       std::string full_name_stored_noise_dependency_;
+      std::time_t noise_dependency_modified_;
 
       virtual int process_config(ACE_Message_Block* mb);
       virtual int process(GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1,
@@ -66,6 +75,12 @@ namespace Gadgetron {
       bool saveNoiseCovariance();
       void computeNoisePrewhitener();
 
+      // key of the noise dependency in the prewhitener cache shared by all connections
+      std::string generateNoiseCacheKey(const std::string& noise_dependency_filename);
+
+      // prewhiten the buffered readouts with one gemm and pass them on
+      int prewhitenBlock();
+
       //We will store/load a copy of the noise scans XML header to enable us to check which coil layout, etc.
       ISMRMRD::IsmrmrdHeader current_ismrmrd_header_;
       ISMRMRD::IsmrmrdHeader noise_ismrmrd_header_;
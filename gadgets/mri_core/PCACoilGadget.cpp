@@ -19,8 +19,11 @@
 namespace Gadgetron {
 
     PCACoilGadget::PCACoilGadget()
-        : max_buffered_profiles_(100)
+        : pca_mode_("buffer")
+        , max_buffered_profiles_(100)
         , samples_to_use_(16)
+        , samples_per_channel_(8)
+        , calibration_samples_per_channel_(8)
     {
     }
 
@@ -63,6 +66,12 @@ namespace Gadgetron {
       present_uncombined_channels.value((int)uncombined_channels_.size());
       GDEBUG("Number of uncombined channels (present_uncombined_channels) set to %d\n", uncombined_channels_.size());
 
+      pca_mode_ = pca_mode.value();
+      max_buffered_profiles_ = max_buffered_profiles.value() > 1 ? max_buffered_profiles.value() : 1;
+      samples_per_channel_ = samples_per_channel.value() > 1 ? samples_per_channel.value() : 1;
+      calibration_samples_per_channel_ = calibration_samples_per_channel.value() > 1 ? calibration_samples_per_channel.value() : 1;
+      GDEBUG("PCA mode is %s, at most %d profiles are buffered\n", pca_mode_.c_str(), max_buffered_profiles_);
+
       return GADGET_OK;
     }
 
@@ -98,111 +107,44 @@ namespace Gadgetron {
             buffer_[location].push_back(m1);
             int profiles_available = buffer_[location].size();
 
-            //Are we ready for calculating PCA
-            if (is_last_scan_in_slice || (profiles_available >= max_buffered_profiles_)) {
-
-                //GDEBUG("Calculating PCA coefficients with %d profiles for %d coils\n", profiles_available, channels);
-                int samples_to_use = samples_per_profile > samples_to_use_ ? samples_to_use_ : samples_per_profile;
-
-                //For some sequences there is so little data, we should just use it all.
-                if (profiles_available < 16) {
-                    samples_to_use = samples_per_profile;
-                }
-
-                int total_samples = samples_to_use*profiles_available;
-
-                std::vector<size_t> dims(2);
-                dims[0] = channels;dims[1] = total_samples;
-
-                hoNDArray< std::complex<float> > A;
-                try{ A.create(&dims); }
-                catch (std::runtime_error & err){
-                    GDEBUG("Unable to create array for PCA calculation\n");
-                    return GADGET_FAIL;
-                }
-
-                std::complex<float>* A_ptr = A.get_data_ptr();
-                size_t sample_counter = 0;
+            bool is_calibration = m1->getObjectPtr()->isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PARALLEL_CALIBRATION)
+                || m1->getObjectPtr()->isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PARALLEL_CALIBRATION_AND_IMAGING);
 
-                size_t data_offset = 0;
-                if (m1->getObjectPtr()->center_sample >= (samples_to_use>>1)) {
-                    data_offset = m1->getObjectPtr()->center_sample - (samples_to_use>>1);
-                }
-
-                //GDEBUG("Data offset = %d\n", data_offset);
-
-                hoNDArray<std::complex<float> > means;
-                std::vector<size_t> means_dims; means_dims.push_back(channels);
+            if ( (pca_mode_ == "streaming") || ((pca_mode_ == "calibration") && is_calibration) ) {
+                accumulate_covariance(location, *m1->getObjectPtr(), *m2->getObjectPtr());
+            }
 
-                try{means.create(&means_dims);}
-                catch (std::runtime_error& err){
-                    GDEBUG("Unable to create temporary stoorage for mean values\n");
-                    return GADGET_FAIL;
-                }
+            //The covariance is only used once it holds enough samples per channel
+            size_t covariance_samples_needed = (size_t)((pca_mode_ == "calibration") ? calibration_samples_per_channel_ : samples_per_channel_) * channels;
+            bool covariance_ready = (pca_mode_ != "buffer") && (covariance_samples_[location] >= covariance_samples_needed);
 
-                means.fill(std::complex<float>(0.0f,0.0f));
+            //The first profile after the calibration region ends the calibration, with too few calibration samples the buffering goes on as in the buffer mode
+            bool calibration_done = (pca_mode_ == "calibration") && !is_calibration && covariance_ready;
 
-                std::complex<float>* means_ptr = means.get_data_ptr();
-                for (size_t p = 0; p < profiles_available; p++) {
-                    GadgetContainerMessage<hoNDArray<std::complex<float> > >* m_tmp =
-                        AsContainerMessage<hoNDArray< std::complex<float> > >(buffer_[location][p]->cont());
+            //Are we ready for calculating PCA
+            if (is_last_scan_in_slice || (profiles_available >= max_buffered_profiles_) || ((pca_mode_ == "streaming") && covariance_ready) || calibration_done) {
 
-                    if (!m_tmp) {
-                        GDEBUG("Fatal error, unable to recover data from data buffer (%d,%d)\n", p, profiles_available);
+                //Without enough samples in the covariance estimate (e.g. no or few calibration profiles), the buffered profiles are used
+                if (covariance_ready) {
+                    if (calculate_pca_from_covariance(location, channels) != GADGET_OK) {
                         return GADGET_FAIL;
                     }
-
-                    std::complex<float>* d = m_tmp->getObjectPtr()->get_data_ptr();
-
-		      for (unsigned s = 0; s < samples_to_use; s++) {
-			for (size_t c = 0; c < channels; c++) {
-			  bool uncombined_channel = std::find(uncombined_channels_.begin(),uncombined_channels_.end(), c) != uncombined_channels_.end();
-			  //We use the conjugate of the data so that the output VT of the SVD is the actual PCA coefficient matrix
-			  if (uncombined_channel) {
-			    A_ptr[c + sample_counter*channels] = std::complex<float>(0.0,0.0);
-			  } else {
-			    A_ptr[c + sample_counter*channels] = d[c*samples_per_profile + data_offset + s];
-			    means_ptr[c] += d[c*samples_per_profile + data_offset + s];
-			  }
-			}
-			
-			sample_counter++;
-			//GDEBUG("Sample counter = %d/%d\n", sample_counter, total_samples);
-		      }
-                }
-
-                //Subtract off mean
-                for (size_t c = 0; c < channels; c++) {
-                    for (size_t s = 0; s < total_samples; s++) {
-                        A_ptr[c + s*channels] -=  means_ptr[c]/std::complex<float>(total_samples,0);
+                } else {
+                    if (calculate_pca_from_buffer(location, samples_per_profile, channels, m1->getObjectPtr()->center_sample) != GADGET_OK) {
+                        return GADGET_FAIL;
                     }
                 }
 
-                //Collected data for temp matrix, now let's calculate SVD coefficients
+                covariance_.erase(location);
+                channel_sum_.erase(location);
+                covariance_samples_.erase(location);
 
                 std::vector<size_t> VT_dims;
                 VT_dims.push_back(channels);
                 VT_dims.push_back(channels);
-                pca_coefficients_[location] = new hoNDArray< std::complex<float> >;
-                hoNDArray< std::complex<float> >* VT = pca_coefficients_[location];
-		
-                try {VT->create(&VT_dims);}
-                catch (std::runtime_error& err){
-                    GEXCEPTION(err,"Failed to create array for VT\n");
-                    return GADGET_FAIL;
-                }
 
-                arma::cx_fmat Am = as_arma_matrix(&A);
-                arma::cx_fmat Vm = as_arma_matrix(VT);
-                arma::cx_fmat Um;
-                arma::fvec Sv;
+                arma::cx_fmat Vm = as_arma_matrix(pca_coefficients_[location]);
 
-
-                if( !arma::svd_econ(Um,Sv,Vm,Am.st(),'r') ){
-                    GDEBUG("Failed to compute SVD\n");
-                    return GADGET_FAIL;
-                }
-		
 		//We will create a new matrix that explicitly preserves the uncombined channels
 		if (uncombined_channels_.size()) {
 		  hoNDArray< std::complex<float> >* VT_new = new hoNDArray< std::complex<float> >;
@@ -251,15 +193,10 @@ namespace Gadgetron {
                 buffering_mode_[location] = false;
 
                 //Now we should pump all the profiles that we have buffered back through the system
-                for (size_t p = 0; p < profiles_available; p++) {
-                    ACE_Message_Block* mb = buffer_[location][p];
-                    if (inherited::process(mb) != GADGET_OK) {
-                        GDEBUG("Failed to reprocess buffered data\n");
-                        return GADGET_FAIL;
-                    }
+                if (release_buffer(location) != GADGET_OK) {
+                    GDEBUG("Failed to reprocess buffered data\n");
+                    return GADGET_FAIL;
                 }
-                //Remove references in this buffer
-                buffer_[location].clear();
             }
         } else {
             //GDEBUG("Not buffering anymore\n");
@@ -296,5 +233,284 @@ namespace Gadgetron {
         return GADGET_OK;
     }
 
+    int PCACoilGadget::calculate_pca_from_buffer(int location, int samples_per_profile, int channels, size_t center_sample)
+    {
+        int profiles_available = buffer_[location].size();
+
+        //GDEBUG("Calculating PCA coefficients with %d profiles for %d coils\n", profiles_available, channels);
+        int samples_to_use = samples_per_profile > samples_to_use_ ? samples_to_use_ : samples_per_profile;
+
+        //For some sequences there is so little data, we should just use it all.
+        if (profiles_available < 16) {
+            samples_to_use = samples_per_profile;
+        }
+
+        int total_samples = samples_to_use*profiles_available;
+
+        std::vector<size_t> dims(2);
+        dims[0] = channels;dims[1] = total_samples;
+
+        hoNDArray< std::complex<float> > A;
+        try{ A.create(&dims); }
+        catch (std::runtime_error & err){
+            GDEBUG("Unable to create array for PCA calculation\n");
+            return GADGET_FAIL;
+        }
+
+        std::complex<float>* A_ptr = A.get_data_ptr();
+        size_t sample_counter = 0;
+
+        size_t data_offset = 0;
+        if (center_sample >= (samples_to_use>>1)) {
+            data_offset = center_sample - (samples_to_use>>1);
+        }
+
+        //GDEBUG("Data offset = %d\n", data_offset);
+
+        hoNDArray<std::complex<float> > means;
+        std::vector<size_t> means_dims; means_dims.push_back(channels);
+
+        try{means.create(&means_dims);}
+        catch (std::runtime_error& err){
+            GDEBUG("Unable to create temporary stoorage for mean values\n");
+            return GADGET_FAIL;
+        }
+
+        means.fill(std::complex<float>(0.0f,0.0f));
+
+        std::complex<float>* means_ptr = means.get_data_ptr();
+        for (size_t p = 0; p < profiles_available; p++) {
+            GadgetContainerMessage<hoNDArray<std::complex<float> > >* m_tmp =
+                AsContainerMessage<hoNDArray< std::complex<float> > >(buffer_[location][p]->cont());
+
+            if (!m_tmp) {
+                GDEBUG("Fatal error, unable to recover data from data buffer (%d,%d)\n", p, profiles_available);
+                return GADGET_FAIL;
+            }
+
+            std::complex<float>* d = m_tmp->getObjectPtr()->get_data_ptr();
+
+		      for (unsigned s = 0; s < samples_to_use; s++) {
+			for (size_t c = 0; c < channels; c++) {
+			  bool uncombined_channel = std::find(uncombined_channels_.begin(),uncombined_channels_.end(), c) != uncombined_channels_.end();
+			  //We use the conjugate of the data so that the output VT of the SVD is the actual PCA coefficient matrix
+			  if (uncombined_channel) {
+			    A_ptr[c + sample_counter*channels] = std::complex<float>(0.0,0.0);
+			  } else {
+			    A_ptr[c + sample_counter*channels] = d[c*samples_per_profile + data_offset + s];
+			    means_ptr[c] += d[c*samples_per_profile + data_offset + s];
+			  }
+			}
+			
+			sample_counter++;
+			//GDEBUG("Sample counter = %d/%d\n", sample_counter, total_samples);
+		      }
+        }
+
+        //Subtract off mean
+        for (size_t c = 0; c < channels; c++) {
+            for (size_t s = 0; s < total_samples; s++) {
+                A_ptr[c + s*channels] -=  means_ptr[c]/std::complex<float>(total_samples,0);
+            }
+        }
+
+        //Collected data for temp matrix, now let's calculate SVD coefficients
+
+        std::vector<size_t> VT_dims;
+        VT_dims.push_back(channels);
+        VT_dims.push_back(channels);
+        pca_coefficients_[location] = new hoNDArray< std::complex<float> >;
+        hoNDArray< std::complex<float> >* VT = pca_coefficients_[location];
+		
+        try {VT->create(&VT_dims);}
+        catch (std::runtime_error& err){
+            GEXCEPTION(err,"Failed to create array for VT\n");
+            return GADGET_FAIL;
+        }
+
+        arma::cx_fmat Am = as_arma_matrix(&A);
+        arma::cx_fmat Vm = as_arma_matrix(VT);
+        arma::cx_fmat Um;
+        arma::fvec Sv;
+
+
+        if( !arma::svd_econ(Um,Sv,Vm,Am.st(),'r') ){
+            GDEBUG("Failed to compute SVD\n");
+            return GADGET_FAIL;
+        }
+
+        return GADGET_OK;
+    }
+
+    void PCACoilGadget::accumulate_covariance(int location, ISMRMRD::AcquisitionHeader& acqhdr, hoNDArray< std::complex<float> >& data)
+    {
+        size_t samples_per_profile = data.get_size(0);
+        size_t channels = data.get_size(1);
+
+        hoNDArray< std::complex<float> >& C = covariance_[location];
+        hoNDArray< std::complex<float> >& m = channel_sum_[location];
+
+        if (C.get_number_of_elements() != channels*channels) {
+            C.create(channels, channels);
+            m.create(channels);
+            C.fill(std::complex<float>(0.0f,0.0f));
+            m.fill(std::complex<float>(0.0f,0.0f));
+            covariance_samples_[location] = 0;
+        }
+
+        //The same samples around the k-space center as for the buffered PCA
+        size_t samples_to_use = samples_per_profile > (size_t)samples_to_use_ ? (size_t)samples_to_use_ : samples_per_profile;
+
+        size_t data_offset = 0;
+        if (acqhdr.center_sample >= (samples_to_use>>1)) {
+            data_offset = acqhdr.center_sample - (samples_to_use>>1);
+        }
+        if (data_offset + samples_to_use > samples_per_profile) {
+            data_offset = samples_per_profile - samples_to_use;
+        }
+
+        //Uncombined channels do not contribute
+        hoNDArray< std::complex<float> > X(samples_to_use, channels);
+        for (size_t c = 0; c < channels; c++) {
+            bool uncombined_channel = std::find(uncombined_channels_.begin(),uncombined_channels_.end(), c) != uncombined_channels_.end();
+            for (size_t s = 0; s < samples_to_use; s++) {
+                X(s, c) = uncombined_channel ? std::complex<float>(0.0f,0.0f) : data(data_offset + s, c);
+                m(c) += X(s, c);
+            }
+        }
+
+        //C += X^H X
+        arma::cx_fmat Xm = as_arma_matrix(&X);
+        arma::cx_fmat Cm = as_arma_matrix(&C);
+        Cm += Xm.t()*Xm;
+
+        covariance_samples_[location] += samples_to_use;
+    }
+
+    int PCACoilGadget::calculate_pca_from_covariance(int location, int channels)
+    {
+        hoNDArray< std::complex<float> >& C = covariance_[location];
+        hoNDArray< std::complex<float> >& m = channel_sum_[location];
+        float N = (float)covariance_samples_[location];
+
+        if (C.get_size(0) != (size_t)channels) {
+            GDEBUG("Number of channels changed while accumulating the covariance (%d, %d)\n", C.get_size(0), channels);
+            return GADGET_FAIL;
+        }
+
+        //Subtract off mean, sum over samples of (x-mu)^H (x-mu) = C - m^H m / N
+        arma::cx_fmat Cm = as_arma_matrix(&C);
+        arma::cx_fvec mv(reinterpret_cast<std::complex<float>*>(m.get_data_ptr()), channels, false, true);
+        Cm -= arma::conj(mv)*mv.st()/N;
+
+        //The eigenvectors of the covariance are the right singular vectors of the data matrix
+        arma::fvec eigval;
+        arma::cx_fmat eigvec;
+        if ( !arma::eig_sym(eigval, eigvec, Cm) ) {
+            GDEBUG("Failed to compute eigen decomposition of the coil covariance\n");
+            return GADGET_FAIL;
+        }
+
+        std::vector<size_t> VT_dims;
+        VT_dims.push_back(channels);
+        VT_dims.push_back(channels);
+        pca_coefficients_[location] = new hoNDArray< std::complex<float> >;
+        hoNDArray< std::complex<float> >* VT = pca_coefficients_[location];
+
+        try {VT->create(&VT_dims);}
+        catch (std::runtime_error& err){
+            GEXCEPTION(err,"Failed to create array for VT\n");
+            return GADGET_FAIL;
+        }
+
+        //Largest principal component first
+        arma::cx_fmat Vm = as_arma_matrix(VT);
+        Vm = arma::fliplr(eigvec);
+
+        return GADGET_OK;
+    }
+
+    int PCACoilGadget::release_buffer(int location)
+    {
+        std::vector< ACE_Message_Block* >& buffer = buffer_[location];
+        hoNDArray< std::complex<float> >* VT = pca_coefficients_[location];
+
+        if (buffer.empty()) return GADGET_OK;
+
+        size_t channels = VT->get_size(0);
+
+        size_t N = 0;
+        for (size_t p = 0; p < buffer.size(); p++) {
+            GadgetContainerMessage<hoNDArray<std::complex<float> > >* m_tmp =
+                AsContainerMessage<hoNDArray< std::complex<float> > >(buffer[p]->cont());
+
+            if (!m_tmp || (m_tmp->getObjectPtr()->get_size(1) != channels)) {
+                GDEBUG("Fatal error, unable to recover data from data buffer (%d,%d)\n", p, buffer.size());
+                return GADGET_FAIL;
+            }
+            N += m_tmp->getObjectPtr()->get_size(0);
+        }
+
+        //The work arrays only grow, the block is a [N channels] view at their start
+        if (block_data_.get_number_of_elements() < N*channels) {
+            try {
+                block_data_.create(N*channels);
+                block_pca_.create(N*channels);
+            }
+            catch (std::runtime_error& err){
+                GEXCEPTION(err,"Unable to create storage for PCA coils\n");
+                return GADGET_FAIL;
+            }
+        }
+
+        hoNDArray< std::complex<float> > data(N, channels, block_data_.get_data_ptr());
+        hoNDArray< std::complex<float> > pca(N, channels, block_pca_.get_data_ptr());
+
+        size_t offset = 0;
+        for (size_t p = 0; p < buffer.size(); p++) {
+            hoNDArray< std::complex<float> >* d = AsContainerMessage<hoNDArray< std::complex<float> > >(buffer[p]->cont())->getObjectPtr();
+            size_t samples = d->get_size(0);
+            for (size_t c = 0; c < channels; c++) {
+                memcpy(data.get_data_ptr() + c*N + offset, d->get_data_ptr() + c*samples, sizeof(std::complex<float>)*samples);
+            }
+            offset += samples;
+        }
+
+        arma::cx_fmat am3 = as_arma_matrix(&pca);
+        arma::cx_fmat am2 = as_arma_matrix(&data);
+        arma::cx_fmat aPca = as_arma_matrix(VT);
+        am3 = am2*aPca;
+
+        int ret = GADGET_OK;
+
+        offset = 0;
+        for (size_t p = 0; p < buffer.size(); p++) {
+            GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1 = AsContainerMessage<ISMRMRD::AcquisitionHeader>(buffer[p]);
+            GadgetContainerMessage< hoNDArray< std::complex<float> > >* m2 = AsContainerMessage<hoNDArray< std::complex<float> > >(m1->cont());
+            size_t samples = m2->getObjectPtr()->get_size(0);
+
+            if (ret != GADGET_OK) {
+                m1->release();
+                continue;
+            }
+
+            //The data are replaced in place, the profiles keep their message blocks
+            for (size_t c = 0; c < channels; c++) {
+                memcpy(m2->getObjectPtr()->get_data_ptr() + c*samples, pca.get_data_ptr() + c*N + offset, sizeof(std::complex<float>)*samples);
+            }
+            offset += samples;
+
+            if (this->next()->putq(m1) < 0) {
+                GDEBUG("Unable to put message on Q");
+                m1->release();
+                ret = GADGET_FAIL;
+            }
+        }
+
+        //Remove references in this buffer
+        buffer.clear();
+        return ret;
+    }
+
     GADGET_FACTORY_DECLARE(PCACoilGadget)
 }
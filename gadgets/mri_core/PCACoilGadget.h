@@ -29,6 +29,21 @@ namespace Gadgetron {
   private:
     GADGET_PROPERTY(uncombined_channels_by_name, std::string, "List of comma separated channels by name", "");
     GADGET_PROPERTY(present_uncombined_channels, int, "Number of uncombined channels found", 0);
+    GADGET_PROPERTY_LIMITS(pca_mode, std::string, "How the PCA coefficients are estimated", "buffer",
+			   GadgetPropertyLimitsEnumeration,
+			   "buffer",       // SVD of the buffered profiles
+			   "streaming",    // covariance accumulated as the profiles arrive
+			   "calibration"); // covariance of the parallel calibration profiles
+    GADGET_PROPERTY(max_buffered_profiles, int, "Maximal number of profiles held back per location before the PCA is computed", 100);
+    GADGET_PROPERTY(samples_per_channel, int, "Samples per channel after which the streaming covariance is used", 8);
+    GADGET_PROPERTY(calibration_samples_per_channel, int, "Minimal number of calibration samples per channel, with fewer the buffered profiles are used", 8);
+
+    int calculate_pca_from_buffer(int location, int samples_per_profile, int channels, size_t center_sample);
+    int calculate_pca_from_covariance(int location, int channels);
+    void accumulate_covariance(int location, ISMRMRD::AcquisitionHeader& acqhdr, hoNDArray< std::complex<float> >& data);
+
+    //Apply the PCA coefficients to all buffered profiles of a location with one matrix multiplication
+    int release_buffer(int location);
 
     std::vector<unsigned int> uncombined_channels_;
     
@@ -41,8 +56,20 @@ namespace Gadgetron {
     //Map for storing PCA coefficients for each location
     std::map<int, hoNDArray<std::complex<float> >* > pca_coefficients_;
 
+    //Streaming estimate for each location, sum of x^H x, sum of x and number of samples
+    std::map<int, hoNDArray<std::complex<float> > > covariance_;
+    std::map<int, hoNDArray<std::complex<float> > > channel_sum_;
+    std::map<int, size_t> covariance_samples_;
+
+    //Work arrays for releasing the buffered profiles
+    hoNDArray< std::complex<float> > block_data_;
+    hoNDArray< std::complex<float> > block_pca_;
+
+    std::string pca_mode_;
     int max_buffered_profiles_;
     int samples_to_use_;
+    int samples_per_channel_;
+    int calibration_samples_per_channel_;
   };
 }
 
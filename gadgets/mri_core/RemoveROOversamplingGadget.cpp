@@ -1,5 +1,6 @@
 #include "RemoveROOversamplingGadget.h"
 #include "hoNDFFT.h"
+#include "mri_core_utility.h"
 #include "ismrmrd/xml.h"
 
 #ifdef USE_OMP
@@ -8,7 +9,7 @@
 
 namespace Gadgetron{
 
-    RemoveROOversamplingGadget::RemoveROOversamplingGadget()
+    RemoveROOversamplingGadget::RemoveROOversamplingGadget() : use_polyphase_(false), filter_RO_(0), filter_checked_(false)
     {
     }
 
@@ -54,9 +55,54 @@ namespace Gadgetron{
       dowork_ = true;
     }
 
+        use_polyphase_ = (method.value() == "polyphase");
+        filter_RO_ = 0;
+        filter_checked_ = false;
+        GDEBUG_STREAM("RemoveROOversamplingGadget, method is " << method.value());
+
         return GADGET_OK;
     }
 
+    bool RemoveROOversamplingGadget::check_decimation_filter(const hoNDArray< std::complex<float> >& readout)
+    {
+        size_t RO = readout.get_size(0);
+        size_t CHA = readout.get_number_of_elements()/RO;
+
+        hoNDArray< std::complex<float> > data(readout), ref(RO/2, CHA), res;
+
+        remove_ro_oversampling(data, decimation_filter_, 2, res);
+
+        // the fft path, as in process
+        hoNDFFT<float>::instance()->ifft(&data, 0);
+        size_t cha;
+        for ( cha=0; cha<CHA; cha++ )
+        {
+            memcpy(ref.begin() + cha*RO/2, data.begin() + cha*RO + RO/4, sizeof(std::complex<float>)*RO/2);
+        }
+        hoNDFFT<float>::instance()->fft(&ref, 0);
+
+        double diff = 0, norm = 0;
+        size_t n;
+        for ( n=0; n<ref.get_number_of_elements(); n++ )
+        {
+            diff += std::norm(ref(n) - res(n));
+            norm += std::norm(ref(n));
+        }
+
+        if ( norm <= 0 )
+        {
+            GDEBUG_STREAM("RemoveROOversamplingGadget, readout without signal, the polyphase filter is checked on the next one ... ");
+            return true;
+        }
+
+        double err = std::sqrt(diff/norm);
+        filter_checked_ = true;
+
+        GDEBUG_STREAM("RemoveROOversamplingGadget, polyphase filter for " << RO << " samples with " << decimation_filter_.get_number_of_elements() << " taps, relative difference to the fft path " << err);
+
+        return (err < 1e-3);
+    }
+
     int RemoveROOversamplingGadget
         ::process(GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1,
         GadgetContainerMessage< hoNDArray< std::complex<float> > >* m2)
@@ -100,24 +146,57 @@ namespace Gadgetron{
         size_t start = (size_t)( (m2->getObjectPtr()->get_size(0)-data_out_dims[0])/ratioFOV );
 
         size_t dRO = m3->getObjectPtr()->get_size(0);
-        size_t numOfBytes = data_out_dims[0]*sizeof(std::complex<float>);
-
-        int c;
-
-        int CHA = (int)(data_out_dims[1]);
 
-        std::complex<float>* data_in, *data_out;
+        // the decimation filter reproduces the central crop of the fft path for the oversampling factor 2
+        if ( use_polyphase_ && (sRO == 2*dRO) && (sRO%4 == 0) && (filter_RO_ != sRO) )
+        {
+            compute_ro_decimation_filter(sRO, 2, (size_t)polyphase_half_length.value(), decimation_filter_);
+            filter_RO_ = sRO;
+            filter_checked_ = false;
+        }
 
-        hoNDFFT<float>::instance()->ifft(m2->getObjectPtr(), 0);
-        data_in  = m2->getObjectPtr()->get_data_ptr();
-        data_out = m3->getObjectPtr()->get_data_ptr();
+        // the filter is checked against the fft path on the first readout with signal, readouts until then are processed with fft
+        bool filter_checked = filter_checked_;
+        if ( use_polyphase_ && (filter_RO_ == sRO) && (sRO == 2*dRO) && !filter_checked )
+        {
+            if ( !check_decimation_filter(*m2->getObjectPtr()) )
+            {
+                GWARN_STREAM("RemoveROOversamplingGadget, polyphase filter with " << decimation_filter_.get_number_of_elements() << " taps is not accurate enough for this data, e.g. signal at the fov edge, fft is used instead ... ");
+                use_polyphase_ = false;
+            }
+        }
 
-        for ( c=0; c<CHA; c++)
+        if ( use_polyphase_ && filter_checked && (filter_RO_ == sRO) && (sRO == 2*dRO) )
         {
-            memcpy( data_out+c*dRO, data_in+c*sRO+start, numOfBytes );
+            try { remove_ro_oversampling(*m2->getObjectPtr(), decimation_filter_, 2, *m3->getObjectPtr()); }
+            catch (...)
+            {
+                GERROR("RemoveROOversamplingGadget, polyphase oversampling removal failed\n");
+                m3->release();
+                return GADGET_FAIL;
+            }
         }
+        else
+        {
+            size_t numOfBytes = data_out_dims[0]*sizeof(std::complex<float>);
+
+            int c;
+
+            int CHA = (int)(data_out_dims[1]);
+
+            std::complex<float>* data_in, *data_out;
 
-        hoNDFFT<float>::instance()->fft(m3->getObjectPtr(), 0);
+            hoNDFFT<float>::instance()->ifft(m2->getObjectPtr(), 0);
+            data_in  = m2->getObjectPtr()->get_data_ptr();
+            data_out = m3->getObjectPtr()->get_data_ptr();
+
+            for ( c=0; c<CHA; c++)
+            {
+                memcpy( data_out+c*dRO, data_in+c*sRO+start, numOfBytes );
+            }
+
+            hoNDFFT<float>::instance()->fft(m3->getObjectPtr(), 0);
+        }
 
         m2->release(); //We are done with this data
 
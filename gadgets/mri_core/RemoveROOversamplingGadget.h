@@ -19,12 +19,22 @@ namespace Gadgetron{
         virtual ~RemoveROOversamplingGadget();
 
     protected:
+        GADGET_PROPERTY_LIMITS(method, std::string, "Oversampling removal method, fft: ifft, crop and fft, polyphase: decimation filter in kspace, used for the oversampling factor 2", "fft",
+                               GadgetPropertyLimitsEnumeration,
+                               "fft",
+                               "polyphase");
+        GADGET_PROPERTY(polyphase_half_length, int, "Half length of the polyphase decimation filter, the filter has 2*half_length+1 taps", 32);
 
         virtual int process_config(ACE_Message_Block* mb);
 
         virtual int process(GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1,
             GadgetContainerMessage< hoNDArray< std::complex<float> > >* m2);
 
+        // compare the decimation filter with the fft path on a measured readout, false if it is not accurate enough
+        // the filter is only exact away from the edges of the recon fov, so signal there fails the check
+        // a readout without signal cannot be checked, filter_checked_ stays false
+        bool check_decimation_filter(const hoNDArray< std::complex<float> >& readout);
+
         hoNDArray< std::complex<float> > fft_res_;
         hoNDArray< std::complex<float> > ifft_res_;
 
@@ -39,5 +49,11 @@ namespace Gadgetron{
 	// if true the gadget performs the operation
 	// otherwise, it just passes the data on
 	bool dowork_;
+
+        // decimation filter for the polyphase method, computed for the readout length filter_RO_
+        bool use_polyphase_;
+        size_t filter_RO_;
+        bool filter_checked_;
+        hoNDArray< std::complex<float> > decimation_filter_;
     };
 }
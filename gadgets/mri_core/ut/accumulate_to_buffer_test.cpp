@@ -0,0 +1,233 @@
+#include "AcquisitionAccumulateTriggerGadget.h"
+#include "BucketToBufferGadget.h"
+
+#include <gtest/gtest.h>
+#include <ace/Task.h>
+#include <ace/OS_NS_sys_time.h>
+#include <complex>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace Gadgetron;
+
+typedef std::complex<float> ComplexType;
+
+namespace {
+
+// 2D cartesian, 3 slices, 2 contrasts and 4 repetitions
+const char* header_xml =
+	"<?xml version=\"1.0\"?>"
+	"<ismrmrdHeader xmlns=\"http://www.ismrm.org/ISMRMRD\">"
+	"<experimentalConditions><H1resonanceFrequency_Hz>63500000</H1resonanceFrequency_Hz></experimentalConditions>"
+	"<encoding>"
+	"<encodedSpace><matrixSize><x>32</x><y>16</y><z>1</z></matrixSize>"
+	"<fieldOfView_mm><x>300</x><y>150</y><z>5</z></fieldOfView_mm></encodedSpace>"
+	"<reconSpace><matrixSize><x>32</x><y>16</y><z>1</z></matrixSize>"
+	"<fieldOfView_mm><x>300</x><y>150</y><z>5</z></fieldOfView_mm></reconSpace>"
+	"<encodingLimits>"
+	"<kspace_encoding_step_1><minimum>0</minimum><maximum>15</maximum><center>8</center></kspace_encoding_step_1>"
+	"<kspace_encoding_step_2><minimum>0</minimum><maximum>0</maximum><center>0</center></kspace_encoding_step_2>"
+	"<slice><minimum>0</minimum><maximum>2</maximum><center>0</center></slice>"
+	"<contrast><minimum>0</minimum><maximum>1</maximum><center>0</center></contrast>"
+	"<repetition><minimum>0</minimum><maximum>3</maximum><center>0</center></repetition>"
+	"</encodingLimits>"
+	"<trajectory>cartesian</trajectory>"
+	"</encoding>"
+	"</ismrmrdHeader>";
+
+const size_t RO = 32, E1 = 16, CHA = 4, SLC = 3, CON = 2, REP = 4;
+
+class TestAccumulateGadget : public AcquisitionAccumulateTriggerGadget
+{
+public:
+	using AcquisitionAccumulateTriggerGadget::process_config;
+	using AcquisitionAccumulateTriggerGadget::process;
+	using AcquisitionAccumulateTriggerGadget::trigger;
+};
+
+class TestBucketToBufferGadget : public BucketToBufferGadget
+{
+public:
+	using BucketToBufferGadget::process_config;
+	using BucketToBufferGadget::process;
+};
+
+// Collects the messages a gadget passes down the chain
+class Collector : public ACE_Task<ACE_MT_SYNCH>
+{
+public:
+	Collector()
+	{
+		this->msg_queue()->high_water_mark(1024*1024*1024);
+	}
+
+	~Collector()
+	{
+		this->msg_queue()->flush();
+	}
+
+	ACE_Message_Block* next_message()
+	{
+		ACE_Message_Block* mb = 0;
+		ACE_Time_Value nowait(ACE_OS::gettimeofday());
+		if (this->getq(mb, &nowait) == -1) return 0;
+		return mb;
+	}
+};
+
+ACE_Message_Block* create_config()
+{
+	ACE_Message_Block* mb = new ACE_Message_Block(std::strlen(header_xml) + 1);
+	mb->copy(header_xml);
+	return mb;
+}
+
+// Readouts in acquisition order, every other line of the first repetition is also a calibration line
+void feed(TestAccumulateGadget& gadget, size_t first_repetition)
+{
+	uint32_t scan = 0;
+	for (size_t rep = 0; rep < REP; rep++) {
+		for (size_t con = 0; con < CON; con++) {
+			for (size_t slc = 0; slc < SLC; slc++) {
+				for (size_t e1 = 0; e1 < E1; e1++) {
+					GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1 = new GadgetContainerMessage<ISMRMRD::AcquisitionHeader>();
+					ISMRMRD::AcquisitionHeader& h = *m1->getObjectPtr();
+					h.scan_counter = scan++;
+					h.number_of_samples = RO;
+					h.center_sample = RO/2;
+					h.active_channels = CHA;
+					h.available_channels = CHA;
+					h.idx.kspace_encode_step_1 = e1;
+					h.idx.slice = slc;
+					h.idx.contrast = con;
+					h.idx.repetition = first_repetition + rep;
+					if ((rep == 0) && (e1 % 2 == 0)) h.setFlag(ISMRMRD::ISMRMRD_ACQ_IS_PARALLEL_CALIBRATION_AND_IMAGING);
+
+					GadgetContainerMessage< hoNDArray<ComplexType> >* m2 = new GadgetContainerMessage< hoNDArray<ComplexType> >();
+					m2->getObjectPtr()->create(RO, CHA);
+					for (size_t i = 0; i < RO*CHA; i++) (*m2->getObjectPtr())(i) = ComplexType(float(h.scan_counter), float(i));
+					m1->cont(m2);
+
+					ASSERT_EQ(gadget.process(m1, m2), GADGET_OK);
+				}
+			}
+		}
+	}
+}
+
+void expect_same_buffer(IsmrmrdDataBuffered& a, IsmrmrdDataBuffered& b)
+{
+	ASSERT_EQ(*a.data_.get_dimensions(), *b.data_.get_dimensions());
+	ASSERT_EQ(*a.headers_.get_dimensions(), *b.headers_.get_dimensions());
+	EXPECT_EQ(a.trajectory_.get_number_of_elements(), b.trajectory_.get_number_of_elements());
+
+	for (size_t i = 0; i < a.data_.get_number_of_elements(); i++) {
+		ASSERT_EQ(a.data_(i), b.data_(i));
+	}
+
+	for (size_t i = 0; i < a.headers_.get_number_of_elements(); i++) {
+		EXPECT_EQ(a.headers_(i).scan_counter, b.headers_(i).scan_counter);
+		EXPECT_EQ(a.headers_(i).idx.kspace_encode_step_1, b.headers_(i).idx.kspace_encode_step_1);
+		EXPECT_EQ(a.headers_(i).idx.slice, b.headers_(i).idx.slice);
+		EXPECT_EQ(a.headers_(i).idx.contrast, b.headers_(i).idx.contrast);
+		EXPECT_EQ(a.headers_(i).idx.repetition, b.headers_(i).idx.repetition);
+	}
+
+	EXPECT_EQ(a.sampling_.sampling_limits_[0].center_, b.sampling_.sampling_limits_[0].center_);
+	EXPECT_EQ(a.sampling_.sampling_limits_[1].max_, b.sampling_.sampling_limits_[1].max_);
+	EXPECT_EQ(a.sampling_.encoded_matrix_[1], b.sampling_.encoded_matrix_[1]);
+}
+
+// Runs the same readouts through accumulate_to_buffer and through the AcquisitionAccumulateTrigger/BucketToBuffer pair
+void compare(const std::string& trigger, const std::string& sorting, const std::string& N, const std::string& S, size_t expected_buffers, size_t first_repetition = 0)
+{
+	Collector buffers, buckets, bucket_buffers;
+
+	TestAccumulateGadget direct;
+	direct.set_parameter("trigger_dimension", trigger.c_str());
+	direct.set_parameter("sorting_dimension", sorting.c_str());
+	direct.set_parameter("accumulate_to_buffer", "true");
+	direct.set_parameter("N_dimension", N.c_str());
+	direct.set_parameter("S_dimension", S.c_str());
+	direct.next(&buffers);
+
+	TestAccumulateGadget accumulate;
+	accumulate.set_parameter("trigger_dimension", trigger.c_str());
+	accumulate.set_parameter("sorting_dimension", sorting.c_str());
+	accumulate.next(&buckets);
+
+	TestBucketToBufferGadget bucket_to_buffer;
+	bucket_to_buffer.set_parameter("N_dimension", N.c_str());
+	bucket_to_buffer.set_parameter("S_dimension", S.c_str());
+	// a slice sorted buffer only holds its own slice
+	if (sorting == "slice") bucket_to_buffer.set_parameter("split_slices", "true");
+	bucket_to_buffer.next(&bucket_buffers);
+
+	ACE_Message_Block* config = create_config();
+	ASSERT_EQ(direct.process_config(config), GADGET_OK);
+	ASSERT_EQ(accumulate.process_config(config), GADGET_OK);
+	ASSERT_EQ(bucket_to_buffer.process_config(config), GADGET_OK);
+	config->release();
+
+	feed(direct, first_repetition);
+	feed(accumulate, first_repetition);
+	ASSERT_EQ(direct.trigger(), GADGET_OK);
+	ASSERT_EQ(accumulate.trigger(), GADGET_OK);
+
+	for (ACE_Message_Block* mb = buckets.next_message(); mb; mb = buckets.next_message()) {
+		GadgetContainerMessage<IsmrmrdAcquisitionBucket>* bucket = AsContainerMessage<IsmrmrdAcquisitionBucket>(mb);
+		ASSERT_TRUE(bucket != 0);
+		ASSERT_EQ(bucket_to_buffer.process(bucket), GADGET_OK);
+	}
+
+	size_t num_buffers = 0;
+	for (ACE_Message_Block* mb = buffers.next_message(); mb; mb = buffers.next_message()) {
+		ACE_Message_Block* expected_mb = bucket_buffers.next_message();
+		ASSERT_TRUE(expected_mb != 0);
+
+		GadgetContainerMessage<IsmrmrdReconData>* recon_data = AsContainerMessage<IsmrmrdReconData>(mb);
+		GadgetContainerMessage<IsmrmrdReconData>* expected = AsContainerMessage<IsmrmrdReconData>(expected_mb);
+		ASSERT_TRUE(recon_data != 0);
+		ASSERT_TRUE(expected != 0);
+
+		ASSERT_EQ(recon_data->getObjectPtr()->rbit_.size(), expected->getObjectPtr()->rbit_.size());
+		for (size_t e = 0; e < expected->getObjectPtr()->rbit_.size(); e++) {
+			expect_same_buffer(recon_data->getObjectPtr()->rbit_[e].data_, expected->getObjectPtr()->rbit_[e].data_);
+			expect_same_buffer(recon_data->getObjectPtr()->rbit_[e].ref_, expected->getObjectPtr()->rbit_[e].ref_);
+		}
+
+		mb->release();
+		expected_mb->release();
+		num_buffers++;
+	}
+
+	EXPECT_EQ(bucket_buffers.next_message(), (ACE_Message_Block*)0);
+	EXPECT_EQ(num_buffers, expected_buffers);
+}
+
+}
+
+TEST(accumulate_to_buffer_test,endOfScanTest){
+	// one buffer per repetition with all slices and contrasts
+	compare("", "", "contrast", "", REP);
+}
+
+TEST(accumulate_to_buffer_test,sortedTest){
+	// one buffer per slice and repetition, holding one location
+	compare("repetition", "slice", "contrast", "", SLC*REP);
+}
+
+TEST(accumulate_to_buffer_test,triggerOnNDimensionTest){
+	// every trigger only holds one repetition of the N dimension, the buffers must not be sized from the encoding limits
+	compare("repetition", "", "repetition", "contrast", REP);
+}
+
+TEST(accumulate_to_buffer_test,sliceDimensionTest){
+	compare("contrast", "", "slice", "", REP*CON);
+}
+
+TEST(accumulate_to_buffer_test,beyondLimitsTest){
+	// the last repetition is beyond the encoding limits of the header, the buffers grow
+	compare("", "", "repetition", "", CON, 1);
+}
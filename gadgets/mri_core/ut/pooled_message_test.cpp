@@ -0,0 +1,109 @@
+#include "GadgetMessageBlockPool.h"
+#include "hoNDArray.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <vector>
+
+using namespace Gadgetron;
+
+typedef std::complex<float> ComplexType;
+
+namespace {
+
+// Same layout the acquisition reader uses: the samples live in the pooled buffer behind the array
+GadgetContainerMessage< hoNDArray<ComplexType> >* create_pooled_array(size_t RO, size_t CHA)
+{
+	std::vector<size_t> dims(2);
+	dims[0] = RO; dims[1] = CHA;
+
+	GadgetContainerMessage< hoNDArray<ComplexType> >* m =
+		GadgetMessageBlockPool::instance()->create_message< hoNDArray<ComplexType> >(sizeof(ComplexType)*RO*CHA);
+
+	m->getObjectPtr()->create(&dims, reinterpret_cast<ComplexType*>(GadgetMessageBlockPool::payload(m)), false);
+	for (size_t i = 0; i < RO*CHA; i++) (*m->getObjectPtr())(i) = ComplexType(float(i), -float(i));
+
+	return m;
+}
+
+ComplexType* payload_of(GadgetContainerMessage< hoNDArray<ComplexType> >* m)
+{
+	return reinterpret_cast<ComplexType*>(GadgetMessageBlockPool::payload(m));
+}
+
+}
+
+TEST(pooled_message_test,alignmentTest){
+	// the payload of every size class, and of buffers larger than the biggest class, is aligned for AVX
+	size_t sizes[] = { 1, 8, 256, 32*1024 + 8, size_t(80)*1024*1024 };
+	for (size_t k = 0; k < sizeof(sizes)/sizeof(sizes[0]); k++){
+		size_t RO = (sizes[k] + sizeof(ComplexType) - 1)/sizeof(ComplexType);
+		GadgetContainerMessage< hoNDArray<ComplexType> >* m = create_pooled_array(RO, 1);
+		EXPECT_EQ(0u, reinterpret_cast<size_t>(payload_of(m)) % 64);
+		m->release();
+	}
+}
+
+TEST(pooled_message_test,reassignTest){
+	GadgetContainerMessage< hoNDArray<ComplexType> >* m = create_pooled_array(256, 8);
+	hoNDArray<ComplexType>& a = *m->getObjectPtr();
+
+	EXPECT_FALSE(a.delete_data_on_destruct());
+	EXPECT_EQ(a.get_data_ptr(), payload_of(m));
+
+	// EPIReconXGadget replaces the readout with one of a different length
+	hoNDArray<ComplexType> data_out(128, 8);
+	for (size_t i = 0; i < data_out.get_number_of_elements(); i++) data_out(i) = ComplexType(1.0f, float(i));
+
+	ASSERT_NO_THROW(a = data_out);
+
+	EXPECT_TRUE(a.delete_data_on_destruct());
+	EXPECT_NE(a.get_data_ptr(), payload_of(m));
+	EXPECT_NE(a.get_data_ptr(), data_out.get_data_ptr());
+	EXPECT_EQ(a.get_size(0), 128);
+	EXPECT_EQ(a.get_size(1), 8);
+	for (size_t i = 0; i < a.get_number_of_elements(); i++) EXPECT_EQ(a(i), data_out(i));
+
+	m->release();
+}
+
+TEST(pooled_message_test,reassignSameSizeTest){
+	GadgetContainerMessage< hoNDArray<ComplexType> >* m = create_pooled_array(256, 8);
+	hoNDArray<ComplexType>& a = *m->getObjectPtr();
+
+	// Same dimensions are copied into the pooled buffer, which stays borrowed
+	hoNDArray<ComplexType> data_out(256, 8);
+	data_out.fill(ComplexType(2.0f, 3.0f));
+
+	ASSERT_NO_THROW(a = data_out);
+
+	EXPECT_FALSE(a.delete_data_on_destruct());
+	EXPECT_EQ(a.get_data_ptr(), payload_of(m));
+	EXPECT_EQ(a(100), ComplexType(2.0f, 3.0f));
+
+	m->release();
+}
+
+TEST(pooled_message_test,recreateTest){
+	GadgetContainerMessage< hoNDArray<ComplexType> >* m = create_pooled_array(256, 8);
+	hoNDArray<ComplexType>& a = *m->getObjectPtr();
+
+	std::vector<size_t> dims(2);
+	dims[0] = 512; dims[1] = 4;
+
+	ASSERT_NO_THROW(a.create(&dims));
+
+	EXPECT_TRUE(a.delete_data_on_destruct());
+	EXPECT_NE(a.get_data_ptr(), payload_of(m));
+	EXPECT_EQ(a.get_number_of_elements(), 512*4);
+
+	// Moving a fresh array in keeps its ownership
+	hoNDArray<ComplexType> b(64, 2);
+	ComplexType* pb = b.get_data_ptr();
+	a = std::move(b);
+
+	EXPECT_TRUE(a.delete_data_on_destruct());
+	EXPECT_EQ(a.get_data_ptr(), pb);
+
+	m->release();
+}
@@ -147,12 +147,16 @@ namespace Gadgetron{
 	// This is kind of a nasty busy wait, maybe we should add an event
 	// handler to the NotificationStrategy of the Q or something, but
 	// for now, this will do it.
-	while (this->next()->msg_queue()->is_full()) {
-	  // GDEBUG("Gadget (%s) sleeping while downstream Gadget (%s) does some work\n",
-	  //        this->module()->name(), this->next()->module()->name());
-	  // Sleep for 10ms while the downstream Gadget does some work
-	  ACE_Time_Value tv(0,10000);
-	  ACE_OS::sleep(tv);
+	if (this->next()->msg_queue()->is_full()) {
+	  // On a pool thread, a spare thread runs the downstream Gadget meanwhile
+	  GadgetPoolBlockingScope blocking;
+	  while (this->next()->msg_queue()->is_full()) {
+	    // GDEBUG("Gadget (%s) sleeping while downstream Gadget (%s) does some work\n",
+	    //        this->module()->name(), this->next()->module()->name());
+	    // Sleep for 10ms while the downstream Gadget does some work
+	    ACE_Time_Value tv(0,10000);
+	    ACE_OS::sleep(tv);
+	  }
 	}
 	
 	H head = *hmb->getObjectPtr();
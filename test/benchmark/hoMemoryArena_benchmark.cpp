@@ -0,0 +1,114 @@
+/** \file   hoMemoryArena_benchmark.cpp
+    \brief  Allocation time and resident memory of per-iteration hoNDArray temporaries
+
+            Every iteration creates and fills the temporaries of one SPIRiT solve, once from the heap, once
+            from an arena that returns its blocks at the end of every scope and once from the thread arena,
+            which keeps its blocks across scopes. Run with [iterations] [threads].
+*/
+
+#include "hoNDArray.h"
+#include "hoMemoryArena.h"
+
+#include <chrono>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+    #include <sys/resource.h>
+    #include <unistd.h>
+#endif
+
+using namespace Gadgetron;
+
+typedef std::complex<float> ComplexType;
+
+namespace {
+
+struct Usage
+{
+	double ms;
+	long minor_faults;
+	size_t resident_mb;
+};
+
+Usage usage()
+{
+	Usage u;
+	u.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	u.minor_faults = 0;
+	u.resident_mb = 0;
+
+#ifndef _WIN32
+	rusage r;
+	if (getrusage(RUSAGE_SELF, &r) == 0) u.minor_faults = r.ru_minflt;
+
+	FILE* f = fopen("/proc/self/statm", "r");
+	if (f){
+		unsigned long size = 0, resident = 0;
+		if (fscanf(f, "%lu %lu", &size, &resident) == 2) u.resident_mb = resident*sysconf(_SC_PAGESIZE)/(1024*1024);
+		fclose(f);
+	}
+#endif
+
+	return u;
+}
+
+enum Mode { HEAP, ARENA_RELEASE, ARENA_RETAIN };
+
+void iterations(Mode mode, int n)
+{
+	// temporaries of one RO line of the 3D+T SPIRiT solve: [E1 E2 CHA] kspace, kernel and residuals
+	std::vector<size_t> dims(3);
+	dims[0] = 192; dims[1] = 144; dims[2] = 32;
+
+	hoMemoryArena release(hoMemoryArena::DEFAULT_BLOCK_SIZE, 0);
+	hoMemoryArena& arena = (mode == ARENA_RELEASE) ? release : *hoMemoryArena::thread_arena();
+
+	for (int it = 0; it < n; it++){
+		if (mode == HEAP){
+			hoNDArray<ComplexType> a(dims), b(dims), c(dims);
+			a.fill(ComplexType(it, 0)); b.fill(ComplexType(0, it)); c.fill(ComplexType(it, it));
+		}
+		else{
+			hoMemoryArenaScope scope(arena);
+			hoNDArray<ComplexType> a(dims), b(dims), c(dims);
+			a.fill(ComplexType(it, 0)); b.fill(ComplexType(0, it)); c.fill(ComplexType(it, it));
+		}
+	}
+}
+
+void run(const char* name, Mode mode, int n, int threads)
+{
+	Usage u0 = usage();
+
+	std::vector<std::thread> t;
+	for (int k = 0; k < threads; k++) t.push_back(std::thread(iterations, mode, n));
+	for (int k = 0; k < threads; k++) t[k].join();
+
+	Usage u1 = usage();
+
+	std::cout << "  " << name << ": " << (u1.ms-u0.ms)/n << " ms/iteration, "
+		<< (u1.minor_faults-u0.minor_faults)/(n*threads) << " page faults/iteration, "
+		<< "resident " << u1.resident_mb << " MB" << std::endl;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	int n = (argc > 1) ? atoi(argv[1]) : 200;
+	int threads = (argc > 2) ? atoi(argv[2]) : (int)std::thread::hardware_concurrency();
+	if (threads < 1) threads = 1;
+
+	std::cout << "3 temporaries of 192x144x32 complex per iteration, " << n << " iterations on " << threads << " threads" << std::endl;
+
+	run("heap", HEAP, n, threads);
+	run("arena, blocks released per scope", ARENA_RELEASE, n, threads);
+	run("thread arena, blocks retained", ARENA_RETAIN, n, threads);
+
+	return 0;
+}
@@ -0,0 +1,129 @@
+/** \file   hoNDArray_simd_benchmark.cpp
+    \brief  Time of the complex element-wise kernels for every supported instruction set, and of MKL if available
+
+            The arrays are one 2D slice of a 32 channel acquisition. Run with [iterations].
+*/
+
+#include "hoNDArray_simd.h"
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_reductions.h"
+
+#include <chrono>
+#include <complex>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef USE_MKL
+    #include "mkl.h"
+#endif // USE_MKL
+
+using namespace Gadgetron;
+
+namespace {
+
+#ifdef USE_MKL
+
+inline void mkl_multiply(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r){ vcMul((MKL_INT)N, reinterpret_cast<const MKL_Complex8*>(x), reinterpret_cast<const MKL_Complex8*>(y), reinterpret_cast<MKL_Complex8*>(r)); }
+inline void mkl_multiply(size_t N, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r){ vzMul((MKL_INT)N, reinterpret_cast<const MKL_Complex16*>(x), reinterpret_cast<const MKL_Complex16*>(y), reinterpret_cast<MKL_Complex16*>(r)); }
+inline void mkl_multiplyConj(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r){ vcMulByConj((MKL_INT)N, reinterpret_cast<const MKL_Complex8*>(x), reinterpret_cast<const MKL_Complex8*>(y), reinterpret_cast<MKL_Complex8*>(r)); }
+inline void mkl_multiplyConj(size_t N, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r){ vzMulByConj((MKL_INT)N, reinterpret_cast<const MKL_Complex16*>(x), reinterpret_cast<const MKL_Complex16*>(y), reinterpret_cast<MKL_Complex16*>(r)); }
+inline void mkl_abs(size_t N, const std::complex<float>* x, float* r){ vcAbs((MKL_INT)N, reinterpret_cast<const MKL_Complex8*>(x), r); }
+inline void mkl_abs(size_t N, const std::complex<double>* x, double* r){ vzAbs((MKL_INT)N, reinterpret_cast<const MKL_Complex16*>(x), r); }
+inline float mkl_norm2(size_t N, const std::complex<float>* x){ return cblas_scnrm2((MKL_INT)N, x, 1); }
+inline double mkl_norm2(size_t N, const std::complex<double>* x){ return cblas_dznrm2((MKL_INT)N, x, 1); }
+
+// cblas dotc conjugates the first argument
+inline void mkl_dotc(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r){ cblas_cdotc_sub((MKL_INT)N, y, 1, x, 1, r); }
+inline void mkl_dotc(size_t N, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r){ cblas_zdotc_sub((MKL_INT)N, y, 1, x, 1, r); }
+
+#endif // USE_MKL
+
+const size_t OPS = 6;
+const char* ops[OPS] = { "multiply", "multiplyConj", "addEpsilon", "abs", "norm2", "dotc" };
+
+// ms per op, a negative time for an op that is not timed
+typedef std::vector<double> Times;
+
+template <typename Op> double time_ms(Op op, int n)
+{
+	std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+	for (int it = 0; it < n; it++) op();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count();
+}
+
+template <typename REAL> void run(const char* name, int n)
+{
+	typedef std::complex<REAL> T;
+
+	std::vector<size_t> dims(3);
+	dims[0] = 192; dims[1] = 144; dims[2] = 32;
+
+	hoNDArray<T> x(dims), y(dims), r(dims);
+	hoNDArray<REAL> a(dims);
+	for (size_t i = 0; i < x.get_number_of_elements(); i++){
+		x(i) = T(REAL(i%97), REAL(i%89));
+		y(i) = T(REAL(i%83), REAL(i%79));
+	}
+
+	const size_t N = x.get_number_of_elements();
+
+	std::vector<std::string> names;
+	std::vector<Times> times;
+
+	simd::InstructionSet detected = simd::instruction_set();
+	for (int isa = simd::SCALAR; isa <= simd::supported_instruction_set(); isa++){
+		simd::set_instruction_set(static_cast<simd::InstructionSet>(isa));
+		names.push_back(simd::instruction_set_name(simd::instruction_set()));
+
+		Times t(OPS);
+		t[0] = time_ms([&]{ multiply(x, y, r); }, n);
+		t[1] = time_ms([&]{ multiplyConj(x, y, r); }, n);
+		t[2] = time_ms([&]{ addEpsilon(r); }, n);
+		t[3] = time_ms([&]{ Gadgetron::abs(x, a); }, n);
+		t[4] = time_ms([&]{ norm2(x); }, n);
+		t[5] = time_ms([&]{ dotc(x, y); }, n);
+		times.push_back(t);
+	}
+	simd::set_instruction_set(detected);
+
+#ifdef USE_MKL
+	{
+		names.push_back("mkl");
+
+		T c;
+		Times t(OPS);
+		t[0] = time_ms([&]{ mkl_multiply(N, x.begin(), y.begin(), r.begin()); }, n);
+		t[1] = time_ms([&]{ mkl_multiplyConj(N, x.begin(), y.begin(), r.begin()); }, n);
+		t[2] = -1;
+		t[3] = time_ms([&]{ mkl_abs(N, x.begin(), a.begin()); }, n);
+		t[4] = time_ms([&]{ mkl_norm2(N, x.begin()); }, n);
+		t[5] = time_ms([&]{ mkl_dotc(N, x.begin(), y.begin(), &c); }, n);
+		times.push_back(t);
+	}
+#endif // USE_MKL
+
+	std::cout << name << ", " << N << " elements x " << n << " iterations, ms" << std::endl;
+	for (size_t op = 0; op < OPS; op++){
+		std::cout << "  " << ops[op] << ":";
+		for (size_t k = 0; k < names.size(); k++){
+			if (times[k][op] < 0) continue;
+			std::cout << " " << names[k] << " " << times[k][op];
+		}
+		std::cout << std::endl;
+	}
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	int n = (argc > 1) ? atoi(argv[1]) : 20;
+	if (n < 1) n = 1;
+
+	run<float>("complex float", n);
+	run<double>("complex double", n);
+
+	return 0;
+}
@@ -0,0 +1,93 @@
+/** \file   hoNDFFT_benchmark.cpp
+    \brief  Time of the centered 2D and 3D transforms, explicit shifts around fft2/fft3 against the fused fft2c/fft3c
+
+            32 channel data, 256x190 in 2D and 64x64x46 in 3D. Run with [repetitions].
+*/
+
+#include "hoNDFFT.h"
+
+#include <boost/random.hpp>
+#include <chrono>
+#include <complex>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace Gadgetron;
+
+namespace {
+
+double ms_since(std::chrono::steady_clock::time_point t)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count();
+}
+
+template <typename REAL> void run(const char* name, int n)
+{
+	typedef std::complex<REAL> C;
+	hoNDFFT<REAL>* fft = hoNDFFT<REAL>::instance();
+
+	std::vector<size_t> dims2D;
+	dims2D.push_back(256); dims2D.push_back(190); dims2D.push_back(32);
+	std::vector<size_t> dims3D;
+	dims3D.push_back(64); dims3D.push_back(64); dims3D.push_back(46); dims3D.push_back(32);
+
+	for (int rank = 2; rank <= 3; rank++){
+		hoNDArray<C> a(rank == 2 ? dims2D : dims3D);
+		boost::random::mt19937 rng;
+		boost::random::uniform_real_distribution<REAL> uni(0,1);
+		for (size_t i = 0; i < a.get_number_of_elements(); i++)
+			a[i] = C(uni(rng),uni(rng));
+
+		// the first transform of a size creates its plans, leave it out of the timing
+		hoNDArray<C> ref(a), res(a);
+		if (rank == 2){
+			fft->fft2(ref);
+			fft->fft2c(res);
+		} else {
+			fft->fft3(ref);
+			fft->fft3c(res);
+		}
+
+		double shift = 0, fused = 0;
+		for (int it = 0; it < n; it++){
+			ref = a;
+			res = a;
+
+			std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+			if (rank == 2){
+				fft->ifftshift2D(ref);
+				fft->fft2(ref);
+				fft->fftshift2D(ref);
+			} else {
+				fft->ifftshift3D(ref);
+				fft->fft3(ref);
+				fft->fftshift3D(ref);
+			}
+			shift += ms_since(t);
+
+			t = std::chrono::steady_clock::now();
+			if (rank == 2)
+				fft->fft2c(res);
+			else
+				fft->fft3c(res);
+			fused += ms_since(t);
+		}
+
+		std::cout << "  " << name << " fft" << rank << "c: shift path " << shift/n << " ms, fused " << fused/n << " ms" << std::endl;
+	}
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	int n = (argc > 1) ? atoi(argv[1]) : 10;
+	if (n < 1) n = 1;
+
+	std::cout << "centered transforms, mean of " << n << " repetitions" << std::endl;
+	run<float>("float", n);
+	run<double>("double", n);
+
+	return 0;
+}
@@ -0,0 +1,94 @@
+/** \file   mri_core_grappa_benchmark.cpp
+    \brief  Time of the 2D and 3D GRAPPA kernel calibration on synthetic acs data
+
+            2D: 32 channels, 48 acs lines, R=4; 3D: 16 channels, 24x24 acs lines, R=2x2.
+            Run with [repetitions].
+*/
+
+#include "mri_core_grappa.h"
+#include "hoNDArray.h"
+
+#include <boost/random.hpp>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace Gadgetron;
+
+#if defined(USE_MKL) || defined(USE_LAPACK)
+
+namespace {
+
+// acs data with a smooth coil modulation on top of noise, [RO E1 E2 CHA]
+template <typename T> void fill(hoNDArray< std::complex<T> >& acs)
+{
+	boost::random::mt19937 rng;
+	boost::random::normal_distribution<T> noise;
+
+	size_t RO = acs.get_size(0), E1 = acs.get_size(1), E2 = acs.get_size(2);
+	for (size_t i = 0; i < acs.get_number_of_elements(); i++){
+		size_t ro = i%RO, e1 = (i/RO)%E1, e2 = (i/(RO*E1))%E2, cha = i/(RO*E1*E2);
+		T s = T(std::cos(0.05*(cha+1)*ro) + std::sin(0.1*(cha+1)*e1) + std::cos(0.2*(cha+1)*e2));
+		acs(i) = std::complex<T>(4*s + noise(rng), 2*s + noise(rng));
+	}
+}
+
+double ms_since(std::chrono::steady_clock::time_point t)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count();
+}
+
+template <typename T> void run(const char* name, int n)
+{
+	typedef std::complex<T> ComplexType;
+
+	hoNDArray<ComplexType> acs2D(256, 48, 32), acs3D(128, 24, 24, 16);
+	fill(acs2D);
+	fill(acs3D);
+
+	std::vector<int> kE1, oE1, kE2, oE2, kE1_3D, oE1_3D;
+	size_t convKRO, convKE1, convKE2;
+	grappa2d_kerPattern(kE1, oE1, convKRO, convKE1, 4, 5, 4, true);
+	grappa3d_kerPattern(kE1_3D, oE1_3D, kE2, oE2, convKRO, convKE1, convKE2, 2, 2, 5, 4, 4, true);
+
+	hoNDArray<ComplexType> ker;
+	double ms2D = 0, ms3D = 0;
+	for (int it = 0; it < n; it++){
+		std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+		grappa2d_calib(acs2D, acs2D, 0.0005, 5, kE1, oE1, 0, acs2D.get_size(0)-1, 0, acs2D.get_size(1)-1, ker);
+		ms2D += ms_since(t);
+
+		t = std::chrono::steady_clock::now();
+		grappa3d_calib(acs3D, acs3D, 0.0005, 0, 5, kE1_3D, oE1_3D, kE2, oE2, ker);
+		ms3D += ms_since(t);
+	}
+
+	std::cout << "  " << name << ": 2D " << ms2D/n << " ms, 3D " << ms3D/n << " ms" << std::endl;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	int n = (argc > 1) ? atoi(argv[1]) : 5;
+	if (n < 1) n = 1;
+
+	std::cout << "grappa calibration, mean of " << n << " repetitions" << std::endl;
+	run<float>("float", n);
+	run<double>("double", n);
+
+	return 0;
+}
+
+#else
+
+int main(int argc, char** argv)
+{
+	std::cout << "grappa calibration needs MKL or LAPACK" << std::endl;
+	return 0;
+}
+
+#endif // defined(USE_MKL) || defined(USE_LAPACK)
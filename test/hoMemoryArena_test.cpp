@@ -0,0 +1,238 @@
+#include "hoNDArray.h"
+#include "hoMemoryArena.h"
+#include "hoAlignedAllocator.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <thread>
+#include <vector>
+
+using namespace Gadgetron;
+
+typedef std::complex<float> ComplexType;
+
+TEST(hoMemoryArena_test,scopeRewindTest){
+	hoMemoryArena arena(1024*1024);
+
+	for (int it = 0; it < 100; it++){
+		hoMemoryArenaScope scope(arena);
+		hoNDArray<ComplexType> a(64,64,4);
+		hoNDArray<ComplexType> b(a);
+		hoNDArray<float> c(1000);
+
+		EXPECT_EQ(reinterpret_cast<size_t>(a.begin())%hoMemoryArena::ALIGNMENT, 0);
+		EXPECT_EQ(reinterpret_cast<size_t>(c.begin())%hoMemoryArena::ALIGNMENT, 0);
+	}
+
+	hoMemoryArena::Statistics s = arena.get_statistics();
+	EXPECT_EQ(s.allocations, 300);
+	EXPECT_EQ(s.live_allocations, 0);
+	EXPECT_EQ(s.bytes_in_use, 0);
+	EXPECT_LT(s.peak_bytes_in_use, 2*64*64*4*sizeof(ComplexType)+1000*sizeof(float)+3*1024);
+
+	// the block is kept for the next scope instead of going back to the system every iteration
+	EXPECT_EQ(s.blocks, 1);
+	EXPECT_EQ(s.block_allocations, 1);
+	EXPECT_GT(s.capacity, 0);
+
+	EXPECT_TRUE(arena.reset());
+	EXPECT_EQ(arena.get_statistics().capacity, 0);
+}
+
+TEST(hoMemoryArena_test,scopeReleaseTest){
+	hoMemoryArena arena(1024);
+
+	{
+		hoMemoryArenaScope outer(arena);
+		hoNDArray<ComplexType> a(1024);
+
+		{
+			hoMemoryArenaScope inner(arena);
+			hoNDArray<ComplexType> b(2048);
+		}
+
+		// an inner scope only rewinds, the outer one still holds the memory
+		EXPECT_GT(arena.get_statistics().capacity, 0);
+	}
+
+	// the blocks the scope had to grow into are merged into one
+	hoMemoryArena::Statistics s = arena.get_statistics();
+	EXPECT_EQ(s.blocks, 1);
+	EXPECT_GE(s.capacity, (1024+2048)*sizeof(ComplexType));
+
+	// which serves the next scope without going back to the system
+	{
+		hoMemoryArenaScope scope(arena);
+		hoNDArray<ComplexType> a(1024);
+		hoNDArray<ComplexType> b(2048);
+		EXPECT_EQ(arena.get_statistics().blocks, 1);
+	}
+	EXPECT_EQ(arena.get_statistics().block_allocations, s.block_allocations);
+}
+
+TEST(hoMemoryArena_test,retainLimitTest){
+	hoMemoryArena arena(1024*1024, 1024*1024);
+
+	{
+		hoMemoryArenaScope scope(arena);
+		hoNDArray<ComplexType> a(512, 512);
+	}
+
+	// above the retained limit the blocks go back to the system
+	EXPECT_EQ(arena.get_statistics().capacity, 0);
+
+	{
+		hoMemoryArenaScope scope(arena);
+		hoNDArray<ComplexType> a(1024);
+	}
+	EXPECT_GT(arena.get_statistics().capacity, 0);
+
+	arena.set_max_retained_bytes(0);
+	{
+		hoMemoryArenaScope scope(arena);
+		hoNDArray<ComplexType> a(1024);
+	}
+	EXPECT_EQ(arena.get_statistics().capacity, 0);
+}
+
+TEST(hoMemoryArena_test,threadArenaTest){
+	std::vector<size_t> dims(4);
+	dims[0] = 192; dims[1] = 144; dims[2] = 8; dims[3] = 4;
+
+	size_t block_allocations = 0;
+	for (int it = 0; it < 10; it++){
+		{
+			hoMemoryArenaScope scope;
+			hoNDArray<ComplexType> a(dims), b(dims), c(dims);
+			EXPECT_EQ(hoMemoryAllocator::find_owner(a.begin()), hoMemoryArena::thread_arena());
+			EXPECT_EQ(hoMemoryAllocator::find_owner(c.begin()+c.get_number_of_elements()-1), hoMemoryArena::thread_arena());
+		}
+
+		// only the first iteration gets memory from the system
+		if (it == 0) block_allocations = hoMemoryArena::thread_arena()->get_statistics().block_allocations;
+	}
+
+	hoMemoryArena::Statistics s = hoMemoryArena::thread_arena()->get_statistics();
+	EXPECT_EQ(s.live_allocations, 0);
+	EXPECT_EQ(s.block_allocations, block_allocations);
+	EXPECT_GT(s.capacity, 0);
+}
+
+TEST(hoMemoryArena_test,ownerTest){
+	// more arenas than one chunk of the range registry holds
+	const size_t numOfArenas = 600;
+
+	std::vector<hoMemoryArena*> arenas(numOfArenas);
+	std::vector<void*> p(numOfArenas);
+	for (size_t i = 0; i < numOfArenas; i++){
+		arenas[i] = new hoMemoryArena(1024);
+		p[i] = arenas[i]->allocate(16);
+	}
+
+	for (size_t i = 0; i < numOfArenas; i++)
+		EXPECT_EQ(hoMemoryAllocator::find_owner(p[i]), arenas[i]);
+
+	// released from several threads at once
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < 4; t++){
+		threads.push_back(std::thread([&p, t, numOfArenas](){
+			for (size_t i = t; i < numOfArenas; i += 4) ho_deallocate_memory(p[i]);
+		}));
+	}
+	for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+
+	for (size_t i = 0; i < numOfArenas; i++){
+		EXPECT_EQ(arenas[i]->get_statistics().live_allocations, 0);
+		delete arenas[i];
+	}
+}
+
+TEST(hoMemoryArena_test,escapeTest){
+	hoMemoryArena arena(1024*1024);
+	hoNDArray<ComplexType>* escaped = 0;
+
+	{
+		hoMemoryArenaScope scope(arena);
+		hoNDArray<ComplexType> tmp(128);
+		escaped = new hoNDArray<ComplexType>(128);
+		tmp.fill(ComplexType(1,0));
+		escaped->fill(ComplexType(2,0));
+	}
+
+	// the escaped array keeps its memory, new allocations do not overwrite it
+	{
+		hoMemoryArenaScope scope(arena);
+		hoNDArray<ComplexType> tmp(256);
+		tmp.fill(ComplexType(3,0));
+	}
+
+	EXPECT_EQ(arena.get_statistics().live_allocations, 1);
+	for (size_t i = 0; i < escaped->get_number_of_elements(); i++)
+		EXPECT_EQ((*escaped)[i], ComplexType(2,0));
+
+	// released on another thread
+	std::thread t([escaped](){ delete escaped; });
+	t.join();
+
+	EXPECT_EQ(arena.get_statistics().live_allocations, 0);
+	EXPECT_TRUE(arena.reset());
+}
+
+TEST(hoMemoryArena_test,deferredResetTest){
+	hoMemoryArena arena(1024*1024);
+	hoNDArray<ComplexType>* escaped = 0;
+
+	{
+		hoMemoryArenaScope scope(arena);
+		escaped = new hoNDArray<ComplexType>(128);
+	}
+
+	// an array is still alive, the blocks go back to the system with it
+	EXPECT_FALSE(arena.reset());
+	EXPECT_GT(arena.get_statistics().capacity, 0);
+
+	delete escaped;
+	EXPECT_EQ(arena.get_statistics().capacity, 0);
+
+	// the next scope is not affected
+	{
+		hoMemoryArenaScope scope(arena);
+		hoNDArray<ComplexType> a(128);
+	}
+	EXPECT_GT(arena.get_statistics().capacity, 0);
+}
+
+TEST(hoMemoryArena_test,heapTest){
+	// without a scope the arrays come from the heap
+	hoNDArray<ComplexType> a(100);
+	EXPECT_EQ(hoMemoryAllocator::find_owner(a.begin()), (hoMemoryAllocator*)0);
+
+	hoMemoryArena arena;
+	{
+		hoMemoryArenaScope scope(arena);
+		hoNDArray<ComplexType> b(100);
+		EXPECT_EQ(hoMemoryAllocator::find_owner(b.begin()), &arena);
+	}
+}
+
+TEST(hoMemoryArena_test,alignedAllocatorTest){
+	hoAlignedAllocator allocator(64);
+	{
+		hoMemoryAllocatorScope scope(&allocator);
+		for (size_t n = 1; n < 1000; n += 37){
+			hoNDArray<ComplexType> a(n);
+			EXPECT_EQ(reinterpret_cast<size_t>(a.begin()) % 64, 0);
+		}
+	}
+
+	// large arrays on transparent huge pages are aligned to the huge page size
+	hoAlignedAllocator huge(64, hoAlignedAllocator::HUGE_PAGES_TRANSPARENT, 1024*1024);
+	{
+		hoMemoryAllocatorScope scope(&huge);
+		hoNDArray<ComplexType> small(1000);
+		hoNDArray<ComplexType> large(512, 512);
+		EXPECT_EQ(reinterpret_cast<size_t>(small.begin()) % 64, 0);
+		EXPECT_EQ(reinterpret_cast<size_t>(large.begin()) % hoAlignedAllocator::HUGE_PAGE_SIZE, 0);
+		large.begin()[large.get_number_of_elements()-1] = ComplexType(1,0);
+	}
+}
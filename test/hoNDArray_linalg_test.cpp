@@ -0,0 +1,143 @@
+#if defined(USE_MKL) || defined(USE_LAPACK)
+
+#include "hoNDArray_linalg.h"
+#include "hoNDArray_elemwise.h"
+
+#include <gtest/gtest.h>
+#include <boost/random.hpp>
+#include <complex>
+#include <cstring>
+#include <limits>
+
+using namespace Gadgetron;
+using testing::Types;
+
+template<typename REAL> class hoNDArray_linalg_batch_test : public ::testing::Test {
+protected:
+	virtual void SetUp(){
+		boost::random::mt19937 rng;
+		boost::random::uniform_real_distribution<REAL> uni(-1,1);
+
+		n = 8;
+		batch = 67;
+
+		A = hoNDArray< std::complex<REAL> >(n, 5, batch);
+		b = hoNDArray< std::complex<REAL> >(n, 2, batch);
+
+		for (size_t i = 0; i < A.get_number_of_elements(); i++) A(i) = std::complex<REAL>(uni(rng),uni(rng));
+		for (size_t i = 0; i < b.get_number_of_elements(); i++) b(i) = std::complex<REAL>(uni(rng),uni(rng));
+
+		// Hermitian positive definite stack, A*A' + I
+		gemm_batch(H, A, false, A, true);
+		for (size_t k = 0; k < batch; k++)
+			for (size_t i = 0; i < n; i++)
+				H(i + i*n + k*n*n) += REAL(1);
+	}
+
+	// copy of one matrix of a stack
+	hoNDArray< std::complex<REAL> > slice(const hoNDArray< std::complex<REAL> >& x, size_t k){
+		hoNDArray< std::complex<REAL> > r(x.get_size(0), x.get_size(1));
+		memcpy(r.begin(), x.begin() + k*r.get_number_of_elements(), r.get_number_of_bytes());
+		return r;
+	}
+
+	size_t n;
+	size_t batch;
+	hoNDArray< std::complex<REAL> > A;
+	hoNDArray< std::complex<REAL> > b;
+	hoNDArray< std::complex<REAL> > H;
+};
+
+typedef Types<float, double> realImplementations;
+TYPED_TEST_CASE(hoNDArray_linalg_batch_test, realImplementations);
+
+TYPED_TEST(hoNDArray_linalg_batch_test,gemmTest){
+	typedef std::complex<TypeParam> T;
+	const TypeParam tol = std::numeric_limits<TypeParam>::epsilon()*64;
+
+	hoNDArray<T> C;
+	gemm_batch(C, this->A, true, this->A, false);
+	EXPECT_EQ(5, C.get_size(0));
+	EXPECT_EQ(5, C.get_size(1));
+	EXPECT_EQ(this->batch, C.get_size(2));
+
+	for (size_t k = 0; k < this->batch; k++){
+		hoNDArray<T> a = this->slice(this->A, k), a2(a), c;
+		gemm(c, a, true, a2, false);
+		for (size_t i = 0; i < c.get_number_of_elements(); i++)
+			EXPECT_NEAR(0, std::abs(c(i) - C(i + k*25)), tol);
+	}
+}
+
+TYPED_TEST(hoNDArray_linalg_batch_test,posvTest){
+	typedef std::complex<TypeParam> T;
+	const TypeParam tol = std::numeric_limits<TypeParam>::epsilon()*64;
+
+	hoNDArray<T> H(this->H), x(this->b);
+	posv_batch(H, x);
+
+	for (size_t k = 0; k < this->batch; k++){
+		hoNDArray<T> h = this->slice(this->H, k), y = this->slice(this->b, k);
+		posv(h, y);
+		for (size_t i = 0; i < y.get_number_of_elements(); i++)
+			EXPECT_NEAR(0, std::abs(y(i) - x(i + k*y.get_number_of_elements())), tol);
+	}
+}
+
+TYPED_TEST(hoNDArray_linalg_batch_test,tikhonovTest){
+	typedef std::complex<TypeParam> T;
+	const TypeParam tol = std::numeric_limits<TypeParam>::epsilon()*64;
+
+	hoNDArray<T> H(this->H), x(this->b);
+	SolveNormalEquation_Tikhonov_batch(H, x, 0.01);
+
+	for (size_t k = 0; k < this->batch; k++){
+		hoNDArray<T> h = this->slice(this->H, k), y = this->slice(this->b, k);
+		SolveNormalEquation_Tikhonov(h, y, 0.01);
+		for (size_t i = 0; i < y.get_number_of_elements(); i++)
+			EXPECT_NEAR(0, std::abs(y(i) - x(i + k*y.get_number_of_elements())), tol);
+	}
+}
+
+TYPED_TEST(hoNDArray_linalg_batch_test,potrfTest){
+	typedef std::complex<TypeParam> T;
+	const TypeParam tol = std::numeric_limits<TypeParam>::epsilon()*64;
+
+	hoNDArray<T> H(this->H);
+	potrf_batch(H, 'L');
+
+	for (size_t k = 0; k < this->batch; k++){
+		hoNDArray<T> h = this->slice(this->H, k);
+		potrf(h, 'L');
+		for (size_t i = 0; i < h.get_number_of_elements(); i++)
+			EXPECT_NEAR(0, std::abs(h(i) - H(i + k*h.get_number_of_elements())), tol);
+	}
+
+	// a matrix which is not positive definite fails the whole call
+	H = this->H;
+	H(this->n*this->n*3) = T(-1);
+	EXPECT_ANY_THROW(potrf_batch(H, 'L'));
+}
+
+TYPED_TEST(hoNDArray_linalg_batch_test,heevTest){
+	typedef std::complex<TypeParam> T;
+	const TypeParam tol = std::numeric_limits<TypeParam>::epsilon()*256;
+
+	hoNDArray<T> H(this->H);
+	hoNDArray<TypeParam> ev;
+	heev_batch(H, ev);
+	EXPECT_EQ(this->n, ev.get_size(0));
+	EXPECT_EQ(this->batch, ev.get_size(1));
+
+	for (size_t k = 0; k < this->batch; k++){
+		hoNDArray<T> h = this->slice(this->H, k);
+		hoNDArray<TypeParam> e;
+		heev(h, e);
+		for (size_t i = 0; i < this->n; i++)
+			EXPECT_NEAR(e(i), ev(i, k), tol*e(this->n-1));
+		for (size_t i = 0; i < h.get_number_of_elements(); i++)
+			EXPECT_NEAR(0, std::abs(h(i) - H(i + k*h.get_number_of_elements())), tol);
+	}
+}
+
+#endif // defined(USE_MKL) || defined(USE_LAPACK)
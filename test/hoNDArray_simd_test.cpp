@@ -0,0 +1,96 @@
+#include "hoNDArray_simd.h"
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_reductions.h"
+
+#include <gtest/gtest.h>
+#include <boost/random.hpp>
+#include <complex>
+#include <limits>
+#include <vector>
+
+using namespace Gadgetron;
+using testing::Types;
+
+template<typename REAL> class hoNDArray_simd_test : public ::testing::Test {
+protected:
+	virtual void SetUp(){
+		boost::random::mt19937 rng;
+		boost::random::uniform_real_distribution<REAL> uni(-1,1);
+
+		// not a multiple of any vector width, so the remainder loops are exercised
+		x = hoNDArray< std::complex<REAL> >(1021, 37);
+		y = hoNDArray< std::complex<REAL> >(1021, 37);
+
+		for (size_t i = 0; i < x.get_number_of_elements(); i++){
+			x(i) = std::complex<REAL>(uni(rng),uni(rng));
+			y(i) = std::complex<REAL>(uni(rng),uni(rng));
+		}
+
+		// values below and above the epsilon threshold of addEpsilon
+		x(3) = std::complex<REAL>(0, 0);
+		x(10) = std::complex<REAL>(std::numeric_limits<REAL>::epsilon()/4, 0);
+		x(11) = std::complex<REAL>(0, std::numeric_limits<REAL>::epsilon()*2);
+	}
+
+	virtual void TearDown(){
+		simd::set_instruction_set(simd::supported_instruction_set());
+	}
+
+	hoNDArray< std::complex<REAL> > x;
+	hoNDArray< std::complex<REAL> > y;
+};
+
+typedef Types<float, double> realImplementations;
+TYPED_TEST_CASE(hoNDArray_simd_test, realImplementations);
+
+TYPED_TEST(hoNDArray_simd_test,kernelTest){
+	typedef std::complex<TypeParam> T;
+	const TypeParam tol = std::numeric_limits<TypeParam>::epsilon()*8;
+	const size_t N = this->x.get_number_of_elements();
+
+	for (int isa = simd::SCALAR; isa <= simd::supported_instruction_set(); isa++){
+		simd::set_instruction_set(static_cast<simd::InstructionSet>(isa));
+		SCOPED_TRACE(simd::instruction_set_name(simd::instruction_set()));
+
+		hoNDArray<T> r(this->x.get_dimensions());
+
+		multiply(this->x, this->y, r);
+		for (size_t i = 0; i < N; i++)
+			EXPECT_NEAR(0, std::abs(r(i) - this->x(i)*this->y(i)), tol);
+
+		multiplyConj(this->x, this->y, r);
+		for (size_t i = 0; i < N; i++)
+			EXPECT_NEAR(0, std::abs(r(i) - this->x(i)*std::conj(this->y(i))), tol);
+
+		hoNDArray<T> acc(this->y);
+		simd::multiplyAdd(N, this->x.begin(), this->y.begin(), acc.begin());
+		for (size_t i = 0; i < N; i++)
+			EXPECT_NEAR(0, std::abs(acc(i) - (this->y(i) + this->x(i)*this->y(i))), tol*2);
+
+		hoNDArray<TypeParam> a;
+		a.create(this->x.get_dimensions());
+		Gadgetron::abs(this->x, a);
+		for (size_t i = 0; i < N; i++)
+			EXPECT_NEAR(std::abs(this->x(i)), a(i), tol);
+
+		hoNDArray<T> e(this->x);
+		addEpsilon(e);
+		EXPECT_EQ(std::numeric_limits<TypeParam>::epsilon(), e(3).real());
+		EXPECT_EQ(std::numeric_limits<TypeParam>::epsilon()*5/4, e(10).real());
+		EXPECT_EQ(this->x(11), e(11));
+		EXPECT_EQ(this->x(12), e(12));
+
+		double s = 0;
+		std::complex<double> d = 0;
+		for (size_t i = 0; i < N; i++){
+			s += std::norm(std::complex<double>(this->x(i)));
+			d += std::complex<double>(this->x(i)) * std::conj(std::complex<double>(this->y(i)));
+		}
+
+		EXPECT_NEAR(std::sqrt(s), norm2(this->x), std::sqrt(s)*tol*16);
+
+		T c = dotc(this->x, this->y);
+		EXPECT_NEAR(d.real(), c.real(), std::abs(d)*tol*16);
+		EXPECT_NEAR(d.imag(), c.imag(), std::abs(d)*tol*16);
+	}
+}
@@ -3,6 +3,8 @@
 #include "complext.h"
 #include <gtest/gtest.h>
 #include <boost/random.hpp>
+#include <algorithm>
+#include <complex>
 
 using namespace Gadgetron;
 using testing::Types;
@@ -44,3 +46,68 @@ TYPED_TEST(hoNDFFT_test,ifftNrm2Test){
 	EXPECT_NEAR(nrm2(&this->Array2),nrm2(&this->Array),nrm2(&this->Array)*1e-2);
 
 }
+
+TYPED_TEST(hoNDFFT_test,planCacheTest){
+	hoNDFFT<TypeParam>::instance()->fft(&this->Array);
+	typename hoNDFFT<TypeParam>::PlanCacheStatistics before = hoNDFFT<TypeParam>::instance()->get_plan_cache_statistics();
+
+	hoNDFFT<TypeParam>::instance()->fft(&this->Array);
+	typename hoNDFFT<TypeParam>::PlanCacheStatistics after = hoNDFFT<TypeParam>::instance()->get_plan_cache_statistics();
+
+	EXPECT_GT(after.hits, before.hits);
+	EXPECT_EQ(after.misses, before.misses);
+}
+
+// Centered transforms of even sizes run fused and in place, compare against explicit shifts around fft2/fft3
+template<typename REAL> static double centeredTransformError(hoNDArray< std::complex<REAL> >& a, hoNDArray< std::complex<REAL> >& b){
+	double err = 0, peak = 0;
+	for (size_t i = 0; i < a.get_number_of_elements(); i++){
+		err = std::max(err, (double)std::abs(a[i]-b[i]));
+		peak = std::max(peak, (double)std::abs(a[i]));
+	}
+	return err/peak;
+}
+
+TYPED_TEST(hoNDFFT_test,centeredFusedTest){
+	typedef std::complex<TypeParam> C;
+	hoNDFFT<TypeParam>* fft = hoNDFFT<TypeParam>::instance();
+
+	// 32 channel 2D and 3D data, one size with N/2 odd to cover the sign correction
+	std::vector<size_t> dims2D;
+	dims2D.push_back(256); dims2D.push_back(190); dims2D.push_back(32);
+	std::vector<size_t> dims3D;
+	dims3D.push_back(64); dims3D.push_back(64); dims3D.push_back(46); dims3D.push_back(32);
+
+	for (int rank = 2; rank <= 3; rank++){
+		hoNDArray<C> a(rank == 2 ? dims2D : dims3D);
+		boost::random::mt19937 rng;
+		boost::random::uniform_real_distribution<TypeParam> uni(0,1);
+		for (size_t i = 0; i < a.get_number_of_elements(); i++)
+			a[i] = C(uni(rng),uni(rng));
+
+		hoNDArray<C> ref(a), res(a);
+
+		if (rank == 2){
+			fft->ifftshift2D(ref);
+			fft->fft2(ref);
+			fft->fftshift2D(ref);
+		} else {
+			fft->ifftshift3D(ref);
+			fft->fft3(ref);
+			fft->fftshift3D(ref);
+		}
+
+		if (rank == 2)
+			fft->fft2c(res);
+		else
+			fft->fft3c(res);
+
+		EXPECT_LE(centeredTransformError(ref, res), 1e-4);
+
+		if (rank == 2)
+			fft->ifft2c(res);
+		else
+			fft->ifft3c(res);
+		EXPECT_LE(centeredTransformError(a, res), 1e-4);
+	}
+}
@@ -0,0 +1,121 @@
+#if defined(USE_MKL) || defined(USE_LAPACK)
+
+#include "mri_core_coil_map_estimation.h"
+#include "hoNDArray_elemwise.h"
+
+#include <gtest/gtest.h>
+#include <boost/random.hpp>
+#include <complex>
+#include <limits>
+#include <vector>
+
+using namespace Gadgetron;
+using testing::Types;
+
+template<typename REAL> class mri_core_coil_map_estimation_test : public ::testing::Test {
+protected:
+	typedef std::complex<REAL> T;
+
+	// smooth coil sensitivities times a smooth object plus noise, [RO E1 E2 CHA]
+	void fill(hoNDArray<T>& data, size_t CHA){
+		boost::random::mt19937 rng;
+		boost::random::normal_distribution<REAL> noise;
+
+		size_t pixels = data.get_number_of_elements()/CHA;
+		for (size_t i = 0; i < data.get_number_of_elements(); i++){
+			size_t p = i%pixels, cha = i/pixels;
+			double ph = 0.01*p*(cha+1);
+			data(i) = T(REAL(3*std::cos(ph)) + REAL(0.3)*noise(rng), REAL(3*std::sin(0.7*ph)) + REAL(0.3)*noise(rng));
+		}
+	}
+
+	// coil map of one pixel from the explicit local covariance, as the data matrix based implementation
+	void reference_pixel(const hoNDArray<T>& data, size_t RO, size_t E1, size_t E2, size_t CHA, size_t ks, size_t kz, size_t power,
+		long long ro, long long e1, long long e2, std::vector< std::complex<double> >& sen){
+		long long h = ks/2, hz = kz/2;
+		std::vector< std::complex<double> > H(CHA*CHA, 0), s(CHA, 0), v(CHA), y(CHA);
+
+		for (long long k2 = -hz; k2 <= hz; k2++)
+			for (long long k1 = -h; k1 <= h; k1++)
+				for (long long k0 = -h; k0 <= h; k0++){
+					size_t d2 = (e2 + k2 + E2)%E2, d1 = (e1 + k1 + E1)%E1, d0 = (ro + k0 + RO)%RO;
+					for (size_t j = 0; j < CHA; j++){
+						std::complex<double> xj = data(d0 + d1*RO + d2*RO*E1 + j*RO*E1*E2);
+						s[j] += xj;
+						for (size_t i = 0; i < CHA; i++)
+							H[i + j*CHA] += std::conj(std::complex<double>(data(d0 + d1*RO + d2*RO*E1 + i*RO*E1*E2))) * xj;
+					}
+				}
+
+		v = s;
+		for (size_t po = 0; po <= power; po++){
+			if (po > 0){
+				for (size_t i = 0; i < CHA; i++){
+					y[i] = 0;
+					for (size_t j = 0; j < CHA; j++) y[i] += H[i + j*CHA]*v[j];
+				}
+				v = y;
+			}
+			double n = 0;
+			for (size_t i = 0; i < CHA; i++) n += std::norm(v[i]);
+			for (size_t i = 0; i < CHA; i++) v[i] /= std::sqrt(n);
+		}
+
+		std::complex<double> phase = 0;
+		for (size_t i = 0; i < CHA; i++) phase += s[i]*v[i];
+		phase /= std::abs(phase);
+
+		sen.resize(CHA);
+		for (size_t i = 0; i < CHA; i++) sen[i] = std::conj(v[i])*phase;
+	}
+
+	// compare the coil map at pixels on the borders, tile boundaries and inside
+	REAL max_difference(const hoNDArray<T>& data, const hoNDArray<T>& coilMap, size_t RO, size_t E1, size_t E2, size_t CHA, size_t ks, size_t kz, size_t power){
+		long long ros[] = { 0, 1, 31, 32, (long long)RO/2, (long long)RO-1 };
+		long long e1s[] = { 0, 5, 31, 32, (long long)E1-1 };
+		std::vector<long long> e2s;
+		e2s.push_back(0);
+		e2s.push_back(E2/2);
+		e2s.push_back(E2-1);
+
+		REAL diff = 0;
+		std::vector< std::complex<double> > sen;
+		for (size_t a = 0; a < 6; a++)
+			for (size_t b = 0; b < 5; b++)
+				for (size_t c = 0; c < e2s.size(); c++){
+					long long ro = ros[a]%RO, e1 = e1s[b]%E1, e2 = e2s[c];
+					reference_pixel(data, RO, E1, E2, CHA, ks, kz, power, ro, e1, e2, sen);
+					for (size_t cha = 0; cha < CHA; cha++)
+						diff = std::max(diff, REAL(std::abs(sen[cha] - std::complex<double>(coilMap(ro + e1*RO + e2*RO*E1 + cha*RO*E1*E2)))));
+				}
+		return diff;
+	}
+};
+
+typedef Types<float, double> realImplementations;
+TYPED_TEST_CASE(mri_core_coil_map_estimation_test, realImplementations);
+
+TYPED_TEST(mri_core_coil_map_estimation_test,Inati2DTest){
+	typedef std::complex<TypeParam> T;
+
+	hoNDArray<T> data(77, 45, 8), coilMap;
+	this->fill(data, 8);
+
+	coil_map_2d_Inati(data, coilMap, 7, 3);
+	ASSERT_TRUE(data.dimensions_equal(&coilMap));
+	EXPECT_LE(this->max_difference(data, coilMap, 77, 45, 1, 8, 7, 1, 3), std::numeric_limits<TypeParam>::epsilon()*1e3);
+}
+
+TYPED_TEST(mri_core_coil_map_estimation_test,Inati3DTest){
+	typedef std::complex<TypeParam> T;
+
+	// more than one slab along E2
+	hoNDArray<T> data(37, 33, 40, 6), coilMap;
+	this->fill(data, 6);
+
+	coil_map_3d_Inati(data, coilMap, 5, 3);
+	ASSERT_TRUE(data.dimensions_equal(&coilMap));
+	EXPECT_LE(this->max_difference(data, coilMap, 37, 33, 40, 6, 5, 5, 3), std::numeric_limits<TypeParam>::epsilon()*1e3);
+}
+
+#endif // defined(USE_MKL) || defined(USE_LAPACK)
@@ -0,0 +1,242 @@
+#if defined(USE_MKL) || defined(USE_LAPACK)
+
+#include "mri_core_grappa.h"
+#include "hoNDArray_linalg.h"
+#include "hoNDArray_elemwise.h"
+
+#include <gtest/gtest.h>
+#include <boost/random.hpp>
+#include <complex>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace Gadgetron;
+using testing::Types;
+
+template<typename REAL> class mri_core_grappa_test : public ::testing::Test {
+protected:
+	typedef std::complex<REAL> T;
+
+	// acs data with a smooth coil modulation on top of noise, [RO E1 E2 CHA]
+	void fill(hoNDArray<T>& acs){
+		boost::random::mt19937 rng;
+		boost::random::normal_distribution<REAL> noise;
+
+		size_t RO = acs.get_size(0), E1 = acs.get_size(1), E2 = acs.get_size(2);
+		for (size_t i = 0; i < acs.get_number_of_elements(); i++){
+			size_t ro = i%RO, e1 = (i/RO)%E1, e2 = (i/(RO*E1))%E2, cha = i/(RO*E1*E2);
+			REAL s = REAL(std::cos(0.05*(cha+1)*ro) + std::sin(0.1*(cha+1)*e1) + std::cos(0.2*(cha+1)*e2));
+			acs(i) = T(4*s + noise(rng), 2*s + noise(rng));
+		}
+	}
+
+	// the previous calibration, A and B are formed explicitly
+	void reference_calib(const hoNDArray<T>& acs, double thres, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, const std::vector<int>& kE2, const std::vector<int>& oE2, hoNDArray<T>& x){
+		size_t RO = acs.get_size(0), E1 = acs.get_size(1), E2 = acs.get_size(2), CHA = acs.get_size(3);
+		long long kROhalf = kRO/2;
+
+		size_t sE1 = std::abs(kE1[0]), eE1 = E1 - 1 - kE1.back();
+		size_t sE2 = std::abs(kE2[0]), eE2 = E2 - 1 - kE2.back();
+		size_t rowA = (RO - 2*kROhalf)*(eE1 - sE1 + 1)*(eE2 - sE2 + 1);
+		size_t colA = kRO*kE1.size()*kE2.size()*CHA, colB = CHA*oE1.size()*oE2.size();
+
+		hoNDArray<T> A(rowA, colA), B(rowA, colB);
+		size_t r = 0;
+		for (size_t e2 = sE2; e2 <= eE2; e2++)
+			for (size_t e1 = sE1; e1 <= eE1; e1++)
+				for (long long ro = kROhalf; ro < (long long)RO - kROhalf; ro++, r++){
+					size_t col = 0;
+					for (size_t cha = 0; cha < CHA; cha++)
+						for (size_t ke2 = 0; ke2 < kE2.size(); ke2++)
+							for (size_t ke1 = 0; ke1 < kE1.size(); ke1++)
+								for (long long kro = -kROhalf; kro <= kROhalf; kro++)
+									A(r, col++) = acs(ro + kro, e1 + kE1[ke1], e2 + kE2[ke2], cha);
+					col = 0;
+					for (size_t oe2 = 0; oe2 < oE2.size(); oe2++)
+						for (size_t oe1 = 0; oe1 < oE1.size(); oe1++)
+							for (size_t cha = 0; cha < CHA; cha++)
+								B(r, col++) = acs(ro, e1 + oE1[oe1], e2 + oE2[oe2], cha);
+				}
+
+		SolveLinearSystem_Tikhonov(A, B, x, thres);
+	}
+
+	REAL relative_difference(const hoNDArray<T>& a, const hoNDArray<T>& b){
+		double d = 0, n = 0;
+		for (size_t i = 0; i < a.get_number_of_elements(); i++){
+			d += std::norm(std::complex<double>(a(i)) - std::complex<double>(b(i)));
+			n += std::norm(std::complex<double>(a(i)));
+		}
+		return REAL(std::sqrt(d/n));
+	}
+};
+
+typedef Types<float, double> realImplementations;
+TYPED_TEST_CASE(mri_core_grappa_test, realImplementations);
+
+TYPED_TEST(mri_core_grappa_test,calib2DTest){
+	typedef std::complex<TypeParam> T;
+
+	hoNDArray<T> acs(64, 32, 1, 8);
+	this->fill(acs);
+	hoNDArray<T> acs2D(64, 32, 8, acs.begin());
+
+	std::vector<int> kE1, oE1, kE2(1, 0), oE2(1, 0);
+	size_t convKRO, convKE1;
+	grappa2d_kerPattern(kE1, oE1, convKRO, convKE1, 3, 5, 4, true);
+
+	hoNDArray<T> ker, x;
+	grappa2d_calib(acs2D, acs2D, 0.0005, 5, kE1, oE1, 0, acs2D.get_size(0)-1, 0, acs2D.get_size(1)-1, ker);
+	this->reference_calib(acs, 0.0005, 5, kE1, oE1, kE2, oE2, x);
+
+	EXPECT_EQ(x.get_number_of_elements(), ker.get_number_of_elements());
+	EXPECT_LE(this->relative_difference(x, ker), std::numeric_limits<TypeParam>::epsilon()*1e3);
+}
+
+TYPED_TEST(mri_core_grappa_test,calib3DTest){
+	typedef std::complex<TypeParam> T;
+
+	hoNDArray<T> acs(32, 16, 12, 4);
+	this->fill(acs);
+
+	std::vector<int> kE1, oE1, kE2, oE2;
+	size_t convKRO, convKE1, convKE2;
+	grappa3d_kerPattern(kE1, oE1, kE2, oE2, convKRO, convKE1, convKE2, 2, 2, 5, 4, 3, true);
+
+	hoNDArray<T> ker, x;
+	grappa3d_calib(acs, acs, 0.0005, 0, 5, kE1, oE1, kE2, oE2, ker);
+	this->reference_calib(acs, 0.0005, 5, kE1, oE1, kE2, oE2, x);
+
+	EXPECT_EQ(x.get_number_of_elements(), ker.get_number_of_elements());
+	EXPECT_LE(this->relative_difference(x, ker), std::numeric_limits<TypeParam>::epsilon()*1e3);
+}
+
+TYPED_TEST(mri_core_grappa_test,calib2DBatchTest){
+	typedef std::complex<TypeParam> T;
+
+	hoNDArray<T> acs(48, 32, 1, 6*3);
+	this->fill(acs);
+	hoNDArray<T> acsSrc(48, 32, 6, 3, acs.begin()), acsDst(48, 32, 4, 3);
+	for (size_t n = 0; n < 3; n++)
+		memcpy(acsDst.begin() + n*48*32*4, acsSrc.begin() + n*48*32*6, sizeof(T)*48*32*4);
+
+	hoNDArray<T> convKer;
+	grappa2d_calib_convolution_kernel_batch(acsSrc, acsDst, 3, 0.0005, 5, 4, convKer);
+	ASSERT_EQ(3, convKer.get_size(4));
+
+	// every N calibrated on its own
+	for (size_t n = 0; n < 3; n++){
+		hoNDArray<T> src(48, 32, 6, acsSrc.begin() + n*48*32*6), dst(48, 32, 4, acsDst.begin() + n*48*32*4), convKerN;
+		grappa2d_calib_convolution_kernel(src, dst, 3, 0.0005, 5, 4, convKerN);
+
+		ASSERT_EQ(convKerN.get_number_of_elements()*3, convKer.get_number_of_elements());
+		hoNDArray<T> batchN(convKerN.get_dimensions().get(), convKer.begin() + n*convKerN.get_number_of_elements());
+		EXPECT_LE(this->relative_difference(convKerN, batchN), std::numeric_limits<TypeParam>::epsilon()*1e2);
+	}
+}
+
+TYPED_TEST(mri_core_grappa_test,imageDomainKernelCacheTest){
+	typedef std::complex<TypeParam> T;
+
+	hoNDArray<T> acs(32, 24, 4), acs2;
+	this->fill(acs);
+	acs2 = acs;
+	acs2(7) += T(1);
+
+	GrappaImageDomainKernelKey key;
+	key.RO = 64; key.E1 = 48; key.calibRO = 32; key.calibE1 = 24; key.acceFactorE1 = 2;
+	key.kRO = 5; key.kNE1 = 4; key.srcCHA = 4; key.dstCHA = 4;
+	key.checksum = grappa_checksum(acs);
+
+	// the checksum follows the content, not the array
+	hoNDArray<T> acsCopy(acs);
+	EXPECT_EQ(key.checksum, grappa_checksum(acsCopy));
+	EXPECT_NE(key.checksum, grappa_checksum(acs2));
+
+	GrappaImageDomainKernelCache<T> cache;
+	EXPECT_FALSE(cache.find(0, key));
+
+	boost::shared_ptr< hoNDArray<T> > kIm0(new hoNDArray<T>(64, 48, 4, 4)), kIm1(new hoNDArray<T>(64, 48, 4, 4));
+	cache.insert(0, key, kIm0);
+	cache.insert(1, key, kIm1);
+
+	// every slot keeps its own kernel
+	EXPECT_EQ(kIm0.get(), cache.find(0, key).get());
+	EXPECT_EQ(kIm1.get(), cache.find(1, key).get());
+	EXPECT_EQ(2, cache.size());
+
+	// changed acs data or settings are a miss
+	GrappaImageDomainKernelKey key2(key);
+	key2.checksum = grappa_checksum(acs2);
+	EXPECT_FALSE(cache.find(0, key2));
+	key2 = key;
+	key2.acceFactorE1 = 3;
+	EXPECT_FALSE(cache.find(0, key2));
+
+	EXPECT_EQ(2, cache.hits());
+	EXPECT_EQ(3, cache.misses());
+
+	cache.erase(0);
+	EXPECT_FALSE(cache.find(0, key));
+	EXPECT_EQ(1, cache.size());
+}
+
+TYPED_TEST(mri_core_grappa_test,unwrappingROChunkTest){
+	typedef std::complex<TypeParam> T;
+
+	// odd and even sizes, RO not a multiple of the chunk size
+	hoNDArray<T> convKer(5, 3, 3, 4, 4), kspace(18, 9, 8, 4, 2);
+	this->fill(convKer);
+	this->fill(kspace);
+
+	hoNDArray<T> ref, res;
+	grappa3d_image_domain_unwrapping(convKer, kspace, 2, 2, ref);
+
+	size_t chunks[] = { 1, 4, 7, 18, 0 };
+	for (size_t c = 0; c < sizeof(chunks)/sizeof(size_t); c++){
+		grappa3d_image_domain_unwrapping_ro_chunk(convKer, kspace, 2, 2, chunks[c], res);
+
+		ASSERT_EQ(ref.get_number_of_elements(), res.get_number_of_elements());
+		EXPECT_EQ(4, res.get_size(3));
+		EXPECT_LE(this->relative_difference(ref, res), std::numeric_limits<TypeParam>::epsilon()*1e2);
+	}
+}
+
+TYPED_TEST(mri_core_grappa_test,unmixTest){
+	typedef std::complex<TypeParam> T;
+
+	// image size not a multiple of the tile size, coefficients shared over N for 2D and given per N for 3D
+	hoNDArray<T> aliasedIm(67, 41, 5, 3), unmixCoeff(67, 41, 5), aliasedIm3D(19, 13, 7, 4, 2), unmixCoeff3D(19, 13, 7, 4, 2);
+	this->fill(aliasedIm);
+	this->fill(unmixCoeff);
+	this->fill(aliasedIm3D);
+	this->fill(unmixCoeff3D);
+
+	hoNDArray<T> complexIm, complexIm3D;
+	apply_unmix_coeff_aliased_image(aliasedIm, unmixCoeff, complexIm);
+	apply_unmix_coeff_aliased_image_3D(aliasedIm3D, unmixCoeff3D, complexIm3D);
+	ASSERT_EQ(67*41*3, complexIm.get_number_of_elements());
+	ASSERT_EQ(19*13*7*2, complexIm3D.get_number_of_elements());
+
+	hoNDArray<T> ref(67, 41, 1, 3), ref3D(19, 13, 7, 2);
+	for (size_t n = 0; n < 3; n++)
+		for (size_t p = 0; p < 67*41; p++){
+			std::complex<double> v = 0;
+			for (size_t cha = 0; cha < 5; cha++)
+				v += std::complex<double>(aliasedIm(p + cha*67*41 + n*67*41*5)) * std::complex<double>(unmixCoeff(p + cha*67*41));
+			ref(p + n*67*41) = T(v);
+		}
+	for (size_t n = 0; n < 2; n++)
+		for (size_t p = 0; p < 19*13*7; p++){
+			std::complex<double> v = 0;
+			for (size_t cha = 0; cha < 4; cha++)
+				v += std::complex<double>(aliasedIm3D(p + (cha + n*4)*19*13*7)) * std::complex<double>(unmixCoeff3D(p + (cha + n*4)*19*13*7));
+			ref3D(p + n*19*13*7) = T(v);
+		}
+
+	EXPECT_LE(this->relative_difference(ref, complexIm), std::numeric_limits<TypeParam>::epsilon()*16);
+	EXPECT_LE(this->relative_difference(ref3D, complexIm3D), std::numeric_limits<TypeParam>::epsilon()*16);
+}
+
+#endif // defined(USE_MKL) || defined(USE_LAPACK)
@@ -0,0 +1,98 @@
+#include "mri_core_kspace_filter.h"
+#include "hoNDArray_elemwise.h"
+
+#include <gtest/gtest.h>
+#include <boost/random.hpp>
+#include <complex>
+#include <limits>
+
+using namespace Gadgetron;
+using testing::Types;
+
+template<typename REAL> class mri_core_kspace_filter_test : public ::testing::Test {
+protected:
+	typedef std::complex<REAL> T;
+
+	virtual void SetUp(){
+		boost::random::mt19937 rng;
+		boost::random::uniform_real_distribution<REAL> uni(-1,1);
+
+		// [RO E1 E2 CHA N]
+		data = hoNDArray<T>(37, 24, 9, 3, 2);
+		for (size_t i = 0; i < data.get_number_of_elements(); i++) data(i) = T(uni(rng), uni(rng));
+
+		generate_symmetric_filter(37, fRO, ISMRMRD_FILTER_GAUSSIAN, 1.5);
+		generate_symmetric_filter(24, fE1, ISMRMRD_FILTER_HANNING);
+		generate_symmetric_filter(9, fE2, ISMRMRD_FILTER_TAPERED_HANNING, 1.5, 3);
+	}
+
+	// filter value at (ro, e1, e2), the filters given as empty arrays are all ones
+	T filter_value(const hoNDArray<T>& fx, const hoNDArray<T>& fy, const hoNDArray<T>& fz, size_t ro, size_t e1, size_t e2){
+		T v = T(1);
+		if (fx.get_number_of_elements()) v *= fx(ro);
+		if (fy.get_number_of_elements()) v *= fy(e1);
+		if (fz.get_number_of_elements()) v *= fz(e2);
+		return v;
+	}
+
+	void check(const hoNDArray<T>& res, const hoNDArray<T>& fx, const hoNDArray<T>& fy, const hoNDArray<T>& fz){
+		ASSERT_EQ(data.get_number_of_elements(), res.get_number_of_elements());
+		for (size_t i = 0; i < data.get_number_of_elements(); i++){
+			size_t ro = i%37, e1 = (i/37)%24, e2 = (i/(37*24))%9;
+			EXPECT_NEAR(0, std::abs(res(i) - data(i)*this->filter_value(fx, fy, fz, ro, e1, e2)), std::numeric_limits<REAL>::epsilon()*16);
+		}
+	}
+
+	hoNDArray<T> data;
+	hoNDArray<T> fRO;
+	hoNDArray<T> fE1;
+	hoNDArray<T> fE2;
+};
+
+typedef Types<float, double> realImplementations;
+TYPED_TEST_CASE(mri_core_kspace_filter_test, realImplementations);
+
+TYPED_TEST(mri_core_kspace_filter_test,separableTest){
+	typedef std::complex<TypeParam> T;
+	hoNDArray<T> none, res;
+
+	apply_kspace_filter_ROE1E2(this->data, this->fRO, this->fE1, this->fE2, res);
+	this->check(res, this->fRO, this->fE1, this->fE2);
+
+	apply_kspace_filter_E1(this->data, this->fE1, res);
+	this->check(res, none, this->fE1, none);
+
+	apply_kspace_filter_ROE2(this->data, this->fRO, this->fE2, res);
+	this->check(res, this->fRO, none, this->fE2);
+
+	apply_kspace_filter_E1E2(this->data, this->fE1, this->fE2, res);
+	this->check(res, none, this->fE1, this->fE2);
+
+	// in place, same as the materialized 3D filter
+	hoNDArray<T> fxyz, ref;
+	compute_3d_filter(this->fRO, this->fE1, this->fE2, fxyz);
+	multiply(this->data, fxyz, ref);
+
+	res = this->data;
+	apply_kspace_filter_separable(res, this->fRO, this->fE1, this->fE2, res);
+	for (size_t i = 0; i < ref.get_number_of_elements(); i++)
+		EXPECT_NEAR(0, std::abs(res(i) - ref(i)), std::numeric_limits<TypeParam>::epsilon()*16);
+
+	// filters not matching the data size are rejected
+	EXPECT_ANY_THROW(apply_kspace_filter_separable(this->data, this->fE1, none, none, res));
+}
+
+TYPED_TEST(mri_core_kspace_filter_test,filterCacheTest){
+	typedef std::complex<TypeParam> T;
+
+	// a cached filter is returned as a copy, changing it does not affect later calls
+	hoNDArray<T> f1, f2;
+	generate_symmetric_filter(24, f1, ISMRMRD_FILTER_HANNING);
+	f1(3) = T(7);
+	generate_symmetric_filter(24, f2, ISMRMRD_FILTER_HANNING);
+	EXPECT_EQ(this->fE1(3), f2(3));
+	EXPECT_NE(f1.begin(), f2.begin());
+
+	// the tapered hanning filter is flat outside the transition bands
+	for (size_t i = 3; i < 6; i++) EXPECT_EQ(this->fE2(3), this->fE2(i));
+}
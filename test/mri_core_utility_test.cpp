@@ -0,0 +1,80 @@
+#include "mri_core_utility.h"
+#include "hoNDFFT.h"
+
+#include <gtest/gtest.h>
+#include <boost/random.hpp>
+#include <complex>
+#include <cstring>
+
+using namespace Gadgetron;
+using testing::Types;
+
+template<typename REAL> class mri_core_utility_test : public ::testing::Test {
+protected:
+	typedef std::complex<REAL> T;
+
+	// oversampled readouts [RO N] of objects within the central 80% of the recon fov, factor 2
+	void fill(hoNDArray<T>& data){
+		boost::random::mt19937 rng;
+		boost::random::normal_distribution<REAL> noise;
+
+		size_t RO = data.get_size(0);
+		for (size_t i = 0; i < data.get_number_of_elements(); i++){
+			size_t ro = i%RO, n = i/RO;
+			double x = (double(ro) - RO/2)/(RO/2);
+			data(i) = (std::abs(x) < 0.4) ? T(REAL(1 + 0.3*std::cos(9*x + n)) + REAL(0.05)*noise(rng), REAL(0.2)*noise(rng)) : T(0);
+		}
+		hoNDFFT<REAL>::instance()->fft(&data, 0);
+	}
+
+	// the fft path of RemoveROOversamplingGadget
+	void remove_ro_oversampling_fft(hoNDArray<T> data, hoNDArray<T>& res){
+		size_t RO = data.get_size(0), M = RO/2, N = data.get_number_of_elements()/RO;
+		res.create(M, N);
+		hoNDFFT<REAL>::instance()->ifft(&data, 0);
+		for (size_t n = 0; n < N; n++) memcpy(res.begin() + n*M, data.begin() + n*RO + (RO - M)/2, sizeof(T)*M);
+		hoNDFFT<REAL>::instance()->fft(&res, 0);
+	}
+
+	REAL relative_difference(const hoNDArray<T>& a, const hoNDArray<T>& b){
+		double d = 0, n = 0;
+		for (size_t i = 0; i < a.get_number_of_elements(); i++){
+			d += std::norm(std::complex<double>(a(i)) - std::complex<double>(b(i)));
+			n += std::norm(std::complex<double>(a(i)));
+		}
+		return REAL(std::sqrt(d/n));
+	}
+};
+
+typedef Types<float, double> realImplementations;
+TYPED_TEST_CASE(mri_core_utility_test, realImplementations);
+
+TYPED_TEST(mri_core_utility_test,roDecimationTest){
+	typedef std::complex<TypeParam> T;
+
+	// 8 coils x 3 readouts, more than one column block is not needed for the check
+	hoNDArray<T> data(256, 8, 3), ref, res;
+	this->fill(data);
+	this->remove_ro_oversampling_fft(data, ref);
+
+	hoNDArray<T> filter;
+	compute_ro_decimation_filter(256, 2, 32, filter);
+	ASSERT_EQ(65, filter.get_number_of_elements());
+
+	// half-band: the even taps except the center are zero
+	EXPECT_EQ(T(0), filter(32 + 2));
+	EXPECT_EQ(T(0), filter(32 - 10));
+
+	remove_ro_oversampling(data, filter, 2, res);
+	ASSERT_EQ(128, res.get_size(0));
+	ASSERT_EQ(8, res.get_size(1));
+	ASSERT_EQ(3, res.get_size(2));
+
+	EXPECT_LE(this->relative_difference(ref, res), 1e-4);
+
+	// a short filter is less accurate but still usable
+	compute_ro_decimation_filter(256, 2, 8, filter);
+	remove_ro_oversampling(data, filter, 2, res);
+	EXPECT_LE(this->relative_difference(ref, res), 5e-2);
+	EXPECT_GE(this->relative_difference(ref, res), 1e-4);
+}
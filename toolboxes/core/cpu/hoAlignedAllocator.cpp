@@ -0,0 +1,183 @@
+#include "hoAlignedAllocator.h"
+#include "log.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+#ifdef _WIN32
+    #include <malloc.h>
+#else
+    #include <sys/mman.h>
+#endif
+
+namespace Gadgetron
+{
+    namespace
+    {
+        size_t round_up(size_t bytes, size_t multiple)
+        {
+            return (bytes + multiple - 1) / multiple * multiple;
+        }
+
+        // explicit huge page mappings, which have to be released with munmap and their size
+        struct HugePageMappings
+        {
+            std::mutex mutex_;
+            std::map<void*, size_t> sizes_;
+        };
+
+        HugePageMappings& huge_page_mappings()
+        {
+            static HugePageMappings* mappings = new HugePageMappings();
+            return *mappings;
+        }
+    }
+
+    hoAlignedAllocator::hoAlignedAllocator(size_t alignment, HugePageMode mode, size_t huge_page_threshold)
+        : alignment_(MIN_ALIGNMENT), mode_(mode), huge_page_threshold_(huge_page_threshold)
+    {
+        while ( alignment_ < alignment ) alignment_ *= 2;
+
+#ifdef _WIN32
+        if ( mode_ != HUGE_PAGES_NONE )
+        {
+            GWARN("hoAlignedAllocator, huge pages are not supported on this platform\n");
+            mode_ = HUGE_PAGES_NONE;
+        }
+#endif
+    }
+
+    hoAlignedAllocator::~hoAlignedAllocator()
+    {
+    }
+
+    void* hoAlignedAllocator::allocate(size_t bytes)
+    {
+        if ( mode_ != HUGE_PAGES_NONE && bytes >= huge_page_threshold_ )
+        {
+            void* p = this->allocate_huge_pages(bytes);
+            if ( p != NULL ) return p;
+        }
+
+        return this->allocate_aligned(bytes, alignment_);
+    }
+
+    void* hoAlignedAllocator::allocate_aligned(size_t bytes, size_t alignment)
+    {
+        void* p = NULL;
+
+#ifdef _WIN32
+        p = _aligned_malloc(bytes, alignment);
+
+        // _aligned_malloc memory can not be released with free
+        if ( p != NULL ) register_range(this, p, bytes);
+#else
+        // released by ho_deallocate_memory with free, no need to register
+        if ( posix_memalign(&p, alignment, bytes) != 0 ) p = NULL;
+#endif
+
+        return p;
+    }
+
+    void* hoAlignedAllocator::allocate_huge_pages(size_t bytes)
+    {
+#ifdef _WIN32
+        return NULL;
+#else
+        size_t size = round_up(bytes, HUGE_PAGE_SIZE);
+
+#ifdef MAP_HUGETLB
+        if ( mode_ == HUGE_PAGES_EXPLICIT )
+        {
+            void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if ( p != MAP_FAILED )
+            {
+                {
+                    HugePageMappings& m = huge_page_mappings();
+                    std::lock_guard<std::mutex> guard(m.mutex_);
+                    m.sizes_[p] = size;
+                }
+
+                register_range(this, p, size);
+                return p;
+            }
+
+            GDEBUG("hoAlignedAllocator, no explicit huge pages available for %d bytes, using transparent huge pages\n", (int)bytes);
+        }
+#endif
+
+        void* p = this->allocate_aligned(size, HUGE_PAGE_SIZE);
+
+#ifdef MADV_HUGEPAGE
+        if ( p != NULL ) madvise(p, size, MADV_HUGEPAGE);
+#endif
+
+        return p;
+#endif // _WIN32
+    }
+
+    void hoAlignedAllocator::deallocate(void* p)
+    {
+        if ( p == NULL ) return;
+
+#ifdef _WIN32
+        unregister_range(p);
+        _aligned_free(p);
+#else
+        size_t size = 0;
+        {
+            HugePageMappings& m = huge_page_mappings();
+            std::lock_guard<std::mutex> guard(m.mutex_);
+            std::map<void*, size_t>::iterator it = m.sizes_.find(p);
+            if ( it != m.sizes_.end() )
+            {
+                size = it->second;
+                m.sizes_.erase(it);
+            }
+        }
+
+        if ( size > 0 )
+        {
+            unregister_range(p);
+            munmap(p, size);
+        }
+        else
+        {
+            free(p);
+        }
+#endif
+    }
+
+    hoAlignedAllocator* hoAlignedAllocator::from_environment()
+    {
+        const char* alignment = getenv(GADGETRON_MEMORY_ALIGNMENT_ENVIRONMENT);
+        const char* huge_pages = getenv(GADGETRON_HUGE_PAGES_ENVIRONMENT);
+
+        size_t a = (alignment != NULL) ? (size_t)atol(alignment) : 0;
+
+        HugePageMode mode = HUGE_PAGES_NONE;
+        if ( huge_pages != NULL )
+        {
+            if ( strcmp(huge_pages, "transparent") == 0 )
+            {
+                mode = HUGE_PAGES_TRANSPARENT;
+            }
+            else if ( strcmp(huge_pages, "explicit") == 0 )
+            {
+                mode = HUGE_PAGES_EXPLICIT;
+            }
+            else if ( strlen(huge_pages) > 0 )
+            {
+                GWARN("Unknown %s setting %s, use transparent or explicit\n", GADGETRON_HUGE_PAGES_ENVIRONMENT, huge_pages);
+            }
+        }
+
+        if ( a == 0 && mode == HUGE_PAGES_NONE ) return NULL;
+
+        hoAlignedAllocator* allocator = new hoAlignedAllocator(a, mode);
+        GDEBUG("hoNDArray memory aligned to %d bytes, huge pages mode %d\n", (int)allocator->alignment(), (int)mode);
+        return allocator;
+    }
+}
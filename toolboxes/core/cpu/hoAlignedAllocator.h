@@ -0,0 +1,74 @@
+/** \file   hoAlignedAllocator.h
+    \brief  Aligned and huge page backed storage for hoNDArray
+
+            All allocations are aligned to at least 64 bytes, so that SIMD loads and FFTW plans created for
+            aligned data can be used on every array. Allocations above the huge page threshold can be backed
+            by transparent huge pages (advised with madvise) or by explicit huge pages from the hugetlb pool,
+            which cuts TLB misses on multi-GB buffers. Explicit huge pages fall back to transparent ones when
+            the pool is exhausted. Huge pages are only available on Linux.
+
+            The allocator can be selected for the whole process with hoMemoryAllocator::set_default, for a
+            thread or a single array with hoMemoryAllocatorScope, or through the environment:
+
+                GADGETRON_MEMORY_ALIGNMENT=64         use the aligned allocator as process default
+                GADGETRON_HUGE_PAGES=transparent      (or explicit) back large arrays with huge pages
+*/
+
+#pragma once
+
+#include "hoMemoryArena.h"
+
+#include <cstddef>
+
+#define GADGETRON_MEMORY_ALIGNMENT_ENVIRONMENT "GADGETRON_MEMORY_ALIGNMENT"
+#define GADGETRON_HUGE_PAGES_ENVIRONMENT "GADGETRON_HUGE_PAGES"
+
+namespace Gadgetron
+{
+    class EXPORTCPUCORE hoAlignedAllocator : public hoMemoryAllocator
+    {
+    public:
+
+        enum HugePageMode
+        {
+            HUGE_PAGES_NONE,
+            HUGE_PAGES_TRANSPARENT,
+            HUGE_PAGES_EXPLICIT
+        };
+
+        enum
+        {
+            MIN_ALIGNMENT = 64,
+            HUGE_PAGE_SIZE = 2*1024*1024,
+            DEFAULT_HUGE_PAGE_THRESHOLD = 32*1024*1024
+        };
+
+        /// alignment is rounded up to a power of two of at least MIN_ALIGNMENT
+        hoAlignedAllocator(size_t alignment = MIN_ALIGNMENT, HugePageMode mode = HUGE_PAGES_NONE, size_t huge_page_threshold = DEFAULT_HUGE_PAGE_THRESHOLD);
+        virtual ~hoAlignedAllocator();
+
+        virtual void* allocate(size_t bytes);
+        virtual void deallocate(void* p);
+
+        size_t alignment() const { return alignment_; }
+        HugePageMode huge_page_mode() const { return mode_; }
+        size_t huge_page_threshold() const { return huge_page_threshold_; }
+
+        /// allocator configured by GADGETRON_MEMORY_ALIGNMENT / GADGETRON_HUGE_PAGES, NULL if neither is set
+        static hoAlignedAllocator* from_environment();
+
+    protected:
+
+        void* allocate_aligned(size_t bytes, size_t alignment);
+        void* allocate_huge_pages(size_t bytes);
+
+        size_t alignment_;
+        HugePageMode mode_;
+        size_t huge_page_threshold_;
+
+    private:
+
+        hoAlignedAllocator(const hoAlignedAllocator&);
+        hoAlignedAllocator& operator=(const hoAlignedAllocator&);
+    };
+}
@@ -0,0 +1,731 @@
+#include "hoMemoryArena.h"
+#include "hoAlignedAllocator.h"
+#include "log.h"
+
+#include <boost/thread/tss.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+    #include <malloc.h>
+#endif
+
+namespace Gadgetron
+{
+    // ------------------------------------------------------------------------
+    // allocator registry
+    // ------------------------------------------------------------------------
+
+    namespace
+    {
+        struct ThreadMemoryState
+        {
+            ThreadMemoryState() : current_(NULL), arena_(NULL) {}
+            ~ThreadMemoryState() { delete arena_; }
+
+            hoMemoryAllocator* current_;
+            hoMemoryArena* arena_;
+        };
+
+        boost::thread_specific_ptr<ThreadMemoryState>& thread_memory_state()
+        {
+            static boost::thread_specific_ptr<ThreadMemoryState> state;
+            return state;
+        }
+
+        ThreadMemoryState* get_thread_memory_state()
+        {
+            ThreadMemoryState* s = thread_memory_state().get();
+            if ( s == NULL )
+            {
+                s = new ThreadMemoryState();
+                thread_memory_state().reset(s);
+            }
+            return s;
+        }
+
+        // ranges aligned to RANGE_GRANULARITY are entered per granule in a two level table indexed by address,
+        // so the owner of a pointer is found with two loads; a granule belongs to at most one range
+        enum
+        {
+            GRANULE_BITS = 16,
+            LEAF_BITS = 16,
+            ROOT_BITS = 16  // 48 bit address space
+        };
+
+        static_assert((size_t(1)<<GRANULE_BITS) == hoMemoryAllocator::RANGE_GRANULARITY, "granule of the range table");
+
+        struct GranuleLeaf
+        {
+            std::atomic<hoMemoryAllocator*> owner_[size_t(1)<<LEAF_BITS];
+        };
+
+        // other ranges (the _aligned_malloc allocations on Windows) are kept in a list that is scanned;
+        // begin_ is NULL for a free slot, end_ and owner_ are written before begin_ is published
+        struct MemoryRange
+        {
+            std::atomic<const char*> begin_;
+            std::atomic<const char*> end_;
+            std::atomic<hoMemoryAllocator*> owner_;
+        };
+
+        struct MemoryRangeChunk
+        {
+            enum { SLOTS = 256 };
+
+            MemoryRangeChunk() : next_(NULL)
+            {
+                for ( size_t i=0; i<SLOTS; i++ )
+                {
+                    ranges_[i].begin_.store(NULL);
+                    ranges_[i].end_.store(NULL);
+                    ranges_[i].owner_.store(NULL);
+                }
+            }
+
+            MemoryRange ranges_[SLOTS];
+            std::atomic<MemoryRangeChunk*> next_;
+        };
+
+        // leaves and chunks are never freed, so find_owner can read them while other threads register and
+        // unregister; only the writers take the mutex
+        struct MemoryRegistry
+        {
+            MemoryRegistry() : count_(0), listed_(0), used_(0), leaves_(new std::atomic<GranuleLeaf*>[size_t(1)<<ROOT_BITS]()) {}
+
+            // the table slot of the granule holding p, NULL if p is outside of the table or its leaf does not exist
+            std::atomic<hoMemoryAllocator*>* granule(const void* p)
+            {
+                size_t g = reinterpret_cast<size_t>(p) >> GRANULE_BITS;
+                if ( (g >> LEAF_BITS) >= (size_t(1)<<ROOT_BITS) ) return NULL;
+
+                GranuleLeaf* leaf = leaves_[g >> LEAF_BITS].load(std::memory_order_acquire);
+                if ( leaf == NULL ) return NULL;
+
+                return &leaf->owner_[g & ((size_t(1)<<LEAF_BITS)-1)];
+            }
+
+            // as granule(), creating the leaf; called with the mutex held
+            std::atomic<hoMemoryAllocator*>* create_granule(const void* p)
+            {
+                size_t g = reinterpret_cast<size_t>(p) >> GRANULE_BITS;
+                std::atomic<GranuleLeaf*>& root = leaves_[g >> LEAF_BITS];
+                if ( root.load(std::memory_order_relaxed) == NULL ) root.store(new GranuleLeaf(), std::memory_order_release);
+                return granule(p);
+            }
+
+            // true if [begin, begin+bytes) can be entered in the table
+            static bool in_table(const char* begin, size_t bytes)
+            {
+                size_t b = reinterpret_cast<size_t>(begin);
+                if ( b % hoMemoryAllocator::RANGE_GRANULARITY != 0 || bytes % hoMemoryAllocator::RANGE_GRANULARITY != 0 || bytes == 0 ) return false;
+                return ((b + bytes - 1) >> (GRANULE_BITS + LEAF_BITS)) < (size_t(1)<<ROOT_BITS);
+            }
+
+            // list slot i, the chunks up to i must exist
+            MemoryRange& range(size_t i)
+            {
+                MemoryRangeChunk* chunk = &first_;
+                for ( ; i>=MemoryRangeChunk::SLOTS; i-=MemoryRangeChunk::SLOTS ) chunk = chunk->next_.load(std::memory_order_acquire);
+                return chunk->ranges_[i];
+            }
+
+            // the list slot holding begin, NULL if not listed; called with the mutex held
+            MemoryRange* find(const char* begin)
+            {
+                size_t used = used_.load(std::memory_order_relaxed);
+                for ( size_t i=0; i<used; i++ )
+                {
+                    MemoryRange& r = range(i);
+                    if ( r.begin_.load(std::memory_order_relaxed) == begin ) return &r;
+                }
+                return NULL;
+            }
+
+            std::mutex mutex_;
+            std::atomic<size_t> count_;     // registered ranges
+            std::atomic<size_t> listed_;    // registered ranges in the list
+            std::atomic<size_t> used_;      // list slots ever used, find_owner scans these
+            std::atomic<GranuleLeaf*>* leaves_;
+            std::map<const char*, size_t> table_ranges_;   // size of the ranges in the table, to unregister them
+            MemoryRangeChunk first_;
+        };
+
+        // never destroyed, arrays and thread arenas may release memory during static destruction
+        MemoryRegistry& memory_registry()
+        {
+            static MemoryRegistry* registry = new MemoryRegistry();
+            return *registry;
+        }
+
+        // owner of the blocks of arenas destroyed while their allocations were still alive
+        class hoOrphanedMemory : public hoMemoryAllocator
+        {
+        public:
+            virtual void* allocate(size_t) { return NULL; }
+            virtual void deallocate(void*) {}
+        };
+
+        hoMemoryAllocator* orphaned_memory()
+        {
+            static hoOrphanedMemory* orphaned = new hoOrphanedMemory();
+            return orphaned;
+        }
+    }
+
+    static std::atomic<hoMemoryAllocator*>& default_allocator()
+    {
+        static std::atomic<hoMemoryAllocator*> allocator(hoAlignedAllocator::from_environment());
+        return allocator;
+    }
+
+    hoMemoryAllocator* hoMemoryAllocator::get_default()
+    {
+        return default_allocator().load(std::memory_order_acquire);
+    }
+
+    void hoMemoryAllocator::set_default(hoMemoryAllocator* allocator)
+    {
+        default_allocator().store(allocator, std::memory_order_release);
+    }
+
+    hoMemoryAllocator* hoMemoryAllocator::current()
+    {
+        ThreadMemoryState* s = thread_memory_state().get();
+        return (s != NULL) ? s->current_ : NULL;
+    }
+
+    void hoMemoryAllocator::set_current(hoMemoryAllocator* allocator)
+    {
+        get_thread_memory_state()->current_ = allocator;
+    }
+
+    bool hoMemoryAllocator::has_registered_ranges()
+    {
+        return memory_registry().count_.load(std::memory_order_acquire) > 0;
+    }
+
+    hoMemoryAllocator* hoMemoryAllocator::find_owner(const void* p)
+    {
+        MemoryRegistry& r = memory_registry();
+        if ( r.count_.load(std::memory_order_acquire) == 0 ) return NULL;
+
+        // the range holding a live allocation can not be unregistered meanwhile
+        std::atomic<hoMemoryAllocator*>* g = r.granule(p);
+        if ( g != NULL )
+        {
+            hoMemoryAllocator* owner = g->load(std::memory_order_acquire);
+            if ( owner != NULL ) return owner;
+        }
+
+        if ( r.listed_.load(std::memory_order_acquire) == 0 ) return NULL;
+
+        const char* c = static_cast<const char*>(p);
+
+        // a slot reused by another range while it is read is detected by reading begin_ again
+        size_t used = r.used_.load(std::memory_order_acquire);
+        MemoryRangeChunk* chunk = &r.first_;
+        for ( size_t i=0; i<used && chunk!=NULL; i++ )
+        {
+            if ( i>0 && i%MemoryRangeChunk::SLOTS == 0 ) chunk = chunk->next_.load(std::memory_order_acquire);
+            if ( chunk == NULL ) break;
+
+            MemoryRange& range = chunk->ranges_[i%MemoryRangeChunk::SLOTS];
+
+            const char* begin = range.begin_.load(std::memory_order_acquire);
+            if ( begin == NULL || c < begin ) continue;
+
+            const char* end = range.end_.load(std::memory_order_acquire);
+            hoMemoryAllocator* owner = range.owner_.load(std::memory_order_acquire);
+            if ( range.begin_.load(std::memory_order_acquire) != begin ) continue;
+
+            if ( c < end ) return owner;
+        }
+
+        return NULL;
+    }
+
+    void hoMemoryAllocator::register_range(hoMemoryAllocator* allocator, const void* begin, size_t bytes)
+    {
+        MemoryRegistry& r = memory_registry();
+        const char* c = static_cast<const char*>(begin);
+
+        std::lock_guard<std::mutex> guard(r.mutex_);
+
+        if ( MemoryRegistry::in_table(c, bytes) )
+        {
+            // a range registered again changes its owner
+            std::map<const char*, size_t>::iterator it = r.table_ranges_.find(c);
+            bool registered = (it != r.table_ranges_.end());
+            if ( registered ) bytes = it->second;
+
+            for ( size_t offset=0; offset<bytes; offset+=RANGE_GRANULARITY )
+            {
+                r.create_granule(c + offset)->store(allocator, std::memory_order_release);
+            }
+
+            if ( !registered )
+            {
+                r.table_ranges_[c] = bytes;
+                r.count_.fetch_add(1, std::memory_order_release);
+            }
+            return;
+        }
+
+        MemoryRange* range = r.find(c);
+        if ( range != NULL )
+        {
+            range->end_.store(c + bytes, std::memory_order_release);
+            range->owner_.store(allocator, std::memory_order_release);
+            return;
+        }
+
+        size_t used = r.used_.load(std::memory_order_relaxed);
+        size_t i;
+        for ( i=0; i<used; i++ )
+        {
+            if ( r.range(i).begin_.load(std::memory_order_relaxed) == NULL ) break;
+        }
+
+        // all slots are taken, the chunk for slot i exists unless i starts a new one
+        if ( i == used && i>0 && i%MemoryRangeChunk::SLOTS == 0 )
+        {
+            MemoryRangeChunk* last = &r.first_;
+            while ( last->next_.load(std::memory_order_relaxed) != NULL ) last = last->next_.load(std::memory_order_relaxed);
+            last->next_.store(new MemoryRangeChunk(), std::memory_order_release);
+        }
+
+        range = &r.range(i);
+        range->end_.store(c + bytes, std::memory_order_relaxed);
+        range->owner_.store(allocator, std::memory_order_relaxed);
+        range->begin_.store(c, std::memory_order_release);
+
+        if ( i == used ) r.used_.store(used+1, std::memory_order_release);
+        r.listed_.fetch_add(1, std::memory_order_release);
+        r.count_.fetch_add(1, std::memory_order_release);
+    }
+
+    void hoMemoryAllocator::unregister_range(const void* begin)
+    {
+        MemoryRegistry& r = memory_registry();
+        const char* c = static_cast<const char*>(begin);
+
+        std::lock_guard<std::mutex> guard(r.mutex_);
+
+        std::map<const char*, size_t>::iterator it = r.table_ranges_.find(c);
+        if ( it != r.table_ranges_.end() )
+        {
+            for ( size_t offset=0; offset<it->second; offset+=RANGE_GRANULARITY )
+            {
+                r.granule(c + offset)->store(NULL, std::memory_order_release);
+            }
+
+            r.table_ranges_.erase(it);
+            r.count_.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+
+        MemoryRange* range = r.find(c);
+        if ( range == NULL ) return;
+
+        range->begin_.store(NULL, std::memory_order_release);
+        r.listed_.fetch_sub(1, std::memory_order_release);
+        r.count_.fetch_sub(1, std::memory_order_release);
+    }
+
+    // ------------------------------------------------------------------------
+
+    hoMemoryAllocatorScope::hoMemoryAllocatorScope(hoMemoryAllocator* allocator) : previous_(hoMemoryAllocator::current())
+    {
+        hoMemoryAllocator::set_current(allocator);
+    }
+
+    hoMemoryAllocatorScope::~hoMemoryAllocatorScope()
+    {
+        hoMemoryAllocator::set_current(previous_);
+    }
+
+    // ------------------------------------------------------------------------
+    // arena
+    // ------------------------------------------------------------------------
+
+    struct hoMemoryArena::Impl
+    {
+        struct Block
+        {
+            char* data_;    // aligned to RANGE_GRANULARITY
+            size_t size_;   // multiple of RANGE_GRANULARITY
+        };
+
+        struct Position
+        {
+            size_t block_;
+            size_t offset_;
+
+            bool operator<(const Position& p) const
+            {
+                return (block_ < p.block_) || (block_ == p.block_ && offset_ < p.offset_);
+            }
+
+            bool operator<=(const Position& p) const
+            {
+                return !(p < *this);
+            }
+        };
+
+        struct Mark
+        {
+            Position pos_;
+            size_t live_;   // allocations above pos_ and below the next mark that are still alive
+        };
+
+        // precedes every allocation, padded so that the allocation stays aligned
+        struct Header
+        {
+            size_t bytes_;  // including the header
+            size_t block_;
+        };
+
+        std::mutex mutex_;
+        size_t block_size_;
+        size_t max_retained_bytes_;
+        bool release_pending_;      // reset() was called while allocations were alive
+        std::vector<Block> blocks_;
+        Position top_;
+        std::vector<Mark> marks_;
+
+        size_t allocations_;
+        size_t live_;
+        size_t peak_bytes_;
+        size_t block_allocations_;
+
+        static size_t align(size_t bytes)
+        {
+            return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        }
+
+        size_t bytes_in_use() const
+        {
+            size_t bytes = top_.offset_;
+            for ( size_t b=0; b<top_.block_ && b<blocks_.size(); b++ ) bytes += blocks_[b].size_;
+            return bytes;
+        }
+
+        size_t capacity() const
+        {
+            size_t bytes = 0;
+            for ( size_t b=0; b<blocks_.size(); b++ ) bytes += blocks_[b].size_;
+            return bytes;
+        }
+
+        // blocks are granule aligned, so the registry finds their owner in O(1)
+        bool add_block(hoMemoryArena* arena, size_t size)
+        {
+            Block block;
+            block.size_ = (size + RANGE_GRANULARITY - 1) / RANGE_GRANULARITY * RANGE_GRANULARITY;
+
+#ifdef _WIN32
+            block.data_ = static_cast<char*>(_aligned_malloc(block.size_, RANGE_GRANULARITY));
+#else
+            void* p = NULL;
+            block.data_ = (posix_memalign(&p, RANGE_GRANULARITY, block.size_) == 0) ? static_cast<char*>(p) : NULL;
+#endif
+            if ( block.data_ == NULL ) return false;
+
+            blocks_.push_back(block);
+            block_allocations_++;
+
+            hoMemoryAllocator::register_range(arena, block.data_, block.size_);
+            return true;
+        }
+
+        void free_blocks(size_t first)
+        {
+            for ( size_t b=first; b<blocks_.size(); b++ )
+            {
+                hoMemoryAllocator::unregister_range(blocks_[b].data_);
+#ifdef _WIN32
+                _aligned_free(blocks_[b].data_);
+#else
+                std::free(blocks_[b].data_);
+#endif
+            }
+            blocks_.resize(first);
+        }
+
+        // nothing is alive any more; the next unit most likely needs the same amount of memory, so the
+        // blocks are kept (merged into one if the last unit had to grow) unless they exceed the retained limit
+        // or a reset() is pending
+        void rewind(hoMemoryArena* arena)
+        {
+            top_.block_ = 0;
+            top_.offset_ = 0;
+            for ( size_t m=0; m<marks_.size(); m++ ) marks_[m].pos_ = top_;
+
+            size_t bytes = this->capacity();
+            if ( release_pending_ || bytes > max_retained_bytes_ )
+            {
+                free_blocks(0);
+                release_pending_ = false;
+            }
+            else if ( blocks_.size() > 1 )
+            {
+                free_blocks(0);
+                add_block(arena, bytes);
+            }
+        }
+    };
+
+    hoMemoryArena::hoMemoryArena(size_t block_size, size_t max_retained_bytes) : impl_(new Impl())
+    {
+        impl_->block_size_ = Impl::align(block_size>0 ? block_size : (size_t)DEFAULT_BLOCK_SIZE);
+        impl_->max_retained_bytes_ = max_retained_bytes;
+        impl_->release_pending_ = false;
+        impl_->top_.block_ = 0;
+        impl_->top_.offset_ = 0;
+        impl_->allocations_ = 0;
+        impl_->live_ = 0;
+        impl_->peak_bytes_ = 0;
+        impl_->block_allocations_ = 0;
+
+        Impl::Mark base;
+        base.pos_ = impl_->top_;
+        base.live_ = 0;
+        impl_->marks_.push_back(base);
+    }
+
+    hoMemoryArena::~hoMemoryArena()
+    {
+        if ( impl_->live_ > 0 )
+        {
+            // the blocks can not be released safely, hand them to an owner that never frees
+            GERROR("hoMemoryArena destroyed with %d allocations still alive, leaking %d blocks\n", (int)impl_->live_, (int)impl_->blocks_.size());
+            for ( size_t b=0; b<impl_->blocks_.size(); b++ )
+            {
+                hoMemoryAllocator::register_range(orphaned_memory(), impl_->blocks_[b].data_, impl_->blocks_[b].size_);
+            }
+        }
+        else
+        {
+            impl_->free_blocks(0);
+        }
+
+        delete impl_;
+    }
+
+    void* hoMemoryArena::allocate(size_t bytes)
+    {
+        std::lock_guard<std::mutex> guard(impl_->mutex_);
+
+        size_t need = Impl::align(bytes) + Impl::align(sizeof(Impl::Header));
+
+        if ( impl_->blocks_.empty() )
+        {
+            if ( !impl_->add_block(this, std::max(impl_->block_size_, need)) ) return NULL;
+            impl_->top_.block_ = 0;
+            impl_->top_.offset_ = 0;
+        }
+        else if ( impl_->top_.offset_ + need > impl_->blocks_[impl_->top_.block_].size_ )
+        {
+            // blocks after the top are unused, reuse the next one if it is large enough
+            size_t next = impl_->top_.block_ + 1;
+            if ( next >= impl_->blocks_.size() || impl_->blocks_[next].size_ < need )
+            {
+                impl_->free_blocks(next);
+                if ( !impl_->add_block(this, std::max(impl_->block_size_, need)) ) return NULL;
+            }
+
+            impl_->top_.block_ = next;
+            impl_->top_.offset_ = 0;
+        }
+
+        char* h = impl_->blocks_[impl_->top_.block_].data_ + impl_->top_.offset_;
+        Impl::Header* header = reinterpret_cast<Impl::Header*>(h);
+        header->bytes_ = need;
+        header->block_ = impl_->top_.block_;
+
+        impl_->top_.offset_ += need;
+        impl_->marks_.back().live_++;
+        impl_->live_++;
+        impl_->allocations_++;
+
+        size_t in_use = impl_->bytes_in_use();
+        if ( in_use > impl_->peak_bytes_ ) impl_->peak_bytes_ = in_use;
+
+        return h + Impl::align(sizeof(Impl::Header));
+    }
+
+    void hoMemoryArena::deallocate(void* p)
+    {
+        if ( p == NULL ) return;
+
+        std::lock_guard<std::mutex> guard(impl_->mutex_);
+
+        char* h = static_cast<char*>(p) - Impl::align(sizeof(Impl::Header));
+        Impl::Header* header = reinterpret_cast<Impl::Header*>(h);
+
+        Impl::Position pos;
+        pos.block_ = header->block_;
+        pos.offset_ = h - impl_->blocks_[pos.block_].data_;
+
+        // the allocation belongs to the innermost mark below it
+        size_t m = impl_->marks_.size() - 1;
+        while ( m > 0 && pos < impl_->marks_[m].pos_ ) m--;
+        impl_->marks_[m].live_--;
+        impl_->live_--;
+
+        if ( impl_->live_ == 0 )
+        {
+            // nothing is alive, every scope starts over from the beginning
+            if ( impl_->marks_.size() == 1 )
+            {
+                // the last array escaping the scopes is gone
+                impl_->rewind(this);
+            }
+            else
+            {
+                impl_->top_.block_ = 0;
+                impl_->top_.offset_ = 0;
+                for ( size_t k=0; k<impl_->marks_.size(); k++ ) impl_->marks_[k].pos_ = impl_->top_;
+            }
+        }
+        else if ( m == impl_->marks_.size()-1
+            && pos.block_ == impl_->top_.block_
+            && pos.offset_ + header->bytes_ == impl_->top_.offset_ )
+        {
+            // released in reverse order of allocation, the space can be used again right away
+            impl_->top_.offset_ = pos.offset_;
+        }
+    }
+
+    void hoMemoryArena::push_mark()
+    {
+        std::lock_guard<std::mutex> guard(impl_->mutex_);
+
+        Impl::Mark mark;
+        mark.pos_ = impl_->top_;
+        mark.live_ = 0;
+        impl_->marks_.push_back(mark);
+    }
+
+    bool hoMemoryArena::pop_mark()
+    {
+        std::lock_guard<std::mutex> guard(impl_->mutex_);
+
+        if ( impl_->marks_.size() < 2 ) return false;
+
+        Impl::Mark mark = impl_->marks_.back();
+        impl_->marks_.pop_back();
+
+        if ( mark.live_ > 0 )
+        {
+            // allocations escaping the scope now belong to the enclosing one
+            impl_->marks_.back().live_ += mark.live_;
+            return false;
+        }
+
+        if ( mark.pos_ < impl_->top_ ) impl_->top_ = mark.pos_;
+
+        // end of an outermost scope with nothing alive
+        if ( impl_->marks_.size() == 1 && impl_->live_ == 0 ) impl_->rewind(this);
+
+        return true;
+    }
+
+    bool hoMemoryArena::reset()
+    {
+        std::lock_guard<std::mutex> guard(impl_->mutex_);
+
+        if ( impl_->live_ > 0 )
+        {
+            // the blocks go back to the system with the last allocation
+            impl_->release_pending_ = true;
+            return false;
+        }
+
+        impl_->top_.block_ = 0;
+        impl_->top_.offset_ = 0;
+        for ( size_t m=0; m<impl_->marks_.size(); m++ ) impl_->marks_[m].pos_ = impl_->top_;
+
+        impl_->free_blocks(0);
+        impl_->release_pending_ = false;
+        return true;
+    }
+
+    void hoMemoryArena::set_max_retained_bytes(size_t bytes)
+    {
+        std::lock_guard<std::mutex> guard(impl_->mutex_);
+        impl_->max_retained_bytes_ = bytes;
+    }
+
+    hoMemoryArena::Statistics hoMemoryArena::get_statistics()
+    {
+        std::lock_guard<std::mutex> guard(impl_->mutex_);
+
+        Statistics s;
+        s.allocations = impl_->allocations_;
+        s.live_allocations = impl_->live_;
+        s.bytes_in_use = impl_->bytes_in_use();
+        s.peak_bytes_in_use = impl_->peak_bytes_;
+        s.capacity = impl_->capacity();
+        s.blocks = impl_->blocks_.size();
+        s.block_allocations = impl_->block_allocations_;
+        return s;
+    }
+
+    hoMemoryArena* hoMemoryArena::thread_arena()
+    {
+        ThreadMemoryState* s = get_thread_memory_state();
+        if ( s->arena_ == NULL ) s->arena_ = new hoMemoryArena();
+        return s->arena_;
+    }
+
+    // ------------------------------------------------------------------------
+
+    hoMemoryArenaScope::hoMemoryArenaScope() : arena_(hoMemoryArena::thread_arena()), previous_(hoMemoryAllocator::current())
+    {
+        arena_->push_mark();
+        hoMemoryAllocator::set_current(arena_);
+    }
+
+    hoMemoryArenaScope::hoMemoryArenaScope(hoMemoryArena& arena) : arena_(&arena), previous_(hoMemoryAllocator::current())
+    {
+        arena_->push_mark();
+        hoMemoryAllocator::set_current(arena_);
+    }
+
+    hoMemoryArenaScope::~hoMemoryArenaScope()
+    {
+        hoMemoryAllocator::set_current(previous_);
+        arena_->pop_mark();
+    }
+
+    // ------------------------------------------------------------------------
+
+    void* ho_allocate_memory(size_t bytes)
+    {
+        hoMemoryAllocator* allocator = hoMemoryAllocator::current();
+        if ( allocator == NULL ) allocator = hoMemoryAllocator::get_default();
+        if ( allocator != NULL ) return allocator->allocate(bytes);
+        return std::malloc(bytes);
+    }
+
+    void ho_deallocate_memory(void* p)
+    {
+        if ( p == NULL ) return;
+
+        hoMemoryAllocator* owner = hoMemoryAllocator::find_owner(p);
+        if ( owner != NULL )
+        {
+            owner->deallocate(p);
+        }
+        else
+        {
+            std::free(p);
+        }
+    }
+}
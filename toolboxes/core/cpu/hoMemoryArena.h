@@ -0,0 +1,184 @@
+/** \file   hoMemoryArena.h
+    \brief  Pluggable memory allocation for hoNDArray and a per-thread arena for reconstruction temporaries
+
+            hoNDArray storage of plain element types (float, double, complex, vector_td) is obtained with
+            ho_allocate_memory() and released with ho_deallocate_memory(). An allocator installed for the
+            calling thread with hoMemoryAllocatorScope serves all allocations made on that thread while the
+            scope is alive. Other allocations use the process default allocator (see hoAlignedAllocator.h),
+            or malloc/free if there is none.
+
+            hoMemoryArena is a bump allocator for the many same-shaped temporaries created per slice and per
+            iteration in the reconstruction loops. An hoMemoryArenaScope marks the arena top on entry; when
+            everything allocated inside the scope has been released on exit, the arena rewinds to the mark
+            in O(1). Arrays that outlive the scope keep their memory, the arena then only rewinds once they
+            are released as well. The blocks are kept for the next scope, so a loop that wraps every iteration
+            in a scope reuses the same memory instead of going back to the system; if an iteration had to grow
+            the arena, its blocks are merged into one. Blocks above the retained limit, and all blocks on
+            reset(), are returned to the system. The thread arenas live as long as their threads, so a
+            parallel loop that uses them should reset() them when it is done.
+
+            Memory is released to the allocator it came from, even when the array is destroyed on another
+            thread or after the scope has ended. Ranges aligned to RANGE_GRANULARITY (arena blocks, huge page
+            mappings) are entered in a lock-free table indexed by address, so the owner is found in O(1) and
+            releasing memory does not serialize the threads.
+*/
+
+#pragma once
+
+#include "cpucore_export.h"
+
+#include <cstddef>
+
+namespace Gadgetron
+{
+    /**
+     * Memory provider for hoNDArray
+     * Allocators register the address ranges they hand out, so that ho_deallocate_memory can find the owner
+     */
+    class EXPORTCPUCORE hoMemoryAllocator
+    {
+    public:
+
+        enum
+        {
+            /// ranges aligned to and sized in multiples of this are found in O(1), others with a scan
+            RANGE_GRANULARITY = 64*1024
+        };
+
+        virtual ~hoMemoryAllocator() {}
+
+        virtual void* allocate(size_t bytes) = 0;
+        virtual void deallocate(void* p) = 0;
+
+        /// allocator used by the calling thread, NULL for malloc/free
+        static hoMemoryAllocator* current();
+        static void set_current(hoMemoryAllocator* allocator);
+
+        /// allocator used by threads without their own, NULL for malloc/free; initially taken from the environment
+        static hoMemoryAllocator* get_default();
+        static void set_default(hoMemoryAllocator* allocator);
+
+        /// the allocator owning p, NULL if p is not in a registered range; lock free
+        static hoMemoryAllocator* find_owner(const void* p);
+
+        /// true if any allocator has registered memory, otherwise everything came from malloc
+        static bool has_registered_ranges();
+
+    protected:
+
+        /// memory in [begin, begin+bytes) handed out by this allocator must be released through it
+        static void register_range(hoMemoryAllocator* allocator, const void* begin, size_t bytes);
+        static void unregister_range(const void* begin);
+    };
+
+    /**
+     * Installs an allocator for the calling thread and restores the previous one on destruction
+     */
+    class EXPORTCPUCORE hoMemoryAllocatorScope
+    {
+    public:
+
+        explicit hoMemoryAllocatorScope(hoMemoryAllocator* allocator);
+        ~hoMemoryAllocatorScope();
+
+    protected:
+
+        hoMemoryAllocator* previous_;
+
+    private:
+
+        hoMemoryAllocatorScope(const hoMemoryAllocatorScope&);
+        hoMemoryAllocatorScope& operator=(const hoMemoryAllocatorScope&);
+    };
+
+    /**
+     * Stack-like arena, allocations are 64-byte aligned
+     */
+    class EXPORTCPUCORE hoMemoryArena : public hoMemoryAllocator
+    {
+    public:
+
+        enum
+        {
+            ALIGNMENT = 64,
+            DEFAULT_BLOCK_SIZE = 32*1024*1024,
+            DEFAULT_MAX_RETAINED_BYTES = 64*1024*1024
+        };
+
+        struct Statistics
+        {
+            size_t allocations;         // allocations served
+            size_t live_allocations;    // allocations not yet released
+            size_t bytes_in_use;        // distance of the arena top from the start
+            size_t peak_bytes_in_use;
+            size_t capacity;            // bytes held in blocks
+            size_t blocks;
+            size_t block_allocations;   // blocks obtained from the system
+        };
+
+        explicit hoMemoryArena(size_t block_size = DEFAULT_BLOCK_SIZE, size_t max_retained_bytes = DEFAULT_MAX_RETAINED_BYTES);
+        virtual ~hoMemoryArena();
+
+        virtual void* allocate(size_t bytes);
+        virtual void deallocate(void* p);
+
+        /// remember the current top, all allocations made afterwards belong to this mark
+        void push_mark();
+
+        /// rewind to the last mark if all allocations made since have been released, returns true if rewound
+        bool pop_mark();
+
+        /// rewind the whole arena and return its blocks to the system, returns true if done right away
+        /// if allocations are still alive, the blocks are returned once the last of them is released
+        bool reset();
+
+        /// blocks held beyond this many bytes are returned to the system when nothing is alive
+        void set_max_retained_bytes(size_t bytes);
+
+        Statistics get_statistics();
+
+        /// the arena of the calling thread, created on first use and destroyed at thread exit
+        static hoMemoryArena* thread_arena();
+
+    protected:
+
+        struct Impl;
+        Impl* impl_;
+
+    private:
+
+        hoMemoryArena(const hoMemoryArena&);
+        hoMemoryArena& operator=(const hoMemoryArena&);
+    };
+
+    /**
+     * Serves the hoNDArray allocations of the calling thread from an arena while in scope.
+     * Wrap one reconstruction unit (a slice, an iteration) in a scope; temporaries created inside are
+     * released to the arena in O(1) at the end of the scope.
+     */
+    class EXPORTCPUCORE hoMemoryArenaScope
+    {
+    public:
+
+        /// use the arena of the calling thread
+        hoMemoryArenaScope();
+        explicit hoMemoryArenaScope(hoMemoryArena& arena);
+        ~hoMemoryArenaScope();
+
+    protected:
+
+        hoMemoryArena* arena_;
+        hoMemoryAllocator* previous_;
+
+    private:
+
+        hoMemoryArenaScope(const hoMemoryArenaScope&);
+        hoMemoryArenaScope& operator=(const hoMemoryArenaScope&);
+    };
+
+    /// storage for hoNDArray of plain element types, from the allocator of the calling thread, the default allocator or malloc
+    EXPORTCPUCORE void* ho_allocate_memory(size_t bytes);
+
+    /// release memory obtained from ho_allocate_memory, on any thread
+    EXPORTCPUCORE void ho_deallocate_memory(void* p);
+}
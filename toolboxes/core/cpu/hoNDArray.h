@@ -9,6 +9,7 @@
 #include "vector_td.h"
 
 #include "cpucore_export.h"
+#include "hoMemoryArena.h"
 
 #include <string.h>
 #include <float.h>
@@ -177,6 +178,7 @@ namespace Gadgetron{
     }
 
     // Overload these instances to avoid invoking the element class constructor/destructor
+    // Their storage comes from the allocator of the calling thread, see hoMemoryArena.h
     //
 
     virtual void _allocate_memory( size_t size, float** data );
@@ -199,12 +201,12 @@ namespace Gadgetron{
 
     template<class TYPE, unsigned int D> void _allocate_memory( size_t size, vector_td<TYPE,D>** data )
     {
-      *data = (vector_td<TYPE,D>*) malloc( size*sizeof(vector_td<TYPE,D>) );
+      *data = (vector_td<TYPE,D>*) ho_allocate_memory( size*sizeof(vector_td<TYPE,D>) );
     }
 
     template<class TYPE, unsigned int D>  void _deallocate_memory( vector_td<TYPE,D>* data )
     {
-      free( data );
+      ho_deallocate_memory( data );
     }
   };
 }
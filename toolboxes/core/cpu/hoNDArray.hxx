@@ -298,6 +298,7 @@ namespace Gadgetron
     template <typename T>
     hoNDArray<T>::hoNDArray(hoNDArray<T>&& a) : NDArray<T>::NDArray(){
     	data_ = a.data_;
+    	this->delete_data_on_destruct_ = a.delete_data_on_destruct_;
     	*this->dimensions_ = *a.dimensions_;
     	this->elements_ = a.elements_;
     	a.dimensions_.reset();
@@ -344,6 +345,7 @@ namespace Gadgetron
         rhs.dimensions_.reset();
         rhs.offsetFactors_.reset();
         data_ = rhs.data_;
+        this->delete_data_on_destruct_ = rhs.delete_data_on_destruct_;
         rhs.data_ = nullptr;
         return *this;
     }
@@ -897,8 +899,11 @@ namespace Gadgetron
     template <typename T> 
     void hoNDArray<T>::deallocate_memory()
     {
+        // Borrowed data (e.g. a pooled message buffer) is only dropped, the array gets its own memory on the next allocation
         if (!(this->delete_data_on_destruct_)) {
-             throw std::runtime_error("You don't own this data.  You cannot deallocate its memory.");
+            this->data_ = 0x0;
+            this->delete_data_on_destruct_ = true;
+            return;
         }
         
         if( this->data_ ){
@@ -910,73 +915,73 @@ namespace Gadgetron
     template <typename T> 
     inline void hoNDArray<T>::_allocate_memory( size_t size, float** data )
     {
-        *data = (float*) malloc( size*sizeof(float) );
+        *data = (float*) ho_allocate_memory( size*sizeof(float) );
     }
 
     template <typename T> 
     inline void hoNDArray<T>::_deallocate_memory( float* data )
     {
-        free(data);
+        ho_deallocate_memory( data );
     }
 
     template <typename T> 
     inline void hoNDArray<T>::_allocate_memory( size_t size, double** data )
     {
-        *data = (double*) malloc( size*sizeof(double) );
+        *data = (double*) ho_allocate_memory( size*sizeof(double) );
     }
 
     template <typename T> 
     inline void hoNDArray<T>::_deallocate_memory( double* data )
     {
-        free(data);
+        ho_deallocate_memory( data );
     }
 
     template <typename T> 
     inline void hoNDArray<T>::_allocate_memory( size_t size, std::complex<float>** data )
     {
-        *data = (std::complex<float>*) malloc( size*sizeof(std::complex<float>) );
+        *data = (std::complex<float>*) ho_allocate_memory( size*sizeof(std::complex<float>) );
     }
 
     template <typename T> 
     inline void hoNDArray<T>::_deallocate_memory( std::complex<float>* data )
     {
-        free(data);
+        ho_deallocate_memory( data );
     }
 
     template <typename T> 
     inline void hoNDArray<T>::_allocate_memory( size_t size, std::complex<double>** data )
     {
-        *data = (std::complex<double>*) malloc( size*sizeof(std::complex<double>) );
+        *data = (std::complex<double>*) ho_allocate_memory( size*sizeof(std::complex<double>) );
     }
 
     template <typename T> 
     inline void hoNDArray<T>::_deallocate_memory( std::complex<double>* data )
     {
-        free(data);
+        ho_deallocate_memory( data );
     }
 
     template <typename T> 
     inline void hoNDArray<T>::_allocate_memory( size_t size, float_complext** data )
     {
-        *data = (float_complext*) malloc( size*sizeof(float_complext) );
+        *data = (float_complext*) ho_allocate_memory( size*sizeof(float_complext) );
     }
 
     template <typename T> 
     inline void hoNDArray<T>::_deallocate_memory( float_complext* data )
     {
-        free( data );
+        ho_deallocate_memory( data );
     }
 
     template <typename T> 
     inline void hoNDArray<T>::_allocate_memory( size_t size, double_complext** data )
     {
-        *data = (double_complext*) malloc( size*sizeof(double_complext) );
+        *data = (double_complext*) ho_allocate_memory( size*sizeof(double_complext) );
     }
 
     template <typename T> 
     inline void hoNDArray<T>::_deallocate_memory( double_complext* data )
     {
-        free( data );
+        ho_deallocate_memory( data );
     }
 
     template <typename T> 
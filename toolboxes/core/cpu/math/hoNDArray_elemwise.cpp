@@ -2,6 +2,7 @@
 #include "hoNDArray_reductions.h"
 #include "complext.h"
 #include "hoArmadillo.h"
+#include "hoNDArray_simd.h"
 
 #ifdef USE_OMP
     #include <omp.h>
@@ -21,6 +22,9 @@
 
 #define NumElementsUseThreading 64*1024
 
+// large loops are split into blocks of this size, which are processed by the vectorized kernels
+#define NumElementsPerBlock 4096
+
 namespace Gadgetron{
 
   //
@@ -282,6 +286,26 @@ namespace Gadgetron{
 
     // --------------------------------------------------------------------------------
 
+    // multiplication of a contiguous block, complex arrays use the explicit SIMD kernels
+    template <class A, class B, class C>
+    inline void multiply_block(size_t N, const A* a, const B* b, C* c)
+    {
+      for (size_t n=0; n<N; n++ )
+        {
+          c[n] = a[n]*b[n];
+        }
+    }
+
+    inline void multiply_block(size_t N, const complext<float>* a, const complext<float>* b, complext<float>* c)
+    {
+      simd::multiply(N, reinterpret_cast<const std::complex<float>*>(a), reinterpret_cast<const std::complex<float>*>(b), reinterpret_cast<std::complex<float>*>(c));
+    }
+
+    inline void multiply_block(size_t N, const complext<double>* a, const complext<double>* b, complext<double>* c)
+    {
+      simd::multiply(N, reinterpret_cast<const std::complex<double>*>(a), reinterpret_cast<const std::complex<double>*>(b), reinterpret_cast<std::complex<double>*>(c));
+    }
+
     // internal low level function for element-wise multiplication of two arrays
     template <class T, class S>
     void multiply_impl(size_t sizeX, size_t sizeY, const T* x, const S* y, typename mathReturnType<T,S>::type * r)
@@ -299,13 +323,15 @@ namespace Gadgetron{
       if (sizeX==sizeY) {
           // No Broadcasting
           long long loopsize = sizeX;
-          long long n;
+          long long numblocks = (loopsize+NumElementsPerBlock-1)/NumElementsPerBlock;
+          long long blk;
 #ifdef USE_OMP
-#pragma omp parallel for default(none) private(n) shared(loopsize, c, a, b) if (loopsize>NumElementsUseThreading)
+#pragma omp parallel for default(none) private(blk) shared(loopsize, numblocks, c, a, b) if (loopsize>NumElementsUseThreading)
 #endif
-          for (n=0; n< loopsize; n++ )
+          for (blk=0; blk< numblocks; blk++ )
             {
-              c[n] = a[n]*b[n];
+              size_t offset = blk * NumElementsPerBlock;
+              multiply_block(std::min((size_t)NumElementsPerBlock, (size_t)loopsize-offset), &a[offset], &b[offset], &c[offset]);
             }
       } else {
           // Broadcasting
@@ -315,27 +341,23 @@ namespace Gadgetron{
               // No OMP at All
               for (long long outer=0; outer<outerloopsize; outer++) {
                   size_t offset = outer * innerloopsize;
-                  const typename mathInternalType<T>::type * ai= &a[offset];
-                  typename mathInternalType<typename mathReturnType<T,S>::type >::type * ci = &c[offset];
-                  for (long long n=0; n< innerloopsize; n++ )
-                    {
-                      ci[n] = ai[n]*b[n];
-                    }
+                  multiply_block(innerloopsize, &a[offset], b, &c[offset]);
               }
           } else if (innerloopsize>NumElementsUseThreading) {
               // OMP in the inner loop
+              long long numblocks = (innerloopsize+NumElementsPerBlock-1)/NumElementsPerBlock;
               for (long long outer=0; outer<outerloopsize; outer++) {
                   size_t offset = outer * innerloopsize;
                   const typename mathInternalType<T>::type * ai= &a[offset];
                   typename mathInternalType<typename mathReturnType<T,S>::type >::type * ci = &c[offset];
-
-                  long long n;
+                  long long blk;
 #ifdef USE_OMP
-#pragma omp parallel for default(none) private(n) shared(innerloopsize, ci, ai, b)
+#pragma omp parallel for default(none) private(blk) shared(innerloopsize, numblocks, ci, ai, b)
 #endif
-                  for (n=0; n< innerloopsize; n++ )
+                  for (blk=0; blk< numblocks; blk++ )
                     {
-                      ci[n] = ai[n]*b[n];
+                      size_t n = blk * NumElementsPerBlock;
+                      multiply_block(std::min((size_t)NumElementsPerBlock, (size_t)innerloopsize-n), &ai[n], &b[n], &ci[n]);
                     }
               }
           } else {
@@ -346,12 +368,7 @@ namespace Gadgetron{
 #endif
               for (outer=0; outer<outerloopsize; outer++) {
                   size_t offset = outer * innerloopsize;
-                  const typename mathInternalType<T>::type * ai = &a[offset];
-                  typename mathInternalType<typename mathReturnType<T,S>::type >::type * ci = &c[offset];
-                  for (long long n=0; n< innerloopsize; n++ )
-                    {
-                      ci[n] = ai[n]*b[n];
-                    }
+                  multiply_block(innerloopsize, &a[offset], b, &c[offset]);
               }
           }
       }
@@ -528,6 +545,26 @@ namespace Gadgetron{
     // --------------------------------------------------------------------------------
 
 
+    // conjugate multiplication of a contiguous block, complex arrays use the explicit SIMD kernels
+    template <class A, class B, class C>
+    inline void multiplyConj_block(size_t N, const A* a, const B* b, C* c)
+    {
+      for (size_t n=0; n<N; n++ )
+        {
+          c[n] = a[n]*conj(b[n]);
+        }
+    }
+
+    inline void multiplyConj_block(size_t N, const complext<float>* a, const complext<float>* b, complext<float>* c)
+    {
+      simd::multiplyConj(N, reinterpret_cast<const std::complex<float>*>(a), reinterpret_cast<const std::complex<float>*>(b), reinterpret_cast<std::complex<float>*>(c));
+    }
+
+    inline void multiplyConj_block(size_t N, const complext<double>* a, const complext<double>* b, complext<double>* c)
+    {
+      simd::multiplyConj(N, reinterpret_cast<const std::complex<double>*>(a), reinterpret_cast<const std::complex<double>*>(b), reinterpret_cast<std::complex<double>*>(c));
+    }
+
     // internal low level function for element-wise multiplication of two arrays
     template <class T, class S>
     void multiplyConj_impl(size_t sizeX, size_t sizeY, const T* x, const S* y, typename mathReturnType<T,S>::type * r)
@@ -545,13 +582,15 @@ namespace Gadgetron{
       if (sizeX==sizeY) {
           // No Broadcasting
           long long loopsize = sizeX;
-          long long n;
+          long long numblocks = (loopsize+NumElementsPerBlock-1)/NumElementsPerBlock;
+          long long blk;
 #ifdef USE_OMP
-#pragma omp parallel for default(none) private(n) shared(loopsize, c, a, b) if (loopsize>NumElementsUseThreading)
+#pragma omp parallel for default(none) private(blk) shared(loopsize, numblocks, c, a, b) if (loopsize>NumElementsUseThreading)
 #endif
-          for (n=0; n< loopsize; n++ )
+          for (blk=0; blk< numblocks; blk++ )
             {
-              c[n] = a[n]*conj(b[n]);
+              size_t offset = blk * NumElementsPerBlock;
+              multiplyConj_block(std::min((size_t)NumElementsPerBlock, (size_t)loopsize-offset), &a[offset], &b[offset], &c[offset]);
             }
       } else {
           // Broadcasting
@@ -561,26 +600,23 @@ namespace Gadgetron{
               // No OMP at All
               for (long long outer=0; outer<outerloopsize; outer++) {
                   size_t offset = outer * innerloopsize;
-                  const typename mathInternalType<T>::type * ai= &a[offset];
-                  typename mathInternalType<typename mathReturnType<T,S>::type >::type * ci = &c[offset];
-                  for (long long n=0; n< innerloopsize; n++ )
-                    {
-                      ci[n] = ai[n]*conj(b[n]);
-                    }
+                  multiplyConj_block(innerloopsize, &a[offset], b, &c[offset]);
               }
           } else if (innerloopsize>NumElementsUseThreading) {
               // OMP in the inner loop
+              long long numblocks = (innerloopsize+NumElementsPerBlock-1)/NumElementsPerBlock;
               for (long long outer=0; outer<outerloopsize; outer++) {
                   size_t offset = outer * innerloopsize;
                   const typename mathInternalType<T>::type * ai= &a[offset];
                   typename mathInternalType<typename mathReturnType<T,S>::type >::type * ci = &c[offset];
-                  long long n;
+                  long long blk;
 #ifdef USE_OMP
-#pragma omp parallel for default(none) private(n) shared(innerloopsize, ci, ai, b)
+#pragma omp parallel for default(none) private(blk) shared(innerloopsize, numblocks, ci, ai, b)
 #endif
-                  for (n=0; n< innerloopsize; n++ )
+                  for (blk=0; blk< numblocks; blk++ )
                     {
-                      ci[n] = ai[n]*conj(b[n]);
+                      size_t n = blk * NumElementsPerBlock;
+                      multiplyConj_block(std::min((size_t)NumElementsPerBlock, (size_t)innerloopsize-n), &ai[n], &b[n], &ci[n]);
                     }
               }
           } else {
@@ -591,12 +627,7 @@ namespace Gadgetron{
 #endif
               for (outer=0; outer<outerloopsize; outer++) {
                   size_t offset = outer * innerloopsize;
-                  const typename mathInternalType<T>::type * ai = &a[offset];
-                  typename mathInternalType<typename mathReturnType<T,S>::type >::type * ci = &c[offset];
-                  for (long long n=0; n< innerloopsize; n++ )
-                    {
-                      ci[n] = ai[n]*conj(b[n]);
-                    }
+                  multiplyConj_block(innerloopsize, &a[offset], b, &c[offset]);
               }
           }
       }
@@ -704,33 +735,27 @@ namespace Gadgetron{
 
     inline void addEpsilon(size_t N,  std::complex<float> * x)
     {
-        const float eps = std::numeric_limits<float>::epsilon();
-
-        long long n;
+        long long numblocks = (N+NumElementsPerBlock-1)/NumElementsPerBlock;
+        long long blk;
 
-        #pragma omp parallel for private(n) if (N>NumElementsUseThreading)
-        for (n=0; n<(long long)N; n++ )
+        #pragma omp parallel for private(blk) shared(N, numblocks, x) if (N>NumElementsUseThreading)
+        for (blk=0; blk<numblocks; blk++ )
         {
-            if ( std::abs(x[n]) < eps )
-            {
-                reinterpret_cast<float(&)[2]>(x[n])[0] += eps;
-            }
+            size_t n = blk*NumElementsPerBlock;
+            simd::addEpsilon(std::min((size_t)NumElementsPerBlock, N-n), x+n);
         }
     }
 
     inline void addEpsilon(size_t N,  std::complex<double> * x)
     {
-        const double eps = std::numeric_limits<double>::epsilon();
-
-        long long n;
+        long long numblocks = (N+NumElementsPerBlock-1)/NumElementsPerBlock;
+        long long blk;
 
-        #pragma omp parallel for private(n) if (N>NumElementsUseThreading)
-        for (n=0; n<(long long)N; n++ )
+        #pragma omp parallel for private(blk) shared(N, numblocks, x) if (N>NumElementsUseThreading)
+        for (blk=0; blk<numblocks; blk++ )
         {
-            if ( std::abs(x[n]) < eps )
-            {
-                reinterpret_cast<double(&)[2]>(x[n])[0] += eps;
-            }
+            size_t n = blk*NumElementsPerBlock;
+            simd::addEpsilon(std::min((size_t)NumElementsPerBlock, N-n), x+n);
         }
     }
 
@@ -816,58 +841,38 @@ namespace Gadgetron{
 
     inline void abs(size_t N, const  std::complex<float> * x, float* r)
     {
-        long long n;
+        long long numblocks = (N+NumElementsPerBlock-1)/NumElementsPerBlock;
+        long long blk;
 
-        #pragma omp parallel for default(none) private(n) shared(N, x, r) if (N>NumElementsUseThreading)
-        for ( n=0; n<(long long)N; n++ )
+        #pragma omp parallel for default(none) private(blk) shared(N, numblocks, x, r) if (N>NumElementsUseThreading)
+        for ( blk=0; blk<numblocks; blk++ )
         {
-            const  std::complex<float> & c = x[n];
-            const float re = c.real();
-            const float im = c.imag();
-            r[n]= std::sqrt( (re*re) + (im * im) );
+            size_t n = blk*NumElementsPerBlock;
+            simd::abs(std::min((size_t)NumElementsPerBlock, N-n), x+n, r+n);
         }
     }
 
     inline void abs(size_t N, const  std::complex<double> * x, double* r)
     {
-        long long n;
+        long long numblocks = (N+NumElementsPerBlock-1)/NumElementsPerBlock;
+        long long blk;
 
-        #pragma omp parallel for default(none) private(n) shared(N, x, r) if (N>NumElementsUseThreading)
-        for ( n=0; n<(long long)N; n++ )
+        #pragma omp parallel for default(none) private(blk) shared(N, numblocks, x, r) if (N>NumElementsUseThreading)
+        for ( blk=0; blk<numblocks; blk++ )
         {
-            const  std::complex<double> & c = x[n];
-            const double re = c.real();
-            const double im = c.imag();
-            r[n]= std::sqrt( (re*re) + (im * im) );
+            size_t n = blk*NumElementsPerBlock;
+            simd::abs(std::min((size_t)NumElementsPerBlock, N-n), x+n, r+n);
         }
     }
 
     void abs(size_t N, const complext<float> * x, float* r)
     {
-        long long n;
-
-        #pragma omp parallel for private(n) shared(N, x, r) if (N>NumElementsUseThreading)
-        for ( n=0; n<(long long)N; n++ )
-        {
-            const  complext<float> & c = x[n];
-            const float re = c.real();
-            const float im = c.imag();
-            r[n]= std::sqrt( (re*re) + (im * im) );
-        }
+        abs(N, reinterpret_cast<const std::complex<float>*>(x), r);
     }
 
     void abs(size_t N, const complext<double> * x, double* r)
     {
-        long long n;
-
-        #pragma omp parallel for private(n) shared(N, x, r) if (N>NumElementsUseThreading)
-        for ( n=0; n<(long long)N; n++ )
-        {
-            const  complext<double> & c = x[n];
-            const double re = c.real();
-            const double im = c.imag();
-            r[n]= std::sqrt( (re*re) + (im * im) );
-        }
+        abs(N, reinterpret_cast<const std::complex<double>*>(x), r);
     }
 
     template <typename T> 
@@ -908,7 +908,7 @@ void potrf(hoNDArray<T>& A, char uplo)
         {
             cpotrf_(&uplo, &n, reinterpret_cast<lapack_complex_float*>(pA), &lda, &info);
         }
-        else if ( (typeid(T)==typeid( std::complex<float> )) || (typeid(T)==typeid( complext<double> )) )
+        else if ( (typeid(T)==typeid( std::complex<double> )) || (typeid(T)==typeid( complext<double> )) )
         {
             zpotrf_(&uplo, &n, reinterpret_cast<lapack_complex_double*>(pA), &lda, &info);
         }
@@ -1020,7 +1020,7 @@ void heev(hoNDArray<T>& A, hoNDArray<typename realType<T>::Type>& eigenValue)
             hoNDArray<float> rwork(3*M);
             cheev_(&jobz, &uplo, &M, reinterpret_cast<lapack_complex_float*>(pA), &M, reinterpret_cast<float*>(pEV), reinterpret_cast<lapack_complex_float*>(work.begin()), &lwork, rwork.begin(), &info);
         }
-        else if ( (typeid(T)==typeid( std::complex<float> )) || (typeid(T)==typeid( complext<double> )) )
+        else if ( (typeid(T)==typeid( std::complex<double> )) || (typeid(T)==typeid( complext<double> )) )
         {
             hoNDArray< std::complex<double> > work(M, M);
             hoNDArray<double> rwork(3*M);
@@ -1149,7 +1149,7 @@ void potri(hoNDArray<T>& A)
             cpotri_(&uplo, &n, reinterpret_cast<lapack_complex_float*>(pA), &lda, &info);
             GADGET_CHECK_THROW(info==0);
         }
-        else if ( (typeid(T)==typeid( std::complex<float> )) || (typeid(T)==typeid( complext<double> )) )
+        else if ( (typeid(T)==typeid( std::complex<double> )) || (typeid(T)==typeid( complext<double> )) )
         {
             zpotrf_(&uplo, &n, reinterpret_cast<lapack_complex_double*>(pA), &lda, &info);
             GADGET_CHECK_THROW(info==0);
@@ -1203,7 +1203,7 @@ void trtri(hoNDArray<T>& A, char uplo)
         {
             info = LAPACKE_ctrtri(LAPACK_COL_MAJOR, uplo, diag, n, reinterpret_cast<lapack_complex_float*>(pA), lda);
         }
-        else if ( (typeid(T)==typeid( std::complex<float> )) || (typeid(T)==typeid( complext<double> )) )
+        else if ( (typeid(T)==typeid( std::complex<double> )) || (typeid(T)==typeid( complext<double> )) )
         {
             info = LAPACKE_ztrtri(LAPACK_COL_MAJOR, uplo, diag, n, reinterpret_cast<lapack_complex_double*>(pA), lda);
         }
@@ -1224,7 +1224,7 @@ void trtri(hoNDArray<T>& A, char uplo)
         {
             ctrtri_(&uplo, &diag, &n, reinterpret_cast<lapack_complex_float*>(pA), &lda, &info);
         }
-        else if ( (typeid(T)==typeid( std::complex<float> )) || (typeid(T)==typeid( complext<double> )) )
+        else if ( (typeid(T)==typeid( std::complex<double> )) || (typeid(T)==typeid( complext<double> )) )
         {
             ztrtri_(&uplo, &diag, &n, reinterpret_cast<lapack_complex_double*>(pA), &lda, &info);
         }
@@ -1280,7 +1280,7 @@ void posv(hoNDArray<T>& A, hoNDArray<T>& b)
         {
             info = LAPACKE_cposv(LAPACK_COL_MAJOR, uplo, n, nrhs, reinterpret_cast<lapack_complex_float*>(pA), lda, reinterpret_cast<lapack_complex_float*>(pB), ldb);
         }
-        else if ( (typeid(T)==typeid( std::complex<float> )) || (typeid(T)==typeid( complext<double> )) )
+        else if ( (typeid(T)==typeid( std::complex<double> )) || (typeid(T)==typeid( complext<double> )) )
         {
             info = LAPACKE_zposv(LAPACK_COL_MAJOR, uplo, n, nrhs, reinterpret_cast<lapack_complex_double*>(pA), lda, reinterpret_cast<lapack_complex_double*>(pB), ldb);
         }
@@ -1799,7 +1799,7 @@ void getri(hoNDArray<T>& A)
         {
             info = LAPACKE_cgetri(LAPACK_COL_MAJOR, m, reinterpret_cast<lapack_complex_float*>(pA), lda, reinterpret_cast<lapack_int*>(pIPIV));
         }
-        else if ( (typeid(T)==typeid( std::complex<float> )) || (typeid(T)==typeid( complext<double> )) )
+        else if ( (typeid(T)==typeid( std::complex<double> )) || (typeid(T)==typeid( complext<double> )) )
         {
             info = LAPACKE_zgetri(LAPACK_COL_MAJOR, m, reinterpret_cast<lapack_complex_double*>(pA), lda, reinterpret_cast<lapack_int*>(pIPIV));
         }
@@ -1851,28 +1851,8 @@ template EXPORTCPUCOREMATH void getri(hoNDArray< complext<double> >& A);
 /// ------------------------------------------------------------------------------------
 
 template<typename T>
-void SolveLinearSystem_Tikhonov(hoNDArray<T>& A, hoNDArray<T>& b, hoNDArray<T>& x, double lamda)
+static double apply_Tikhonov_regularization(hoNDArray<T>& AHA, hoNDArray<T>& x, double lamda)
 {
-    GADGET_CHECK_THROW(b.get_size(0)==A.get_size(0));
-
-    hoNDArray<T> AHA(A.get_size(1), A.get_size(1));
-    Gadgetron::clear(AHA);
-
-    // hoNDArray<T> ACopy(A);
-    // GADGET_CHECK_THROW(gemm(AHA, ACopy, true, A, false));
-
-    //GDEBUG_STREAM("SolveLinearSystem_Tikhonov - A = " << Gadgetron::norm2(A));
-    //GDEBUG_STREAM("SolveLinearSystem_Tikhonov - b = " << Gadgetron::norm2(b));
-
-    char uplo = 'L';
-    bool isAHA = true;
-    herk(AHA, A, uplo, isAHA);
-    //GDEBUG_STREAM("SolveLinearSystem_Tikhonov - AHA = " << Gadgetron::norm2(AHA));
-
-    x.create(A.get_size(1), b.get_size(1));
-    gemm(x, A, true, b, false);
-    //GDEBUG_STREAM("SolveLinearSystem_Tikhonov - x = " << Gadgetron::norm2(x));
-
     // apply the Tikhonov regularization
     // Ideally, we shall apply the regularization is lamda*maxEigenValue
     // However, computing the maximal eigenvalue is computational intensive
@@ -1917,6 +1897,34 @@ void SolveLinearSystem_Tikhonov(hoNDArray<T>& A, hoNDArray<T>& b, hoNDArray<T>&
         Gadgetron::scal( scalingFactor, x);
     }
 
+    return trA;
+}
+
+template<typename T>
+void SolveLinearSystem_Tikhonov(hoNDArray<T>& A, hoNDArray<T>& b, hoNDArray<T>& x, double lamda)
+{
+    GADGET_CHECK_THROW(b.get_size(0)==A.get_size(0));
+
+    hoNDArray<T> AHA(A.get_size(1), A.get_size(1));
+    Gadgetron::clear(AHA);
+
+    // hoNDArray<T> ACopy(A);
+    // GADGET_CHECK_THROW(gemm(AHA, ACopy, true, A, false));
+
+    //GDEBUG_STREAM("SolveLinearSystem_Tikhonov - A = " << Gadgetron::norm2(A));
+    //GDEBUG_STREAM("SolveLinearSystem_Tikhonov - b = " << Gadgetron::norm2(b));
+
+    char uplo = 'L';
+    bool isAHA = true;
+    herk(AHA, A, uplo, isAHA);
+    //GDEBUG_STREAM("SolveLinearSystem_Tikhonov - AHA = " << Gadgetron::norm2(AHA));
+
+    x.create(A.get_size(1), b.get_size(1));
+    gemm(x, A, true, b, false);
+    //GDEBUG_STREAM("SolveLinearSystem_Tikhonov - x = " << Gadgetron::norm2(x));
+
+    double trA = apply_Tikhonov_regularization(AHA, x, lamda);
+
     try
     {
         posv(AHA, x);
@@ -1965,6 +1973,416 @@ template EXPORTCPUCOREMATH void SolveLinearSystem_Tikhonov(hoNDArray< complext<f
 template EXPORTCPUCOREMATH void SolveLinearSystem_Tikhonov(hoNDArray< std::complex<double> >& A, hoNDArray< std::complex<double> >& b, hoNDArray< std::complex<double> >& x, double lamda);
 template EXPORTCPUCOREMATH void SolveLinearSystem_Tikhonov(hoNDArray< complext<double> >& A, hoNDArray< complext<double> >& b, hoNDArray< complext<double> >& x, double lamda);
 
+template<typename T>
+void SolveNormalEquation_Tikhonov(hoNDArray<T>& AHA, hoNDArray<T>& x, double lamda)
+{
+    GADGET_CHECK_THROW(AHA.get_size(0)==AHA.get_size(1));
+    GADGET_CHECK_THROW(x.get_size(0)==AHA.get_size(0));
+
+    double trA = apply_Tikhonov_regularization(AHA, x, lamda);
+
+    try
+    {
+        posv(AHA, x);
+    }
+    catch(...)
+    {
+        GERROR_STREAM("posv failed in SolveNormalEquation_Tikhonov(... ) ... ");
+        GDEBUG_STREAM("trA = " << trA);
+        throw;
+    }
+}
+
+template EXPORTCPUCOREMATH void SolveNormalEquation_Tikhonov(hoNDArray<float>& AHA, hoNDArray<float>& x, double lamda);
+template EXPORTCPUCOREMATH void SolveNormalEquation_Tikhonov(hoNDArray<double>& AHA, hoNDArray<double>& x, double lamda);
+template EXPORTCPUCOREMATH void SolveNormalEquation_Tikhonov(hoNDArray< std::complex<float> >& AHA, hoNDArray< std::complex<float> >& x, double lamda);
+template EXPORTCPUCOREMATH void SolveNormalEquation_Tikhonov(hoNDArray< complext<float> >& AHA, hoNDArray< complext<float> >& x, double lamda);
+template EXPORTCPUCOREMATH void SolveNormalEquation_Tikhonov(hoNDArray< std::complex<double> >& AHA, hoNDArray< std::complex<double> >& x, double lamda);
+template EXPORTCPUCOREMATH void SolveNormalEquation_Tikhonov(hoNDArray< complext<double> >& AHA, hoNDArray< complext<double> >& x, double lamda);
+
+/// ------------------------------------------------------------------------------------
+/// batched small-matrix functions
+/// ------------------------------------------------------------------------------------
+
+// element types passed to the fortran interface
+template <typename T> struct lapackType { typedef T type; };
+template <> struct lapackType< complext<float> > { typedef std::complex<float> type; };
+template <> struct lapackType< complext<double> > { typedef std::complex<double> type; };
+
+inline void gemm_one(char ta, char tb, lapack_int M, lapack_int N, lapack_int K, const float* a, lapack_int lda, const float* b, lapack_int ldb, float* c)
+{
+    float alpha(1), beta(0);
+    if ( ta == 'C' ) ta = 'T';
+    if ( tb == 'C' ) tb = 'T';
+    sgemm_(&ta, &tb, &M, &N, &K, &alpha, a, &lda, b, &ldb, &beta, c, &M);
+}
+
+inline void gemm_one(char ta, char tb, lapack_int M, lapack_int N, lapack_int K, const double* a, lapack_int lda, const double* b, lapack_int ldb, double* c)
+{
+    double alpha(1), beta(0);
+    if ( ta == 'C' ) ta = 'T';
+    if ( tb == 'C' ) tb = 'T';
+    dgemm_(&ta, &tb, &M, &N, &K, &alpha, a, &lda, b, &ldb, &beta, c, &M);
+}
+
+inline void gemm_one(char ta, char tb, lapack_int M, lapack_int N, lapack_int K, const std::complex<float>* a, lapack_int lda, const std::complex<float>* b, lapack_int ldb, std::complex<float>* c)
+{
+    std::complex<float> alpha(1), beta(0);
+    cgemm_(&ta, &tb, &M, &N, &K, reinterpret_cast<lapack_complex_float*>(&alpha), reinterpret_cast<const lapack_complex_float*>(a), &lda, reinterpret_cast<const lapack_complex_float*>(b), &ldb, reinterpret_cast<lapack_complex_float*>(&beta), reinterpret_cast<lapack_complex_float*>(c), &M);
+}
+
+inline void gemm_one(char ta, char tb, lapack_int M, lapack_int N, lapack_int K, const std::complex<double>* a, lapack_int lda, const std::complex<double>* b, lapack_int ldb, std::complex<double>* c)
+{
+    std::complex<double> alpha(1), beta(0);
+    zgemm_(&ta, &tb, &M, &N, &K, reinterpret_cast<lapack_complex_double*>(&alpha), reinterpret_cast<const lapack_complex_double*>(a), &lda, reinterpret_cast<const lapack_complex_double*>(b), &ldb, reinterpret_cast<lapack_complex_double*>(&beta), reinterpret_cast<lapack_complex_double*>(c), &M);
+}
+
+inline lapack_int potrf_one(char uplo, lapack_int n, float* a) { lapack_int info; spotrf_(&uplo, &n, a, &n, &info); return info; }
+inline lapack_int potrf_one(char uplo, lapack_int n, double* a) { lapack_int info; dpotrf_(&uplo, &n, a, &n, &info); return info; }
+inline lapack_int potrf_one(char uplo, lapack_int n, std::complex<float>* a) { lapack_int info; cpotrf_(&uplo, &n, reinterpret_cast<lapack_complex_float*>(a), &n, &info); return info; }
+inline lapack_int potrf_one(char uplo, lapack_int n, std::complex<double>* a) { lapack_int info; zpotrf_(&uplo, &n, reinterpret_cast<lapack_complex_double*>(a), &n, &info); return info; }
+
+inline lapack_int posv_one(char uplo, lapack_int n, lapack_int nrhs, float* a, float* b) { lapack_int info; sposv_(&uplo, &n, &nrhs, a, &n, b, &n, &info); return info; }
+inline lapack_int posv_one(char uplo, lapack_int n, lapack_int nrhs, double* a, double* b) { lapack_int info; dposv_(&uplo, &n, &nrhs, a, &n, b, &n, &info); return info; }
+inline lapack_int posv_one(char uplo, lapack_int n, lapack_int nrhs, std::complex<float>* a, std::complex<float>* b) { lapack_int info; cposv_(&uplo, &n, &nrhs, reinterpret_cast<lapack_complex_float*>(a), &n, reinterpret_cast<lapack_complex_float*>(b), &n, &info); return info; }
+inline lapack_int posv_one(char uplo, lapack_int n, lapack_int nrhs, std::complex<double>* a, std::complex<double>* b) { lapack_int info; zposv_(&uplo, &n, &nrhs, reinterpret_cast<lapack_complex_double*>(a), &n, reinterpret_cast<lapack_complex_double*>(b), &n, &info); return info; }
+
+// lwork==-1 queries the optimal workspace size, which is returned in work[0]
+inline lapack_int heev_one(lapack_int n, float* a, float* w, float* work, lapack_int lwork, float* /*rwork*/)
+{
+    lapack_int info;
+    char jobz = 'V', uplo = 'L';
+    ssyev_(&jobz, &uplo, &n, a, &n, w, work, &lwork, &info);
+    return info;
+}
+
+inline lapack_int heev_one(lapack_int n, double* a, double* w, double* work, lapack_int lwork, double* /*rwork*/)
+{
+    lapack_int info;
+    char jobz = 'V', uplo = 'L';
+    dsyev_(&jobz, &uplo, &n, a, &n, w, work, &lwork, &info);
+    return info;
+}
+
+inline lapack_int heev_one(lapack_int n, std::complex<float>* a, float* w, std::complex<float>* work, lapack_int lwork, float* rwork)
+{
+    lapack_int info;
+    char jobz = 'V', uplo = 'L';
+    cheev_(&jobz, &uplo, &n, reinterpret_cast<lapack_complex_float*>(a), &n, w, reinterpret_cast<lapack_complex_float*>(work), &lwork, rwork, &info);
+    return info;
+}
+
+inline lapack_int heev_one(lapack_int n, std::complex<double>* a, double* w, std::complex<double>* work, lapack_int lwork, double* rwork)
+{
+    lapack_int info;
+    char jobz = 'V', uplo = 'L';
+    zheev_(&jobz, &uplo, &n, reinterpret_cast<lapack_complex_double*>(a), &n, w, reinterpret_cast<lapack_complex_double*>(work), &lwork, rwork, &info);
+    return info;
+}
+
+template<typename T> 
+void gemm_batch(hoNDArray<T>& C, const hoNDArray<T>& A, bool transA, const hoNDArray<T>& B, bool transB)
+{
+    try
+    {
+        typedef typename lapackType<T>::type LT;
+
+        GADGET_CHECK_THROW( (&C!=&A) && (&C!=&B) );
+
+        lapack_int lda = (lapack_int)A.get_size(0);
+        lapack_int ldb = (lapack_int)B.get_size(0);
+
+        lapack_int M = (lapack_int)A.get_size(0);
+        lapack_int K = (lapack_int)A.get_size(1);
+        if ( transA )
+        {
+            M = (lapack_int)A.get_size(1);
+            K = (lapack_int)A.get_size(0);
+        }
+
+        lapack_int K2 = (lapack_int)B.get_size(0);
+        lapack_int N = (lapack_int)B.get_size(1);
+        if ( transB )
+        {
+            K2 = (lapack_int)B.get_size(1);
+            N = (lapack_int)B.get_size(0);
+        }
+
+        GADGET_CHECK_THROW(K==K2);
+
+        size_t sizeA = A.get_size(0)*A.get_size(1);
+        size_t sizeB = B.get_size(0)*B.get_size(1);
+        size_t sizeC = (size_t)M*N;
+
+        if ( sizeA==0 || sizeB==0 ) return;
+
+        long long batch = (long long)(A.get_number_of_elements()/sizeA);
+        GADGET_CHECK_THROW(B.get_number_of_elements()==batch*sizeB);
+
+        if ( (C.get_size(0)!=M) || (C.get_size(1)!=N) || (C.get_number_of_elements()!=batch*sizeC) )
+        {
+            C.create(M, N, batch);
+        }
+
+        char TA = transA ? 'C' : 'N';
+        char TB = transB ? 'C' : 'N';
+
+        const LT* pA = reinterpret_cast<const LT*>(A.begin());
+        const LT* pB = reinterpret_cast<const LT*>(B.begin());
+        LT* pC = reinterpret_cast<LT*>(C.begin());
+
+        long long b;
+
+#pragma omp parallel for default(none) private(b) shared(batch, TA, TB, M, N, K, pA, lda, pB, ldb, pC, sizeA, sizeB, sizeC) if (batch>1)
+        for ( b=0; b<batch; b++ )
+        {
+            gemm_one(TA, TB, M, N, K, pA+b*sizeA, lda, pB+b*sizeB, ldb, pC+b*sizeC);
+        }
+    }
+    catch(...)
+    {
+        GADGET_THROW("Errors in gemm_batch(hoNDArray<T>& C, const hoNDArray<T>& A, bool transA, const hoNDArray<T>& B, bool transB) ...");
+    }
+}
+
+template EXPORTCPUCOREMATH void gemm_batch(hoNDArray<float>& C, const hoNDArray<float>& A, bool transA, const hoNDArray<float>& B, bool transB);
+template EXPORTCPUCOREMATH void gemm_batch(hoNDArray<double>& C, const hoNDArray<double>& A, bool transA, const hoNDArray<double>& B, bool transB);
+template EXPORTCPUCOREMATH void gemm_batch(hoNDArray< std::complex<float> >& C, const hoNDArray< std::complex<float> >& A, bool transA, const hoNDArray< std::complex<float> >& B, bool transB);
+template EXPORTCPUCOREMATH void gemm_batch(hoNDArray< complext<float> >& C, const hoNDArray< complext<float> >& A, bool transA, const hoNDArray< complext<float> >& B, bool transB);
+template EXPORTCPUCOREMATH void gemm_batch(hoNDArray< std::complex<double> >& C, const hoNDArray< std::complex<double> >& A, bool transA, const hoNDArray< std::complex<double> >& B, bool transB);
+template EXPORTCPUCOREMATH void gemm_batch(hoNDArray< complext<double> >& C, const hoNDArray< complext<double> >& A, bool transA, const hoNDArray< complext<double> >& B, bool transB);
+
+/// ------------------------------------------------------------------------------------
+
+template<typename T> 
+void potrf_batch(hoNDArray<T>& A, char uplo)
+{
+    try
+    {
+        typedef typename lapackType<T>::type LT;
+
+        if( A.get_number_of_elements()==0 ) return;
+        GADGET_CHECK_THROW(A.get_size(0)==A.get_size(1));
+
+        lapack_int n = (lapack_int)(A.get_size(0));
+        size_t sizeA = (size_t)n*n;
+        long long batch = (long long)(A.get_number_of_elements()/sizeA);
+
+        LT* pA = reinterpret_cast<LT*>(A.begin());
+
+        long long b;
+        long long failed = 0;
+
+#pragma omp parallel for default(none) private(b) shared(batch, uplo, n, pA, sizeA) reduction(+:failed) if (batch>1)
+        for ( b=0; b<batch; b++ )
+        {
+            LT* pAb = pA + b*sizeA;
+
+            if ( potrf_one(uplo, n, pAb) != 0 )
+            {
+                failed++;
+                continue;
+            }
+
+            lapack_int r, c;
+            if ( uplo == 'U' )
+            {
+                for (c=0; c<n; c++)
+                {
+                    for (r=c+1; r<n; r++)
+                    {
+                        pAb[r + c*n] = 0;
+                    }
+                }
+            }
+            else
+            {
+                for (c=1; c<n; c++)
+                {
+                    for (r=0; r<c; r++)
+                    {
+                        pAb[r + c*n] = 0;
+                    }
+                }
+            }
+        }
+
+        if ( failed > 0 )
+        {
+            GERROR_STREAM("potrf_batch : " << failed << " of " << batch << " matrices are not positive definite ... ");
+            GADGET_THROW("potrf_batch failed ... ");
+        }
+    }
+    catch(...)
+    {
+        GADGET_THROW("Errors in potrf_batch(hoNDArray<T>& A, char uplo) ...");
+    }
+}
+
+template EXPORTCPUCOREMATH void potrf_batch(hoNDArray<float>& A, char uplo);
+template EXPORTCPUCOREMATH void potrf_batch(hoNDArray<double>& A, char uplo);
+template EXPORTCPUCOREMATH void potrf_batch(hoNDArray< std::complex<float> >& A, char uplo);
+template EXPORTCPUCOREMATH void potrf_batch(hoNDArray< complext<float> >& A, char uplo);
+template EXPORTCPUCOREMATH void potrf_batch(hoNDArray< std::complex<double> >& A, char uplo);
+template EXPORTCPUCOREMATH void potrf_batch(hoNDArray< complext<double> >& A, char uplo);
+
+/// ------------------------------------------------------------------------------------
+
+template<typename T> 
+void posv_batch(hoNDArray<T>& A, hoNDArray<T>& b)
+{
+    try
+    {
+        typedef typename lapackType<T>::type LT;
+
+        if( A.get_number_of_elements()==0 ) return;
+        if( b.get_number_of_elements()==0 ) return;
+        GADGET_CHECK_THROW(A.get_size(0)==A.get_size(1));
+        GADGET_CHECK_THROW(A.get_size(0)==b.get_size(0));
+
+        lapack_int n = (lapack_int)A.get_size(0);
+        lapack_int nrhs = (lapack_int)b.get_size(1);
+
+        size_t sizeA = (size_t)n*n;
+        size_t sizeB = (size_t)n*nrhs;
+        long long batch = (long long)(A.get_number_of_elements()/sizeA);
+        GADGET_CHECK_THROW(b.get_number_of_elements()==batch*sizeB);
+
+        LT* pA = reinterpret_cast<LT*>(A.begin());
+        LT* pB = reinterpret_cast<LT*>(b.begin());
+
+        long long k;
+        long long failed = 0;
+
+#pragma omp parallel for default(none) private(k) shared(batch, n, nrhs, pA, pB, sizeA, sizeB) reduction(+:failed) if (batch>1)
+        for ( k=0; k<batch; k++ )
+        {
+            if ( posv_one('L', n, nrhs, pA+k*sizeA, pB+k*sizeB) != 0 ) failed++;
+        }
+
+        if ( failed > 0 )
+        {
+            GERROR_STREAM("posv_batch : " << failed << " of " << batch << " systems could not be solved ... ");
+            GADGET_THROW("posv_batch failed ... ");
+        }
+    }
+    catch(...)
+    {
+        GADGET_THROW("Errors in posv_batch(hoNDArray<T>& A, hoNDArray<T>& b) ...");
+    }
+}
+
+template EXPORTCPUCOREMATH void posv_batch(hoNDArray<float>& A, hoNDArray<float>& b);
+template EXPORTCPUCOREMATH void posv_batch(hoNDArray<double>& A, hoNDArray<double>& b);
+template EXPORTCPUCOREMATH void posv_batch(hoNDArray< std::complex<float> >& A, hoNDArray< std::complex<float> >& b);
+template EXPORTCPUCOREMATH void posv_batch(hoNDArray< complext<float> >& A, hoNDArray< complext<float> >& b);
+template EXPORTCPUCOREMATH void posv_batch(hoNDArray< std::complex<double> >& A, hoNDArray< std::complex<double> >& b);
+template EXPORTCPUCOREMATH void posv_batch(hoNDArray< complext<double> >& A, hoNDArray< complext<double> >& b);
+
+/// ------------------------------------------------------------------------------------
+
+template<typename T> 
+void SolveNormalEquation_Tikhonov_batch(hoNDArray<T>& AHA, hoNDArray<T>& x, double lamda)
+{
+    try
+    {
+        if( AHA.get_number_of_elements()==0 ) return;
+        GADGET_CHECK_THROW(AHA.get_size(0)==AHA.get_size(1));
+        GADGET_CHECK_THROW(x.get_size(0)==AHA.get_size(0));
+
+        size_t n = AHA.get_size(0);
+        size_t nrhs = x.get_size(1);
+        size_t batch = AHA.get_number_of_elements()/(n*n);
+        GADGET_CHECK_THROW(x.get_number_of_elements()==batch*n*nrhs);
+
+        for ( size_t b=0; b<batch; b++ )
+        {
+            hoNDArray<T> AHAb(n, n, AHA.begin()+b*n*n);
+            hoNDArray<T> xb(n, nrhs, x.begin()+b*n*nrhs);
+            apply_Tikhonov_regularization(AHAb, xb, lamda);
+        }
+
+        posv_batch(AHA, x);
+    }
+    catch(...)
+    {
+        GADGET_THROW("Errors in SolveNormalEquation_Tikhonov_batch(hoNDArray<T>& AHA, hoNDArray<T>& x, double lamda) ...");
+    }
+}
+
+template EXPORTCPUCOREMATH void SolveNormalEquation_Tikhonov_batch(hoNDArray<float>& AHA, hoNDArray<float>& x, double lamda);
+template EXPORTCPUCOREMATH void SolveNormalEquation_Tikhonov_batch(hoNDArray<double>& AHA, hoNDArray<double>& x, double lamda);
+template EXPORTCPUCOREMATH void SolveNormalEquation_Tikhonov_batch(hoNDArray< std::complex<float> >& AHA, hoNDArray< std::complex<float> >& x, double lamda);
+template EXPORTCPUCOREMATH void SolveNormalEquation_Tikhonov_batch(hoNDArray< complext<float> >& AHA, hoNDArray< complext<float> >& x, double lamda);
+template EXPORTCPUCOREMATH void SolveNormalEquation_Tikhonov_batch(hoNDArray< std::complex<double> >& AHA, hoNDArray< std::complex<double> >& x, double lamda);
+template EXPORTCPUCOREMATH void SolveNormalEquation_Tikhonov_batch(hoNDArray< complext<double> >& AHA, hoNDArray< complext<double> >& x, double lamda);
+
+/// ------------------------------------------------------------------------------------
+
+template<typename T> 
+void heev_batch(hoNDArray<T>& A, hoNDArray<typename realType<T>::Type>& eigenValue)
+{
+    try
+    {
+        typedef typename lapackType<T>::type LT;
+        typedef typename realType<T>::Type value_type;
+
+        if( A.get_number_of_elements()==0 ) return;
+
+        lapack_int M = (lapack_int)A.get_size(0);
+        GADGET_CHECK_THROW(A.get_size(1) == M);
+
+        size_t sizeA = (size_t)M*M;
+        long long batch = (long long)(A.get_number_of_elements()/sizeA);
+
+        if ( (eigenValue.get_size(0)!=M) || (eigenValue.get_number_of_elements()!=batch*M) )
+        {
+            eigenValue.create(M, batch);
+        }
+
+        LT* pA = reinterpret_cast<LT*>(A.begin());
+        value_type* pEV = eigenValue.begin();
+
+        // the workspace size only depends on M, query it once
+        LT workSize;
+        lapack_int info = heev_one(M, pA, pEV, &workSize, -1, NULL);
+        GADGET_CHECK_THROW(info==0);
+        lapack_int lwork = std::max( (lapack_int)std::real(workSize), 2*M );
+
+        long long b;
+        long long failed = 0;
+
+#pragma omp parallel default(none) private(b) shared(batch, M, pA, pEV, sizeA, lwork) reduction(+:failed) if (batch>1)
+        {
+            std::vector<LT> work(lwork);
+            std::vector<value_type> rwork(3*M);
+
+#pragma omp for
+            for ( b=0; b<batch; b++ )
+            {
+                if ( heev_one(M, pA+b*sizeA, pEV+b*M, &work[0], lwork, &rwork[0]) != 0 ) failed++;
+            }
+        }
+
+        if ( failed > 0 )
+        {
+            GERROR_STREAM("heev_batch : " << failed << " of " << batch << " eigen decompositions did not converge ... ");
+            GADGET_THROW("heev_batch failed ... ");
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in heev_batch(hoNDArray<T>& A, hoNDArray<typename realType<T>::Type>& eigenValue) ... ");
+    }
+}
+
+template EXPORTCPUCOREMATH void heev_batch(hoNDArray<float>& A, hoNDArray<float>& eigenValue);
+template EXPORTCPUCOREMATH void heev_batch(hoNDArray<double>& A, hoNDArray<double>& eigenValue);
+template EXPORTCPUCOREMATH void heev_batch(hoNDArray< std::complex<float> >& A, hoNDArray<float>& eigenValue);
+template EXPORTCPUCOREMATH void heev_batch(hoNDArray< complext<float> >& A, hoNDArray<float>& eigenValue);
+template EXPORTCPUCOREMATH void heev_batch(hoNDArray< std::complex<double> >& A, hoNDArray<double>& eigenValue);
+template EXPORTCPUCOREMATH void heev_batch(hoNDArray< complext<double> >& A, hoNDArray<double>& eigenValue);
+
 #endif // defined(USE_MKL) || defined(USE_LAPACK)
 
 }
@@ -78,6 +78,11 @@ void gesv(hoNDArray<T>& A, hoNDArray<T>& b);
 template<typename T> EXPORTCPUCOREMATH
 void SolveLinearSystem_Tikhonov(hoNDArray<T>& A, hoNDArray<T>& b, hoNDArray<T>& x, double lamda);
 
+/// solve the normal equation AHA*x = AHb with the same Tikhonov regularization as SolveLinearSystem_Tikhonov
+/// only the lower triangle of AHA is used; x is AHb on input and the solution on output, AHA is overwritten
+template<typename T> EXPORTCPUCOREMATH
+void SolveNormalEquation_Tikhonov(hoNDArray<T>& AHA, hoNDArray<T>& x, double lamda);
+
 /// Computes the LU factorization of a general m-by-n matrix
 /// this function is called by general matrix inversion
 template<typename T> EXPORTCPUCOREMATH 
@@ -87,4 +92,31 @@ void getrf(hoNDArray<T>& A, hoNDArray<lapack_int>& ipiv);
 template<typename T> EXPORTCPUCOREMATH 
 void getri(hoNDArray<T>& A);
 
+/// ----------------------------------------------------------------------
+/// batched versions for stacks of small matrices, e.g. one matrix per pixel
+/// the matrices of a stack are stored contiguously, [rows cols batch]
+/// the batch is processed in parallel without per-matrix allocation
+/// ----------------------------------------------------------------------
+
+/// C(:,:,b) = A(:,:,b)*B(:,:,b); transA/transB as for gemm
+/// C is created as [M N batch] if its size does not match, A and B may be the same array
+template<typename T> EXPORTCPUCOREMATH
+void gemm_batch(hoNDArray<T>& C, const hoNDArray<T>& A, bool transA, const hoNDArray<T>& B, bool transB);
+
+/// Cholesky factorization of every A(:,:,b), the other triangle is set to zero
+template<typename T> EXPORTCPUCOREMATH
+void potrf_batch(hoNDArray<T>& A, char uplo);
+
+/// solve A(:,:,b)*x = b(:,:,b) for symmetric or Hermitian positive-definite A, b [n nrhs batch] is replaced with x
+template<typename T> EXPORTCPUCOREMATH
+void posv_batch(hoNDArray<T>& A, hoNDArray<T>& b);
+
+/// SolveNormalEquation_Tikhonov for every AHA(:,:,b) and x(:,:,b), the systems are solved with posv_batch
+template<typename T> EXPORTCPUCOREMATH
+void SolveNormalEquation_Tikhonov_batch(hoNDArray<T>& AHA, hoNDArray<T>& x, double lamda);
+
+/// eigenvalues in ascending order [n batch] and eigenvectors of every Hermitian A(:,:,b), A is replaced with the eigenvectors
+template<typename T> EXPORTCPUCOREMATH
+void heev_batch(hoNDArray<T>& A, hoNDArray<typename realType<T>::Type>& eigenValue);
+
 }
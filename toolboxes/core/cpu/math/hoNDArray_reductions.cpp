@@ -1,5 +1,6 @@
 #include "hoNDArray_reductions.h"
 #include "hoArmadillo.h"
+#include "hoNDArray_simd.h"
 
 #ifndef lapack_int
     #define lapack_int int
@@ -15,6 +16,9 @@
 
 #define NumElementsUseThreading 64*1024
 
+// large reductions are split into blocks of this size, which are processed by the vectorized kernels
+#define NumElementsPerBlock 4096
+
 //Declaration of BLAS and LAPACK routines
 extern "C"
 {
@@ -318,17 +322,16 @@ namespace Gadgetron{
 
     inline void norm2(size_t N, const  std::complex<float> * x, float& r)
     {
-        long long i;
+        long long numblocks = (N+NumElementsPerBlock-1)/NumElementsPerBlock;
+        long long blk;
 
         float sum(0);
 
-        #pragma omp parallel for private(i) reduction(+:sum) if (N>NumElementsUseThreading)
-        for (i = 0; i < (long long)N; i++)
+        #pragma omp parallel for private(blk) reduction(+:sum) if (N>NumElementsUseThreading)
+        for (blk = 0; blk < numblocks; blk++)
         {
-            const std::complex<float>& c = x[i];
-            const float re = c.real();
-            const float im = c.imag();
-            sum += ( (re*re) + (im * im) );
+            size_t n = blk*NumElementsPerBlock;
+            sum += simd::norm2_square(std::min((size_t)NumElementsPerBlock, N-n), x+n);
         }
 
         r = std::sqrt(sum);
@@ -341,17 +344,16 @@ namespace Gadgetron{
 
     inline void norm2(size_t N, const  std::complex<double> * x, double& r)
     {
-        long long i;
+        long long numblocks = (N+NumElementsPerBlock-1)/NumElementsPerBlock;
+        long long blk;
 
         double sum(0);
 
-        #pragma omp parallel for private(i) reduction(+:sum) if (N>NumElementsUseThreading)
-        for (i = 0; i < (long long)N; i++)
+        #pragma omp parallel for private(blk) reduction(+:sum) if (N>NumElementsUseThreading)
+        for (blk = 0; blk < numblocks; blk++)
         {
-            const std::complex<double>& c = x[i];
-            const double re = c.real();
-            const double im = c.imag();
-            sum += ( (re*re) + (im * im) );
+            size_t n = blk*NumElementsPerBlock;
+            sum += simd::norm2_square(std::min((size_t)NumElementsPerBlock, N-n), x+n);
         }
 
         r = std::sqrt(sum);
@@ -656,22 +658,18 @@ namespace Gadgetron{
 
     inline void dotc(size_t N, const  std::complex<float> * x, const  std::complex<float> * y,  std::complex<float> & r)
     {
-        long long n;
-
-        float sum(0);
+        long long numblocks = (N+NumElementsPerBlock-1)/NumElementsPerBlock;
+        long long blk;
 
         float sa(0), sb(0);
 
-        #pragma omp parallel for private(n) reduction(+:sa) if (N>NumElementsUseThreading)
-        for (n = 0; n < (long long)N; n++)
+        #pragma omp parallel for private(blk) reduction(+:sa,sb) if (N>NumElementsUseThreading)
+        for (blk = 0; blk < numblocks; blk++)
         {
-            const float a = x[n].real();
-            const float b = x[n].imag();
-            const float c = y[n].real();
-            const float d = y[n].imag();
-
-            sa += (a*c + b*d);
-            sb += (c*b - a*d);
+            size_t n = blk*NumElementsPerBlock;
+            std::complex<float> v = simd::dotc(std::min((size_t)NumElementsPerBlock, N-n), x+n, y+n);
+            sa += v.real();
+            sb += v.imag();
         }
 
         reinterpret_cast<float(&)[2]>(r)[0] = sa;
@@ -680,22 +678,18 @@ namespace Gadgetron{
 
     inline void dotc(size_t N, const  std::complex<double> * x, const  std::complex<double> * y,  std::complex<double> & r)
     {
-        long long n;
-
-        double sum(0);
+        long long numblocks = (N+NumElementsPerBlock-1)/NumElementsPerBlock;
+        long long blk;
 
         double sa(0), sb(0);
 
-        #pragma omp parallel for private(n) reduction(+:sa) if (N>NumElementsUseThreading)
-        for (n = 0; n < (long long)N; n++)
+        #pragma omp parallel for private(blk) reduction(+:sa,sb) if (N>NumElementsUseThreading)
+        for (blk = 0; blk < numblocks; blk++)
         {
-            const double a = x[n].real();
-            const double b = x[n].imag();
-            const double c = y[n].real();
-            const double d = y[n].imag();
-
-            sa += (a*c + b*d);
-            sb += (c*b - a*d);
+            size_t n = blk*NumElementsPerBlock;
+            std::complex<double> v = simd::dotc(std::min((size_t)NumElementsPerBlock, N-n), x+n, y+n);
+            sa += v.real();
+            sb += v.imag();
         }
 
         reinterpret_cast<double(&)[2]>(r)[0] = sa;
@@ -0,0 +1,934 @@
+#include "hoNDArray_simd.h"
+#include "log.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define GADGETRON_SIMD_X86
+    #include <immintrin.h>
+
+    // kernels are compiled for their instruction set only, the rest of the library stays generic
+    #define GADGETRON_TARGET_AVX2 __attribute__((target("avx2,fma")))
+    #define GADGETRON_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+namespace Gadgetron
+{
+    namespace simd
+    {
+        // --------------------------------------------------------------------------------
+        // scalar kernels, also used for the remainder of the vectorized loops
+        // --------------------------------------------------------------------------------
+
+        template <typename T>
+        inline void multiply_scalar(size_t N, const std::complex<T>* x, const std::complex<T>* y, std::complex<T>* r)
+        {
+            for ( size_t n=0; n<N; n++ )
+            {
+                const T a = x[n].real(), b = x[n].imag();
+                const T c = y[n].real(), d = y[n].imag();
+                r[n] = std::complex<T>(a*c - b*d, a*d + b*c);
+            }
+        }
+
+        template <typename T>
+        inline void multiplyConj_scalar(size_t N, const std::complex<T>* x, const std::complex<T>* y, std::complex<T>* r)
+        {
+            for ( size_t n=0; n<N; n++ )
+            {
+                const T a = x[n].real(), b = x[n].imag();
+                const T c = y[n].real(), d = y[n].imag();
+                r[n] = std::complex<T>(a*c + b*d, b*c - a*d);
+            }
+        }
+
+        template <typename T>
+        inline void multiplyAdd_scalar(size_t N, const std::complex<T>* x, const std::complex<T>* y, std::complex<T>* r)
+        {
+            for ( size_t n=0; n<N; n++ )
+            {
+                const T a = x[n].real(), b = x[n].imag();
+                const T c = y[n].real(), d = y[n].imag();
+                r[n] += std::complex<T>(a*c - b*d, a*d + b*c);
+            }
+        }
+
+        template <typename T>
+        inline void addEpsilon_scalar(size_t N, std::complex<T>* x)
+        {
+            const T eps = std::numeric_limits<T>::epsilon();
+
+            for ( size_t n=0; n<N; n++ )
+            {
+                if ( std::abs(x[n]) < eps )
+                {
+                    reinterpret_cast<T(&)[2]>(x[n])[0] += eps;
+                }
+            }
+        }
+
+        template <typename T>
+        inline void abs_scalar(size_t N, const std::complex<T>* x, T* r)
+        {
+            for ( size_t n=0; n<N; n++ )
+            {
+                const T re = x[n].real();
+                const T im = x[n].imag();
+                r[n] = std::sqrt( (re*re) + (im*im) );
+            }
+        }
+
+        template <typename T>
+        inline T norm2_square_scalar(size_t N, const std::complex<T>* x)
+        {
+            T sum(0);
+            for ( size_t n=0; n<N; n++ )
+            {
+                const T re = x[n].real();
+                const T im = x[n].imag();
+                sum += (re*re) + (im*im);
+            }
+            return sum;
+        }
+
+        template <typename T>
+        inline std::complex<T> dotc_scalar(size_t N, const std::complex<T>* x, const std::complex<T>* y)
+        {
+            T sa(0), sb(0);
+            for ( size_t n=0; n<N; n++ )
+            {
+                const T a = x[n].real(), b = x[n].imag();
+                const T c = y[n].real(), d = y[n].imag();
+                sa += a*c + b*d;
+                sb += b*c - a*d;
+            }
+            return std::complex<T>(sa, sb);
+        }
+
+#ifdef GADGETRON_SIMD_X86
+
+        // --------------------------------------------------------------------------------
+        // AVX2 + FMA, 4 complex<float> or 2 complex<double> per register
+        // --------------------------------------------------------------------------------
+
+        GADGETRON_TARGET_AVX2 void multiply_avx2(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r)
+        {
+            const float* a = reinterpret_cast<const float*>(x);
+            const float* b = reinterpret_cast<const float*>(y);
+            float* c = reinterpret_cast<float*>(r);
+
+            size_t n = 0;
+            for ( ; n+4<=N; n+=4 )
+            {
+                __m256 va = _mm256_loadu_ps(a+2*n);
+                __m256 vb = _mm256_loadu_ps(b+2*n);
+                __m256 br = _mm256_moveldup_ps(vb);
+                __m256 bi = _mm256_movehdup_ps(vb);
+                __m256 vs = _mm256_permute_ps(va, 0xB1);
+
+                // (ar*br - ai*bi, ai*br + ar*bi)
+                _mm256_storeu_ps(c+2*n, _mm256_fmaddsub_ps(va, br, _mm256_mul_ps(vs, bi)));
+            }
+
+            multiply_scalar(N-n, x+n, y+n, r+n);
+        }
+
+        GADGETRON_TARGET_AVX2 void multiply_avx2(size_t N, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r)
+        {
+            const double* a = reinterpret_cast<const double*>(x);
+            const double* b = reinterpret_cast<const double*>(y);
+            double* c = reinterpret_cast<double*>(r);
+
+            size_t n = 0;
+            for ( ; n+2<=N; n+=2 )
+            {
+                __m256d va = _mm256_loadu_pd(a+2*n);
+                __m256d vb = _mm256_loadu_pd(b+2*n);
+                __m256d br = _mm256_movedup_pd(vb);
+                __m256d bi = _mm256_permute_pd(vb, 0xF);
+                __m256d vs = _mm256_permute_pd(va, 0x5);
+
+                _mm256_storeu_pd(c+2*n, _mm256_fmaddsub_pd(va, br, _mm256_mul_pd(vs, bi)));
+            }
+
+            multiply_scalar(N-n, x+n, y+n, r+n);
+        }
+
+        GADGETRON_TARGET_AVX2 void multiplyConj_avx2(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r)
+        {
+            const float* a = reinterpret_cast<const float*>(x);
+            const float* b = reinterpret_cast<const float*>(y);
+            float* c = reinterpret_cast<float*>(r);
+
+            size_t n = 0;
+            for ( ; n+4<=N; n+=4 )
+            {
+                __m256 va = _mm256_loadu_ps(a+2*n);
+                __m256 vb = _mm256_loadu_ps(b+2*n);
+                __m256 br = _mm256_moveldup_ps(vb);
+                __m256 bi = _mm256_movehdup_ps(vb);
+                __m256 vs = _mm256_permute_ps(va, 0xB1);
+
+                // (ar*br + ai*bi, ai*br - ar*bi)
+                _mm256_storeu_ps(c+2*n, _mm256_fmsubadd_ps(va, br, _mm256_mul_ps(vs, bi)));
+            }
+
+            multiplyConj_scalar(N-n, x+n, y+n, r+n);
+        }
+
+        GADGETRON_TARGET_AVX2 void multiplyConj_avx2(size_t N, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r)
+        {
+            const double* a = reinterpret_cast<const double*>(x);
+            const double* b = reinterpret_cast<const double*>(y);
+            double* c = reinterpret_cast<double*>(r);
+
+            size_t n = 0;
+            for ( ; n+2<=N; n+=2 )
+            {
+                __m256d va = _mm256_loadu_pd(a+2*n);
+                __m256d vb = _mm256_loadu_pd(b+2*n);
+                __m256d br = _mm256_movedup_pd(vb);
+                __m256d bi = _mm256_permute_pd(vb, 0xF);
+                __m256d vs = _mm256_permute_pd(va, 0x5);
+
+                _mm256_storeu_pd(c+2*n, _mm256_fmsubadd_pd(va, br, _mm256_mul_pd(vs, bi)));
+            }
+
+            multiplyConj_scalar(N-n, x+n, y+n, r+n);
+        }
+
+        GADGETRON_TARGET_AVX2 void multiplyAdd_avx2(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r)
+        {
+            const float* a = reinterpret_cast<const float*>(x);
+            const float* b = reinterpret_cast<const float*>(y);
+            float* c = reinterpret_cast<float*>(r);
+
+            size_t n = 0;
+            for ( ; n+4<=N; n+=4 )
+            {
+                __m256 va = _mm256_loadu_ps(a+2*n);
+                __m256 vb = _mm256_loadu_ps(b+2*n);
+                __m256 br = _mm256_moveldup_ps(vb);
+                __m256 bi = _mm256_movehdup_ps(vb);
+                __m256 vs = _mm256_permute_ps(va, 0xB1);
+
+                __m256 vp = _mm256_fmaddsub_ps(va, br, _mm256_mul_ps(vs, bi));
+                _mm256_storeu_ps(c+2*n, _mm256_add_ps(_mm256_loadu_ps(c+2*n), vp));
+            }
+
+            multiplyAdd_scalar(N-n, x+n, y+n, r+n);
+        }
+
+        GADGETRON_TARGET_AVX2 void multiplyAdd_avx2(size_t N, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r)
+        {
+            const double* a = reinterpret_cast<const double*>(x);
+            const double* b = reinterpret_cast<const double*>(y);
+            double* c = reinterpret_cast<double*>(r);
+
+            size_t n = 0;
+            for ( ; n+2<=N; n+=2 )
+            {
+                __m256d va = _mm256_loadu_pd(a+2*n);
+                __m256d vb = _mm256_loadu_pd(b+2*n);
+                __m256d br = _mm256_movedup_pd(vb);
+                __m256d bi = _mm256_permute_pd(vb, 0xF);
+                __m256d vs = _mm256_permute_pd(va, 0x5);
+
+                __m256d vp = _mm256_fmaddsub_pd(va, br, _mm256_mul_pd(vs, bi));
+                _mm256_storeu_pd(c+2*n, _mm256_add_pd(_mm256_loadu_pd(c+2*n), vp));
+            }
+
+            multiplyAdd_scalar(N-n, x+n, y+n, r+n);
+        }
+
+        GADGETRON_TARGET_AVX2 void addEpsilon_avx2(size_t N, std::complex<float>* x)
+        {
+            const float eps = std::numeric_limits<float>::epsilon();
+            const __m256 veps2 = _mm256_set1_ps(eps*eps);
+            const __m256 vepsr = _mm256_setr_ps(eps, 0, eps, 0, eps, 0, eps, 0);
+
+            float* a = reinterpret_cast<float*>(x);
+
+            size_t n = 0;
+            for ( ; n+4<=N; n+=4 )
+            {
+                __m256 v = _mm256_loadu_ps(a+2*n);
+                __m256 s = _mm256_mul_ps(v, v);
+
+                // |x|^2 in both the real and the imaginary lane
+                __m256 m = _mm256_cmp_ps(_mm256_add_ps(s, _mm256_permute_ps(s, 0xB1)), veps2, _CMP_LT_OQ);
+                _mm256_storeu_ps(a+2*n, _mm256_add_ps(v, _mm256_and_ps(m, vepsr)));
+            }
+
+            addEpsilon_scalar(N-n, x+n);
+        }
+
+        GADGETRON_TARGET_AVX2 void addEpsilon_avx2(size_t N, std::complex<double>* x)
+        {
+            const double eps = std::numeric_limits<double>::epsilon();
+            const __m256d veps2 = _mm256_set1_pd(eps*eps);
+            const __m256d vepsr = _mm256_setr_pd(eps, 0, eps, 0);
+
+            double* a = reinterpret_cast<double*>(x);
+
+            size_t n = 0;
+            for ( ; n+2<=N; n+=2 )
+            {
+                __m256d v = _mm256_loadu_pd(a+2*n);
+                __m256d s = _mm256_mul_pd(v, v);
+                __m256d m = _mm256_cmp_pd(_mm256_add_pd(s, _mm256_permute_pd(s, 0x5)), veps2, _CMP_LT_OQ);
+                _mm256_storeu_pd(a+2*n, _mm256_add_pd(v, _mm256_and_pd(m, vepsr)));
+            }
+
+            addEpsilon_scalar(N-n, x+n);
+        }
+
+        GADGETRON_TARGET_AVX2 void abs_avx2(size_t N, const std::complex<float>* x, float* r)
+        {
+            const float* a = reinterpret_cast<const float*>(x);
+
+            size_t n = 0;
+            for ( ; n+8<=N; n+=8 )
+            {
+                __m256 v0 = _mm256_loadu_ps(a+2*n);
+                __m256 v1 = _mm256_loadu_ps(a+2*n+8);
+                v0 = _mm256_mul_ps(v0, v0);
+                v1 = _mm256_mul_ps(v1, v1);
+
+                // hadd works per 128 bit lane and yields the order 0 1 4 5 2 3 6 7
+                __m256 h = _mm256_hadd_ps(v0, v1);
+                h = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(h), 0xD8));
+
+                _mm256_storeu_ps(r+n, _mm256_sqrt_ps(h));
+            }
+
+            abs_scalar(N-n, x+n, r+n);
+        }
+
+        GADGETRON_TARGET_AVX2 void abs_avx2(size_t N, const std::complex<double>* x, double* r)
+        {
+            const double* a = reinterpret_cast<const double*>(x);
+
+            size_t n = 0;
+            for ( ; n+4<=N; n+=4 )
+            {
+                __m256d v0 = _mm256_loadu_pd(a+2*n);
+                __m256d v1 = _mm256_loadu_pd(a+2*n+4);
+                v0 = _mm256_mul_pd(v0, v0);
+                v1 = _mm256_mul_pd(v1, v1);
+
+                // order 0 2 1 3
+                __m256d h = _mm256_permute4x64_pd(_mm256_hadd_pd(v0, v1), 0xD8);
+
+                _mm256_storeu_pd(r+n, _mm256_sqrt_pd(h));
+            }
+
+            abs_scalar(N-n, x+n, r+n);
+        }
+
+        GADGETRON_TARGET_AVX2 float norm2_square_avx2(size_t N, const std::complex<float>* x)
+        {
+            const float* a = reinterpret_cast<const float*>(x);
+
+            __m256 acc0 = _mm256_setzero_ps();
+            __m256 acc1 = _mm256_setzero_ps();
+
+            size_t n = 0;
+            for ( ; n+8<=N; n+=8 )
+            {
+                __m256 v0 = _mm256_loadu_ps(a+2*n);
+                __m256 v1 = _mm256_loadu_ps(a+2*n+8);
+                acc0 = _mm256_fmadd_ps(v0, v0, acc0);
+                acc1 = _mm256_fmadd_ps(v1, v1, acc1);
+            }
+
+            float s[8];
+            _mm256_storeu_ps(s, _mm256_add_ps(acc0, acc1));
+
+            return (s[0] + s[1]) + (s[2] + s[3]) + (s[4] + s[5]) + (s[6] + s[7]) + norm2_square_scalar(N-n, x+n);
+        }
+
+        GADGETRON_TARGET_AVX2 double norm2_square_avx2(size_t N, const std::complex<double>* x)
+        {
+            const double* a = reinterpret_cast<const double*>(x);
+
+            __m256d acc0 = _mm256_setzero_pd();
+            __m256d acc1 = _mm256_setzero_pd();
+
+            size_t n = 0;
+            for ( ; n+4<=N; n+=4 )
+            {
+                __m256d v0 = _mm256_loadu_pd(a+2*n);
+                __m256d v1 = _mm256_loadu_pd(a+2*n+4);
+                acc0 = _mm256_fmadd_pd(v0, v0, acc0);
+                acc1 = _mm256_fmadd_pd(v1, v1, acc1);
+            }
+
+            double s[4];
+            _mm256_storeu_pd(s, _mm256_add_pd(acc0, acc1));
+
+            return (s[0] + s[1]) + (s[2] + s[3]) + norm2_square_scalar(N-n, x+n);
+        }
+
+        GADGETRON_TARGET_AVX2 std::complex<float> dotc_avx2(size_t N, const std::complex<float>* x, const std::complex<float>* y)
+        {
+            const float* a = reinterpret_cast<const float*>(x);
+            const float* b = reinterpret_cast<const float*>(y);
+
+            // accr sums ar*br and ai*bi; acci holds ai*br in the even and ar*bi in the odd lanes
+            __m256 accr = _mm256_setzero_ps();
+            __m256 acci = _mm256_setzero_ps();
+
+            size_t n = 0;
+            for ( ; n+4<=N; n+=4 )
+            {
+                __m256 va = _mm256_loadu_ps(a+2*n);
+                __m256 vb = _mm256_loadu_ps(b+2*n);
+                accr = _mm256_fmadd_ps(va, vb, accr);
+                acci = _mm256_fmadd_ps(_mm256_permute_ps(va, 0xB1), vb, acci);
+            }
+
+            float sr[8], si[8];
+            _mm256_storeu_ps(sr, accr);
+            _mm256_storeu_ps(si, acci);
+
+            std::complex<float> r = dotc_scalar(N-n, x+n, y+n);
+            return r + std::complex<float>( (sr[0] + sr[1]) + (sr[2] + sr[3]) + (sr[4] + sr[5]) + (sr[6] + sr[7]),
+                                            (si[0] - si[1]) + (si[2] - si[3]) + (si[4] - si[5]) + (si[6] - si[7]) );
+        }
+
+        GADGETRON_TARGET_AVX2 std::complex<double> dotc_avx2(size_t N, const std::complex<double>* x, const std::complex<double>* y)
+        {
+            const double* a = reinterpret_cast<const double*>(x);
+            const double* b = reinterpret_cast<const double*>(y);
+
+            __m256d accr = _mm256_setzero_pd();
+            __m256d acci = _mm256_setzero_pd();
+
+            size_t n = 0;
+            for ( ; n+2<=N; n+=2 )
+            {
+                __m256d va = _mm256_loadu_pd(a+2*n);
+                __m256d vb = _mm256_loadu_pd(b+2*n);
+                accr = _mm256_fmadd_pd(va, vb, accr);
+                acci = _mm256_fmadd_pd(_mm256_permute_pd(va, 0x5), vb, acci);
+            }
+
+            double sr[4], si[4];
+            _mm256_storeu_pd(sr, accr);
+            _mm256_storeu_pd(si, acci);
+
+            std::complex<double> r = dotc_scalar(N-n, x+n, y+n);
+            return r + std::complex<double>( (sr[0] + sr[1]) + (sr[2] + sr[3]), (si[0] - si[1]) + (si[2] - si[3]) );
+        }
+
+        // --------------------------------------------------------------------------------
+        // AVX-512, 8 complex<float> or 4 complex<double> per register
+        // --------------------------------------------------------------------------------
+
+        // GCC 12 builds the unmasked lane shuffles and sqrt on _mm512_undefined_ps/pd, reported by -Wall -O2 as -Wmaybe-uninitialized;
+        // the masked forms with all lanes selected merge into the input register instead and compile to the same instructions
+
+        GADGETRON_TARGET_AVX512 inline __m512 swap_re_im_avx512(__m512 v) { return _mm512_mask_permute_ps(v, 0xFFFF, v, 0xB1); }
+        GADGETRON_TARGET_AVX512 inline __m512d swap_re_im_avx512(__m512d v) { return _mm512_mask_permute_pd(v, 0xFF, v, 0x55); }
+
+        GADGETRON_TARGET_AVX512 inline __m512 dup_re_avx512(__m512 v) { return _mm512_mask_moveldup_ps(v, 0xFFFF, v); }
+        GADGETRON_TARGET_AVX512 inline __m512d dup_re_avx512(__m512d v) { return _mm512_mask_movedup_pd(v, 0xFF, v); }
+
+        GADGETRON_TARGET_AVX512 inline __m512 dup_im_avx512(__m512 v) { return _mm512_mask_movehdup_ps(v, 0xFFFF, v); }
+        GADGETRON_TARGET_AVX512 inline __m512d dup_im_avx512(__m512d v) { return _mm512_mask_permute_pd(v, 0xFF, v, 0xFF); }
+
+        GADGETRON_TARGET_AVX512 inline __m512 sqrt_avx512(__m512 v) { return _mm512_mask_sqrt_ps(v, 0xFFFF, v); }
+        GADGETRON_TARGET_AVX512 inline __m512d sqrt_avx512(__m512d v) { return _mm512_mask_sqrt_pd(v, 0xFF, v); }
+
+        GADGETRON_TARGET_AVX512 void multiply_avx512(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r)
+        {
+            const float* a = reinterpret_cast<const float*>(x);
+            const float* b = reinterpret_cast<const float*>(y);
+            float* c = reinterpret_cast<float*>(r);
+
+            size_t n = 0;
+            for ( ; n+8<=N; n+=8 )
+            {
+                __m512 va = _mm512_loadu_ps(a+2*n);
+                __m512 vb = _mm512_loadu_ps(b+2*n);
+                __m512 br = dup_re_avx512(vb);
+                __m512 bi = dup_im_avx512(vb);
+                __m512 vs = swap_re_im_avx512(va);
+
+                _mm512_storeu_ps(c+2*n, _mm512_fmaddsub_ps(va, br, _mm512_mul_ps(vs, bi)));
+            }
+
+            multiply_scalar(N-n, x+n, y+n, r+n);
+        }
+
+        GADGETRON_TARGET_AVX512 void multiply_avx512(size_t N, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r)
+        {
+            const double* a = reinterpret_cast<const double*>(x);
+            const double* b = reinterpret_cast<const double*>(y);
+            double* c = reinterpret_cast<double*>(r);
+
+            size_t n = 0;
+            for ( ; n+4<=N; n+=4 )
+            {
+                __m512d va = _mm512_loadu_pd(a+2*n);
+                __m512d vb = _mm512_loadu_pd(b+2*n);
+                __m512d br = dup_re_avx512(vb);
+                __m512d bi = dup_im_avx512(vb);
+                __m512d vs = swap_re_im_avx512(va);
+
+                _mm512_storeu_pd(c+2*n, _mm512_fmaddsub_pd(va, br, _mm512_mul_pd(vs, bi)));
+            }
+
+            multiply_scalar(N-n, x+n, y+n, r+n);
+        }
+
+        GADGETRON_TARGET_AVX512 void multiplyConj_avx512(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r)
+        {
+            const float* a = reinterpret_cast<const float*>(x);
+            const float* b = reinterpret_cast<const float*>(y);
+            float* c = reinterpret_cast<float*>(r);
+
+            size_t n = 0;
+            for ( ; n+8<=N; n+=8 )
+            {
+                __m512 va = _mm512_loadu_ps(a+2*n);
+                __m512 vb = _mm512_loadu_ps(b+2*n);
+                __m512 br = dup_re_avx512(vb);
+                __m512 bi = dup_im_avx512(vb);
+                __m512 vs = swap_re_im_avx512(va);
+
+                _mm512_storeu_ps(c+2*n, _mm512_fmsubadd_ps(va, br, _mm512_mul_ps(vs, bi)));
+            }
+
+            multiplyConj_scalar(N-n, x+n, y+n, r+n);
+        }
+
+        GADGETRON_TARGET_AVX512 void multiplyConj_avx512(size_t N, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r)
+        {
+            const double* a = reinterpret_cast<const double*>(x);
+            const double* b = reinterpret_cast<const double*>(y);
+            double* c = reinterpret_cast<double*>(r);
+
+            size_t n = 0;
+            for ( ; n+4<=N; n+=4 )
+            {
+                __m512d va = _mm512_loadu_pd(a+2*n);
+                __m512d vb = _mm512_loadu_pd(b+2*n);
+                __m512d br = dup_re_avx512(vb);
+                __m512d bi = dup_im_avx512(vb);
+                __m512d vs = swap_re_im_avx512(va);
+
+                _mm512_storeu_pd(c+2*n, _mm512_fmsubadd_pd(va, br, _mm512_mul_pd(vs, bi)));
+            }
+
+            multiplyConj_scalar(N-n, x+n, y+n, r+n);
+        }
+
+        GADGETRON_TARGET_AVX512 void multiplyAdd_avx512(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r)
+        {
+            const float* a = reinterpret_cast<const float*>(x);
+            const float* b = reinterpret_cast<const float*>(y);
+            float* c = reinterpret_cast<float*>(r);
+
+            size_t n = 0;
+            for ( ; n+8<=N; n+=8 )
+            {
+                __m512 va = _mm512_loadu_ps(a+2*n);
+                __m512 vb = _mm512_loadu_ps(b+2*n);
+                __m512 br = dup_re_avx512(vb);
+                __m512 bi = dup_im_avx512(vb);
+                __m512 vs = swap_re_im_avx512(va);
+
+                __m512 vp = _mm512_fmaddsub_ps(va, br, _mm512_mul_ps(vs, bi));
+                _mm512_storeu_ps(c+2*n, _mm512_add_ps(_mm512_loadu_ps(c+2*n), vp));
+            }
+
+            multiplyAdd_scalar(N-n, x+n, y+n, r+n);
+        }
+
+        GADGETRON_TARGET_AVX512 void multiplyAdd_avx512(size_t N, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r)
+        {
+            const double* a = reinterpret_cast<const double*>(x);
+            const double* b = reinterpret_cast<const double*>(y);
+            double* c = reinterpret_cast<double*>(r);
+
+            size_t n = 0;
+            for ( ; n+4<=N; n+=4 )
+            {
+                __m512d va = _mm512_loadu_pd(a+2*n);
+                __m512d vb = _mm512_loadu_pd(b+2*n);
+                __m512d br = dup_re_avx512(vb);
+                __m512d bi = dup_im_avx512(vb);
+                __m512d vs = swap_re_im_avx512(va);
+
+                __m512d vp = _mm512_fmaddsub_pd(va, br, _mm512_mul_pd(vs, bi));
+                _mm512_storeu_pd(c+2*n, _mm512_add_pd(_mm512_loadu_pd(c+2*n), vp));
+            }
+
+            multiplyAdd_scalar(N-n, x+n, y+n, r+n);
+        }
+
+        GADGETRON_TARGET_AVX512 void addEpsilon_avx512(size_t N, std::complex<float>* x)
+        {
+            const float eps = std::numeric_limits<float>::epsilon();
+            const __m512 veps = _mm512_set1_ps(eps);
+            const __m512 veps2 = _mm512_set1_ps(eps*eps);
+
+            float* a = reinterpret_cast<float*>(x);
+
+            size_t n = 0;
+            for ( ; n+8<=N; n+=8 )
+            {
+                __m512 v = _mm512_loadu_ps(a+2*n);
+                __m512 s = _mm512_mul_ps(v, v);
+
+                // only the real lanes are changed
+                __mmask16 m = _mm512_cmp_ps_mask(_mm512_add_ps(s, swap_re_im_avx512(s)), veps2, _CMP_LT_OQ) & 0x5555;
+                _mm512_storeu_ps(a+2*n, _mm512_mask_add_ps(v, m, v, veps));
+            }
+
+            addEpsilon_scalar(N-n, x+n);
+        }
+
+        GADGETRON_TARGET_AVX512 void addEpsilon_avx512(size_t N, std::complex<double>* x)
+        {
+            const double eps = std::numeric_limits<double>::epsilon();
+            const __m512d veps = _mm512_set1_pd(eps);
+            const __m512d veps2 = _mm512_set1_pd(eps*eps);
+
+            double* a = reinterpret_cast<double*>(x);
+
+            size_t n = 0;
+            for ( ; n+4<=N; n+=4 )
+            {
+                __m512d v = _mm512_loadu_pd(a+2*n);
+                __m512d s = _mm512_mul_pd(v, v);
+                __mmask8 m = _mm512_cmp_pd_mask(_mm512_add_pd(s, swap_re_im_avx512(s)), veps2, _CMP_LT_OQ) & 0x55;
+                _mm512_storeu_pd(a+2*n, _mm512_mask_add_pd(v, m, v, veps));
+            }
+
+            addEpsilon_scalar(N-n, x+n);
+        }
+
+        GADGETRON_TARGET_AVX512 void abs_avx512(size_t N, const std::complex<float>* x, float* r)
+        {
+            const float* a = reinterpret_cast<const float*>(x);
+
+            // even lanes of both registers
+            const __m512i even = _mm512_set_epi32(30, 28, 26, 24, 22, 20, 18, 16, 14, 12, 10, 8, 6, 4, 2, 0);
+
+            size_t n = 0;
+            for ( ; n+16<=N; n+=16 )
+            {
+                __m512 v0 = _mm512_loadu_ps(a+2*n);
+                __m512 v1 = _mm512_loadu_ps(a+2*n+16);
+                v0 = _mm512_mul_ps(v0, v0);
+                v1 = _mm512_mul_ps(v1, v1);
+                v0 = _mm512_add_ps(v0, swap_re_im_avx512(v0));
+                v1 = _mm512_add_ps(v1, swap_re_im_avx512(v1));
+
+                _mm512_storeu_ps(r+n, sqrt_avx512(_mm512_permutex2var_ps(v0, even, v1)));
+            }
+
+            abs_scalar(N-n, x+n, r+n);
+        }
+
+        GADGETRON_TARGET_AVX512 void abs_avx512(size_t N, const std::complex<double>* x, double* r)
+        {
+            const double* a = reinterpret_cast<const double*>(x);
+
+            const __m512i even = _mm512_set_epi64(14, 12, 10, 8, 6, 4, 2, 0);
+
+            size_t n = 0;
+            for ( ; n+8<=N; n+=8 )
+            {
+                __m512d v0 = _mm512_loadu_pd(a+2*n);
+                __m512d v1 = _mm512_loadu_pd(a+2*n+8);
+                v0 = _mm512_mul_pd(v0, v0);
+                v1 = _mm512_mul_pd(v1, v1);
+                v0 = _mm512_add_pd(v0, swap_re_im_avx512(v0));
+                v1 = _mm512_add_pd(v1, swap_re_im_avx512(v1));
+
+                _mm512_storeu_pd(r+n, sqrt_avx512(_mm512_permutex2var_pd(v0, even, v1)));
+            }
+
+            abs_scalar(N-n, x+n, r+n);
+        }
+
+        GADGETRON_TARGET_AVX512 float norm2_square_avx512(size_t N, const std::complex<float>* x)
+        {
+            const float* a = reinterpret_cast<const float*>(x);
+
+            __m512 acc0 = _mm512_setzero_ps();
+            __m512 acc1 = _mm512_setzero_ps();
+
+            size_t n = 0;
+            for ( ; n+16<=N; n+=16 )
+            {
+                __m512 v0 = _mm512_loadu_ps(a+2*n);
+                __m512 v1 = _mm512_loadu_ps(a+2*n+16);
+                acc0 = _mm512_fmadd_ps(v0, v0, acc0);
+                acc1 = _mm512_fmadd_ps(v1, v1, acc1);
+            }
+
+            float s[16];
+            _mm512_storeu_ps(s, _mm512_add_ps(acc0, acc1));
+
+            float sum(0);
+            for ( size_t k=0; k<16; k++ ) sum += s[k];
+
+            return sum + norm2_square_scalar(N-n, x+n);
+        }
+
+        GADGETRON_TARGET_AVX512 double norm2_square_avx512(size_t N, const std::complex<double>* x)
+        {
+            const double* a = reinterpret_cast<const double*>(x);
+
+            __m512d acc0 = _mm512_setzero_pd();
+            __m512d acc1 = _mm512_setzero_pd();
+
+            size_t n = 0;
+            for ( ; n+8<=N; n+=8 )
+            {
+                __m512d v0 = _mm512_loadu_pd(a+2*n);
+                __m512d v1 = _mm512_loadu_pd(a+2*n+8);
+                acc0 = _mm512_fmadd_pd(v0, v0, acc0);
+                acc1 = _mm512_fmadd_pd(v1, v1, acc1);
+            }
+
+            double s[8];
+            _mm512_storeu_pd(s, _mm512_add_pd(acc0, acc1));
+
+            double sum(0);
+            for ( size_t k=0; k<8; k++ ) sum += s[k];
+
+            return sum + norm2_square_scalar(N-n, x+n);
+        }
+
+        GADGETRON_TARGET_AVX512 std::complex<float> dotc_avx512(size_t N, const std::complex<float>* x, const std::complex<float>* y)
+        {
+            const float* a = reinterpret_cast<const float*>(x);
+            const float* b = reinterpret_cast<const float*>(y);
+
+            __m512 accr = _mm512_setzero_ps();
+            __m512 acci = _mm512_setzero_ps();
+
+            size_t n = 0;
+            for ( ; n+8<=N; n+=8 )
+            {
+                __m512 va = _mm512_loadu_ps(a+2*n);
+                __m512 vb = _mm512_loadu_ps(b+2*n);
+                accr = _mm512_fmadd_ps(va, vb, accr);
+                acci = _mm512_fmadd_ps(swap_re_im_avx512(va), vb, acci);
+            }
+
+            float sr[16], si[16];
+            _mm512_storeu_ps(sr, accr);
+            _mm512_storeu_ps(si, acci);
+
+            float re(0), im(0);
+            for ( size_t k=0; k<16; k+=2 )
+            {
+                re += sr[k] + sr[k+1];
+                im += si[k] - si[k+1];
+            }
+
+            return std::complex<float>(re, im) + dotc_scalar(N-n, x+n, y+n);
+        }
+
+        GADGETRON_TARGET_AVX512 std::complex<double> dotc_avx512(size_t N, const std::complex<double>* x, const std::complex<double>* y)
+        {
+            const double* a = reinterpret_cast<const double*>(x);
+            const double* b = reinterpret_cast<const double*>(y);
+
+            __m512d accr = _mm512_setzero_pd();
+            __m512d acci = _mm512_setzero_pd();
+
+            size_t n = 0;
+            for ( ; n+4<=N; n+=4 )
+            {
+                __m512d va = _mm512_loadu_pd(a+2*n);
+                __m512d vb = _mm512_loadu_pd(b+2*n);
+                accr = _mm512_fmadd_pd(va, vb, accr);
+                acci = _mm512_fmadd_pd(swap_re_im_avx512(va), vb, acci);
+            }
+
+            double sr[8], si[8];
+            _mm512_storeu_pd(sr, accr);
+            _mm512_storeu_pd(si, acci);
+
+            double re(0), im(0);
+            for ( size_t k=0; k<8; k+=2 )
+            {
+                re += sr[k] + sr[k+1];
+                im += si[k] - si[k+1];
+            }
+
+            return std::complex<double>(re, im) + dotc_scalar(N-n, x+n, y+n);
+        }
+
+#endif // GADGETRON_SIMD_X86
+
+        // --------------------------------------------------------------------------------
+        // dispatch
+        // --------------------------------------------------------------------------------
+
+        namespace
+        {
+            InstructionSet detect_instruction_set()
+            {
+#ifdef GADGETRON_SIMD_X86
+                __builtin_cpu_init();
+                if ( __builtin_cpu_supports("avx512f") ) return AVX512;
+                if ( __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ) return AVX2;
+#endif
+                return SCALAR;
+            }
+
+            InstructionSet initial_instruction_set()
+            {
+                InstructionSet isa = supported_instruction_set();
+
+                const char* setting = getenv(GADGETRON_SIMD_ENVIRONMENT);
+                if ( setting != NULL && strlen(setting) > 0 )
+                {
+                    if ( strcmp(setting, "scalar") == 0 )
+                    {
+                        isa = SCALAR;
+                    }
+                    else if ( strcmp(setting, "avx2") == 0 )
+                    {
+                        isa = (isa < AVX2) ? isa : AVX2;
+                    }
+                    else if ( strcmp(setting, "avx512") != 0 )
+                    {
+                        GWARN("Unknown %s setting %s, use scalar, avx2 or avx512\n", GADGETRON_SIMD_ENVIRONMENT, setting);
+                    }
+                }
+
+                GDEBUG("hoNDArray complex kernels use %s\n", instruction_set_name(isa));
+                return isa;
+            }
+
+            std::atomic<int>& active_instruction_set()
+            {
+                static std::atomic<int> isa(initial_instruction_set());
+                return isa;
+            }
+        }
+
+        InstructionSet supported_instruction_set()
+        {
+            static const InstructionSet isa = detect_instruction_set();
+            return isa;
+        }
+
+        InstructionSet instruction_set()
+        {
+            return static_cast<InstructionSet>(active_instruction_set().load(std::memory_order_relaxed));
+        }
+
+        void set_instruction_set(InstructionSet isa)
+        {
+            InstructionSet supported = supported_instruction_set();
+            active_instruction_set().store( (isa < supported) ? isa : supported );
+        }
+
+        const char* instruction_set_name(InstructionSet isa)
+        {
+            switch (isa)
+            {
+                case AVX2: return "avx2";
+                case AVX512: return "avx512";
+                default: return "scalar";
+            }
+        }
+
+#ifdef GADGETRON_SIMD_X86
+    #define GADGETRON_SIMD_DISPATCH(name, ...)                                  \
+        switch ( instruction_set() )                                            \
+        {                                                                       \
+            case AVX512: return name##_avx512(__VA_ARGS__);                     \
+            case AVX2: return name##_avx2(__VA_ARGS__);                         \
+            default: return name##_scalar(__VA_ARGS__);                         \
+        }
+#else
+    #define GADGETRON_SIMD_DISPATCH(name, ...) return name##_scalar(__VA_ARGS__);
+#endif
+
+        void multiply(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r)
+        {
+            GADGETRON_SIMD_DISPATCH(multiply, N, x, y, r)
+        }
+
+        void multiply(size_t N, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r)
+        {
+            GADGETRON_SIMD_DISPATCH(multiply, N, x, y, r)
+        }
+
+        void multiplyConj(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r)
+        {
+            GADGETRON_SIMD_DISPATCH(multiplyConj, N, x, y, r)
+        }
+
+        void multiplyConj(size_t N, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r)
+        {
+            GADGETRON_SIMD_DISPATCH(multiplyConj, N, x, y, r)
+        }
+
+        void multiplyAdd(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r)
+        {
+            GADGETRON_SIMD_DISPATCH(multiplyAdd, N, x, y, r)
+        }
+
+        void multiplyAdd(size_t N, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r)
+        {
+            GADGETRON_SIMD_DISPATCH(multiplyAdd, N, x, y, r)
+        }
+
+        void addEpsilon(size_t N, std::complex<float>* x)
+        {
+            GADGETRON_SIMD_DISPATCH(addEpsilon, N, x)
+        }
+
+        void addEpsilon(size_t N, std::complex<double>* x)
+        {
+            GADGETRON_SIMD_DISPATCH(addEpsilon, N, x)
+        }
+
+        void abs(size_t N, const std::complex<float>* x, float* r)
+        {
+            GADGETRON_SIMD_DISPATCH(abs, N, x, r)
+        }
+
+        void abs(size_t N, const std::complex<double>* x, double* r)
+        {
+            GADGETRON_SIMD_DISPATCH(abs, N, x, r)
+        }
+
+        float norm2_square(size_t N, const std::complex<float>* x)
+        {
+            GADGETRON_SIMD_DISPATCH(norm2_square, N, x)
+        }
+
+        double norm2_square(size_t N, const std::complex<double>* x)
+        {
+            GADGETRON_SIMD_DISPATCH(norm2_square, N, x)
+        }
+
+        std::complex<float> dotc(size_t N, const std::complex<float>* x, const std::complex<float>* y)
+        {
+            GADGETRON_SIMD_DISPATCH(dotc, N, x, y)
+        }
+
+        std::complex<double> dotc(size_t N, const std::complex<double>* x, const std::complex<double>* y)
+        {
+            GADGETRON_SIMD_DISPATCH(dotc, N, x, y)
+        }
+    }
+}
@@ -0,0 +1,76 @@
+/** \file   hoNDArray_simd.h
+    \brief  Vectorized kernels for the hot complex elementwise operations of hoNDArray
+
+            The compilers rarely vectorize loops over interleaved std::complex data. These kernels implement
+            them explicitly with AVX2/FMA and AVX-512 and pick the widest instruction set supported by the CPU
+            at runtime, so the library can still be built for a generic x86-64 target. Other platforms use the
+            scalar kernels.
+
+            The kernels process one contiguous block on the calling thread; the hoNDArray functions in
+            hoNDArray_elemwise.cpp and hoNDArray_reductions.cpp split large arrays over OpenMP threads.
+
+            The instruction set can be forced for testing with set_instruction_set() or through the environment:
+
+                GADGETRON_SIMD=scalar|avx2|avx512
+*/
+
+#pragma once
+
+#include "cpucore_math_export.h"
+
+#include <complex>
+#include <cstddef>
+
+#define GADGETRON_SIMD_ENVIRONMENT "GADGETRON_SIMD"
+
+namespace Gadgetron
+{
+    namespace simd
+    {
+        enum InstructionSet
+        {
+            SCALAR = 0,
+            AVX2 = 1,
+            AVX512 = 2
+        };
+
+        /// widest instruction set supported by the CPU
+        EXPORTCPUCOREMATH InstructionSet supported_instruction_set();
+
+        /// instruction set used by the kernels
+        EXPORTCPUCOREMATH InstructionSet instruction_set();
+
+        /// use a narrower instruction set than supported, wider requests are clamped to the supported one
+        EXPORTCPUCOREMATH void set_instruction_set(InstructionSet isa);
+
+        EXPORTCPUCOREMATH const char* instruction_set_name(InstructionSet isa);
+
+        /// r = x * y
+        EXPORTCPUCOREMATH void multiply(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r);
+        EXPORTCPUCOREMATH void multiply(size_t N, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r);
+
+        /// r = x * conj(y)
+        EXPORTCPUCOREMATH void multiplyConj(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r);
+        EXPORTCPUCOREMATH void multiplyConj(size_t N, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r);
+
+        /// r += x * y
+        EXPORTCPUCOREMATH void multiplyAdd(size_t N, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r);
+        EXPORTCPUCOREMATH void multiplyAdd(size_t N, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r);
+
+        /// x += eps for |x| < eps, eps being the machine epsilon
+        EXPORTCPUCOREMATH void addEpsilon(size_t N, std::complex<float>* x);
+        EXPORTCPUCOREMATH void addEpsilon(size_t N, std::complex<double>* x);
+
+        /// r = |x|
+        EXPORTCPUCOREMATH void abs(size_t N, const std::complex<float>* x, float* r);
+        EXPORTCPUCOREMATH void abs(size_t N, const std::complex<double>* x, double* r);
+
+        /// sum of |x|^2, the square of the 2-norm
+        EXPORTCPUCOREMATH float norm2_square(size_t N, const std::complex<float>* x);
+        EXPORTCPUCOREMATH double norm2_square(size_t N, const std::complex<double>* x);
+
+        /// sum of x * conj(y)
+        EXPORTCPUCOREMATH std::complex<float> dotc(size_t N, const std::complex<float>* x, const std::complex<float>* y);
+        EXPORTCPUCOREMATH std::complex<double> dotc(size_t N, const std::complex<double>* x, const std::complex<double>* y);
+    }
+}
@@ -8,6 +8,11 @@
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_math.h"
 
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
 namespace Gadgetron{
 
 template<typename T> hoNDFFT<T>* hoNDFFT<T>::instance()
@@ -18,6 +23,215 @@ template<typename T> hoNDFFT<T>* hoNDFFT<T>::instance()
 
 template<class T> hoNDFFT<T>* hoNDFFT<T>::instance_ = NULL;
 
+template<typename T> hoNDFFT<T>::hoNDFFT()
+	: plan_cache_hits_(0)
+	, plan_cache_misses_(0)
+	, plans_uncached_(0)
+	, cached_plans_(0)
+	, planning_seconds_(0)
+{
+#ifdef USE_OMP
+	num_of_max_threads_ = omp_get_num_procs();
+#else
+	num_of_max_threads_ = 1;
+#endif // USE_OMP
+
+	for (size_t i = 0; i < PLAN_CACHE_SIZE; i++) plan_cache_[i] = NULL;
+
+	const char* wisdom = std::getenv(GADGETRON_FFTW_WISDOM_ENVIRONMENT);
+	if (wisdom != NULL && std::strlen(wisdom) > 0)
+	{
+		wisdom_file_ = std::string(wisdom) + ((sizeof(T) == sizeof(float)) ? "_float.wisdom" : "_double.wisdom");
+		if (load_wisdom(wisdom_file_))
+		{
+			GDEBUG_STREAM("hoNDFFT: loaded FFTW wisdom from " << wisdom_file_ << std::endl);
+		}
+		std::atexit(&hoNDFFT<T>::save_wisdom_at_exit);
+	}
+}
+
+template<typename T> hoNDFFT<T>::~hoNDFFT()
+{
+	for (size_t i = 0; i < PLAN_CACHE_SIZE; i++)
+	{
+		PlanEntry* e = plan_cache_[i].load();
+		if (e != NULL)
+		{
+			fftw_destroy_plan_(e->plan);
+			delete e;
+		}
+	}
+	fftw_cleanup_();
+}
+
+template<typename T> void hoNDFFT<T>::save_wisdom_at_exit()
+{
+	if (instance_ != NULL && !instance_->wisdom_file_.empty())
+	{
+		instance_->save_wisdom(instance_->wisdom_file_);
+	}
+}
+
+template<typename T> bool hoNDFFT<T>::load_wisdom(const std::string& filename)
+{
+	FILE* f = std::fopen(filename.c_str(), "r");
+	if (f == NULL) return false;
+
+	int res;
+	{
+		boost::mutex::scoped_lock lock(mutex_);
+		res = fftw_import_wisdom_from_file_(f);
+	}
+	std::fclose(f);
+	return (res != 0);
+}
+
+template<typename T> bool hoNDFFT<T>::save_wisdom(const std::string& filename)
+{
+	FILE* f = std::fopen(filename.c_str(), "w");
+	if (f == NULL) return false;
+
+	{
+		boost::mutex::scoped_lock lock(mutex_);
+		fftw_export_wisdom_to_file_(f);
+	}
+	std::fclose(f);
+	return true;
+}
+
+template<typename T>
+typename hoNDFFT<T>::PlanEntry* hoNDFFT<T>::find_plan(const PlanKey& key, size_t hash)
+{
+	for (size_t i = 0; i < PLAN_CACHE_SIZE; i++)
+	{
+		PlanEntry* e = plan_cache_[(hash + i) % PLAN_CACHE_SIZE].load(std::memory_order_acquire);
+		if (e == NULL) return NULL;
+		if (std::memcmp(&e->key, &key, sizeof(PlanKey)) == 0) return e;
+	}
+	return NULL;
+}
+
+template<typename T>
+typename fftw_types<T>::plan * hoNDFFT<T>::get_plan(int rank, const int* n, int howmany,
+		ComplexType* in, int istride, int idist,
+		ComplexType* out, int ostride, int odist,
+		int sign, unsigned flags, bool& cached)
+{
+	if (rank < 1 || rank > 3) throw std::runtime_error("hoNDFFT::get_plan: unsupported rank");
+
+	PlanKey key;
+	std::memset(&key, 0, sizeof(PlanKey));
+	key.rank = rank;
+	for (int d = 0; d < rank; d++) key.n[d] = n[d];
+	key.howmany = howmany;
+	key.istride = istride;
+	key.idist = idist;
+	key.ostride = ostride;
+	key.odist = odist;
+	key.sign = sign;
+	key.in_place = (in == out) ? 1 : 0;
+	key.ialign = fftw_alignment_of_(in);
+	key.oalign = fftw_alignment_of_(out);
+	key.flags = flags;
+
+	// FNV-1a over the key
+	size_t hash = 2166136261U;
+	const unsigned char* kb = reinterpret_cast<const unsigned char*>(&key);
+	for (size_t b = 0; b < sizeof(PlanKey); b++) hash = (hash ^ kb[b]) * 16777619U;
+
+	PlanEntry* e = find_plan(key, hash);
+	if (e != NULL)
+	{
+		plan_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+		cached = true;
+		return e->plan;
+	}
+
+	boost::mutex::scoped_lock lock(mutex_);
+
+	// another thread may have created the plan while we waited for the lock
+	e = find_plan(key, hash);
+	if (e != NULL)
+	{
+		plan_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+		cached = true;
+		return e->plan;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	typename fftw_types<T>::plan * p = fftw_plan_many_dft_(rank, n, howmany,
+			in, NULL, istride, idist,
+			out, NULL, ostride, odist,
+			sign, flags);
+	planning_seconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	if (p == NULL) throw std::runtime_error("hoNDFFT: failed to create fft plan");
+	plan_cache_misses_++;
+
+	if (cached_plans_ < PLAN_CACHE_SIZE)
+	{
+		for (size_t i = 0; i < PLAN_CACHE_SIZE; i++)
+		{
+			size_t slot = (hash + i) % PLAN_CACHE_SIZE;
+			if (plan_cache_[slot].load(std::memory_order_relaxed) == NULL)
+			{
+				e = new PlanEntry;
+				e->key = key;
+				e->plan = p;
+				plan_cache_[slot].store(e, std::memory_order_release);
+				cached_plans_++;
+				cached = true;
+				return p;
+			}
+		}
+	}
+
+	plans_uncached_++;
+	cached = false;
+	return p;
+}
+
+template<typename T>
+void hoNDFFT<T>::release_plan(typename fftw_types<T>::plan * p, bool cached)
+{
+	if (cached || p == NULL) return;
+	boost::mutex::scoped_lock lock(mutex_);
+	fftw_destroy_plan_(p);
+}
+
+template<typename T>
+inline unsigned hoNDFFT<T>::offset_flags(const ComplexType* in, const ComplexType* out, size_t offset)
+{
+	// if one step keeps the SIMD alignment, all multiples of it do
+	if ( fftw_alignment_of_(in) != fftw_alignment_of_(in+offset) ) return FFTW_UNALIGNED;
+	if ( fftw_alignment_of_(out) != fftw_alignment_of_(out+offset) ) return FFTW_UNALIGNED;
+	return 0;
+}
+
+template<typename T>
+typename hoNDFFT<T>::PlanCacheStatistics hoNDFFT<T>::get_plan_cache_statistics()
+{
+	PlanCacheStatistics s;
+	boost::mutex::scoped_lock lock(mutex_);
+	s.hits = plan_cache_hits_.load();
+	s.misses = plan_cache_misses_;
+	s.uncached = plans_uncached_;
+	s.cached_plans = cached_plans_;
+	s.planning_seconds = planning_seconds_;
+	return s;
+}
+
+template<typename T>
+void hoNDFFT<T>::print_plan_cache_statistics()
+{
+	PlanCacheStatistics s = get_plan_cache_statistics();
+	unsigned long long total = s.hits + s.misses;
+	GINFO("hoNDFFT<%s>: %llu plans cached, %llu hits, %llu misses (%.1f%% hit rate), %llu uncached, %.3f s planning\n",
+		(sizeof(T) == sizeof(float)) ? "float" : "double",
+		(unsigned long long)s.cached_plans, s.hits, s.misses,
+		total ? 100.0*s.hits/total : 0.0, s.uncached, s.planning_seconds);
+}
+
 
 template<class T> void hoNDFFT<T>::fft_int_uneven(hoNDArray< ComplexType >* input, size_t dim_to_transform, int sign)
    {
@@ -77,9 +291,12 @@ template<class T> void hoNDFFT<T>::fft_int_uneven(hoNDArray< ComplexType >* inpu
 
 
        //Allocate storage and make plan
+       bool plan_cached = false;
        {
-           mutex_.lock();
-           fft_storage = (ComplexType*)fftw_malloc_(sizeof(T)*length*2);
+           {
+               boost::mutex::scoped_lock lock(mutex_);
+               fft_storage = (ComplexType*)fftw_malloc_(sizeof(T)*length*2);
+           }
            if (fft_storage == 0)
            {
                GDEBUG_STREAM("Failed to allocate buffer for FFT" << std::endl);
@@ -89,15 +306,17 @@ template<class T> void hoNDFFT<T>::fft_int_uneven(hoNDArray< ComplexType >* inpu
 
            unsigned planner_flags = FFTW_MEASURE | FFTW_DESTROY_INPUT;
 
-           fft_plan = fftw_plan_dft_1d_(length, fft_storage, fft_storage, sign, planner_flags);
-
-           if (fft_plan == 0)
+           try
+           {
+               fft_plan = get_plan(1, &length, 1, fft_storage, 1, length, fft_storage, 1, length, sign, planner_flags, plan_cached);
+           }
+           catch (...)
            {
+               boost::mutex::scoped_lock lock(mutex_);
                fftw_free_(fft_storage);
                GDEBUG_STREAM("Failed to create plan for FFT" << std::endl);
                return;
            }
-           mutex_.unlock();
        }
 
        //Grab address of data
@@ -126,7 +345,7 @@ template<class T> void hoNDFFT<T>::fft_int_uneven(hoNDArray< ComplexType >* inpu
                    }
                }
 
-               fftw_execute_(fft_plan);
+               fftw_execute_dft_(fft_plan, fft_buffer, fft_buffer);
 
                {
                    int j, idx3 = idx2;
@@ -146,18 +365,13 @@ template<class T> void hoNDFFT<T>::fft_int_uneven(hoNDArray< ComplexType >* inpu
        } //Loop over chunks
 
        //clean up
+       release_plan(fft_plan, plan_cached);
        {
-           mutex_.lock();
-           if (fft_plan != 0)
-           {
-               fftw_destroy_plan_(fft_plan);
-           }
-
+           boost::mutex::scoped_lock lock(mutex_);
            if (fft_storage != 0)
            {
                fftw_free_(fft_storage);
            }
-           mutex_.unlock();
        }
    }
 
@@ -221,20 +435,11 @@ template<class T> void hoNDFFT<T>::fft_int(hoNDArray< ComplexType >* input, size
 //Grab address of data
 	ComplexType* data_ptr = input->get_data_ptr();
 
-	//Allocate storage and make plan
-	{
-		mutex_.lock();
-
-		unsigned planner_flags = FFTW_ESTIMATE;
-		fft_plan = fftw_plan_many_dft_(1,&length,trafos,data_ptr,&length,stride,dist,data_ptr,&length,stride,dist,sign,planner_flags);
-		//fftw_print_plan_(fft_plan);
-		if (fft_plan == NULL)
-		{
-			throw std::runtime_error("hoNDFFT: failed to create fft plan");
-		}
-		mutex_.unlock();
-
-	}
+	//Find or make plan
+	bool plan_cached = false;
+	unsigned planner_flags = FFTW_ESTIMATE | offset_flags(data_ptr, data_ptr, chunk_size);
+	fft_plan = get_plan(1,&length,trafos,data_ptr,stride,dist,data_ptr,stride,dist,sign,planner_flags,plan_cached);
+	//fftw_print_plan_(fft_plan);
 
 #pragma omp parallel for
 	for (int k = 0; k < chunks; k++)
@@ -246,15 +451,7 @@ template<class T> void hoNDFFT<T>::fft_int(hoNDArray< ComplexType >* input, size
 
 
 	//clean up
-	{
-		mutex_.lock();
-		if (fft_plan != 0)
-		{
-			fftw_destroy_plan_(fft_plan);
-		}
-
-		mutex_.unlock();
-	}
+	release_plan(fft_plan, plan_cached);
 
 
 	*input *= scale;
@@ -768,6 +965,12 @@ inline void hoNDFFT<T>::ifft1(const hoNDArray< ComplexType >& a, hoNDArray< Comp
 template<typename T>
 inline void hoNDFFT<T>::fft1c(hoNDArray< ComplexType >& a)
 {
+	if ( centered_fusable(a, 1) )
+	{
+		fftc(a, a, 1, true);
+		return;
+	}
+
 	ifftshift1D(a);
 	fft1(a);
 	fftshift1D(a);
@@ -776,6 +979,12 @@ inline void hoNDFFT<T>::fft1c(hoNDArray< ComplexType >& a)
 template<typename T>
 inline void hoNDFFT<T>::ifft1c(hoNDArray< ComplexType >& a)
 {
+	if ( centered_fusable(a, 1) )
+	{
+		fftc(a, a, 1, false);
+		return;
+	}
+
 	ifftshift1D(a);
 	ifft1(a);
 	fftshift1D(a);
@@ -784,6 +993,17 @@ inline void hoNDFFT<T>::ifft1c(hoNDArray< ComplexType >& a)
 template<typename T>
 inline void hoNDFFT<T>::fft1c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r)
 {
+	if ( centered_fusable(a, 1) )
+	{
+		if ( !r.dimensions_equal(&a) )
+		{
+			r.create(a.get_dimensions());
+		}
+
+		fftc(a, r, 1, true);
+		return;
+	}
+
 	ifftshift1D(a, r);
 	fft1(r);
 	fftshift1D(r);
@@ -793,6 +1013,17 @@ inline void hoNDFFT<T>::fft1c(const hoNDArray< ComplexType >& a, hoNDArray< Comp
 template<typename T>
 inline void hoNDFFT<T>::ifft1c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r)
 {
+	if ( centered_fusable(a, 1) )
+	{
+		if ( !r.dimensions_equal(&a) )
+		{
+			r.create(a.get_dimensions());
+		}
+
+		fftc(a, r, 1, false);
+		return;
+	}
+
 	ifftshift1D(a, r);
 	ifft1(r);
 	fftshift1D(r);
@@ -801,6 +1032,17 @@ inline void hoNDFFT<T>::ifft1c(const hoNDArray< ComplexType >& a, hoNDArray< Com
 template<typename T>
 inline void hoNDFFT<T>::fft1c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, hoNDArray< ComplexType >& buf)
 {
+	if ( centered_fusable(a, 1) )
+	{
+		if ( !r.dimensions_equal(&a) )
+		{
+			r.create(a.get_dimensions());
+		}
+
+		fftc(a, r, 1, true);
+		return;
+	}
+
 	ifftshift1D(a, r);
 	fft1(r, buf);
 	fftshift1D(buf, r);
@@ -809,6 +1051,17 @@ inline void hoNDFFT<T>::fft1c(const hoNDArray< ComplexType >& a, hoNDArray< Comp
 template<typename T>
 inline void hoNDFFT<T>::ifft1c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, hoNDArray< ComplexType >& buf)
 {
+	if ( centered_fusable(a, 1) )
+	{
+		if ( !r.dimensions_equal(&a) )
+		{
+			r.create(a.get_dimensions());
+		}
+
+		fftc(a, r, 1, false);
+		return;
+	}
+
 	ifftshift1D(a, r);
 	ifft1(r, buf);
 	fftshift1D(buf, r);
@@ -858,6 +1111,12 @@ inline void hoNDFFT<T>::ifft2(const hoNDArray< ComplexType >& a, hoNDArray< Comp
 template<typename T>
 inline void hoNDFFT<T>::fft2c(hoNDArray< ComplexType >& a)
 {
+	if ( centered_fusable(a, 2) )
+	{
+		fftc(a, a, 2, true);
+		return;
+	}
+
 	ifftshift2D(a);
 	fft2(a);
 	fftshift2D(a);
@@ -867,6 +1126,12 @@ inline void hoNDFFT<T>::fft2c(hoNDArray< ComplexType >& a)
 template<typename T>
 inline void hoNDFFT<T>::ifft2c(hoNDArray< ComplexType >& a)
 {
+	if ( centered_fusable(a, 2) )
+	{
+		fftc(a, a, 2, false);
+		return;
+	}
+
 	ifftshift2D(a);
 	ifft2(a);
 	fftshift2D(a);
@@ -875,6 +1140,17 @@ inline void hoNDFFT<T>::ifft2c(hoNDArray< ComplexType >& a)
 template<typename T>
 inline void hoNDFFT<T>::fft2c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r)
 {
+	if ( centered_fusable(a, 2) )
+	{
+		if ( !r.dimensions_equal(&a) )
+		{
+			r.create(a.get_dimensions());
+		}
+
+		fftc(a, r, 2, true);
+		return;
+	}
+
 	ifftshift2D(a, r);
 	fft2(r);
 	fftshift2D(r);
@@ -883,6 +1159,17 @@ inline void hoNDFFT<T>::fft2c(const hoNDArray< ComplexType >& a, hoNDArray< Comp
 template<typename T>
 inline void hoNDFFT<T>::ifft2c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r)
 {
+	if ( centered_fusable(a, 2) )
+	{
+		if ( !r.dimensions_equal(&a) )
+		{
+			r.create(a.get_dimensions());
+		}
+
+		fftc(a, r, 2, false);
+		return;
+	}
+
 	ifftshift2D(a, r);
 	ifft2(r);
 	fftshift2D(r);
@@ -891,6 +1178,17 @@ inline void hoNDFFT<T>::ifft2c(const hoNDArray< ComplexType >& a, hoNDArray< Com
 template<typename T>
 inline void hoNDFFT<T>::fft2c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, hoNDArray< ComplexType >& buf)
 {
+	if ( centered_fusable(a, 2) )
+	{
+		if ( !r.dimensions_equal(&a) )
+		{
+			r.create(a.get_dimensions());
+		}
+
+		fftc(a, r, 2, true);
+		return;
+	}
+
 	ifftshift2D(a, r);
 	fft2(r, buf);
 	fftshift2D(buf, r);
@@ -899,6 +1197,17 @@ inline void hoNDFFT<T>::fft2c(const hoNDArray< ComplexType >& a, hoNDArray< Comp
 template<typename T>
 inline void hoNDFFT<T>::ifft2c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, hoNDArray< ComplexType >& buf)
 {
+	if ( centered_fusable(a, 2) )
+	{
+		if ( !r.dimensions_equal(&a) )
+		{
+			r.create(a.get_dimensions());
+		}
+
+		fftc(a, r, 2, false);
+		return;
+	}
+
 	ifftshift2D(a, r);
 	ifft2(r, buf);
 	fftshift2D(buf, r);
@@ -947,6 +1256,12 @@ inline void hoNDFFT<T>::ifft3(const hoNDArray< ComplexType >& a, hoNDArray< Comp
 template<typename T>
 inline void hoNDFFT<T>::fft3c(hoNDArray< ComplexType >& a)
 {
+	if ( centered_fusable(a, 3) )
+	{
+		fftc(a, a, 3, true);
+		return;
+	}
+
 	ifftshift3D(a);
 	fft3(a);
 	fftshift3D(a);
@@ -955,6 +1270,12 @@ inline void hoNDFFT<T>::fft3c(hoNDArray< ComplexType >& a)
 template<typename T>
 inline void hoNDFFT<T>::ifft3c(hoNDArray< ComplexType >& a)
 {
+	if ( centered_fusable(a, 3) )
+	{
+		fftc(a, a, 3, false);
+		return;
+	}
+
 	ifftshift3D(a);
 	ifft3(a);
 	fftshift3D(a);
@@ -963,6 +1284,17 @@ inline void hoNDFFT<T>::ifft3c(hoNDArray< ComplexType >& a)
 template<typename T>
 inline void hoNDFFT<T>::fft3c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r)
 {
+	if ( centered_fusable(a, 3) )
+	{
+		if ( !r.dimensions_equal(&a) )
+		{
+			r.create(a.get_dimensions());
+		}
+
+		fftc(a, r, 3, true);
+		return;
+	}
+
 	ifftshift3D(a, r);
 	fft3(r);
 	fftshift3D(r);
@@ -971,6 +1303,17 @@ inline void hoNDFFT<T>::fft3c(const hoNDArray< ComplexType >& a, hoNDArray< Comp
 template<typename T>
 inline void hoNDFFT<T>::ifft3c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r)
 {
+	if ( centered_fusable(a, 3) )
+	{
+		if ( !r.dimensions_equal(&a) )
+		{
+			r.create(a.get_dimensions());
+		}
+
+		fftc(a, r, 3, false);
+		return;
+	}
+
 	ifftshift3D(a, r);
 	ifft3(r);
 	fftshift3D(r);
@@ -979,6 +1322,17 @@ inline void hoNDFFT<T>::ifft3c(const hoNDArray< ComplexType >& a, hoNDArray< Com
 template<typename T>
 inline void hoNDFFT<T>::fft3c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, hoNDArray< ComplexType >& buf)
 {
+	if ( centered_fusable(a, 3) )
+	{
+		if ( !r.dimensions_equal(&a) )
+		{
+			r.create(a.get_dimensions());
+		}
+
+		fftc(a, r, 3, true);
+		return;
+	}
+
 	ifftshift3D(a, r);
 	fft3(r, buf);
 	fftshift3D(buf, r);
@@ -987,6 +1341,17 @@ inline void hoNDFFT<T>::fft3c(const hoNDArray< ComplexType >& a, hoNDArray< Comp
 template<typename T>
 inline void hoNDFFT<T>::ifft3c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, hoNDArray< ComplexType >& buf)
 {
+	if ( centered_fusable(a, 3) )
+	{
+		if ( !r.dimensions_equal(&a) )
+		{
+			r.create(a.get_dimensions());
+		}
+
+		fftc(a, r, 3, false);
+		return;
+	}
+
 	ifftshift3D(a, r);
 	ifft3(r, buf);
 	fftshift3D(buf, r);
@@ -1029,21 +1394,12 @@ void hoNDFFT<T>::fft1(hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r,
 
 
 	typename fftw_types<T>::plan * p;
+	bool cached = false;
 
 	if( num_thr > 1 )
 	{
-		{
-			mutex_.lock();
-			if ( forward )
-			{
-				p = fftw_plan_dft_1d_(n0,a.get_data_ptr(),r.get_data_ptr(),FFTW_FORWARD,FFTW_ESTIMATE);
-			}
-			else
-			{
-				p = fftw_plan_dft_1d_(n0,a.get_data_ptr(),r.get_data_ptr(),FFTW_BACKWARD,FFTW_ESTIMATE);
-			}
-			mutex_.unlock();
-		}
+		p = get_plan(1, &n0, 1, a.get_data_ptr(), 1, n0, r.get_data_ptr(), 1, n0,
+				forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE | offset_flags(a.get_data_ptr(), r.get_data_ptr(), n0), cached);
 
 #pragma omp parallel for private(n) shared(num, p, a, n0, r) num_threads(num_thr)
 		for ( n=0; n<num; n++ )
@@ -1051,48 +1407,18 @@ void hoNDFFT<T>::fft1(hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r,
 			fftw_execute_dft_(p, a.get_data_ptr()+n*n0,
 					r.get_data_ptr()+n*n0);
 		}
-
-		{
-			mutex_.lock();
-			fftw_destroy_plan_(p);
-			mutex_.unlock();
-		}
 	}
 	else
 	{
 		// multiple fft interface
-		{
-			mutex_.lock();
-			if ( forward )
-			{
-				p = fftw_plan_many_dft_(1, &n0, num,
-						a.get_data_ptr(), NULL,
-						1, n0,
-						r.get_data_ptr(), NULL,
-						1, n0,
-						FFTW_FORWARD, FFTW_ESTIMATE);
-			}
-			else
-			{
-				p = fftw_plan_many_dft_(1, &n0, num,
-						a.get_data_ptr(),NULL,
-						1, n0,
-						r.get_data_ptr(), NULL,
-						1, n0,
-						FFTW_BACKWARD, FFTW_ESTIMATE);
-			}
-			mutex_.unlock();
-		}
-
-		fftw_execute_(p);
+		p = get_plan(1, &n0, num, a.get_data_ptr(), 1, n0, r.get_data_ptr(), 1, n0,
+				forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE, cached);
 
-		{
-			mutex_.lock();
-			fftw_destroy_plan_(p);
-			mutex_.unlock();
-		}
+		fftw_execute_dft_(p, a.get_data_ptr(), r.get_data_ptr());
 	}
 
+	release_plan(p, cached);
+
 	r *= fftRatio;
 }
 
@@ -1113,17 +1439,14 @@ void hoNDFFT<T>::fft2(hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r,
 
 
 	typename fftw_types<T>::plan * p;
+	bool cached = false;
+
+	int dims[] = {n0, n1};
 
 	if ( num_thr > 1 )
 	{
-		{
-			mutex_.lock();
-			p = fftw_plan_dft_2d_(n0, n1,
-					a.begin(),
-					r.begin(),
-					forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-			mutex_.unlock();
-		}
+		p = get_plan(2, dims, 1, a.begin(), 1, n0*n1, r.begin(), 1, n0*n1,
+				forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE | offset_flags(a.begin(), r.begin(), n0*n1), cached);
 
 #pragma omp parallel for private(n) shared(num, p, a, n0, n1, r) num_threads(num_thr)
 		for ( n=0; n<num; n++ )
@@ -1131,43 +1454,21 @@ void hoNDFFT<T>::fft2(hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r,
 			fftw_execute_dft_(p, a.begin()+n*n0*n1,
 					r.begin()+n*n0*n1);
 		}
-
-		{
-			mutex_.lock();
-			fftw_destroy_plan_(p);
-			mutex_.unlock();
-		}
 	}
 	else
 	{
 		// multiple fft interface
-
-		int n[] = {n0, n1};
 		int idist = n0*n1;
 		int odist = n0*n1;
 
-		{
-			mutex_.lock();
-
-			p = fftw_plan_many_dft_(2, n, num,
-					a.begin(), NULL,
-					1, idist,
-					r.begin(), NULL,
-					1, odist,
-					forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-
-			mutex_.unlock();
-		}
+		p = get_plan(2, dims, num, a.begin(), 1, idist, r.begin(), 1, odist,
+				forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE, cached);
 
-		fftw_execute_(p);
-
-		{
-			mutex_.lock();
-			fftw_destroy_plan_(p);
-			mutex_.unlock();
-		}
+		fftw_execute_dft_(p, a.begin(), r.begin());
 	}
 
+	release_plan(p, cached);
+
 	r *= fftRatio;
 
 }
@@ -1189,17 +1490,11 @@ void hoNDFFT<T>::fft3(hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r,
 	long long n;
 
 	typename fftw_types<T>::plan * p;
+	bool cached = false;
 
-	{
-		mutex_.lock();
-
-		p = fftw_plan_dft_3d_(n0, n1, n2,
-				a.get_data_ptr(),
-				r.get_data_ptr(),
-				forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-
-		mutex_.unlock();
-	}
+	int dims[] = {n0, n1, n2};
+	p = get_plan(3, dims, 1, a.get_data_ptr(), 1, n0*n1*n2, r.get_data_ptr(), 1, n0*n1*n2,
+			forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE | offset_flags(a.get_data_ptr(), r.get_data_ptr(), n0*n1*n2), cached);
 
 #pragma omp parallel for private(n) shared(num, p, a, n0, n1, n2, r) if (num_thr > 1) num_threads(num_thr)
 	for ( n=0; n<num; n++ )
@@ -1208,15 +1503,105 @@ void hoNDFFT<T>::fft3(hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r,
 				r.begin()+n*n0*n1*n2);
 	}
 
+	release_plan(p, cached);
+
+	r *= fftRatio;
+
+}
+template<typename T>
+bool hoNDFFT<T>::centered_fusable(const hoNDArray< ComplexType >& a, size_t rank)
+{
+	if ( a.get_number_of_dimensions() < rank ) return false;
+
+	for ( size_t d=0; d<rank; d++ )
 	{
-		mutex_.lock();
-		fftw_destroy_plan_(p);
-		mutex_.unlock();
+		if ( a.get_size(d)%2 != 0 ) return false;
 	}
 
-	r *= fftRatio;
+	return (a.get_number_of_elements() > 0);
+}
 
+template<typename T>
+void hoNDFFT<T>::fftc(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, size_t rank, bool forward)
+{
+	size_t n[3] = {1, 1, 1};
+	for ( size_t d=0; d<rank; d++ ) n[d] = a.get_size(d);
+
+	size_t len = n[0]*n[1]*n[2];
+	size_t num = a.get_number_of_elements()/len;
+
+	// (-1)^(N/2) for every transformed dimension, together with the unitary scaling
+	T scale = T(1.0/std::sqrt( T(len) ));
+	for ( size_t d=0; d<rank; d++ )
+	{
+		if ( (n[d]/2)%2 == 1 ) scale = -scale;
+	}
+
+	chessboard(a.begin(), r.begin(), n[0], n[1], n[2], num, T(1));
+
+	// fftw expects the slowest varying dimension first
+	int dims[3];
+	for ( size_t d=0; d<rank; d++ ) dims[d] = (int)n[rank-1-d];
+
+	int num_thr = 1;
+	if ( rank == 1 )
+		num_thr = get_num_threads_fft1(n[0], num);
+	else if ( rank == 2 )
+		num_thr = get_num_threads_fft2(n[1], n[0], num);
+	else
+		num_thr = get_num_threads_fft3(n[2], n[1], n[0], num);
+
+	ComplexType* data = r.begin();
+	int sign = forward ? FFTW_FORWARD : FFTW_BACKWARD;
+	bool cached = false;
+	typename fftw_types<T>::plan * p;
+
+	if ( num_thr > 1 )
+	{
+		p = get_plan((int)rank, dims, 1, data, 1, (int)len, data, 1, (int)len, sign, FFTW_ESTIMATE | offset_flags(data, data, len), cached);
+
+		long long k;
+#pragma omp parallel for private(k) shared(num, p, data, len) num_threads(num_thr)
+		for ( k=0; k<(long long)num; k++ )
+		{
+			fftw_execute_dft_(p, data+k*len, data+k*len);
+		}
+	}
+	else
+	{
+		p = get_plan((int)rank, dims, (int)num, data, 1, (int)len, data, 1, (int)len, sign, FFTW_ESTIMATE, cached);
+		fftw_execute_dft_(p, data, data);
+	}
+
+	release_plan(p, cached);
+
+	chessboard(data, data, n[0], n[1], n[2], num, scale);
 }
+
+template<typename T>
+void hoNDFFT<T>::chessboard(const ComplexType* in, ComplexType* out, size_t n0, size_t n1, size_t n2, size_t num, T scale)
+{
+	long long lines = (long long)(n1*n2*num);
+	long long l;
+
+#pragma omp parallel for private(l) shared(in, out, n0, n1, n2, lines, scale) if (lines*n0 > 64*1024)
+	for ( l=0; l<lines; l++ )
+	{
+		size_t j = (size_t)l % n1;
+		size_t k = ((size_t)l / n1) % n2;
+		T c = ((j+k)%2 == 0) ? scale : -scale;
+
+		const ComplexType* pIn = in + l*n0;
+		ComplexType* pOut = out + l*n0;
+
+		for ( size_t i=0; i<n0; i+=2 )
+		{
+			pOut[i] = pIn[i]*c;
+			pOut[i+1] = pIn[i+1]*(-c);
+		}
+	}
+}
+
 // TODO: implement more optimized threading strategy
 template<typename T>
 inline int hoNDFFT<T>::get_num_threads_fft1(size_t n0, size_t num)
@@ -1426,6 +1811,14 @@ template<> void hoNDFFT<double>::fftw_destroy_plan_( typename fftw_types<double>
 	fftw_destroy_plan(p);
 }
 
+template<> int hoNDFFT<float>::fftw_alignment_of_(const ComplexType* p){
+	return fftwf_alignment_of((float*)p);
+}
+
+template<> int hoNDFFT<double>::fftw_alignment_of_(const ComplexType* p){
+	return fftw_alignment_of((double*)p);
+}
+
 template<> void hoNDFFT<double>::fftw_print_plan_( typename fftw_types<double>::plan * p ){
 	fftw_print_plan(p);
 }
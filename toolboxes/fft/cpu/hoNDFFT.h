@@ -12,11 +12,16 @@
 #include <iostream>
 #include <fftw3.h>
 #include <complex>
+#include <atomic>
+#include <string>
 
 #ifdef USE_OMP
     #include "omp.h"
 #endif // USE_OMP
 
+// environment variable holding the path prefix of persistent FFTW wisdom files
+#define GADGETRON_FFTW_WISDOM_ENVIRONMENT "GADGETRON_FFTW_WISDOM"
+
 namespace Gadgetron{
 
 template<class T> struct fftw_types{};
@@ -40,6 +45,13 @@ template<> struct fftw_types<double>{
 		Note that scaling is 1/sqrt(N) fir both FFT and IFFT, where N is the number of elements along the FFT dimensions
     Access using e.g.
     FFT<float>::instance()
+
+    Plans are cached and reused for all transforms with the same geometry, direction and data alignment.
+    Looking up a cached plan does not take the planner lock, only creating a new plan does.
+    Batches are only planned with FFTW_UNALIGNED if the sub-arrays do not share the SIMD alignment of the
+    first one; with aligned hoNDArray storage (see hoAlignedAllocator.h) the aligned code paths are used.
+    If GADGETRON_FFTW_WISDOM is set, wisdom is loaded from <GADGETRON_FFTW_WISDOM>_float.wisdom
+    (or _double.wisdom) when the instance is created and saved there at exit.
     */
     template <typename T> class EXPORTCPUFFT hoNDFFT
     {
@@ -47,8 +59,23 @@ template<> struct fftw_types<double>{
 
         typedef std::complex<T> ComplexType;
 
+        struct PlanCacheStatistics
+        {
+            unsigned long long hits;        // transforms that reused a cached plan
+            unsigned long long misses;      // plans created
+            unsigned long long uncached;    // plans created while the cache was full
+            size_t cached_plans;
+            double planning_seconds;        // time spent in the FFTW planner
+        };
+
         static hoNDFFT<T>* instance(); 
 
+        PlanCacheStatistics get_plan_cache_statistics();
+        void print_plan_cache_statistics();
+
+        bool load_wisdom(const std::string& filename);
+        bool save_wisdom(const std::string& filename);
+
         void fft(hoNDArray< ComplexType >* input, unsigned int dim_to_transform)
         {
             //-1 refers to the sign of the transform, -1 for FFTW_FORWARD
@@ -129,6 +156,8 @@ template<> struct fftw_types<double>{
         void ifft1(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r);
 
         // centered 1D fft
+        // for even sizes the shifts are folded into a (-1)^n modulation before and after an in-place transform,
+        // odd sizes fall back to explicit fftshift/ifftshift passes
         void fft1c(hoNDArray< ComplexType >& a);
         void ifft1c(hoNDArray< ComplexType >& a);
 
@@ -146,7 +175,7 @@ template<> struct fftw_types<double>{
         void fft2(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r);
         void ifft2(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r);
 
-        // centered 2D fft
+        // centered 2D fft, shifts folded into the transform when both sizes are even
         void fft2c(hoNDArray< ComplexType >& a);
         void ifft2c(hoNDArray< ComplexType >& a);
 
@@ -164,7 +193,7 @@ template<> struct fftw_types<double>{
         void fft3(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r);
         void ifft3(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r);
 
-        // centered 3D fft
+        // centered 3D fft, shifts folded into the transform when all three sizes are even
         void fft3c(hoNDArray< ComplexType >& a);
         void ifft3c(hoNDArray< ComplexType >& a);
 
@@ -178,17 +207,50 @@ template<> struct fftw_types<double>{
 
         //We are making these protected since this class is a singleton
 
-        hoNDFFT() {
+        hoNDFFT();
 
+        virtual ~hoNDFFT();
 
-#ifdef USE_OMP
-            num_of_max_threads_ = omp_get_num_procs();
-#else
-            num_of_max_threads_ = 1;
-#endif // USE_OMP
-        }
+        enum
+        {
+            PLAN_CACHE_SIZE = 1024    // open addressing, entries are never removed
+        };
 
-        virtual ~hoNDFFT() { fftw_cleanup_(); }
+        struct PlanKey
+        {
+            int rank;
+            int n[3];
+            int howmany;
+            int istride;
+            int idist;
+            int ostride;
+            int odist;
+            int sign;
+            int in_place;
+            int ialign;     // fftw_alignment_of the planned arrays, plans can only be executed on arrays with the same
+            int oalign;
+            unsigned flags;
+        };
+
+        struct PlanEntry
+        {
+            PlanKey key;
+            typename fftw_types<T>::plan * plan;
+        };
+
+        /// find or create the plan for this transform, plans with cached == false must be handed to release_plan
+        typename fftw_types<T>::plan * get_plan(int rank, const int* n, int howmany,
+                                               ComplexType* in, int istride, int idist,
+                                               ComplexType* out, int ostride, int odist,
+                                               int sign, unsigned flags, bool& cached);
+        void release_plan(typename fftw_types<T>::plan * p, bool cached);
+
+        PlanEntry* find_plan(const PlanKey& key, size_t hash);
+
+        /// FFTW_UNALIGNED if sub-arrays offset by this many elements from in/out do not share their SIMD alignment
+        unsigned offset_flags(const ComplexType* in, const ComplexType* out, size_t offset);
+
+        static void save_wisdom_at_exit();
 
         void fft_int(hoNDArray< ComplexType >* input, size_t dim_to_transform, int sign);
 
@@ -202,6 +264,7 @@ template<> struct fftw_types<double>{
         void  fftw_execute_dft_(typename fftw_types<T>::plan * p, ComplexType*, ComplexType*);
         void  fftw_execute_(typename fftw_types<T>::plan * p);
         void fftw_print_plan_(typename fftw_types<T>::plan *p);
+        int fftw_alignment_of_(const ComplexType* p);
 
         typename fftw_types<T>::plan * fftw_plan_dft_1d_(int rank, ComplexType*, ComplexType*, int, unsigned);
         typename fftw_types<T>::plan * fftw_plan_dft_2d_(int dim0,int dim1, ComplexType*, ComplexType*, int, unsigned);
@@ -222,6 +285,15 @@ template<> struct fftw_types<double>{
         static hoNDFFT<T>* instance_;
         boost::mutex mutex_;
 
+        std::atomic<PlanEntry*> plan_cache_[PLAN_CACHE_SIZE];
+        std::atomic<unsigned long long> plan_cache_hits_;
+        unsigned long long plan_cache_misses_;
+        unsigned long long plans_uncached_;
+        size_t cached_plans_;
+        double planning_seconds_;
+
+        std::string wisdom_file_;
+
         int num_of_max_threads_;
 
         // the fft and ifft shift pivot for a certain length
@@ -265,6 +337,19 @@ template<> struct fftw_types<double>{
         void fft2(hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, bool forward);
         void fft3(hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, bool forward);
 
+        /**
+         * Centered transform of the first rank dimensions of a into r (which may be a) without temporaries.
+         * For even N, fftshift(fft(ifftshift(x))) equals (-1)^(k+N/2) fft((-1)^n x), so the shifts reduce to a
+         * sign modulation that is fused with the copy into r before, and with the scaling after the in-place transform.
+         * Only valid if centered_fusable(a, rank).
+         */
+        void fftc(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, size_t rank, bool forward);
+
+        bool centered_fusable(const hoNDArray< ComplexType >& a, size_t rank);
+
+        /// out = in * scale * (-1)^(i+j+k) for every n0*n1*n2 block, n0 must be even
+        void chessboard(const ComplexType* in, ComplexType* out, size_t n0, size_t n1, size_t n2, size_t num, T scale);
+
         // get the number of threads used for fft
         int get_num_threads_fft1(size_t n0, size_t num);
         int get_num_threads_fft2(size_t n0, size_t n1, size_t num);
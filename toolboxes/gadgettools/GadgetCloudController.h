@@ -14,6 +14,7 @@
 
 #include <complex>
 #include <vector>
+#include <algorithm>
 #include "boost/tuple/tuple.hpp"
 #include "boost/tuple/tuple_comparison.hpp"
 #include "boost/tuple/tuple_io.hpp"
@@ -74,9 +75,11 @@ public:
     int runJobsOnCloud(std::vector<JobType>& job_list, std::vector<JobType>& completed_job_list, const std::vector<int>& node_ids);
 
     // should be called after calling runJobsOnCloud
+    // while waiting, late jobs are sent again to idle nodes and jobs of a lost node are sent to other nodes
     int waitForJobToComplete();
 
     // send close message to all nodes
+    // if jobs can still be sent again, the close message is sent when all jobs are completed
     int closeCloudNode();
 
     virtual int handle_close (ACE_HANDLE handle, ACE_Reactor_Mask close_mask);
@@ -107,6 +110,12 @@ public:
         return 0;
     }
 
+    // record the time a job is received from a node, called from the reader of the node
+    int setJobReceived(unsigned int nodeID, int jobID);
+
+    // true if a job is already completed on another node and does not need to be sent to this node
+    bool skipJob(unsigned int nodeID, int jobID);
+
     // append the job list
     int appendJobList(std::vector<JobType*>& job_list, 
         std::vector<JobType*>& completed_job_list, 
@@ -120,6 +129,22 @@ public:
     std::vector<int> node_id_used_;
     // job status, 0/-1 : completed/not completed
     std::vector<int> job_status_;
+    // for every job received from a node, the seconds from the time the node could start this job until it was received
+    // i.e. the later of sending this job and receiving the previous job from the same node; -1 if not received
+    std::vector<double> job_seconds_;
+    // for every job, the node whose result is used; -1 if not received
+    std::vector<int> node_id_completed_;
+
+    // speculative execution: a job not received within straggler_deadline_factor_ times the expected job time
+    // (times its position in the queue of its node) is sent again to an idle node, the first result received is used
+    bool speculative_execution_;
+    double straggler_deadline_factor_;
+    // expected seconds per job, used until the first job is received; 0 if not known
+    double expected_job_seconds_;
+    // number of times a job is sent to another node if the connection to its node is lost
+    unsigned int max_job_retries_;
+    // seconds to wait for a job before checking for late jobs
+    double poll_period_;
 
     // a function handler to process job after receive
     // this is a hook to give user a chance to do some processing after receiving every job
@@ -145,12 +170,46 @@ private:
     // if 0, then controller does not need to wait
     unsigned int number_of_jobs_sent_out_;
 
+    // time every job is sent and time the last job is received from every node
+    std::vector<ACE_Time_Value> job_send_time_;
+    std::vector<ACE_Time_Value> node_receive_time_;
+
+    // node running a speculative copy of every job, -1 if none
+    std::vector<int> job_copy_node_id_;
+    // number of times every job is sent again after a lost connection
+    std::vector<unsigned int> job_retries_;
+    // jobs to be sent again after a lost connection
+    std::vector<bool> job_retry_pending_;
+    // whether the result of every job is received by the caller
+    std::vector<bool> job_result_received_;
+    // number of jobs sent to every node, which are not returned or skipped yet
+    std::vector<unsigned int> node_jobs_in_flight_;
+
+    // closeCloudNode is called while jobs can still be sent again
+    bool close_requested_;
+
+    // put a job on the queue of a node
+    int sendJob(int jobID, int nodeID);
+
+    // send the jobs of lost nodes to other nodes and copies of late jobs to idle nodes
+    int redispatchJobs();
+
+    // send the close message to the nodes which are done; a node still running a job received from another node is disconnected
+    int closeOrCancelCloudNode();
+
+    // true if every job is received, or will not be received and is left to the caller
+    bool allJobsCompleted();
+
+    // wait for the reader and writer of every connected node to finish
+    void waitForCloudNode();
+
     // to protect the access to job_status_ and node_id_used_
     ACE_Thread_Mutex cloud_controller_mutex_;
 };
 
 template <typename JobType> 
-GadgetCloudController<JobType>::GadgetCloudController() : cloud_msg_id_reader_(GADGET_MESSAGE_CLOUD_JOB), cloud_msg_id_writer_(GADGET_MESSAGE_CLOUD_JOB), job_handler_(NULL), number_of_jobs_sent_out_(0)
+GadgetCloudController<JobType>::GadgetCloudController() : cloud_msg_id_reader_(GADGET_MESSAGE_CLOUD_JOB), cloud_msg_id_writer_(GADGET_MESSAGE_CLOUD_JOB), job_handler_(NULL), number_of_nodes_(0), number_of_jobs_sent_out_(0), 
+    speculative_execution_(true), straggler_deadline_factor_(2.0), expected_job_seconds_(0), max_job_retries_(2), poll_period_(0.5), close_requested_(false)
 {
 
 }
@@ -159,6 +218,14 @@ template <typename JobType>
 GadgetCloudController<JobType>::~GadgetCloudController()
 {
     GDEBUG("Into ~GadgetCloudController() ... \n");
+
+    // the nodes are not waiting for more jobs
+    if ( close_requested_ )
+    {
+        this->closeOrCancelCloudNode();
+        this->waitForCloudNode();
+    }
+
     this->msg_queue()->deactivate();
 
     for ( unsigned int ii=0; ii<cloud_connectors_.size(); ii++ )
@@ -216,6 +283,8 @@ int GadgetCloudController<JobType>::createConnector(const CloudType& cloud,
 
     cloud_connectors_.resize(number_of_nodes_, NULL);
     node_status_.resize(number_of_nodes_, -1);
+    node_receive_time_.resize(number_of_nodes_, ACE_Time_Value::zero);
+    node_jobs_in_flight_.resize(number_of_nodes_, 0);
 
     cloud_msg_id_reader_ = msgID_reader;
     cloud_msg_id_writer_ = msgID_writer;
@@ -420,29 +489,15 @@ runJobsOnCloud(std::vector<JobType*>& job_list, std::vector<JobType*>& completed
         }
 
         // send job to a node
-        GadgetContainerMessage<GadgetMessageIdentifier>* m1 =
-                new GadgetContainerMessage<GadgetMessageIdentifier>();
-
-        m1->getObjectPtr()->id = (ACE_INT16)cloud_msg_id_writer_;
-
-        GadgetContainerMessage<int>* m2 =
-                new GadgetContainerMessage<int>();
-
-        *(m2->getObjectPtr()) = (int)(ii+startJobID);
-
-        GadgetContainerMessage<JobType>* m3 =
-                new GadgetContainerMessage<JobType>();
-
-        *(m3->getObjectPtr()) = *(job_list[ii]);
-        m1->cont(m2);
-        m2->cont(m3);
-
         if ( node_status_[nodeID] == 0 )
         {
-            if (cloud_connectors_[nodeID]->putq(m1) == -1)
             {
-	      GERROR("Unable to send job package %d on queue for node %d \n", ii+startJobID, nodeID);
-	      m1->release();
+                ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, cloud_controller_mutex_, -1);
+                node_jobs_in_flight_[nodeID]++;
+            }
+
+            if ( this->sendJob((int)(ii+startJobID), nodeID) != 0 )
+            {
 	      return -1;
             }
             else
@@ -451,10 +506,6 @@ runJobsOnCloud(std::vector<JobType*>& job_list, std::vector<JobType*>& completed
 	      number_of_jobs_sent_out_++;
             }
         }
-        else
-        {
-            m1->release();
-        }
     }
 
     GDEBUG("GadgetCloudController - all jobs sent ... \n");
@@ -462,6 +513,36 @@ runJobsOnCloud(std::vector<JobType*>& job_list, std::vector<JobType*>& completed
     return 0;
 }
 
+template <typename JobType> 
+int GadgetCloudController<JobType>::sendJob(int jobID, int nodeID)
+{
+    GadgetContainerMessage<GadgetMessageIdentifier>* m1 =
+            new GadgetContainerMessage<GadgetMessageIdentifier>();
+
+    m1->getObjectPtr()->id = (ACE_INT16)cloud_msg_id_writer_;
+
+    GadgetContainerMessage<int>* m2 =
+            new GadgetContainerMessage<int>();
+
+    *(m2->getObjectPtr()) = jobID;
+
+    GadgetContainerMessage<JobType>* m3 =
+            new GadgetContainerMessage<JobType>();
+
+    *(m3->getObjectPtr()) = *(job_list_[jobID]);
+    m1->cont(m2);
+    m2->cont(m3);
+
+    if (cloud_connectors_[nodeID]->putq(m1) == -1)
+    {
+      GERROR("Unable to send job package %d on queue for node %d \n", jobID, nodeID);
+      m1->release();
+      return -1;
+    }
+
+    return 0;
+}
+
 template <typename JobType> 
 int GadgetCloudController<JobType>::
 runJobsOnCloud(std::vector<JobType>& job_list, std::vector<JobType>& completed_job_list, const std::vector<int>& node_ids)
@@ -499,6 +580,17 @@ closeCloudNode()
 {
     GDEBUG("GadgetCloudController : into closeCloudNode(...) ... \n");
 
+    if ( speculative_execution_ || max_job_retries_>0 )
+    {
+        // nothing is waiting for the nodes, close them now
+        if ( this->allJobsCompleted() ) return this->closeOrCancelCloudNode();
+
+        // keep the nodes open, so jobs can still be sent again while waiting
+        // if the caller does not wait, handle_close or the destructor closes the nodes
+        close_requested_ = true;
+        return 0;
+    }
+
     unsigned int ii;
 
     std::vector<bool> closeMsgSent(number_of_nodes_, false);
@@ -535,94 +627,288 @@ int GadgetCloudController<JobType>::waitForJobToComplete()
     GDEBUG("GadgetCloudController waitForJobToComplete ... \n");
 
     ACE_Message_Block *mb = 0;
-    ACE_Time_Value nowait (ACE_OS::gettimeofday ());
 
     //collect a incoming package a package if we have one
-    while ( number_of_jobs_sent_out_>0 && (this->getq (mb) != -1) )
+    while ( number_of_jobs_sent_out_>0 )
     {
-        GadgetContainerMessage<int>* m_jobID =
-            AsContainerMessage<int>(mb);
+        ACE_Time_Value period;
+        period.set(poll_period_);
+        ACE_Time_Value deadline = ACE_OS::gettimeofday() + period;
 
-        if ( !m_jobID )
+        if ( this->getq(mb, &deadline) == -1 )
         {
-	  GDEBUG("Invalid message id in the GadgetCloudController queue\n");
-	  break;
-        }
+            if ( errno != EWOULDBLOCK ) break;
 
-        int jobID = *(m_jobID->getObjectPtr());
+            // nothing received, check for late jobs
+            mb = 0;
+        }
 
-        if ( jobID != -1 )
+        if ( mb )
         {
-            GadgetContainerMessage<JobType>* job =
-                AsContainerMessage<JobType>(mb->cont());
+            GadgetContainerMessage<int>* m_jobID =
+                AsContainerMessage<int>(mb);
 
-            if ( !job )
+            if ( !m_jobID )
             {
-	      GDEBUG("Invalid message obj in the GadgetCloudController queue\n");
+	      GDEBUG("Invalid message id in the GadgetCloudController queue\n");
 	      break;
             }
 
-            *(completed_job_list_[jobID]) = *(job->getObjectPtr());
-            job_status_[jobID] = 0;
+            int jobID = *(m_jobID->getObjectPtr());
 
-	    GDEBUG("--> receive completed job : %d ... \n", jobID);
-
-            if ( job_handler_ != NULL )
+            if ( jobID != -1 && job_result_received_[jobID] )
+            {
+	      GDEBUG("--> receive job %d again, the first result is used ... \n", jobID);
+            }
+            else if ( jobID != -1 )
             {
-                if ( !job_handler_->processJob( jobID, *(completed_job_list_[jobID]) ) )
+                GadgetContainerMessage<JobType>* job =
+                    AsContainerMessage<JobType>(mb->cont());
+
+                if ( !job )
+                {
+	          GDEBUG("Invalid message obj in the GadgetCloudController queue\n");
+	          break;
+                }
+
+                *(completed_job_list_[jobID]) = *(job->getObjectPtr());
+                job_result_received_[jobID] = true;
+                {
+                    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, cloud_controller_mutex_, -1);
+                    job_status_[jobID] = 0;
+                    job_retry_pending_[jobID] = false;
+                }
+
+	        GDEBUG("--> receive completed job : %d ... \n", jobID);
+
+                if ( job_handler_ != NULL )
                 {
-		  GDEBUG("job_handler_->processJob after receiving failed\n");
+                    if ( !job_handler_->processJob( jobID, *(completed_job_list_[jobID]) ) )
+                    {
+		      GDEBUG("job_handler_->processJob after receiving failed\n");
+                    }
                 }
             }
+            else
+            {
+	      GDEBUG("--> receive jobID == -1 ... \n");
+            }
+
+            mb->release();
         }
-        else
+
+        if ( this->redispatchJobs() != 0 )
         {
-	  GDEBUG("--> receive jobID == -1 ... \n");
+	  GERROR("GadgetCloudController, redispatchJobs() failed ... \n");
         }
 
-        mb->release();
-
         // if all jobs are received, notice the caller thread
-        bool allJobProcessed = true;
+        if ( this->allJobsCompleted() )
+        {
+	  GDEBUG("All jobs are completed and returned on GadgetCloudController queue\n");
+	  break;
+        }
+    }
+
+    if ( close_requested_ )
+    {
+        this->closeOrCancelCloudNode();
+    }
+
+    // need to wait for all reader task to complete
+    this->waitForCloudNode();
+
+    GDEBUG("GadgetCloudController waitForJobToComplete done ... \n");
+    return 0;
+}
+
+template <typename JobType> 
+int GadgetCloudController<JobType>::redispatchJobs()
+{
+    // pairs of job and node to send
+    std::vector< std::pair<int, int> > jobsToSend;
+
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, cloud_controller_mutex_, -1);
+
+        ACE_Time_Value now = ACE_OS::gettimeofday();
+
+        size_t numOfJobs = job_status_.size();
+        size_t ii, jj;
+
+        // jobs of lost nodes go to the available node with the least jobs
+        for ( jj=0; jj<numOfJobs; jj++ )
+        {
+            if ( !job_retry_pending_[jj] ) continue;
+            job_retry_pending_[jj] = false;
+
+            int nodeID = -1;
+            for ( ii=0; ii<number_of_nodes_; ii++ )
+            {
+                if ( node_status_[ii]==0 && (nodeID<0 || node_jobs_in_flight_[ii]<node_jobs_in_flight_[nodeID]) ) nodeID = (int)ii;
+            }
+
+            if ( nodeID < 0 )
+            {
+                // no node is left, the caller needs to process this job
+                job_status_[jj] = 0;
+                continue;
+            }
+
+            GDEBUG("--> send job %d again to node %d after the connection is lost ... \n", jj, nodeID);
+
+            job_retries_[jj]++;
+            node_id_used_[jj] = nodeID;
+            job_send_time_[jj] = now;
+            node_jobs_in_flight_[nodeID]++;
+            jobsToSend.push_back(std::pair<int, int>((int)jj, nodeID));
+        }
+
+        // expected job time from the jobs received so far
+        double expectedSeconds = expected_job_seconds_;
+        double totalSeconds = 0;
+        size_t numOfReceived = 0;
+        for ( jj=0; jj<numOfJobs; jj++ )
         {
-            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, cloud_controller_mutex_, -1);
-            for ( unsigned int ii=0; ii<job_status_.size(); ii++ )
+            if ( job_seconds_[jj] > 0 )
             {
-                if ( job_status_[ii] != 0 )
+                totalSeconds += job_seconds_[jj];
+                numOfReceived++;
+            }
+        }
+        if ( numOfReceived > 0 ) expectedSeconds = totalSeconds/numOfReceived;
+
+        if ( speculative_execution_ && expectedSeconds>0 )
+        {
+            // a job is late if it is not received by the deadline for its position in the queue of its node
+            std::vector<double> lateness(numOfJobs, 0);
+            std::vector<size_t> queuePosition(number_of_nodes_, 0);
+            for ( jj=0; jj<numOfJobs; jj++ )
+            {
+                int nodeID = node_id_used_[jj];
+                if ( job_status_[jj]==0 || nodeID<0 || nodeID>=(int)number_of_nodes_ ) continue;
+
+                queuePosition[nodeID]++;
+                if ( job_copy_node_id_[jj] >= 0 ) continue;
+
+                ACE_Time_Value start = std::max(job_send_time_[jj], node_receive_time_[nodeID]);
+                lateness[jj] = (now - start).msec()/1000.0 - straggler_deadline_factor_*expectedSeconds*queuePosition[nodeID];
+            }
+
+            // an idle node runs a copy of the latest job
+            for ( ii=0; ii<number_of_nodes_; ii++ )
+            {
+                if ( node_status_[ii]!=0 || node_jobs_in_flight_[ii]>0 ) continue;
+
+                int jobID = -1;
+                for ( jj=0; jj<numOfJobs; jj++ )
                 {
-                    allJobProcessed = false;
-                    break;
+                    if ( lateness[jj]>0 && node_id_used_[jj]!=(int)ii && (jobID<0 || lateness[jj]>lateness[jobID]) ) jobID = (int)jj;
                 }
+                if ( jobID < 0 ) break;
+
+                GDEBUG("--> job %d is late on node %d, send a copy to node %d ... \n", jobID, node_id_used_[jobID], ii);
+
+                lateness[jobID] = 0;
+                job_copy_node_id_[jobID] = (int)ii;
+                node_receive_time_[ii] = now;
+                node_jobs_in_flight_[ii]++;
+                jobsToSend.push_back(std::pair<int, int>(jobID, (int)ii));
             }
         }
+    }
 
-        if ( allJobProcessed )
+    size_t n;
+    for ( n=0; n<jobsToSend.size(); n++ )
+    {
+        if ( this->sendJob(jobsToSend[n].first, jobsToSend[n].second) != 0 )
         {
-	  GDEBUG("All jobs are completed and returned on GadgetCloudController queue\n");
-	  break;
+            // the node is treated as lost
+            this->setJobsTobeCompleted(jobsToSend[n].second);
         }
     }
 
-    // need to wait for all reader task to complete
-    for( unsigned int ii=0; ii<number_of_nodes_; ii++ )
+    return 0;
+}
+
+template <typename JobType> 
+int GadgetCloudController<JobType>::closeOrCancelCloudNode()
+{
+    close_requested_ = false;
+
+    std::vector<unsigned int> jobsInFlight;
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, cloud_controller_mutex_, -1);
+        jobsInFlight = node_jobs_in_flight_;
+    }
+
+    unsigned int ii;
+    for( ii=0; ii<number_of_nodes_; ii++ )
     {
-        if ( cloud_connectors_[ii]->status() )
+        if ( cloud_connectors_[ii]==NULL || !cloud_connectors_[ii]->status() ) continue;
+
+        if ( ii<jobsInFlight.size() && jobsInFlight[ii]>0 )
         {
-            cloud_connectors_[ii]->wait();
+            // all results are received, the node is still running a job completed on another node
+            GDEBUG("--> node %d is still running jobs completed on other nodes, disconnect ... \n", ii);
+            cloud_connectors_[ii]->cancel();
+            continue;
+        }
+
+        GadgetContainerMessage<GadgetMessageIdentifier>* m = new GadgetContainerMessage<GadgetMessageIdentifier>();
+        m->getObjectPtr()->id = GADGET_MESSAGE_CLOSE;
+
+        if (cloud_connectors_[ii]->putq(m) == -1)
+        {
+	  GERROR("Unable to send CLOSE package on queue for node %d \n", ii);
+	  m->release();
+	  return -1;
         }
     }
 
-    GDEBUG("GadgetCloudController waitForJobToComplete done ... \n");
     return 0;
 }
 
+template <typename JobType> 
+bool GadgetCloudController<JobType>::allJobsCompleted()
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, cloud_controller_mutex_, false);
+
+    for ( size_t ii=0; ii<job_status_.size(); ii++ )
+    {
+        if ( job_status_[ii] != 0 ) return false;
+    }
+
+    return true;
+}
+
 template <typename JobType> 
 int GadgetCloudController<JobType>::handle_close(ACE_HANDLE handle, ACE_Reactor_Mask close_mask)
 {
     GDEBUG("GadgetCloudController handling close...\n");
+
+    // closeCloudNode was called without waiting for the jobs, the nodes still running jobs are disconnected
+    if ( close_requested_ )
+    {
+        this->closeOrCancelCloudNode();
+        this->waitForCloudNode();
+    }
+
     return this->wait();
 }
 
+template <typename JobType> 
+void GadgetCloudController<JobType>::waitForCloudNode()
+{
+    for( unsigned int ii=0; ii<number_of_nodes_; ii++ )
+    {
+        if ( cloud_connectors_[ii]!=NULL && cloud_connectors_[ii]->status() )
+        {
+            cloud_connectors_[ii]->wait();
+        }
+    }
+}
+
 template<typename JobType> 
 int GadgetCloudController<JobType>::setJobsTobeCompleted(unsigned int nodeID, int jobID)
 {
@@ -634,23 +920,38 @@ int GadgetCloudController<JobType>::setJobsTobeCompleted(unsigned int nodeID, in
             node_status_[nodeID] = -1;
         }
 
+        if ( nodeID<this->node_jobs_in_flight_.size() ) node_jobs_in_flight_[nodeID] = 0;
+
         size_t N = this->node_id_used_.size();
         size_t ii;
         for ( ii=0; ii<N; ii++ )
         {
+            if ( this->job_status_[ii] == 0 ) continue;
+
+            if ( this->job_copy_node_id_[ii] == (int)nodeID )
+            {
+                // the job is still running on its own node
+                this->job_copy_node_id_[ii] = -1;
+                continue;
+            }
+
             if ( this->node_id_used_[ii] == nodeID )
             {
-                //if ( jobID>=0 && jobID<this->job_status_.size() )
-                //{
-                //    this->job_status_[jobID] = 0;
-                //}
-                //else
-                //{
-                //    if ( this->job_status_[ii]!= 0 ) this->job_status_[ii] = 0;
-                //}
-
-                // make sure all jobs on this node is marked as completed
-                if ( this->job_status_[ii]!= 0 ) this->job_status_[ii] = 0;
+                if ( this->job_copy_node_id_[ii] >= 0 )
+                {
+                    // the copy of this job is still running
+                    this->node_id_used_[ii] = this->job_copy_node_id_[ii];
+                    this->job_copy_node_id_[ii] = -1;
+                }
+                else if ( this->job_retries_[ii] < max_job_retries_ )
+                {
+                    this->job_retry_pending_[ii] = true;
+                }
+                else
+                {
+                    // make sure all jobs on this node is marked as completed
+                    this->job_status_[ii] = 0;
+                }
             }
         }
     }
@@ -663,6 +964,42 @@ int GadgetCloudController<JobType>::setJobsTobeCompleted(unsigned int nodeID, in
     return 0;
 }
 
+template<typename JobType> 
+int GadgetCloudController<JobType>::setJobReceived(unsigned int nodeID, int jobID)
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, cloud_controller_mutex_, -1);
+
+    if ( nodeID>=node_receive_time_.size() || jobID<0 || jobID>=(int)job_seconds_.size() ) return -1;
+
+    if ( node_jobs_in_flight_[nodeID] > 0 ) node_jobs_in_flight_[nodeID]--;
+
+    // a node runs its jobs in order, so a job can only start after the previous one was returned
+    ACE_Time_Value now = ACE_OS::gettimeofday();
+    if ( node_id_completed_[jobID] < 0 )
+    {
+        ACE_Time_Value start = std::max(job_send_time_[jobID], node_receive_time_[nodeID]);
+        job_seconds_[jobID] = (now - start).msec()/1000.0;
+        node_id_completed_[jobID] = (int)nodeID;
+    }
+    node_receive_time_[nodeID] = now;
+
+    return 0;
+}
+
+template<typename JobType> 
+bool GadgetCloudController<JobType>::skipJob(unsigned int nodeID, int jobID)
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, cloud_controller_mutex_, false);
+
+    if ( nodeID>=node_jobs_in_flight_.size() || jobID<0 || jobID>=(int)node_id_completed_.size() ) return false;
+
+    if ( node_id_completed_[jobID]<0 || node_id_completed_[jobID]==(int)nodeID ) return false;
+
+    if ( node_jobs_in_flight_[nodeID] > 0 ) node_jobs_in_flight_[nodeID]--;
+
+    return true;
+}
+
 template<typename JobType> 
 int GadgetCloudController<JobType>::appendJobList(std::vector<JobType*>& job_list, 
         std::vector<JobType*>& completed_job_list, 
@@ -698,6 +1035,13 @@ int GadgetCloudController<JobType>::appendJobList(std::vector<JobType*>& job_lis
             completed_job_list_.push_back(completed_job_list[ii]);
             node_id_used_.push_back(node_id_used[ii]);
             job_status_.push_back(job_status[ii]);
+            job_seconds_.push_back(-1);
+            job_send_time_.push_back(ACE_OS::gettimeofday());
+            node_id_completed_.push_back(-1);
+            job_copy_node_id_.push_back(-1);
+            job_retries_.push_back(0);
+            job_retry_pending_.push_back(false);
+            job_result_received_.push_back(false);
         }
     }
     catch(...)
@@ -90,6 +90,15 @@ public:
             return 2;
         }
 
+        // a job completed on another node is not sent
+        GadgetContainerMessage<int>* m_jobID = AsContainerMessage<int>(mb->cont());
+        if ( m_jobID && cloud_connector_->skipJob(*(m_jobID->getObjectPtr())) )
+        {
+            GDEBUG("CloudWriterTask, job %d is completed on another node\n", *(m_jobID->getObjectPtr()));
+            mb->release();
+            return 0;
+        }
+
         GadgetMessageWriter* w = writers_.find(mid->getObjectPtr()->id);
 
         if (!w)
@@ -103,6 +112,12 @@ public:
         {
 	  GDEBUG("Failed to write message to Gadgetron\n");
 
+            if ( cloud_connector_->cancelled() )
+            {
+                mb->release ();
+                return -1;
+            }
+
             // notice the controller
             GadgetContainerMessage<int>* m1 = 
                 dynamic_cast< GadgetContainerMessage<int>* >(mb->cont());
@@ -188,6 +203,12 @@ public:
         {
             if ((recv_count = cloud_connector_->peer().recv_n(&mid, sizeof(GadgetMessageIdentifier))) <= 0)
             {
+                if ( cloud_connector_->cancelled() )
+                {
+                    GDEBUG("CloudReaderTask, connection cancelled\n");
+                    return 0;
+                }
+
 	        GERROR("CloudReaderTask, failed to read message identifier\n");
                 ACE_OS::sleep(ACE_Time_Value( (time_t)GADGETRON_TIMEOUT_PERIOD ));
                 cloud_connector_->set_status(false);
@@ -215,6 +236,12 @@ public:
 
             if (!mb)
             {
+              if ( cloud_connector_->cancelled() )
+              {
+                GDEBUG("CloudReaderTask, connection cancelled\n");
+                return 0;
+              }
+
 	      GERROR("CloudReaderTask, Failed to read message\n");
 	      ACE_OS::sleep(ACE_Time_Value( (time_t)GADGETRON_TIMEOUT_PERIOD ));
 	      cloud_connector_->set_status(false);
@@ -264,6 +291,9 @@ public:
     // if jobID==-1, all jobs for this node is set to be completed
     int setJobTobeCompletedAndNoticeController(int jobID=-1);
 
+    // true if the job is completed on another node and does not need to be sent
+    bool skipJob(int jobID);
+
     virtual int putq  (  ACE_Message_Block * mb ,  ACE_Time_Value *  timeout = 0);
 
     virtual int register_reader(size_t slot, GadgetMessageReader* reader);
@@ -281,6 +311,31 @@ public:
         return this->wait();
     }
 
+    // stop the jobs on this node without waiting for them, the node sees a lost connection
+    int cancel()
+    {
+        GDEBUG("Into GadgetronCloudConnector:cancel() ... \n");
+        mtx_.acquire();
+        status_ = false;
+        cancelled_ = true;
+        mtx_.release();
+        // the writer stops waiting for messages, the reader sees the closed connection
+        cloud_writer_task_.msg_queue()->deactivate();
+        cloud_writer_task_.flush();
+        peer().close_writer();
+        peer().close_reader();
+        return 0;
+    }
+
+    bool cancelled()
+    {
+        bool ret_val;
+        mtx_.acquire();
+        ret_val = cancelled_;
+        mtx_.release();
+        return ret_val;
+    }
+
     virtual int wait()
     {
         GDEBUG("Into GadgetronCloudConnector:wait() ... \n");
@@ -338,6 +393,7 @@ protected:
 
     ACE_Thread_Mutex mtx_;
     bool status_;
+    bool cancelled_;
 
     std::string hostname_;
     std::string port_;
@@ -355,6 +411,7 @@ GadgetronCloudConnector<JobType>::GadgetronCloudConnector() : cloud_controller_(
                                                             cloud_writer_task_(&this->peer()), 
                                                             cloud_reader_task_(&this->peer()), 
                                                             status_(false), 
+                                                            cancelled_(false), 
                                                             mtx_("CLOUDCONNECTOR_MTX")
 {
     GDEBUG("Into GadgetronCloudConnector:GadgetronCloudConnector() ... \n");
@@ -426,6 +483,12 @@ int GadgetronCloudConnector<JobType>::process(size_t messageid, ACE_Message_Bloc
       return -1;
     }
 
+    GadgetContainerMessage<int>* m_jobID = AsContainerMessage<int>(mb);
+    if ( m_jobID && *(m_jobID->getObjectPtr())>=0 )
+    {
+        cloud_controller_->setJobReceived((unsigned int)nodeID_, *(m_jobID->getObjectPtr()));
+    }
+
     if ( cloud_controller_->putq(mb) == -1)
     {
       GERROR("Unable to put received message into the queue of cloud controller %d\n", messageid);
@@ -494,6 +557,13 @@ int GadgetronCloudConnector<JobType>::setJobTobeCompletedAndNoticeController(int
     return 0;
 }
 
+template<typename JobType> 
+bool GadgetronCloudConnector<JobType>::skipJob(int jobID)
+{
+    if ( cloud_controller_ == NULL ) return false;
+    return cloud_controller_->skipJob(nodeID_, jobID);
+}
+
 template<typename JobType> 
 int GadgetronCloudConnector<JobType>::send_gadgetron_configuration_file(std::string config_xml_name)
 {
@@ -9,12 +9,28 @@
 #include <ace/Reactor.h>
 #include <ace/SOCK_Stream.h>
 #include <ace/Reactor_Notification_Strategy.h>
+#include <ace/OS_NS_sys_time.h>
+#include <ace/OS_NS_errno.h>
 #include <string>
+#include <vector>
 
 #define MAXHOSTNAMELENGTH 1024
 
+#define GADGET_WRITER_DEFAULT_FLUSH_BYTES (256*1024)
+#define GADGET_WRITER_MAX_IOV 512
+#define GADGET_WRITER_MAX_BYTES_PER_SEND ((size_t)512*1024*1024)
+
 namespace Gadgetron{
 
+  /**
+     Sends the messages queued for a socket.
+
+     Messages whose writer supports GadgetMessageWriter::gather are not written one by one.
+     Consecutive messages are collected in a scatter/gather list and sent with a single writev once
+     flush_bytes are pending, the list is full, or no further message arrived within max_latency
+     of the first one. Lists larger than GADGET_WRITER_MAX_BYTES_PER_SEND are split into several writes. With the default latency of 0 only messages that are already queued are combined,
+     so batching never delays a message.
+   */
   class WriterTask : public ACE_Task<ACE_MT_SYNCH>
   {
 
@@ -24,11 +40,18 @@ namespace Gadgetron{
   WriterTask(ACE_SOCK_Stream* socket)
     : inherited()
       , socket_(socket)
+      , flush_bytes_(GADGET_WRITER_DEFAULT_FLUSH_BYTES)
+      , max_latency_(ACE_Time_Value::zero)
+      , messages_(0)
+      , batched_messages_(0)
+      , batched_bytes_(0)
+      , batched_writes_(0)
     {
     }
 
     virtual ~WriterTask()
       {
+	this->release_pending();
 	writers_.clear();
       }
 
@@ -46,6 +69,16 @@ namespace Gadgetron{
       return writers_.insert( (unsigned int)slot,writer);
     }
 
+    /**
+       @param flush_bytes Send pending messages once this many bytes are collected, 0 writes every message on its own
+       @param max_latency_us Time the first collected message may wait for further messages
+     */
+    void set_batching(size_t flush_bytes, unsigned long max_latency_us)
+    {
+      flush_bytes_ = flush_bytes;
+      max_latency_ = ACE_Time_Value(max_latency_us/1000000, max_latency_us%1000000);
+    }
+
     virtual int close(unsigned long flags)
     {
       int rval = 0;
@@ -65,11 +98,18 @@ namespace Gadgetron{
     virtual int svc(void)
     {
       ACE_Message_Block *mb = 0;
-      ACE_Time_Value nowait (ACE_OS::gettimeofday ());
-
+      ACE_Time_Value deadline;
+
+      for (;;) {
+	//With messages pending, only wait until the first one has been held for max_latency_
+	if ((pending_.empty() ? this->getq(mb) : this->getq(mb, &deadline)) == -1) {
+	  if (!pending_.empty() && errno == EWOULDBLOCK) {
+	    if (this->flush_pending() < 0) return -1;
+	    continue;
+	  }
+	  break;
+	}
 
-      //Send a package if we have one
-      while (this->getq (mb) != -1) {
 	GadgetContainerMessage<GadgetMessageIdentifier>* mid =
 	  AsContainerMessage<GadgetMessageIdentifier>(mb);
 
@@ -77,12 +117,15 @@ namespace Gadgetron{
 	if (!mid) {
 	  GERROR("Invalid message on output queue\n");
 	  mb->release();
+	  this->release_pending();
 	  return -1;
 	}
 
 	//Is this a shutdown message?
 	if (mid->getObjectPtr()->id == GADGET_MESSAGE_CLOSE) {
+	  if (this->flush_pending() < 0) return -1;
 	  socket_->send_n(mid->getObjectPtr(),sizeof(GadgetMessageIdentifier));
+	  this->print_statistics();
 	  return 0;
 	}
 
@@ -90,6 +133,29 @@ namespace Gadgetron{
 
 	if (!w) {
 	  GERROR("Unrecognized Message ID received: %d\n",mid->getObjectPtr()->id);
+	  mb->release();
+	  this->release_pending();
+	  return -1;
+	}
+
+	messages_++;
+
+	if (flush_bytes_ > 0) {
+	  size_t mark = iov_.count();
+	  if (w->gather(iov_, mb->cont()) == 0) {
+	    if (pending_.empty()) deadline = ACE_OS::gettimeofday() + max_latency_;
+	    pending_.push_back(mb);
+
+	    if (iov_.bytes() >= flush_bytes_ || iov_.count() >= GADGET_WRITER_MAX_IOV) {
+	      if (this->flush_pending() < 0) return -1;
+	    }
+	    continue;
+	  }
+	  iov_.truncate(mark);
+	}
+
+	//Keep the order on the wire
+	if (this->flush_pending() < 0) {
 	  mb->release();
 	  return -1;
 	}
@@ -103,13 +169,62 @@ namespace Gadgetron{
 	mb->release();
       }
 
+      this->release_pending();
       return 0;
 
     }
 
+    void print_statistics()
+    {
+      if (!messages_) return;
+      GINFO("WriterTask: %llu messages, %llu sent in %llu scatter/gather writes (%.1f bytes per write)\n",
+	    messages_, batched_messages_, batched_writes_,
+	    batched_writes_ ? double(batched_bytes_)/batched_writes_ : 0.0);
+    }
+
   protected:
+
+    int flush_pending()
+    {
+      if (pending_.empty()) return 0;
+
+      size_t sent = 0, writes = 0;
+      //A single gathered message may be larger than the cap of one send, or hold more entries than writev takes
+      int res = iov_.send_n(socket_, GADGET_WRITER_MAX_BYTES_PER_SEND, &sent, &writes);
+
+      batched_writes_ += writes;
+      batched_messages_ += pending_.size();
+      batched_bytes_ += sent;
+      this->release_pending();
+
+      if (res < 0) {
+	GERROR("Failed to write messages to Gadgetron\n");
+	return -1;
+      }
+      return 0;
+    }
+
+    void release_pending()
+    {
+      for (size_t i = 0; i < pending_.size(); i++) {
+	pending_[i]->release();
+      }
+      pending_.clear();
+      iov_.clear();
+    }
+
     ACE_SOCK_Stream* socket_;
     GadgetronSlotContainer<GadgetMessageWriter> writers_;
+
+    size_t flush_bytes_;
+    ACE_Time_Value max_latency_;
+    GadgetMessageIOVector iov_;
+    std::vector<ACE_Message_Block*> pending_;
+
+    unsigned long long messages_;
+    unsigned long long batched_messages_;
+    unsigned long long batched_bytes_;
+    unsigned long long batched_writes_;
   };
 
   class EXPORTGADGETTOOLS GadgetronConnector: public ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_MT_SYNCH> {
@@ -137,6 +252,10 @@ namespace Gadgetron{
       return writer_task_.register_writer(slot,writer);
     }
 
+    void set_writer_batching(size_t flush_bytes, unsigned long max_latency_us) {
+      writer_task_.set_batching(flush_bytes, max_latency_us);
+    }
+
     int send_gadgetron_configuration_file(std::string config_xml_name);
     int send_gadgetron_configuration_script(std::string config_xml_name);
     int send_gadgetron_parameters(std::string xml_string);
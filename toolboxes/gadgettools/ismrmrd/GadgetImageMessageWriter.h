@@ -71,6 +71,42 @@ public:
         return 0;
     }
 
+    virtual int gather(GadgetMessageIOVector& iov, ACE_Message_Block* mb)
+    {
+        GadgetContainerMessage<ISMRMRD::ImageHeader>* imagemb = 
+            dynamic_cast< GadgetContainerMessage<ISMRMRD::ImageHeader>* >(mb);
+
+        GadgetContainerMessage< hoNDArray< T > >* datamb = imagemb ?
+            dynamic_cast< GadgetContainerMessage< hoNDArray< T > >* >(imagemb->cont()) : 0;
+
+        if (!imagemb || !datamb) {
+	  GERROR("GadgetImageMessageWriter invalid image message objects");
+	  return -1;
+        }
+
+        GadgetMessageIdentifier id;
+        switch (sizeof(T)) {
+        case 2: //Unsigned short
+            id.id = GADGET_MESSAGE_IMAGE_REAL_USHORT;
+            break;
+        case 4: //Float
+            id.id = GADGET_MESSAGE_IMAGE_REAL_FLOAT;
+            break;
+        case 8: //Complex float
+            id.id = GADGET_MESSAGE_IMAGE_CPLX_FLOAT;
+            break;
+        default:
+	  GERROR("GadgetImageMessageWriter Wrong data size detected\n");
+	  return -1;
+        }
+
+        iov.add_copy(&id, sizeof(GadgetMessageIdentifier));
+        iov.add(imagemb->getObjectPtr(), sizeof(ISMRMRD::ImageHeader));
+        iov.add(datamb->getObjectPtr()->get_data_ptr(), sizeof(T)*datamb->getObjectPtr()->get_number_of_elements());
+
+        return 0;
+    }
+
 };
 
 }
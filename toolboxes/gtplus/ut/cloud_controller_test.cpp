@@ -0,0 +1,297 @@
+#include <gtest/gtest.h>
+
+#include "GadgetCloudController.h"
+#include "GadgetCloudJobMessageReadWrite.h"
+
+#include <ace/INET_Addr.h>
+#include <ace/SOCK_Acceptor.h>
+#include <boost/thread.hpp>
+#include <csignal>
+#include <complex>
+#include <cstring>
+#include <sstream>
+
+using namespace Gadgetron;
+
+typedef GtPlusRecon2DTCloudPackageCPFL PackageType;
+typedef GadgetCloudController<PackageType> ControllerType;
+
+// a cloud node on the loopback interface
+// every job is returned after delay_ms_, marked with the node index in para.reconSizeE2_
+class gtPlus_cloud_node_emulator
+{
+public:
+
+    gtPlus_cloud_node_emulator(size_t index, int delay_ms, bool drop_first_job)
+        : index_(index), delay_ms_(delay_ms), drop_first_job_(drop_first_job), jobs_received_(0), close_received_(false)
+    {
+        ACE_INET_Addr addr((u_short)0, "127.0.0.1");
+        acceptor_.open(addr, 1);
+        acceptor_.get_local_addr(addr);
+
+        std::ostringstream ostr;
+        ostr << addr.get_port_number();
+        port_ = ostr.str();
+
+        thread_ = boost::thread(boost::bind(&gtPlus_cloud_node_emulator::run, this));
+    }
+
+    ~gtPlus_cloud_node_emulator()
+    {
+        this->stop();
+        acceptor_.close();
+    }
+
+    // interrupt a job still being run and wait for the node to finish
+    void stop()
+    {
+        thread_.interrupt();
+        thread_.join();
+    }
+
+    void run()
+    {
+        try
+        {
+            if ( acceptor_.accept(stream_) != 0 ) return;
+
+            GadgetMessageIdentifier id;
+            GadgetMessageConfigurationFile cfg;
+            if ( stream_.recv_n(&id, sizeof(GadgetMessageIdentifier)) <= 0 ) return;
+            if ( stream_.recv_n(&cfg, sizeof(GadgetMessageConfigurationFile)) <= 0 ) return;
+
+            while ( stream_.recv_n(&id, sizeof(GadgetMessageIdentifier)) > 0 )
+            {
+                if ( id.id == GADGET_MESSAGE_CLOSE )
+                {
+                    close_received_ = true;
+                    stream_.send_n(&id, sizeof(GadgetMessageIdentifier));
+                    break;
+                }
+
+                ACE_Message_Block* mb = reader_.read(&stream_);
+                if ( !mb ) break;
+                jobs_received_++;
+
+                if ( drop_first_job_ )
+                {
+                    mb->release();
+                    break;
+                }
+
+                boost::this_thread::sleep(boost::posix_time::milliseconds(delay_ms_));
+
+                AsContainerMessage<PackageType>(mb->cont())->getObjectPtr()->para.reconSizeE2_ = (unsigned int)(100+index_);
+                int res = writer_.write(&stream_, mb);
+                mb->release();
+                if ( res < 0 ) break;
+            }
+        }
+        catch(boost::thread_interrupted&)
+        {
+        }
+
+        stream_.close();
+    }
+
+    ControllerType::CloudNodeType node() const
+    {
+        return ControllerType::CloudNodeType("127.0.0.1", port_, "default.xml", 0);
+    }
+
+    size_t index_;
+    int delay_ms_;
+    bool drop_first_job_;
+    size_t jobs_received_;
+    bool close_received_;
+
+    std::string port_;
+    ACE_SOCK_Acceptor acceptor_;
+    ACE_SOCK_Stream stream_;
+    GadgetCloudJobMessageScatterReader<PackageType> reader_;
+    GadgetCloudJobMessageGatherWriter<PackageType> writer_;
+    boost::thread thread_;
+};
+
+class gtPlus_cloud_controller_Test : public ::testing::Test
+{
+protected:
+
+    virtual void SetUp()
+    {
+#ifndef WIN32
+        // a node may still answer on a connection closed by the controller
+        signal(SIGPIPE, SIG_IGN);
+#endif // WIN32
+    }
+
+    // one job per entry of node_ids
+    void createJobs(size_t numOfJobs)
+    {
+        jobs_.resize(numOfJobs);
+        completed_jobs_.resize(numOfJobs);
+
+        for ( size_t ii=0; ii<numOfJobs; ii++ )
+        {
+            jobs_[ii].kspace.create(16, 16, 2, 1, 1);
+            for ( size_t n=0; n<jobs_[ii].kspace.get_number_of_elements(); n++ ) jobs_[ii].kspace(n) = std::complex<float>((float)ii, (float)n);
+            memset(&jobs_[ii].para, 0, sizeof(GtPlusRecon2DTPara));
+            jobs_[ii].para.reconSizeRO_ = (unsigned int)ii;
+        }
+    }
+
+    void connect(ControllerType& controller, std::vector<gtPlus_cloud_node_emulator*>& nodes)
+    {
+        ControllerType::CloudType cloud;
+        std::vector<GadgetMessageReader*> readers;
+        std::vector<GadgetMessageWriter*> writers;
+
+        for ( size_t ii=0; ii<nodes.size(); ii++ )
+        {
+            cloud.push_back(nodes[ii]->node());
+            readers.push_back(new GtPlus2DTGadgetCloudJobMessageReaderCPFL());
+            writers.push_back(new GtPlus2DTGadgetCloudJobMessageWriterCPFL());
+        }
+
+        ASSERT_EQ(0, controller.open());
+        ASSERT_EQ(0, controller.createConnector(cloud, GADGET_MESSAGE_CLOUD_JOB, readers, GADGET_MESSAGE_CLOUD_JOB, writers));
+        ASSERT_EQ(0, controller.connectToCloud(cloud));
+    }
+
+    std::vector<PackageType> jobs_;
+    std::vector<PackageType> completed_jobs_;
+};
+
+TEST_F(gtPlus_cloud_controller_Test, deadlineTest)
+{
+    // node 0 holds its job until it is stopped, node 1 is fast
+    gtPlus_cloud_node_emulator slow(0, 600000, false), fast(1, 10, false);
+    std::vector<gtPlus_cloud_node_emulator*> nodes;
+    nodes.push_back(&slow);
+    nodes.push_back(&fast);
+
+    {
+        ControllerType controller;
+        controller.max_job_retries_ = 0;
+        connect(controller, nodes);
+
+        createJobs(2);
+        std::vector<int> node_ids(2);
+        node_ids[0] = 0;
+        node_ids[1] = 1;
+
+        ASSERT_EQ(0, controller.runJobsOnCloud(jobs_, completed_jobs_, node_ids));
+        controller.closeCloudNode();
+        ASSERT_EQ(0, controller.waitForJobToComplete());
+
+        // the late job is run again on the fast node, whose result is used
+        EXPECT_EQ(1, controller.node_id_completed_[0]);
+        EXPECT_EQ(1, controller.node_id_completed_[1]);
+        EXPECT_EQ(0, completed_jobs_[0].para.reconSizeRO_);
+        EXPECT_EQ(101, completed_jobs_[0].para.reconSizeE2_);
+        EXPECT_EQ(101, completed_jobs_[1].para.reconSizeE2_);
+        EXPECT_EQ(jobs_[0].kspace.get_number_of_elements(), completed_jobs_[0].kspace.get_number_of_elements());
+        EXPECT_EQ(0, memcmp(jobs_[0].kspace.begin(), completed_jobs_[0].kspace.begin(), jobs_[0].kspace.get_number_of_bytes()));
+    }
+
+    slow.stop();
+    fast.stop();
+
+    EXPECT_EQ(1, slow.jobs_received_);
+    EXPECT_FALSE(slow.close_received_);
+    EXPECT_EQ(2, fast.jobs_received_);
+    EXPECT_TRUE(fast.close_received_);
+}
+
+TEST_F(gtPlus_cloud_controller_Test, retryTest)
+{
+    // node 0 loses the connection once it receives a job
+    gtPlus_cloud_node_emulator lost(0, 0, true), good(1, 10, false);
+    std::vector<gtPlus_cloud_node_emulator*> nodes;
+    nodes.push_back(&lost);
+    nodes.push_back(&good);
+
+    {
+        ControllerType controller;
+        controller.speculative_execution_ = false;
+        controller.max_job_retries_ = 1;
+        connect(controller, nodes);
+
+        createJobs(2);
+        std::vector<int> node_ids(2);
+        node_ids[0] = 0;
+        node_ids[1] = 1;
+
+        ASSERT_EQ(0, controller.runJobsOnCloud(jobs_, completed_jobs_, node_ids));
+        controller.closeCloudNode();
+        ASSERT_EQ(0, controller.waitForJobToComplete());
+
+        // the job of the lost node is sent to the other node
+        EXPECT_EQ(1, controller.node_id_completed_[0]);
+        EXPECT_EQ(1, controller.node_id_completed_[1]);
+        EXPECT_EQ(0, completed_jobs_[0].para.reconSizeRO_);
+        EXPECT_EQ(101, completed_jobs_[0].para.reconSizeE2_);
+
+        int status = 0;
+        controller.get_node_status(0, status);
+        EXPECT_EQ(-1, status);
+    }
+
+    lost.stop();
+    good.stop();
+
+    EXPECT_EQ(1, lost.jobs_received_);
+    EXPECT_EQ(2, good.jobs_received_);
+    EXPECT_TRUE(good.close_received_);
+}
+
+TEST_F(gtPlus_cloud_controller_Test, cancelTest)
+{
+    // the caller gives up without waiting, while node 0 still runs a job
+    gtPlus_cloud_node_emulator busy(0, 600000, false), idle(1, 10, false);
+    std::vector<gtPlus_cloud_node_emulator*> nodes;
+    nodes.push_back(&busy);
+    nodes.push_back(&idle);
+
+    {
+        ControllerType controller;
+        connect(controller, nodes);
+
+        createJobs(1);
+        std::vector<int> node_ids(1, 0);
+
+        ASSERT_EQ(0, controller.runJobsOnCloud(jobs_, completed_jobs_, node_ids));
+        controller.closeCloudNode();
+        controller.handle_close(ACE_INVALID_HANDLE, 0);
+    }
+
+    // the idle node is closed, the busy node is disconnected instead of waited for
+    idle.stop();
+    EXPECT_TRUE(idle.close_received_);
+    EXPECT_EQ(0, idle.jobs_received_);
+
+    busy.stop();
+    EXPECT_FALSE(busy.close_received_);
+    EXPECT_EQ(1, busy.jobs_received_);
+}
+
+TEST_F(gtPlus_cloud_controller_Test, closeTest)
+{
+    // without jobs to wait for, the close message is sent at once
+    gtPlus_cloud_node_emulator node0(0, 10, false), node1(1, 10, false);
+    std::vector<gtPlus_cloud_node_emulator*> nodes;
+    nodes.push_back(&node0);
+    nodes.push_back(&node1);
+
+    {
+        ControllerType controller;
+        connect(controller, nodes);
+        ASSERT_EQ(0, controller.closeCloudNode());
+
+        node0.stop();
+        node1.stop();
+    }
+
+    EXPECT_TRUE(node0.close_received_);
+    EXPECT_TRUE(node1.close_received_);
+}
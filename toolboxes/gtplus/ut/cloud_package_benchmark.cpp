@@ -0,0 +1,132 @@
+/** \file   cloud_package_benchmark.cpp
+    \brief  Loopback throughput of a 2D+T cloud job package, serialized writer/reader against gather writer/scatter reader
+
+            The package is the one of cloud_package_test. Run with [iterations].
+*/
+
+#include "GadgetCloudJobMessageReadWrite.h"
+
+#include <ace/INET_Addr.h>
+#include <ace/SOCK_Acceptor.h>
+#include <ace/SOCK_Connector.h>
+#include <boost/thread.hpp>
+#include <chrono>
+#include <complex>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace Gadgetron;
+
+namespace {
+
+typedef GtPlusRecon2DTCloudPackageCPFL PackageType;
+typedef std::complex<float> T;
+
+// a 2D+T job, [RO E1 CHA N S]
+void fill(PackageType& package)
+{
+    std::vector<size_t> dims(5);
+    dims[0] = 192; dims[1] = 144; dims[2] = 32; dims[3] = 24; dims[4] = 1;
+
+    package.kspace.create(dims);
+    for ( size_t i=0; i<package.kspace.get_number_of_elements(); i++ ) package.kspace(i) = T((float)(i%97), (float)(i%89));
+
+    dims[1] = 48;
+    package.ref.create(dims);
+    for ( size_t i=0; i<package.ref.get_number_of_elements(); i++ ) package.ref(i) = T((float)(i%83), (float)(i%79));
+
+    package.timeStamp.create(144, 24, 1);
+    for ( size_t i=0; i<package.timeStamp.get_number_of_elements(); i++ ) package.timeStamp(i) = (float)i;
+
+    memset(&package.para, 0, sizeof(GtPlusRecon2DTPara));
+    package.para.reconSizeRO_ = 192;
+    package.para.reconSizeE1_ = 144;
+    package.para.reconSizeE2_ = 1;
+}
+
+template <typename Writer> void write(Writer* writer, ACE_SOCK_Stream* stream, ACE_Message_Block* mb, int* res)
+{
+    *res = writer->write(stream, mb);
+}
+
+// seconds to send the package with writer on a separate thread and read it back with reader, negative on failure
+template <typename Writer, typename Reader> double send(Writer& writer, Reader& reader, const PackageType& package, ACE_SOCK_Stream& client, ACE_SOCK_Stream& server)
+{
+    GadgetContainerMessage<int>* jobID = new GadgetContainerMessage<int>();
+    *(jobID->getObjectPtr()) = 7;
+    GadgetContainerMessage<PackageType>* job = new GadgetContainerMessage<PackageType>();
+    jobID->cont(job);
+    *(job->getObjectPtr()) = package;
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+    int res = -1;
+    boost::thread t(boost::bind(&write<Writer>, &writer, &client, jobID, &res));
+
+    GadgetMessageIdentifier id;
+    ACE_Message_Block* mb = NULL;
+    if ( server.recv_n(&id, sizeof(GadgetMessageIdentifier)) > 0 ) mb = reader.read(&server);
+    t.join();
+
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+    jobID->release();
+    if ( mb ) mb->release();
+    if ( (res != 0) || (mb == NULL) ) return -1;
+
+    return std::chrono::duration<double>(t1-t0).count();
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = (argc > 1) ? atoi(argv[1]) : 5;
+    if ( iterations < 1 ) iterations = 1;
+
+    PackageType package;
+    fill(package);
+
+    ACE_SOCK_Acceptor acceptor;
+    ACE_SOCK_Stream client, server;
+    ACE_INET_Addr addr((u_short)0, "127.0.0.1");
+    ACE_SOCK_Connector connector;
+    if ( (acceptor.open(addr, 1) != 0) || (acceptor.get_local_addr(addr) != 0)
+        || (connector.connect(client, addr) != 0) || (acceptor.accept(server) != 0) )
+    {
+        std::cout << "cannot open a loopback connection" << std::endl;
+        return 1;
+    }
+
+    GadgetCloudJobMessageWriter<PackageType> writer;
+    GadgetCloudJobMessageReader<PackageType> reader;
+    GadgetCloudJobMessageGatherWriter<PackageType> gatherWriter;
+    GadgetCloudJobMessageScatterReader<PackageType> scatterReader;
+
+    double MBytes = (package.kspace.get_number_of_bytes() + package.ref.get_number_of_bytes() + package.timeStamp.get_number_of_bytes())/1024.0/1024;
+
+    double tSerialize = 0, tScatterGather = 0;
+    for ( int it=0; it<iterations; it++ )
+    {
+        double t = send(writer, reader, package, client, server);
+        double t2 = send(gatherWriter, scatterReader, package, client, server);
+        if ( (t < 0) || (t2 < 0) )
+        {
+            std::cout << "sending the package failed" << std::endl;
+            return 1;
+        }
+
+        tSerialize += t;
+        tScatterGather += t2;
+    }
+
+    client.close();
+    server.close();
+    acceptor.close();
+
+    std::cout << "cloud package over loopback, " << MBytes << " MBytes, MBytes/s: serialize " << MBytes*iterations/tSerialize
+              << " scatter/gather " << MBytes*iterations/tScatterGather << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include "GadgetCloudJobMessageReadWrite.h"
+
+#include <ace/INET_Addr.h>
+#include <ace/SOCK_Acceptor.h>
+#include <ace/SOCK_Connector.h>
+#include <boost/thread.hpp>
+#include <complex>
+#include <cstring>
+
+using namespace Gadgetron;
+
+class gtPlus_cloud_package_Test : public ::testing::Test
+{
+protected:
+
+    typedef GtPlusRecon2DTCloudPackageCPFL PackageType;
+    typedef std::complex<float> T;
+
+    virtual void SetUp()
+    {
+        // a 2D+T job, [RO E1 CHA N S]
+        std::vector<size_t> dims(5);
+        dims[0] = 192; dims[1] = 144; dims[2] = 32; dims[3] = 24; dims[4] = 1;
+
+        package_.kspace.create(dims);
+        for ( size_t i=0; i<package_.kspace.get_number_of_elements(); i++ ) package_.kspace(i) = T((float)(i%97), (float)(i%89));
+
+        dims[1] = 48;
+        package_.ref.create(dims);
+        for ( size_t i=0; i<package_.ref.get_number_of_elements(); i++ ) package_.ref(i) = T((float)(i%83), (float)(i%79));
+
+        package_.timeStamp.create(144, 24, 1);
+        for ( size_t i=0; i<package_.timeStamp.get_number_of_elements(); i++ ) package_.timeStamp(i) = (float)i;
+
+        memset(&package_.para, 0, sizeof(GtPlusRecon2DTPara));
+        package_.para.reconSizeRO_ = 192;
+        package_.para.reconSizeE1_ = 144;
+        package_.para.reconSizeE2_ = 1;
+
+        ACE_INET_Addr addr((u_short)0, "127.0.0.1");
+        ASSERT_EQ(0, acceptor_.open(addr, 1));
+        ASSERT_EQ(0, acceptor_.get_local_addr(addr));
+
+        ACE_SOCK_Connector connector;
+        ASSERT_EQ(0, connector.connect(client_, addr));
+        ASSERT_EQ(0, acceptor_.accept(server_));
+    }
+
+    virtual void TearDown()
+    {
+        client_.close();
+        server_.close();
+        acceptor_.close();
+    }
+
+    // send the package with writer on a separate thread and read it back with reader
+    template <typename Writer, typename Reader> void send(Writer& writer, Reader& reader, PackageType& received)
+    {
+        GadgetContainerMessage<int>* jobID = new GadgetContainerMessage<int>();
+        *(jobID->getObjectPtr()) = 7;
+        GadgetContainerMessage<PackageType>* job = new GadgetContainerMessage<PackageType>();
+        jobID->cont(job);
+        *(job->getObjectPtr()) = package_;
+
+        int res = -1;
+        boost::thread t(boost::bind(&gtPlus_cloud_package_Test::write<Writer>, &writer, &client_, jobID, &res));
+
+        GadgetMessageIdentifier id;
+        EXPECT_GT(server_.recv_n(&id, sizeof(GadgetMessageIdentifier)), 0);
+        ACE_Message_Block* mb = reader.read(&server_);
+        t.join();
+
+        EXPECT_EQ(0, res);
+        EXPECT_TRUE(mb != NULL);
+        if ( mb )
+        {
+            EXPECT_EQ(7, *(AsContainerMessage<int>(mb)->getObjectPtr()));
+            received = *(AsContainerMessage<PackageType>(mb->cont())->getObjectPtr());
+            mb->release();
+        }
+
+        jobID->release();
+    }
+
+    template <typename Writer> static void write(Writer* writer, ACE_SOCK_Stream* stream, ACE_Message_Block* mb, int* res)
+    {
+        *res = writer->write(stream, mb);
+    }
+
+    template <typename T2> void check(const hoNDArray<T2>& a, const hoNDArray<T2>& b)
+    {
+        ASSERT_EQ(a.get_number_of_dimensions(), b.get_number_of_dimensions());
+        ASSERT_EQ(a.get_number_of_elements(), b.get_number_of_elements());
+        for ( size_t d=0; d<a.get_number_of_dimensions(); d++ ) EXPECT_EQ(a.get_size(d), b.get_size(d));
+        if ( a.get_number_of_elements() > 0 ) EXPECT_EQ(0, memcmp(a.begin(), b.begin(), sizeof(T2)*a.get_number_of_elements()));
+    }
+
+    void check(const PackageType& received)
+    {
+        EXPECT_EQ(package_.para.reconSizeRO_, received.para.reconSizeRO_);
+        EXPECT_EQ(package_.para.reconSizeE1_, received.para.reconSizeE1_);
+        check(package_.kspace, received.kspace);
+        check(package_.timeStamp, received.timeStamp);
+        check(package_.ref, received.ref);
+        check(package_.complexIm, received.complexIm);
+        check(package_.res, received.res);
+    }
+
+    PackageType package_;
+    ACE_SOCK_Acceptor acceptor_;
+    ACE_SOCK_Stream client_;
+    ACE_SOCK_Stream server_;
+};
+
+TEST_F(gtPlus_cloud_package_Test, scatterGatherTest)
+{
+    GadgetCloudJobMessageWriter<PackageType> writer;
+    GadgetCloudJobMessageReader<PackageType> reader;
+    GadgetCloudJobMessageGatherWriter<PackageType> gatherWriter;
+    GadgetCloudJobMessageScatterReader<PackageType> scatterReader;
+
+    // the messages are the same on the wire, so the old and new reader/writer can be mixed
+    PackageType received;
+    send(gatherWriter, scatterReader, received);
+    check(received);
+
+    received = PackageType();
+    send(gatherWriter, reader, received);
+    check(received);
+
+    received = PackageType();
+    send(writer, scatterReader, received);
+    check(received);
+}
+
+TEST_F(gtPlus_cloud_package_Test, splitSendTest)
+{
+    // entries larger than the cap and entries spanning two sends
+    std::vector<char> a(1000), b(10), c(3000);
+    for ( size_t i=0; i<a.size(); i++ ) a[i] = (char)(i%101);
+    for ( size_t i=0; i<b.size(); i++ ) b[i] = (char)(i+1);
+    for ( size_t i=0; i<c.size(); i++ ) c[i] = (char)(i%97);
+
+    GadgetMessageIOVector iov;
+    iov.add(&a[0], a.size());
+    iov.add_copy(&b[0], b.size());
+    iov.add(&c[0], c.size());
+
+    size_t sent = 0, writes = 0;
+    ASSERT_EQ(0, iov.send_n(&client_, 256, &sent, &writes));
+    EXPECT_EQ(iov.bytes(), sent);
+    EXPECT_EQ((iov.bytes()+255)/256, writes);
+
+    std::vector<char> received(sent);
+    ASSERT_GT(server_.recv_n(&received[0], received.size()), 0);
+    EXPECT_EQ(0, memcmp(&received[0], &a[0], a.size()));
+    EXPECT_EQ(0, memcmp(&received[a.size()], &b[0], b.size()));
+    EXPECT_EQ(0, memcmp(&received[a.size()+b.size()], &c[0], c.size()));
+}
+
+TEST_F(gtPlus_cloud_package_Test, corruptedHeaderTest)
+{
+    // the kspace dimensions claim far more than the job holds
+    std::vector<size_t> header(6, 1024*1024);
+    header[0] = 5;
+
+    int id = 7;
+    size_t sizeOfJob = sizeof(GtPlusRecon2DTPara) + sizeof(size_t)*header.size();
+
+    ASSERT_GT(client_.send_n(&id, sizeof(int)), 0);
+    ASSERT_GT(client_.send_n(&sizeOfJob, sizeof(size_t)), 0);
+    ASSERT_GT(client_.send_n(&package_.para, sizeof(GtPlusRecon2DTPara)), 0);
+    ASSERT_GT(client_.send_n(&header[0], sizeof(size_t)*header.size()), 0);
+
+    GadgetCloudJobMessageScatterReader<PackageType> scatterReader;
+    EXPECT_TRUE(scatterReader.read(&server_) == NULL);
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include "gtPlusCloudScheduler.h"
+
+#include <cstdio>
+#include <fstream>
+
+using namespace Gadgetron;
+using namespace Gadgetron::gtPlus;
+
+class gtPlus_cloud_scheduler_Test : public ::testing::Test
+{
+protected:
+
+    virtual void SetUp()
+    {
+        // 24 jobs of different sizes on 4 nodes with equal power indexes
+        // node 3 is 4 times slower than its power index says, node 1 is busy with 2 reconstructions
+        for ( size_t ii=0; ii<24; ii++ ) job_sizes_.push_back(1000 + (ii*7919)%5000);
+
+        seconds_per_byte_.resize(4, 1e-3);
+        seconds_per_byte_[3] = 4e-3;
+        power_.resize(4, 1.0);
+        load_.resize(4, 0);
+        load_[1] = 2;
+
+        sim_.setTrace(job_sizes_, seconds_per_byte_, power_, load_);
+    }
+
+    std::vector<size_t> job_sizes_;
+    std::vector<double> seconds_per_byte_;
+    std::vector<double> power_;
+    std::vector<unsigned int> load_;
+    gtPlusCloudSchedulerSimulator sim_;
+};
+
+TEST_F(gtPlus_cloud_scheduler_Test, lptTest)
+{
+    // 3 nodes, the second one twice as fast
+    gtPlusCloudScheduler scheduler;
+    std::vector<double> power(3, 1.0);
+    power[1] = 2.0;
+    scheduler.setUpNodes(power);
+
+    std::vector<size_t> jobSizes(4);
+    jobSizes[0] = 100; jobSizes[1] = 400; jobSizes[2] = 200; jobSizes[3] = 300;
+    scheduler.setJobSizes(jobSizes);
+
+    std::vector<int> nodeIDforJobs;
+    ASSERT_TRUE(scheduler.schedulerJobs(nodeIDforJobs));
+    ASSERT_EQ(4, nodeIDforJobs.size());
+
+    // the largest job goes to the fast node, the next two to the idle nodes
+    EXPECT_EQ(1, nodeIDforJobs[1]);
+    EXPECT_NE(1, nodeIDforJobs[3]);
+    EXPECT_NE(1, nodeIDforJobs[2]);
+    EXPECT_NE(nodeIDforJobs[2], nodeIDforJobs[3]);
+
+    // a busy node is avoided
+    std::vector<unsigned int> load(3, 0);
+    load[1] = 10;
+    scheduler.setNodeLoads(load);
+    ASSERT_TRUE(scheduler.schedulerJobs(nodeIDforJobs));
+    for ( size_t ii=0; ii<nodeIDforJobs.size(); ii++ ) EXPECT_NE(1, nodeIDforJobs[ii]);
+
+    // measured throughput overrides the power indexes, unmeasured nodes are scaled from the measured ones
+    scheduler.updateNodeThroughput(0, 1000, 8.0);
+    EXPECT_DOUBLE_EQ(8e-3, scheduler.getNodeSecondsPerByte(0));
+    EXPECT_DOUBLE_EQ(4e-3, scheduler.getNodeSecondsPerByte(1));
+    EXPECT_DOUBLE_EQ(8e-3, scheduler.getNodeSecondsPerByte(2));
+}
+
+TEST_F(gtPlus_cloud_scheduler_Test, stragglerTest)
+{
+    // node 0 is twice as fast
+    gtPlusCloudScheduler scheduler;
+    std::vector<double> power(2, 1.0);
+    power[0] = 2.0;
+    scheduler.setUpNodes(power);
+
+    std::vector<size_t> jobSizes(3, 100);
+    scheduler.setJobSizes(jobSizes);
+
+    std::vector<int> nodeIDforJobs;
+    ASSERT_TRUE(scheduler.schedulerJobs(nodeIDforJobs));
+    EXPECT_EQ(0, nodeIDforJobs[0]);
+    EXPECT_EQ(0, nodeIDforJobs[1]);
+    EXPECT_EQ(1, nodeIDforJobs[2]);
+
+    // node 0 is done, the job on node 1 is overdue and completes earlier as a copy on node 0
+    std::vector<bool> jobDone(3, true);
+    jobDone[2] = false;
+    EXPECT_EQ(2, scheduler.selectStragglerJob(0, 110.0, jobDone));
+
+    // a slower node does not get a copy
+    jobDone[2] = true;
+    jobDone[0] = false;
+    EXPECT_EQ(-1, scheduler.selectStragglerJob(1, 40.0, jobDone));
+
+    // without job sizes, there are no stragglers to select
+    scheduler.setNumOfJobs(3);
+    ASSERT_TRUE(scheduler.schedulerJobs(nodeIDforJobs));
+    jobDone.assign(3, false);
+    EXPECT_EQ(-1, scheduler.selectStragglerJob(0, 110.0, jobDone));
+}
+
+TEST_F(gtPlus_cloud_scheduler_Test, simulatorTest)
+{
+    double proportional, lptCold, lpt, lptRedispatch;
+
+    gtPlusCloudScheduler schedulerProportional;
+    ASSERT_TRUE(sim_.replay(schedulerProportional, false, false, proportional));
+
+    // the first replay measures the nodes, the second one uses the measured throughput
+    gtPlusCloudScheduler schedulerLPT;
+    ASSERT_TRUE(sim_.replay(schedulerLPT, true, false, lptCold));
+    ASSERT_TRUE(sim_.replay(schedulerLPT, true, false, lpt));
+
+    // re-dispatch recovers from the wrong power index already in the first replay
+    gtPlusCloudScheduler schedulerRedispatch;
+    ASSERT_TRUE(sim_.replay(schedulerRedispatch, true, true, lptRedispatch));
+
+    EXPECT_LT(lpt, proportional);
+    EXPECT_LT(lptRedispatch, lptCold);
+    EXPECT_LT(lptRedispatch, proportional);
+
+    // the same trace from a file
+    std::string filename = "gtplus_ut_cloud_trace.txt";
+    {
+        std::ofstream f(filename.c_str());
+        f << "# node <seconds per byte> <power index> <active reconstructions>" << std::endl;
+        for ( size_t ii=0; ii<seconds_per_byte_.size(); ii++ ) f << "node " << seconds_per_byte_[ii] << " " << power_[ii] << " " << load_[ii] << std::endl;
+        for ( size_t ii=0; ii<job_sizes_.size(); ii++ ) f << "job " << job_sizes_[ii] << std::endl;
+    }
+
+    gtPlusCloudSchedulerSimulator sim;
+    ASSERT_TRUE(sim.loadTrace(filename));
+    std::remove(filename.c_str());
+
+    gtPlusCloudScheduler scheduler;
+    double makespan;
+    ASSERT_TRUE(sim.replay(scheduler, false, false, makespan));
+    EXPECT_DOUBLE_EQ(proportional, makespan);
+}
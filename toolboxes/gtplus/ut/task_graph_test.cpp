@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include "gtPlusTaskGraph.h"
+
+#include <boost/bind.hpp>
+#include <chrono>
+#include <thread>
+
+using namespace Gadgetron;
+using namespace Gadgetron::gtPlus;
+
+class gtPlus_task_graph_Test : public ::testing::Test
+{
+public:
+
+    // record the finish order of the tasks, sleep for ms to emulate the work
+    bool work(size_t id, int ms, bool succeed)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+
+        #pragma omp critical
+        {
+            order_.push_back(id);
+        }
+
+        return succeed;
+    }
+
+    size_t position(size_t id) const
+    {
+        for ( size_t ii=0; ii<order_.size(); ii++ )
+        {
+            if ( order_[ii] == id ) return ii;
+        }
+
+        return order_.size();
+    }
+
+    std::vector<size_t> order_;
+};
+
+TEST_F(gtPlus_task_graph_Test, dependencyTest)
+{
+    // 4 S, calib -> unwrap for every S, all unwraps -> after unwrapping
+    gtPlusTaskGraph graph;
+
+    std::vector<size_t> calib, unwrap;
+    for ( size_t s=0; s<4; s++ )
+    {
+        calib.push_back(graph.addTask("calib", boost::bind(&gtPlus_task_graph_Test::work, this, 2*s, 20, true)));
+        unwrap.push_back(graph.addTask("unwrap", boost::bind(&gtPlus_task_graph_Test::work, this, 2*s+1, 10, true)));
+        graph.addDependency(unwrap[s], calib[s]);
+    }
+
+    size_t after = graph.addTask("afterUnwrapping", boost::bind(&gtPlus_task_graph_Test::work, this, 100, 1, true));
+    for ( size_t s=0; s<4; s++ ) graph.addDependency(after, unwrap[s]);
+
+    ASSERT_EQ(9, graph.getNumOfTasks());
+    ASSERT_TRUE(graph.run(2));
+    ASSERT_EQ(9, order_.size());
+
+    for ( size_t s=0; s<4; s++ ) EXPECT_LT(position(2*s), position(2*s+1));
+    EXPECT_EQ(8, position(100));
+
+    std::vector<std::string> stages;
+    std::vector<double> busy, wall;
+    graph.getStageTiming(stages, busy, wall);
+    ASSERT_EQ(3, stages.size());
+    EXPECT_EQ("calib", stages[0]);
+    EXPECT_EQ("unwrap", stages[1]);
+    EXPECT_EQ("afterUnwrapping", stages[2]);
+    ASSERT_EQ(3, busy.size());
+    ASSERT_EQ(3, wall.size());
+}
+
+TEST_F(gtPlus_task_graph_Test, singleThreadTest)
+{
+    // with one thread, the ready task added first runs first
+    gtPlusTaskGraph graph;
+
+    size_t a = graph.addTask("calib", boost::bind(&gtPlus_task_graph_Test::work, this, 0, 0, true));
+    size_t b = graph.addTask("unwrap", boost::bind(&gtPlus_task_graph_Test::work, this, 1, 0, true));
+    size_t c = graph.addTask("calib", boost::bind(&gtPlus_task_graph_Test::work, this, 2, 0, true));
+    size_t d = graph.addTask("unwrap", boost::bind(&gtPlus_task_graph_Test::work, this, 3, 0, true));
+    graph.addDependency(b, a);
+    graph.addDependency(d, c);
+    graph.addDependency(c, b);
+
+    ASSERT_TRUE(graph.run(1));
+    ASSERT_EQ(4, order_.size());
+    for ( size_t ii=0; ii<4; ii++ ) EXPECT_EQ(ii, order_[ii]);
+
+    // the graph can be run again
+    order_.clear();
+    ASSERT_TRUE(graph.run(1, true));
+    EXPECT_EQ(4, order_.size());
+}
+
+TEST_F(gtPlus_task_graph_Test, failureTest)
+{
+    gtPlusTaskGraph graph;
+
+    size_t a = graph.addTask("calib", boost::bind(&gtPlus_task_graph_Test::work, this, 0, 1, false));
+    size_t b = graph.addTask("unwrap", boost::bind(&gtPlus_task_graph_Test::work, this, 1, 1, true));
+    graph.addDependency(b, a);
+
+    // a failed task stops its dependents
+    EXPECT_FALSE(graph.run(2));
+    ASSERT_EQ(1, order_.size());
+    EXPECT_EQ(0, order_[0]);
+
+    // a cycle is rejected before anything runs
+    order_.clear();
+    graph.clear();
+    a = graph.addTask("calib", boost::bind(&gtPlus_task_graph_Test::work, this, 0, 1, true));
+    b = graph.addTask("unwrap", boost::bind(&gtPlus_task_graph_Test::work, this, 1, 1, true));
+    graph.addDependency(b, a);
+    graph.addDependency(a, b);
+
+    EXPECT_FALSE(graph.run(2));
+    EXPECT_EQ(0, order_.size());
+}
@@ -3,16 +3,22 @@
             A simple scheduling strategy is implemented here. The number of job packages which are sent
             to a node is propotional to the computing power index for that node.
 
+            If the job sizes are known, the jobs are scheduled longest-processing-time-first instead. Every job goes
+            to the node which is expected to complete it earliest, given the current load of the node and a running
+            estimate of its seconds per byte.
+
             This class may serve as the base class to implement more complicated job scheduling strategies.
 
     \author Hui Xue
 */
 
 #include "gtPlusCloudScheduler.h"
+#include <fstream>
+#include <sstream>
 
 namespace Gadgetron { namespace gtPlus {
 
-gtPlusCloudScheduler::gtPlusCloudScheduler() : num_of_nodes_(0), num_of_jobs_(0)
+gtPlusCloudScheduler::gtPlusCloudScheduler() : num_of_nodes_(0), num_of_jobs_(0), throughput_update_weight_(0.3)
 {
 }
 
@@ -27,16 +33,27 @@ void gtPlusCloudScheduler::printInfo(std::ostream& os) const
     os << "-------------- GTPlus Cloud scheduler for jobs ---------------" << endl;
     os << "This class implements the simple scheduling scheme for GtPlus cloud " << endl;
     os << "The scheduler here tries to allocate nodes to jobs propotional to the power indexes provided " << endl;
+    os << "If the job sizes are set, the jobs are scheduled longest-processing-time-first " << endl;
+    os << "using the node loads and the measured seconds per byte of every node " << endl;
     os << "--------------------------------------------------------------" << endl;
 }
 
 void gtPlusCloudScheduler::setNumOfJobs(size_t numOfJobs)
 {
     num_of_jobs_ = numOfJobs;
+    job_sizes_.clear();
+}
+
+void gtPlusCloudScheduler::setJobSizes(const std::vector<size_t>& jobSizes)
+{
+    num_of_jobs_ = jobSizes.size();
+    job_sizes_ = jobSizes;
 }
 
 void gtPlusCloudScheduler::setUpNodes(size_t numOfNodes)
 {
+    if ( numOfNodes != num_of_nodes_ ) node_seconds_per_byte_.clear();
+
     num_of_nodes_ = numOfNodes;
     if ( num_of_nodes_ > 0 )
     {
@@ -51,6 +68,8 @@ void gtPlusCloudScheduler::setUpNodes(size_t numOfNodes)
 
 void gtPlusCloudScheduler::setUpNodes(const std::vector<double>& nodeComputingPowerIndexes)
 {
+    if ( nodeComputingPowerIndexes.size() != num_of_nodes_ ) node_seconds_per_byte_.clear();
+
     num_of_nodes_ = nodeComputingPowerIndexes.size();
     node_id_computing_power_indexes_.resize(num_of_nodes_);
 
@@ -61,6 +80,119 @@ void gtPlusCloudScheduler::setUpNodes(const std::vector<double>& nodeComputingPo
     }
 }
 
+void gtPlusCloudScheduler::setNodeLoads(const std::vector<unsigned int>& nodeLoads)
+{
+    node_loads_ = nodeLoads;
+}
+
+void gtPlusCloudScheduler::updateNodeThroughput(int nodeID, size_t jobSize, double seconds)
+{
+    if ( nodeID<0 || (size_t)nodeID>=num_of_nodes_ || jobSize==0 || seconds<=0 ) return;
+
+    if ( node_seconds_per_byte_.size() != num_of_nodes_ ) node_seconds_per_byte_.resize(num_of_nodes_, 0);
+
+    double secondsPerByte = seconds/jobSize;
+
+    if ( node_seconds_per_byte_[nodeID] > 0 )
+    {
+        node_seconds_per_byte_[nodeID] = (1.0-throughput_update_weight_)*node_seconds_per_byte_[nodeID] + throughput_update_weight_*secondsPerByte;
+    }
+    else
+    {
+        node_seconds_per_byte_[nodeID] = secondsPerByte;
+    }
+}
+
+double gtPlusCloudScheduler::getNodeComputingPowerIndex(int nodeID) const
+{
+    double power = 1.0;
+
+    size_t ii;
+    for ( ii=0; ii<node_id_computing_power_indexes_.size(); ii++ )
+    {
+        if ( node_id_computing_power_indexes_[ii].first == nodeID )
+        {
+            power = node_id_computing_power_indexes_[ii].second;
+            break;
+        }
+    }
+
+    // a node reporting no computing power is still usable, but only as the last resort
+    if ( power < 1e-3 ) power = 1e-3;
+
+    return power;
+}
+
+bool gtPlusCloudScheduler::hasNodeThroughput() const
+{
+    size_t ii;
+    for ( ii=0; ii<node_seconds_per_byte_.size(); ii++ )
+    {
+        if ( node_seconds_per_byte_[ii] > 0 ) return true;
+    }
+
+    return false;
+}
+
+double gtPlusCloudScheduler::getNodeSecondsPerByte(int nodeID) const
+{
+    if ( nodeID>=0 && (size_t)nodeID<node_seconds_per_byte_.size() && node_seconds_per_byte_[nodeID]>0 )
+    {
+        return node_seconds_per_byte_[nodeID];
+    }
+
+    // scale the measured nodes to this node by the computing power indexes
+    double secondsPerUnitPower = 0;
+    size_t numOfMeasured = 0;
+
+    size_t ii;
+    for ( ii=0; ii<node_seconds_per_byte_.size(); ii++ )
+    {
+        if ( node_seconds_per_byte_[ii] > 0 )
+        {
+            secondsPerUnitPower += node_seconds_per_byte_[ii] * getNodeComputingPowerIndex((int)ii);
+            numOfMeasured++;
+        }
+    }
+
+    if ( numOfMeasured == 0 ) secondsPerUnitPower = 1.0;
+    else secondsPerUnitPower /= numOfMeasured;
+
+    return secondsPerUnitPower / getNodeComputingPowerIndex(nodeID);
+}
+
+int gtPlusCloudScheduler::selectStragglerJob(int idleNodeID, double now, const std::vector<bool>& jobDone) const
+{
+    if ( job_sizes_.empty() || node_id_for_jobs_.size()!=job_sizes_.size() || jobDone.size()!=job_sizes_.size() ) return -1;
+
+    double idleSecondsPerByte = getNodeSecondsPerByte(idleNodeID);
+
+    int jobID = -1;
+    double maxGain = 0;
+
+    size_t ii;
+    for ( ii=0; ii<job_sizes_.size(); ii++ )
+    {
+        if ( jobDone[ii] || node_id_for_jobs_[ii]==idleNodeID ) continue;
+
+        // a job overdue is assumed to need its full time again
+        double expectedFinish = job_expected_finish_[ii];
+        if ( expectedFinish <= now )
+        {
+            expectedFinish = now + job_sizes_[ii]*getNodeSecondsPerByte(node_id_for_jobs_[ii]);
+        }
+
+        double gain = expectedFinish - (now + job_sizes_[ii]*idleSecondsPerByte);
+        if ( gain > maxGain )
+        {
+            maxGain = gain;
+            jobID = (int)ii;
+        }
+    }
+
+    return jobID;
+}
+
 struct gtPlusCloudSchedulerNodeSorter
 {
     gtPlusCloudSchedulerNodeSorter() {}
@@ -96,6 +228,11 @@ bool gtPlusCloudScheduler::schedulerJobs(std::vector<int>& nodeIDforJobs)
             }
         }
 
+        if ( !job_sizes_.empty() )
+        {
+            return this->schedulerJobsLPT(nodeIDforJobs);
+        }
+
         nodeIDforJobs.resize(num_of_jobs_, -1);
 
         // always sort the nodes with higher computing power node ahead
@@ -144,6 +281,10 @@ bool gtPlusCloudScheduler::schedulerJobs(std::vector<int>& nodeIDforJobs)
 
             GADGET_CHECK_RETURN_FALSE(jobID==num_of_jobs_);
         }
+
+        // without job sizes, there is no expected completion time to re-dispatch stragglers
+        node_id_for_jobs_ = nodeIDforJobs;
+        job_expected_finish_.clear();
     }
     catch (...)
     {
@@ -154,4 +295,279 @@ bool gtPlusCloudScheduler::schedulerJobs(std::vector<int>& nodeIDforJobs)
     return true;
 }
 
+struct gtPlusCloudSchedulerJobSorter
+{
+    gtPlusCloudSchedulerJobSorter(const std::vector<size_t>& jobSizes) : job_sizes_(jobSizes) {}
+    ~gtPlusCloudSchedulerJobSorter() {}
+
+    bool operator()(size_t A, size_t B) const
+    {
+        return (job_sizes_[A] > job_sizes_[B]);
+    }
+
+    const std::vector<size_t>& job_sizes_;
+};
+
+bool gtPlusCloudScheduler::schedulerJobsLPT(std::vector<int>& nodeIDforJobs)
+{
+    try
+    {
+        size_t ii, jj;
+
+        nodeIDforJobs.clear();
+        nodeIDforJobs.resize(num_of_jobs_, -1);
+
+        std::vector<double> secondsPerByte(num_of_nodes_);
+        for ( ii=0; ii<num_of_nodes_; ii++ )
+        {
+            secondsPerByte[ii] = this->getNodeSecondsPerByte((int)ii);
+        }
+
+        // the reconstructions already running on a node are assumed to be of the size of an average job
+        double meanJobSize = 0;
+        for ( jj=0; jj<num_of_jobs_; jj++ ) meanJobSize += job_sizes_[jj];
+        meanJobSize /= num_of_jobs_;
+
+        std::vector<double> nodeAvailable(num_of_nodes_, 0);
+        for ( ii=0; ii<num_of_nodes_ && ii<node_loads_.size(); ii++ )
+        {
+            nodeAvailable[ii] = node_loads_[ii] * meanJobSize * secondsPerByte[ii];
+        }
+
+        std::vector<double> nodeStart(nodeAvailable);
+
+        // largest job first, every job goes to the node completing it earliest
+        std::vector<size_t> jobOrder(num_of_jobs_);
+        for ( jj=0; jj<num_of_jobs_; jj++ ) jobOrder[jj] = jj;
+        std::stable_sort(jobOrder.begin(), jobOrder.end(), gtPlusCloudSchedulerJobSorter(job_sizes_));
+
+        for ( jj=0; jj<num_of_jobs_; jj++ )
+        {
+            size_t jobID = jobOrder[jj];
+
+            size_t nodeID = 0;
+            double finish = nodeAvailable[0] + job_sizes_[jobID]*secondsPerByte[0];
+            for ( ii=1; ii<num_of_nodes_; ii++ )
+            {
+                double t = nodeAvailable[ii] + job_sizes_[jobID]*secondsPerByte[ii];
+                if ( t < finish )
+                {
+                    finish = t;
+                    nodeID = ii;
+                }
+            }
+
+            nodeIDforJobs[jobID] = (int)nodeID;
+            nodeAvailable[nodeID] = finish;
+        }
+
+        // a node runs its jobs in the order they are sent, which is the job order
+        job_expected_finish_.resize(num_of_jobs_);
+        for ( jj=0; jj<num_of_jobs_; jj++ )
+        {
+            size_t nodeID = nodeIDforJobs[jj];
+            nodeStart[nodeID] += job_sizes_[jj]*secondsPerByte[nodeID];
+            job_expected_finish_[jj] = nodeStart[nodeID];
+        }
+
+        node_id_for_jobs_ = nodeIDforJobs;
+    }
+    catch (...)
+    {
+        GERROR_STREAM("Errors in gtPlusCloudScheduler::schedulerJobsLPT(std::vector<int>& nodeIDforJobs) ... ");
+        return false;
+    }
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------
+
+gtPlusCloudSchedulerSimulator::gtPlusCloudSchedulerSimulator()
+{
+}
+
+gtPlusCloudSchedulerSimulator::~gtPlusCloudSchedulerSimulator()
+{
+}
+
+bool gtPlusCloudSchedulerSimulator::loadTrace(const std::string& filename)
+{
+    try
+    {
+        std::ifstream f(filename.c_str());
+        if ( !f.is_open() )
+        {
+            GERROR_STREAM("gtPlusCloudSchedulerSimulator, cannot open the trace file : " << filename);
+            return false;
+        }
+
+        job_sizes_.clear();
+        node_seconds_per_byte_.clear();
+        node_computing_power_indexes_.clear();
+        node_loads_.clear();
+
+        std::string line;
+        while ( std::getline(f, line) )
+        {
+            std::istringstream is(line);
+
+            std::string type;
+            if ( !(is >> type) || type[0]=='#' ) continue;
+
+            if ( type == "node" )
+            {
+                double secondsPerByte = 0, power = 1.0;
+                unsigned int load = 0;
+                if ( !(is >> secondsPerByte) || secondsPerByte<=0 )
+                {
+                    GERROR_STREAM("gtPlusCloudSchedulerSimulator, incorrect node record : " << line);
+                    return false;
+                }
+                is >> power >> load;
+
+                node_seconds_per_byte_.push_back(secondsPerByte);
+                node_computing_power_indexes_.push_back(power);
+                node_loads_.push_back(load);
+            }
+            else if ( type == "job" )
+            {
+                size_t jobSize = 0;
+                if ( !(is >> jobSize) )
+                {
+                    GERROR_STREAM("gtPlusCloudSchedulerSimulator, incorrect job record : " << line);
+                    return false;
+                }
+
+                job_sizes_.push_back(jobSize);
+            }
+            else
+            {
+                GERROR_STREAM("gtPlusCloudSchedulerSimulator, unknown trace record : " << line);
+                return false;
+            }
+        }
+    }
+    catch (...)
+    {
+        GERROR_STREAM("Errors in gtPlusCloudSchedulerSimulator::loadTrace(const std::string& filename) ... ");
+        return false;
+    }
+
+    return true;
+}
+
+void gtPlusCloudSchedulerSimulator::setTrace(const std::vector<size_t>& jobSizes, const std::vector<double>& nodeSecondsPerByte, 
+                                const std::vector<double>& nodeComputingPowerIndexes, const std::vector<unsigned int>& nodeLoads)
+{
+    job_sizes_ = jobSizes;
+    node_seconds_per_byte_ = nodeSecondsPerByte;
+    node_computing_power_indexes_ = nodeComputingPowerIndexes;
+    node_loads_ = nodeLoads;
+
+    node_computing_power_indexes_.resize(node_seconds_per_byte_.size(), 1.0);
+    node_loads_.resize(node_seconds_per_byte_.size(), 0);
+}
+
+bool gtPlusCloudSchedulerSimulator::replay(gtPlusCloudScheduler& scheduler, bool useJobSizes, bool redispatch, double& makespan)
+{
+    try
+    {
+        size_t ii, jj;
+
+        makespan = 0;
+
+        size_t numOfNodes = node_seconds_per_byte_.size();
+        size_t numOfJobs = job_sizes_.size();
+        if ( numOfNodes==0 || numOfJobs==0 ) return true;
+
+        scheduler.setUpNodes(node_computing_power_indexes_);
+        scheduler.setNodeLoads(node_loads_);
+        if ( useJobSizes )
+        {
+            scheduler.setJobSizes(job_sizes_);
+        }
+        else
+        {
+            scheduler.setNumOfJobs(numOfJobs);
+        }
+
+        std::vector<int> nodeIDforJobs;
+        GADGET_CHECK_RETURN_FALSE(scheduler.schedulerJobs(nodeIDforJobs));
+        GADGET_CHECK_RETURN_FALSE(nodeIDforJobs.size()==numOfJobs);
+
+        double meanJobSize = 0;
+        for ( jj=0; jj<numOfJobs; jj++ ) meanJobSize += job_sizes_[jj];
+        meanJobSize /= numOfJobs;
+
+        // every node runs its jobs in order after the reconstructions already running
+        std::vector<double> nodeTime(numOfNodes);
+        for ( ii=0; ii<numOfNodes; ii++ )
+        {
+            nodeTime[ii] = node_loads_[ii] * meanJobSize * node_seconds_per_byte_[ii];
+        }
+
+        std::vector<double> jobFinish(numOfJobs);
+        for ( jj=0; jj<numOfJobs; jj++ )
+        {
+            int nodeID = nodeIDforJobs[jj];
+            GADGET_CHECK_RETURN_FALSE(nodeID>=0 && (size_t)nodeID<numOfNodes);
+
+            nodeTime[nodeID] += job_sizes_[jj]*node_seconds_per_byte_[nodeID];
+            jobFinish[jj] = nodeTime[nodeID];
+        }
+
+        if ( redispatch )
+        {
+            // take the idle nodes in time order; a node running out of jobs gets a copy of a straggler job
+            // the originals keep running, a job completes on whichever copy finishes first
+            std::vector<bool> nodeRetired(numOfNodes, false);
+            std::vector<bool> jobRedispatched(numOfJobs, false);
+            std::vector<bool> jobDone(numOfJobs);
+
+            while ( true )
+            {
+                int nodeID = -1;
+                for ( ii=0; ii<numOfNodes; ii++ )
+                {
+                    if ( !nodeRetired[ii] && (nodeID<0 || nodeTime[ii]<nodeTime[nodeID]) ) nodeID = (int)ii;
+                }
+                if ( nodeID < 0 ) break;
+
+                double now = nodeTime[nodeID];
+                for ( jj=0; jj<numOfJobs; jj++ )
+                {
+                    jobDone[jj] = jobRedispatched[jj] || (jobFinish[jj] <= now);
+                }
+
+                int jobID = scheduler.selectStragglerJob(nodeID, now, jobDone);
+                if ( jobID < 0 )
+                {
+                    nodeRetired[nodeID] = true;
+                    continue;
+                }
+
+                jobRedispatched[jobID] = true;
+                nodeTime[nodeID] += job_sizes_[jobID]*node_seconds_per_byte_[nodeID];
+                if ( nodeTime[nodeID] < jobFinish[jobID] ) jobFinish[jobID] = nodeTime[nodeID];
+            }
+        }
+
+        for ( jj=0; jj<numOfJobs; jj++ )
+        {
+            if ( jobFinish[jj] > makespan ) makespan = jobFinish[jj];
+
+            // the scheduler learns the job time measured on the node it was sent to
+            scheduler.updateNodeThroughput(nodeIDforJobs[jj], job_sizes_[jj], job_sizes_[jj]*node_seconds_per_byte_[nodeIDforJobs[jj]]);
+        }
+    }
+    catch (...)
+    {
+        GERROR_STREAM("Errors in gtPlusCloudSchedulerSimulator::replay(...) ... ");
+        return false;
+    }
+
+    return true;
+}
+
 }}
@@ -3,6 +3,10 @@
             A simple scheduling strategy is implemented here. The number of job packages which are sent
             to a node is propotional to the computing power index for that node.
 
+            If the job sizes are known, the jobs are scheduled longest-processing-time-first instead. Every job goes
+            to the node which is expected to complete it earliest, given the current load of the node and a running
+            estimate of its seconds per byte.
+
             This class may serve as the base class to implement more complicated job scheduling strategies.
 
     \author Hui Xue
@@ -34,11 +38,38 @@ public:
     // node ID starts from 0
     virtual bool schedulerJobs(std::vector<int>& nodeIDforJobs);
 
+    // all jobs have equal sizes
     void setNumOfJobs(size_t numOfJobs);
+    // job sizes in bytes, the jobs are scheduled longest-processing-time-first
+    void setJobSizes(const std::vector<size_t>& jobSizes);
 
+    // the throughput estimates are kept if the number of nodes does not change
     void setUpNodes(size_t numOfNodes);
     void setUpNodes(const std::vector<double>& nodeComputingPowerIndexes);
 
+    // number of reconstructions running on every node, e.g. as reported over the CloudBus
+    void setNodeLoads(const std::vector<unsigned int>& nodeLoads);
+
+    // a job of jobSize bytes took seconds on the node, update the running estimate of the node seconds per byte
+    void updateNodeThroughput(int nodeID, size_t jobSize, double seconds);
+
+    // estimated seconds per byte for a node
+    // nodes without measurements are scaled from the measured ones by the computing power indexes
+    // if no node is measured yet, this is 1/computing power index
+    double getNodeSecondsPerByte(int nodeID) const;
+
+    // true if the seconds per byte of at least one node is measured, so getNodeSecondsPerByte(...) is in seconds
+    bool hasNodeThroughput() const;
+
+    // expected completion time of every job for the last schedule, in seconds from the time the jobs are sent
+    const std::vector<double>& getJobExpectedFinishTimes() const { return job_expected_finish_; }
+
+    // a node has run out of jobs at time now (seconds from the time the jobs are sent)
+    // select the job of the last schedule which is expected to complete earliest if a copy runs on this node
+    // jobDone marks the jobs which are completed or already re-dispatched
+    // returns -1 if no job would complete earlier
+    virtual int selectStragglerJob(int idleNodeID, double now, const std::vector<bool>& jobDone) const;
+
 protected:
 
     // number of nodes
@@ -49,6 +80,65 @@ protected:
 
     // computing power indexes for every nodes; if not set, all nodes are treated to have equal computing powers
     std::vector<std::pair<int, double> > node_id_computing_power_indexes_;
+
+    // job sizes in bytes, empty if all jobs have equal sizes
+    std::vector<size_t> job_sizes_;
+
+    // number of reconstructions running on every node
+    std::vector<unsigned int> node_loads_;
+
+    // running estimate of seconds per byte for every node, 0 if not measured
+    std::vector<double> node_seconds_per_byte_;
+
+    // weight of a new measurement in the running estimate
+    double throughput_update_weight_;
+
+    // node and expected completion time of every job, for the last schedule
+    std::vector<int> node_id_for_jobs_;
+    std::vector<double> job_expected_finish_;
+
+    // computing power index of a node
+    double getNodeComputingPowerIndex(int nodeID) const;
+
+    // longest-processing-time-first scheduling of jobs with known sizes
+    bool schedulerJobsLPT(std::vector<int>& nodeIDforJobs);
+};
+
+/**
+Replay a job trace offline to compare scheduling policies.
+The scheduler sees the job sizes, the computing power indexes and the loads of the nodes, 
+the actual speed of every node is given by the trace.
+*/
+
+class EXPORTGTPLUS gtPlusCloudSchedulerSimulator
+{
+public:
+
+    gtPlusCloudSchedulerSimulator();
+    virtual ~gtPlusCloudSchedulerSimulator();
+
+    // a text file with one record per line
+    //  node <seconds per byte> <computing power index> <active reconstructions>
+    //  job <size in bytes>
+    // the node seconds per byte can be taken from a cloud run, e.g. from getNodeSecondsPerByte(...)
+    bool loadTrace(const std::string& filename);
+
+    void setTrace(const std::vector<size_t>& jobSizes, const std::vector<double>& nodeSecondsPerByte, 
+                const std::vector<double>& nodeComputingPowerIndexes, const std::vector<unsigned int>& nodeLoads);
+
+    // schedule the jobs of the trace and run them on the simulated nodes
+    // useJobSizes: if false, the scheduler only knows the number of jobs
+    // redispatch: a node running out of jobs runs a copy of the straggler job selected by the scheduler
+    // the job times are fed back into the scheduler, so repeated replays show how the throughput estimates converge
+    // makespan: time until all jobs are completed, in seconds
+    bool replay(gtPlusCloudScheduler& scheduler, bool useJobSizes, bool redispatch, double& makespan);
+
+protected:
+
+    std::vector<size_t> job_sizes_;
+    std::vector<double> node_seconds_per_byte_;
+    std::vector<double> node_computing_power_indexes_;
+    std::vector<unsigned int> node_loads_;
 };
 
 }}
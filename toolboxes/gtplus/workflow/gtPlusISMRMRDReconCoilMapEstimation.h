@@ -80,10 +80,11 @@ bool gtPlusISMRMRDReconCoilMapEstimation<T>::coilMap2DSPIRIT(const hoNDArray<T>&
 
         #pragma omp parallel default(none) private(ro, e1, scha, dcha) shared(RO, E1, CHA, pkIm, coilMap, eigD)
         {
-            hoMatrix<T> R(CHA, CHA), RC(CHA, CHA), RRT(CHA, CHA);
+            // one row of pixels is decomposed as a stack of small matrices
+            hoNDArray<T> R(CHA, CHA, RO), RRT(CHA, CHA, RO);
             Gadgetron::clear(RRT);
 
-            hoMatrix<value_type> eigenValue;
+            hoNDArray<value_type> eigenValue(CHA, RO);
 
             #pragma omp for 
             for ( e1=0; e1<E1; e1++ )
@@ -91,6 +92,7 @@ bool gtPlusISMRMRDReconCoilMapEstimation<T>::coilMap2DSPIRIT(const hoNDArray<T>&
                 for ( ro=0; ro<RO; ro++ )
                 {
                     const size_t offset = e1*RO + ro;
+                    T* pR = R.begin() + ro*CHA*CHA;
 
                     for ( dcha=0; dcha<CHA; dcha++ )
                     {
@@ -103,22 +105,27 @@ bool gtPlusISMRMRDReconCoilMapEstimation<T>::coilMap2DSPIRIT(const hoNDArray<T>&
                                 v -= 1;
                             }
 
-                            R(scha, dcha) = v;
+                            pR[scha + dcha*CHA] = v;
                         }
                     }
+                }
 
-                    memcpy(RC.begin(), R.begin(), sizeof(T)*CHA*CHA);
-                    Gadgetron::gemm(RRT, RC, false, R, true);
+                Gadgetron::gemm_batch(RRT, R, false, R, true);
 
-                    Gadgetron::heev(RRT, eigenValue);
+                Gadgetron::heev_batch(RRT, eigenValue);
+
+                for ( ro=0; ro<RO; ro++ )
+                {
+                    const T* pRRT = RRT.begin() + ro*CHA*CHA;
 
                     for ( scha=0; scha<CHA; scha++ )
                     {
-                        coilMap(ro, e1, scha, 0) = RRT(scha, 0);
-                        coilMap(ro, e1, scha, 1) = RRT(scha, 1);
-                        eigD(ro, e1, 0) = 1.0 - eigenValue(0, 0);
-                        eigD(ro, e1, 1) = 1.0 - eigenValue(1, 0);
+                        coilMap(ro, e1, scha, 0) = pRRT[scha];
+                        coilMap(ro, e1, scha, 1) = pRRT[scha + CHA];
                     }
+
+                    eigD(ro, e1, 0) = 1.0 - eigenValue(0, ro);
+                    eigD(ro, e1, 1) = 1.0 - eigenValue(1, ro);
                 }
             }
         }
@@ -762,48 +762,14 @@ postProcessing(hoNDArray<T>& res, bool process_gfactor, bool process_wrap_around
             }
             else
             {
-                hoNDArray<T>* pSrc = &res;
-                hoNDArray<T>* pDst = &dataCurr_;
+                // filters not matching the data size are passed empty and leave their dimension unfiltered
+                hoNDArray<T> noFilter;
+                const hoNDArray<T>& fRO = (workOrder_->filterRO_.get_number_of_elements() == RO) ? workOrder_->filterRO_ : noFilter;
+                const hoNDArray<T>& fE1 = (workOrder_->filterE1_.get_number_of_elements() == E1) ? workOrder_->filterE1_ : noFilter;
+                const hoNDArray<T>& fE2 = (workOrder_->filterE2_.get_number_of_elements() == E2) ? workOrder_->filterE2_ : noFilter;
 
-                Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->fft3c(*pDst, *pSrc);
-
-                bool filterPerformed = false;
-
-                if ( workOrder_->filterRO_.get_number_of_elements() == RO )
-                {
-                    // GADGET_CHECK_RETURN_FALSE(gtPlusISMRMRDReconUtil<T>().kspacefilterRO(*pSrc, workOrder_->filterRO_, *pDst));
-                    Gadgetron::apply_kspace_filter_RO(*pSrc, workOrder_->filterRO_, *pDst);
-                    std::swap(pSrc, pDst);
-                    filterPerformed = true;
-                }
-
-                if ( workOrder_->filterE1_.get_number_of_elements() == E1 )
-                {
-                    // GADGET_CHECK_RETURN_FALSE(gtPlusISMRMRDReconUtil<T>().kspacefilterE1(*pSrc, workOrder_->filterE1_, *pDst));
-                    Gadgetron::apply_kspace_filter_E1(*pSrc, workOrder_->filterE1_, *pDst);
-                    std::swap(pSrc, pDst);
-                    filterPerformed = true;
-                }
-
-                if ( workOrder_->filterE2_.get_number_of_elements() == E2 )
-                {
-                    // GADGET_CHECK_RETURN_FALSE(gtPlusISMRMRDReconUtil<T>().kspace3DfilterE2(*pSrc, workOrder_->filterE2_, *pDst));
-                    Gadgetron::apply_kspace_filter_E2(*pSrc, workOrder_->filterE2_, *pDst);
-                    std::swap(pSrc, pDst);
-                    filterPerformed = true;
-                }
-
-                if ( filterPerformed )
-                {
-                    if ( pDst != &dataCurr_ )
-                    {
-                        dataCurr_ = *pDst;
-                    }
-                }
-                else
-                {
-                    dataCurr_ = res;
-                }
+                Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->fft3c(dataCurr_, res);
+                Gadgetron::apply_kspace_filter_separable(res, fRO, fE1, fE2, dataCurr_);
 
                 inKSpace = true;
             }
@@ -679,6 +679,9 @@ public:
     typedef std::vector<CloudNodeType> CloudType;
 
     CloudType gt_cloud_;
+
+    // number of reconstructions running on every cloud node, empty if not known
+    std::vector<unsigned int> gt_cloud_load_;
 };
 
 template <typename T> 
@@ -910,6 +913,7 @@ void gtPlusReconWorkOrder<T>::duplicate(gtPlusReconWorkOrder<T>& worder) const
     worder.CloudComputing_              = CloudComputing_;
     worder.CloudSize_                   = CloudSize_;
     worder.gt_cloud_                    = gt_cloud_;
+    worder.gt_cloud_load_               = gt_cloud_load_;
 }
 
 template <typename T> 
@@ -244,6 +244,16 @@ public:
     size_t interleaved_whichS_combinationcoeff_;
     // number of modes kept for ref data
     int interleaved_ref_numOfModes_;
+
+    // if true and the worker supports it, the calibration and unwrapping are run as a task graph for every S,
+    // so the unwrapping of one S can start while the next S is still calibrating
+    bool pipeline_calib_unwrapping_;
+
+    // timing of the recon stages of the last reconstruction, in seconds
+    // the busy time is summed over all tasks of a stage, the wall time is from the first start to the last finish
+    std::vector<std::string> recon_stage_names_;
+    std::vector<double> recon_stage_busy_seconds_;
+    std::vector<double> recon_stage_wall_seconds_;
 };
 
 template <typename T> 
@@ -274,6 +284,8 @@ gtPlusReconWorkOrder2DT<T>::gtPlusReconWorkOrder2DT() : BaseClass()
     interleaved_same_combinationcoeff_allS_ = false;
     interleaved_whichS_combinationcoeff_ = false;
     interleaved_ref_numOfModes_ = 0;
+
+    pipeline_calib_unwrapping_ = true;
 }
 
 template <typename T> 
@@ -303,6 +315,10 @@ bool gtPlusReconWorkOrder2DT<T>::reset()
         recon_physio_time_stamp_second_.clear();
 
         gfactor_.clear();
+
+        recon_stage_names_.clear();
+        recon_stage_busy_seconds_.clear();
+        recon_stage_wall_seconds_.clear();
     }
     catch(...)
     {
@@ -360,6 +376,8 @@ void gtPlusReconWorkOrder2DT<T>::duplicate(gtPlusReconWorkOrder2DT<T>& worder)
     worder.interleaved_same_combinationcoeff_allS_ = interleaved_same_combinationcoeff_allS_;
     worder.interleaved_whichS_combinationcoeff_ = interleaved_whichS_combinationcoeff_;
     worder.interleaved_ref_numOfModes_ = interleaved_ref_numOfModes_;
+
+    worder.pipeline_calib_unwrapping_ = pipeline_calib_unwrapping_;
 }
 
 template <typename T> 
@@ -395,6 +413,12 @@ void gtPlusReconWorkOrder2DT<T>::printInfo(std::ostream& os) const
     GADGET_PARA_PRINT(interleaved_same_combinationcoeff_allS_);
     GADGET_PARA_PRINT(interleaved_whichS_combinationcoeff_);
     GADGET_PARA_PRINT(interleaved_ref_numOfModes_);
+    GDEBUG_STREAM("---------------------");
+    GADGET_PARA_PRINT(pipeline_calib_unwrapping_);
+    for ( size_t ii=0; ii<recon_stage_names_.size(); ii++ )
+    {
+        GDEBUG_STREAM("recon stage " << recon_stage_names_[ii] << " : busy " << recon_stage_busy_seconds_[ii] << " s, wall " << recon_stage_wall_seconds_[ii] << " s");
+    }
 }
 
 template <typename T> 
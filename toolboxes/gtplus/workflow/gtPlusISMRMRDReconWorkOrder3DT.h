@@ -196,6 +196,12 @@ public:
     // if true, the actual full kspace is computed, not only the coil combined complex images
     bool recon_kspace_needed_;
 
+    // memory budget in MBytes for the image domain kernel and images of one RO chunk, when the kspace is unwrapped
+    // if the kernel for all RO [RO E1 E2 srcCHA dstCHA] is larger, the kspace unwrapping is performed in chunks along RO
+    // if 0, the unwrapping is not split
+    // the budget only bounds the per chunk buffers; the RO ifft of the aliased kspace and fullkspace_ are still held in full size
+    size_t kernelIm_max_Megabytes_;
+
     // if true, no coil compression will be performed
     bool coil_compression_;
     // if true, the same coil compression coefficient is computed for all N
@@ -243,6 +249,7 @@ template <typename T>
 gtPlusReconWorkOrder3DT<T>::gtPlusReconWorkOrder3DT() : BaseClass()
 {
     recon_kspace_needed_ = false;
+    kernelIm_max_Megabytes_ = 0;
     coil_compression_ = true;
     same_coil_compression_coeff_allN_ = false;
 
@@ -322,6 +329,7 @@ void gtPlusReconWorkOrder3DT<T>::duplicate(gtPlusReconWorkOrder3DT<T>& worder)
     BaseClass::duplicate(worder);
 
     worder.recon_kspace_needed_ = recon_kspace_needed_;
+    worder.kernelIm_max_Megabytes_ = kernelIm_max_Megabytes_;
     worder.coil_compression_ = coil_compression_;
     worder.same_coil_compression_coeff_allN_ = same_coil_compression_coeff_allN_;
 
@@ -348,6 +356,7 @@ void gtPlusReconWorkOrder3DT<T>::printInfo(std::ostream& os) const
     BaseClass::printInfo(os);
 
     GADGET_PARA_PRINT(recon_kspace_needed_);
+    GADGET_PARA_PRINT(kernelIm_max_Megabytes_);
     GDEBUG_STREAM("---------------------");
     GADGET_PARA_PRINT(coil_compression_);
     GADGET_PARA_PRINT(same_coil_compression_coeff_allN_);
@@ -283,6 +283,9 @@ public:
     gtPlusISMRMRDReconUtil<T> gtPlus_util_;
     gtPlusISMRMRDReconUtilComplex<T> gtPlus_util_cplx_;
 
+    // cloud scheduler, kept between recons to reuse the measured seconds per byte of every node
+    gtPlusCloudScheduler cloud_scheduler_;
+
     // ----------------------------------------------------
     // recon job splitter and combiner
     // ----------------------------------------------------
@@ -308,6 +311,9 @@ public:
 
     // given the number of nodes in a cloud and corresponding computing power indexes, spread the jobs on the nodes
     virtual bool scheduleJobForNodes(gtPlusReconWorkOrder<T>* workOrder2DT, size_t numOfJobs, std::vector<int>& nodeIdForJob);
+
+    // given the job sizes in bytes, spread the jobs on the nodes using the node loads and the measured node throughput
+    virtual bool scheduleJobForNodes(gtPlusReconWorkOrder<T>* workOrder, const std::vector<size_t>& jobSizes, std::vector<int>& nodeIdForJob);
 };
 
 template <typename T> 
@@ -612,4 +618,33 @@ scheduleJobForNodes(gtPlusReconWorkOrder<T>* workOrder, size_t numOfJobs, std::v
     return true;
 }
 
+template <typename T> 
+bool gtPlusReconWorker<T>::
+scheduleJobForNodes(gtPlusReconWorkOrder<T>* workOrder, const std::vector<size_t>& jobSizes, std::vector<int>& nodeIdForJob)
+{
+    try
+    {
+        size_t numOfNodes = workOrder->gt_cloud_.size();
+
+        std::vector<double> powerIndexes(numOfNodes);
+        for ( size_t ii=0; ii<numOfNodes; ii++ )
+        {
+            powerIndexes[ii] = workOrder->gt_cloud_[ii].template get<3>();
+        }
+
+        cloud_scheduler_.setUpNodes(powerIndexes);
+        cloud_scheduler_.setNodeLoads(workOrder->gt_cloud_load_);
+        cloud_scheduler_.setJobSizes(jobSizes);
+
+        GADGET_CHECK_RETURN_FALSE(cloud_scheduler_.schedulerJobs(nodeIdForJob));
+    }
+    catch(...)
+    {
+        GERROR_STREAM("Errors in gtPlusReconWorker<T>::scheduleJobForNodes(gtPlusReconWorkOrder<T>* workOrder, const std::vector<size_t>& jobSizes, std::vector<int>& nodeIdForJob) ... ");
+        return false;
+    }
+
+    return true;
+}
+
 }}
@@ -30,6 +30,8 @@
 #pragma once
 
 #include "gtPlusISMRMRDReconWorker.h"
+#include "gtPlusTaskGraph.h"
+#include <boost/bind.hpp>
 
 #include "mri_core_kspace_filter.h"
 
@@ -88,6 +90,18 @@ public:
 
     virtual bool performUnwrapping(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& data);
 
+    // to overlap the calibration and unwrapping, the unwrapping is split into a preparation for all S
+    // and an unwrapping for every S, which may run concurrently with the calibration or unwrapping of other S
+    // buffer is owned by the calling thread
+    virtual bool supportPipelinedUnwrapping() const { return false; }
+    virtual bool performUnwrappingPrep(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& data);
+    virtual bool performUnwrappingImpl(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& data, size_t usedS, hoNDArray<T>& buffer);
+
+    // add the calibration and unwrapping tasks of every S to the recon task graph, after the coil map task
+    // the unwrapping of a S starts once its calibration is done
+    virtual bool addCalibUnwrappingTasks(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& ref_src, const hoNDArray<T>& ref_dst, const hoNDArray<T>& data, 
+                                        size_t coilMapTask, std::vector<size_t>& unwrappingTasks, size_t& numOfThreads);
+
     // the partial fourier handling for the 2DT reconstruction
     // the computation is performed on the reconstructed full kspace
     virtual bool performPartialFourierHandling(gtPlusReconWorkOrder2DT<T>* workOrder2DT);
@@ -177,9 +191,22 @@ public:
 
 protected:
 
+    // whether the same combination coefficients are used for all S and which S is used to compute them
+    void getCombinationCoeffS(gtPlusReconWorkOrder2DT<T>* workOrder2DT, bool& same_combinationcoeff_allS, size_t& whichS_combinationcoeff);
+
+    // whether the kernel needs to be calibrated, or has been preset
+    bool isCalibNeeded(gtPlusReconWorkOrder2DT<T>* workOrder2DT, size_t srcCHA, size_t dstCHA);
+
+    // unwrap one S in the task graph, using the buffer of the current thread
+    bool performUnwrappingTask(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& data, size_t usedS);
+
+    // the coil map estimation, calibration, unwrapping and after-unwrapping steps of performRecon
+    gtPlusTaskGraph recon_task_graph_;
+
     // helper memory for computation
     hoNDArray<T> buffer2DT_;
     hoNDArray<T> buffer2DT_unwrapping_;
+    std::vector< hoNDArray<T> > buffer2DT_unwrapping_thread_;
     hoNDArray<T> buffer2DT_partial_fourier_;
     hoNDArray<T> buffer2DT_partial_fourier_kspaceIter_;
     hoNDArray<T> ref_src_;
@@ -900,23 +927,91 @@ bool gtPlusReconWorker2DT<T>::performRecon(gtPlusReconWorkOrder2DT<T>* workOrder
                 data_dst_ = workOrder2DT->data_;
                 ref_coil_map_dst_ = workOrder2DT->ref_coil_map_;
             }
+        }
 
-            if ( performTiming_ ) { gt_timer1_.start("estimateCoilMap"); }
-            GADGET_CHECK_RETURN_FALSE(this->estimateCoilMap(workOrder2DT, ref_src_, ref_dst_, ref_coil_map_dst_));
-            if ( performTiming_ ) { gt_timer1_.stop(); }
+        // the remaining steps run as a task graph
+        // if pipelined, the calibration and unwrapping of different S overlap
+        // otherwise, the steps run one after another and use all cores themselves
+        recon_task_graph_.clear();
 
-            if ( performTiming_ ) { gt_timer1_.start("performCalib"); }
-            GADGET_CHECK_RETURN_FALSE(this->performCalib(workOrder2DT, ref_src_, ref_dst_, ref_coil_map_dst_));
-            if ( performTiming_ ) { gt_timer1_.stop(); }
+        std::vector<size_t> unwrappingTasks;
+        size_t numOfThreads = 1;
+        bool pipelined = false;
+
+        if ( workOrder2DT->workFlow_use_BufferedKernel_ )
+        {
+            unwrappingTasks.push_back(recon_task_graph_.addTask("performUnwrapping", 
+                boost::bind(&gtPlusReconWorker2DT<T>::performUnwrapping, this, workOrder2DT, boost::cref(data_dst_))));
         }
+        else
+        {
+            size_t coilMapTask = recon_task_graph_.addTask("estimateCoilMap", 
+                boost::bind(&gtPlusReconWorker2DT<T>::estimateCoilMap, this, workOrder2DT, boost::cref(ref_src_), boost::cref(ref_dst_), boost::cref(ref_coil_map_dst_)));
 
-        if ( performTiming_ ) { gt_timer1_.start("performUnwrapping"); }
-        GADGET_CHECK_RETURN_FALSE(this->performUnwrapping(workOrder2DT, data_dst_));
-        if ( performTiming_ ) { gt_timer1_.stop(); }
+            size_t S = workOrder2DT->data_.get_size(4);
 
-        if ( performTiming_ ) { gt_timer1_.start("afterUnwrapping"); }
-        GADGET_CHECK_RETURN_FALSE(this->afterUnwrapping(workOrder2DT));
-        if ( performTiming_ ) { gt_timer1_.stop(); }
+            bool same_combinationcoeff_allS = false;
+            size_t whichS_combinationcoeff = 0;
+            this->getCombinationCoeffS(workOrder2DT, same_combinationcoeff_allS, whichS_combinationcoeff);
+
+            pipelined = workOrder2DT->pipeline_calib_unwrapping_ 
+                        && this->supportPipelinedUnwrapping() 
+                        && (S > 1) 
+                        && !same_combinationcoeff_allS 
+                        && this->isCalibNeeded(workOrder2DT, ref_src_.get_size(2), ref_coil_map_dst_.get_size(2));
+
+            if ( pipelined )
+            {
+                GADGET_CHECK_RETURN_FALSE(this->addCalibUnwrappingTasks(workOrder2DT, ref_src_, ref_dst_, data_dst_, coilMapTask, unwrappingTasks, numOfThreads));
+            }
+            else
+            {
+                size_t calibTask = recon_task_graph_.addTask("performCalib", 
+                    boost::bind(&gtPlusReconWorker2DT<T>::performCalib, this, workOrder2DT, boost::cref(ref_src_), boost::cref(ref_dst_), boost::cref(ref_coil_map_dst_)));
+                recon_task_graph_.addDependency(calibTask, coilMapTask);
+
+                size_t unwrappingTask = recon_task_graph_.addTask("performUnwrapping", 
+                    boost::bind(&gtPlusReconWorker2DT<T>::performUnwrapping, this, workOrder2DT, boost::cref(data_dst_)));
+                recon_task_graph_.addDependency(unwrappingTask, calibTask);
+
+                unwrappingTasks.push_back(unwrappingTask);
+            }
+        }
+
+        size_t afterUnwrappingTask = recon_task_graph_.addTask("afterUnwrapping", 
+            boost::bind(&gtPlusReconWorker2DT<T>::afterUnwrapping, this, workOrder2DT));
+        for ( size_t ii=0; ii<unwrappingTasks.size(); ii++ )
+        {
+            recon_task_graph_.addDependency(afterUnwrappingTask, unwrappingTasks[ii]);
+        }
+
+        // the timers are not shared between concurrent tasks
+        bool performTiming = performTiming_;
+        if ( pipelined ) performTiming_ = false;
+
+        // the tasks may use the cores left over by the team
+        bool nested = false;
+        #ifdef USE_OMP
+            if ( pipelined && ((int)numOfThreads < omp_get_num_procs()/2) )
+            {
+                nested = true;
+                GDEBUG_STREAM("performRecon, nested omp is on for the task threads ... ");
+            }
+        #endif // USE_OMP
+
+        bool succeeded = recon_task_graph_.run(numOfThreads, nested);
+
+        performTiming_ = performTiming;
+
+        recon_task_graph_.getStageTiming(workOrder2DT->recon_stage_names_, workOrder2DT->recon_stage_busy_seconds_, workOrder2DT->recon_stage_wall_seconds_);
+        if ( performTiming_ )
+        {
+            std::ostringstream ostr;
+            recon_task_graph_.printInfo(ostr);
+            GDEBUG_STREAM(ostr.str());
+        }
+
+        GADGET_CHECK_RETURN_FALSE(succeeded);
     }
     catch(...)
     {
@@ -947,25 +1042,7 @@ estimateCoilMap(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& re
 
         bool same_combinationcoeff_allS = false;
         size_t whichS_combinationcoeff = 0;
-        if ( workOrder2DT->CalibMode_ == ISMRMRD_interleaved )
-        {
-            same_combinationcoeff_allS = workOrder2DT->interleaved_same_combinationcoeff_allS_;
-            whichS_combinationcoeff = workOrder2DT->interleaved_whichS_combinationcoeff_;
-        }
-
-        if ( workOrder2DT->CalibMode_ == ISMRMRD_embedded )
-        {
-            same_combinationcoeff_allS = workOrder2DT->embedded_same_combinationcoeff_allS_;
-            whichS_combinationcoeff = workOrder2DT->embedded_whichS_combinationcoeff_;
-        }
-
-        if ( workOrder2DT->CalibMode_ == ISMRMRD_separate )
-        {
-            same_combinationcoeff_allS = workOrder2DT->separate_same_combinationcoeff_allS_;
-            whichS_combinationcoeff = workOrder2DT->separate_whichS_combinationcoeff_;
-        }
-
-        if ( whichS_combinationcoeff >= S ) whichS_combinationcoeff=S-1;
+        this->getCombinationCoeffS(workOrder2DT, same_combinationcoeff_allS, whichS_combinationcoeff);
 
         // if the coil map has not been preset
         if ( (workOrder2DT->coilMap_->get_size(0)!=RO) 
@@ -1029,32 +1106,10 @@ performCalib(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& ref_s
 
         bool same_combinationcoeff_allS = false;
         size_t whichS_combinationcoeff = 0;
-        if ( workOrder2DT->CalibMode_ == ISMRMRD_interleaved )
-        {
-            same_combinationcoeff_allS = workOrder2DT->interleaved_same_combinationcoeff_allS_;
-            whichS_combinationcoeff = workOrder2DT->interleaved_whichS_combinationcoeff_;
-        }
-
-        if ( workOrder2DT->CalibMode_ == ISMRMRD_embedded )
-        {
-            same_combinationcoeff_allS = workOrder2DT->embedded_same_combinationcoeff_allS_;
-            whichS_combinationcoeff = workOrder2DT->embedded_whichS_combinationcoeff_;
-        }
-
-        if ( workOrder2DT->CalibMode_ == ISMRMRD_separate )
-        {
-            same_combinationcoeff_allS = workOrder2DT->separate_same_combinationcoeff_allS_;
-            whichS_combinationcoeff = workOrder2DT->separate_whichS_combinationcoeff_;
-        }
-
-        if ( whichS_combinationcoeff >= S ) whichS_combinationcoeff=S-1;
+        this->getCombinationCoeffS(workOrder2DT, same_combinationcoeff_allS, whichS_combinationcoeff);
 
         // calibration
-        if ( (workOrder2DT->kernelIm_->get_size(0)!=RO) 
-                || (workOrder2DT->kernelIm_->get_size(1)!=E1)
-                || (workOrder2DT->kernelIm_->get_size(2)!=srcCHA)
-                || (workOrder2DT->kernelIm_->get_size(3)!=dstCHA)
-                || (workOrder2DT->kernelIm_->get_size(5)!=S) )
+        if ( this->isCalibNeeded(workOrder2DT, srcCHA, dstCHA) )
         {
             GADGET_CHECK_RETURN_FALSE(this->performCalibPrep(ref_src, ref_dst, workOrder2DT));
 
@@ -1124,6 +1179,130 @@ performCalib(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& ref_s
     return true;
 }
 
+template <typename T> 
+void gtPlusReconWorker2DT<T>::
+getCombinationCoeffS(gtPlusReconWorkOrder2DT<T>* workOrder2DT, bool& same_combinationcoeff_allS, size_t& whichS_combinationcoeff)
+{
+    size_t S = workOrder2DT->data_.get_size(4);
+
+    same_combinationcoeff_allS = false;
+    whichS_combinationcoeff = 0;
+    if ( workOrder2DT->CalibMode_ == ISMRMRD_interleaved )
+    {
+        same_combinationcoeff_allS = workOrder2DT->interleaved_same_combinationcoeff_allS_;
+        whichS_combinationcoeff = workOrder2DT->interleaved_whichS_combinationcoeff_;
+    }
+
+    if ( workOrder2DT->CalibMode_ == ISMRMRD_embedded )
+    {
+        same_combinationcoeff_allS = workOrder2DT->embedded_same_combinationcoeff_allS_;
+        whichS_combinationcoeff = workOrder2DT->embedded_whichS_combinationcoeff_;
+    }
+
+    if ( workOrder2DT->CalibMode_ == ISMRMRD_separate )
+    {
+        same_combinationcoeff_allS = workOrder2DT->separate_same_combinationcoeff_allS_;
+        whichS_combinationcoeff = workOrder2DT->separate_whichS_combinationcoeff_;
+    }
+
+    if ( whichS_combinationcoeff >= S ) whichS_combinationcoeff=S-1;
+}
+
+template <typename T> 
+bool gtPlusReconWorker2DT<T>::
+isCalibNeeded(gtPlusReconWorkOrder2DT<T>* workOrder2DT, size_t srcCHA, size_t dstCHA)
+{
+    size_t RO = workOrder2DT->data_.get_size(0);
+    size_t E1 = workOrder2DT->data_.get_size(1);
+    size_t S = workOrder2DT->data_.get_size(4);
+
+    return ( (workOrder2DT->kernelIm_->get_size(0)!=RO) 
+                || (workOrder2DT->kernelIm_->get_size(1)!=E1)
+                || (workOrder2DT->kernelIm_->get_size(2)!=srcCHA)
+                || (workOrder2DT->kernelIm_->get_size(3)!=dstCHA)
+                || (workOrder2DT->kernelIm_->get_size(5)!=S) );
+}
+
+template <typename T> 
+bool gtPlusReconWorker2DT<T>::
+addCalibUnwrappingTasks(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& ref_src, const hoNDArray<T>& ref_dst, const hoNDArray<T>& data, 
+                        size_t coilMapTask, std::vector<size_t>& unwrappingTasks, size_t& numOfThreads)
+{
+    try
+    {
+        size_t S = workOrder2DT->data_.get_size(4);
+        size_t refN = ref_dst.get_size(3);
+
+        typedef gtPlusReconWorker2DT<T> Self;
+
+        // the kernel arrays are allocated once for all S
+        size_t calibPrepTask = recon_task_graph_.addTask("performCalibPrep", 
+            boost::bind(&Self::performCalibPrep, this, boost::cref(ref_src), boost::cref(ref_dst), workOrder2DT));
+        recon_task_graph_.addDependency(calibPrepTask, coilMapTask);
+
+        // the coil map estimation and the unwrapping preparation share buffer2DT_
+        size_t unwrappingPrepTask = recon_task_graph_.addTask("performUnwrappingPrep", 
+            boost::bind(&Self::performUnwrappingPrep, this, workOrder2DT, boost::cref(data)));
+        recon_task_graph_.addDependency(unwrappingPrepTask, calibPrepTask);
+
+        // among the ready tasks, the earlier added ones run first
+        // so the unwrapping of a S is preferred over the calibration of the later S
+        unwrappingTasks.clear();
+
+        size_t usedS, n;
+        for ( usedS=0; usedS<S; usedS++ )
+        {
+            std::vector<size_t> calibTasks(refN);
+            for ( n=0; n<refN; n++ )
+            {
+                calibTasks[n] = recon_task_graph_.addTask("performCalibImpl", 
+                    boost::bind(&Self::performCalibImpl, this, boost::cref(ref_src), boost::cref(ref_dst), workOrder2DT, n, usedS));
+                recon_task_graph_.addDependency(calibTasks[n], calibPrepTask);
+            }
+
+            size_t unwrappingTask = recon_task_graph_.addTask("performUnwrappingImpl", 
+                boost::bind(&Self::performUnwrappingTask, this, workOrder2DT, boost::cref(data), usedS));
+            recon_task_graph_.addDependency(unwrappingTask, unwrappingPrepTask);
+            for ( n=0; n<refN; n++ )
+            {
+                recon_task_graph_.addDependency(unwrappingTask, calibTasks[n]);
+            }
+
+            unwrappingTasks.push_back(unwrappingTask);
+        }
+
+        numOfThreads = 1;
+        #ifdef USE_OMP
+            numOfThreads = (size_t)omp_get_num_procs();
+        #endif // USE_OMP
+
+        if ( numOfThreads > S*refN+1 ) numOfThreads = S*refN+1;
+
+        // the unwrapping buffers are only allocated by the threads which need them
+        buffer2DT_unwrapping_thread_.resize(numOfThreads);
+    }
+    catch(...)
+    {
+        GERROR_STREAM("Errors in gtPlusReconWorker2DT<T>::addCalibUnwrappingTasks(...) ... ");
+        return false;
+    }
+
+    return true;
+}
+
+template <typename T> 
+bool gtPlusReconWorker2DT<T>::
+performUnwrappingTask(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& data, size_t usedS)
+{
+    size_t thread = 0;
+    #ifdef USE_OMP
+        thread = (size_t)omp_get_thread_num();
+    #endif // USE_OMP
+
+    GADGET_CHECK_RETURN_FALSE(thread<buffer2DT_unwrapping_thread_.size());
+    return this->performUnwrappingImpl(workOrder2DT, data, usedS, buffer2DT_unwrapping_thread_[thread]);
+}
+
 template <typename T> 
 bool gtPlusReconWorker2DT<T>::
 performCalibPrep(const hoNDArray<T>& , const hoNDArray<T>& , gtPlusReconWorkOrder2DT<T>* /*workOrder2DT*/)
@@ -1144,6 +1323,18 @@ bool gtPlusReconWorker2DT<T>::performUnwrapping(gtPlusReconWorkOrder2DT<T>* , co
     return true;
 }
 
+template <typename T> 
+bool gtPlusReconWorker2DT<T>::performUnwrappingPrep(gtPlusReconWorkOrder2DT<T>* , const hoNDArray<T>& )
+{
+    return true;
+}
+
+template <typename T> 
+bool gtPlusReconWorker2DT<T>::performUnwrappingImpl(gtPlusReconWorkOrder2DT<T>* , const hoNDArray<T>& , size_t , hoNDArray<T>& )
+{
+    return true;
+}
+
 template <typename T> 
 bool gtPlusReconWorker2DT<T>::unmixCoeff(const hoNDArray<T>& kerIm, const hoNDArray<T>& coilMap, hoNDArray<T>& unmixCoeff, hoNDArray<T>& gFactor)
 {
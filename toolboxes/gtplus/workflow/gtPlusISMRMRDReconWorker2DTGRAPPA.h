@@ -30,6 +30,14 @@ public:
 
     virtual bool performUnwrapping(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& data);
 
+    // the unwrapping of every S only depends on the kernel of that S
+    virtual bool supportPipelinedUnwrapping() const { return true; }
+    virtual bool performUnwrappingPrep(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& data);
+    virtual bool performUnwrappingImpl(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& data, size_t usedS, hoNDArray<T>& buffer);
+
+    // whether the full kspace is reconstructed, otherwise only the coil combined images
+    bool isReconKSpaceNeeded(gtPlusReconWorkOrder2DT<T>* workOrder2DT);
+
     using BaseClass::gt_timer1_;
     using BaseClass::gt_timer2_;
     using BaseClass::gt_timer3_;
@@ -89,6 +97,30 @@ performCalibPrep(const hoNDArray<T>& ref_src, const hoNDArray<T>& ref_dst, gtPlu
         {
             workOrder2DT->wrap_around_map_.create(RO, E1, 2, refN, S);
         }
+
+        // the kernels of all N and S are calibrated together, performCalibImpl then computes the image domain kernel and unmixing coefficients
+        bool same_combinationcoeff_allS = false;
+        size_t whichS_combinationcoeff = 0;
+        this->getCombinationCoeffS(workOrder2DT, same_combinationcoeff_allS, whichS_combinationcoeff);
+
+        size_t startS = 0;
+        size_t numS = S;
+        if ( same_combinationcoeff_allS )
+        {
+            startS = whichS_combinationcoeff;
+            numS = 1;
+        }
+
+        hoNDArray<T> acsSrc(refRO, refE1, srcCHA, refN*numS, const_cast<T*>(ref_src.begin()+startS*refRO*refE1*srcCHA*refN));
+        hoNDArray<T> acsDst(refRO, refE1, dstCHA, refN*numS, const_cast<T*>(ref_dst.begin()+startS*refRO*refE1*dstCHA*refN));
+        hoNDArray<T> convKer(convkRO, convkE1, srcCHA, dstCHA, refN*numS, workOrder2DT->kernel_->begin()+startS*convkRO*convkE1*srcCHA*dstCHA*refN);
+
+        Gadgetron::GadgetronTimer gt_timer_local;
+        gt_timer_local.set_timing_in_destruction(false);
+
+        if ( performTiming_ ) { gt_timer_local.start("grappa2d_calib_convolution_kernel_batch ... "); }
+        Gadgetron::grappa2d_calib_convolution_kernel_batch(acsSrc, acsDst, (size_t)workOrder2DT->acceFactorE1_, workOrder2DT->grappa_reg_lamda_, kRO, kNE1, convKer);
+        if ( performTiming_ ) { gt_timer_local.stop(); }
     }
     catch(...)
     {
@@ -141,10 +173,7 @@ performCalibImpl(const hoNDArray<T>& ref_src, const hoNDArray<T>& ref_dst, gtPlu
         Gadgetron::GadgetronTimer gt_timer_local;
         gt_timer_local.set_timing_in_destruction(false);
 
-        if ( performTiming_ ) { gt_timer_local.start("grappa2d_calib_convolution_kernel ... "); }
-        Gadgetron::grappa2d_calib_convolution_kernel(acsSrc, acsDst, (size_t)workOrder2DT->acceFactorE1_, workOrder2DT->grappa_reg_lamda_, kRO, kNE1, convKer);
-        if ( performTiming_ ) { gt_timer_local.stop(); }
-
+        // the kernel was calibrated in performCalibPrep
         filename = "convKer";
         if (!debugFolder_.empty()) { gt_exporter_.exportArrayComplex(convKer, debugFolder_ + filename + suffix); }
 
@@ -206,18 +235,66 @@ performUnwrapping(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>&
 {
     try
     {
-        int n;
+        size_t S = workOrder2DT->data_.get_size(4);
+
+        GADGET_CHECK_RETURN_FALSE(this->performUnwrappingPrep(workOrder2DT, data_dst));
+
+        size_t usedS;
+        for ( usedS=0; usedS<S; usedS++ )
+        {
+            GADGET_CHECK_RETURN_FALSE(this->performUnwrappingImpl(workOrder2DT, data_dst, usedS, buffer2DT_unwrapping_));
+        }
+    }
+    catch(...)
+    {
+        GERROR_STREAM("Errors in gtPlusReconWorker2DTGRAPPA<T>::performUnwrapping(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& data) ... ");
+        return false;
+    }
+
+    return true;
+}
+
+template <typename T> 
+bool gtPlusReconWorker2DTGRAPPA<T>::
+isReconKSpaceNeeded(gtPlusReconWorkOrder2DT<T>* workOrder2DT)
+{
+    bool recon_kspace = false;
+
+    if ( workOrder2DT->CalibMode_ == ISMRMRD_embedded )
+    {
+        if ( workOrder2DT->embedded_fullres_coilmap_ || workOrder2DT->embedded_ref_fillback_ )
+        {
+            recon_kspace = true;
+        }
+    }
+
+    if ( workOrder2DT->CalibMode_ == ISMRMRD_separate )
+    {
+        if ( workOrder2DT->separate_fullres_coilmap_ )
+        {
+            recon_kspace = true;
+        }
+    }
 
+    if ( workOrder2DT->recon_kspace_needed_ )
+    {
+        recon_kspace = true;
+    }
+
+    return recon_kspace;
+}
+
+template <typename T> 
+bool gtPlusReconWorker2DTGRAPPA<T>::
+performUnwrappingPrep(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& data_dst)
+{
+    try
+    {
         size_t RO = workOrder2DT->data_.get_size(0);
         size_t E1 = workOrder2DT->data_.get_size(1);
         size_t N = workOrder2DT->data_.get_size(3);
         size_t S = workOrder2DT->data_.get_size(4);
 
-        size_t srcCHA = workOrder2DT->kernelIm_->get_size(2);
-        size_t dstCHA = workOrder2DT->kernelIm_->get_size(3);
-
-        size_t refN = workOrder2DT->kernelIm_->get_size(4);
-
         workOrder2DT->complexIm_.create(RO, E1, N, S);
 
         if ( workOrder2DT->downstream_coil_compression_ )
@@ -261,162 +338,168 @@ performUnwrapping(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>&
 
         if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(buffer2DT_, debugFolder_+"buffer2DT_"); }
 
-        bool recon_kspace = false;
-
-        if ( workOrder2DT->CalibMode_ == ISMRMRD_embedded )
+        // the unwrapping of every S fills its part of the full kspace
+        if ( this->isReconKSpaceNeeded(workOrder2DT) )
         {
-            if ( workOrder2DT->embedded_fullres_coilmap_ || workOrder2DT->embedded_ref_fillback_ )
-            {
-                recon_kspace = true;
-            }
+            workOrder2DT->fullkspace_ = data_dst;
         }
-
-        if ( workOrder2DT->CalibMode_ == ISMRMRD_separate )
+        else
         {
-            if ( workOrder2DT->separate_fullres_coilmap_ )
-            {
-                recon_kspace = true;
-            }
+            workOrder2DT->fullkspace_.create(RO, E1, 1, N, S);
         }
+    }
+    catch(...)
+    {
+        GERROR_STREAM("Errors in gtPlusReconWorker2DTGRAPPA<T>::performUnwrappingPrep(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& data) ... ");
+        return false;
+    }
 
-        if ( workOrder2DT->recon_kspace_needed_ )
-        {
-            recon_kspace = true;
-        }
+    return true;
+}
 
-        // if kspace is actually needed
-        if ( recon_kspace )
-        {
-            workOrder2DT->fullkspace_ = data_dst;
+template <typename T> 
+bool gtPlusReconWorker2DTGRAPPA<T>::
+performUnwrappingImpl(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& /*data_dst*/, size_t usedS, hoNDArray<T>& buffer)
+{
+    try
+    {
+        int n;
+
+        size_t RO = workOrder2DT->data_.get_size(0);
+        size_t E1 = workOrder2DT->data_.get_size(1);
+        size_t N = workOrder2DT->data_.get_size(3);
 
-            buffer2DT_unwrapping_.create(RO, E1, srcCHA, dstCHA);
+        size_t srcCHA = workOrder2DT->kernelIm_->get_size(2);
+        size_t dstCHA = workOrder2DT->kernelIm_->get_size(3);
 
-            size_t usedS;
-            for ( usedS=0; usedS<S; usedS++ )
+        size_t refN = workOrder2DT->kernelIm_->get_size(4);
+
+        // if kspace is actually needed
+        if ( this->isReconKSpaceNeeded(workOrder2DT) )
+        {
+            if ( (refN<N) || (refN==1) )
             {
-                if ( (refN<N) || (refN==1) )
+                if ( buffer.get_number_of_elements() != RO*E1*srcCHA*dstCHA )
                 {
-                    hoNDArray<T> kIm(RO, E1, srcCHA, dstCHA, workOrder2DT->kernelIm_->begin()+usedS*RO*E1*srcCHA*dstCHA*refN);
-                    hoNDArray<T> aliasedIm(RO, E1, srcCHA, N, buffer2DT_.begin()+usedS*RO*E1*srcCHA*N);
-                    hoNDArray<T> unwarppedIm(RO, E1, dstCHA, N, workOrder2DT->fullkspace_.begin()+usedS*RO*E1*dstCHA*N);
+                    buffer.create(RO, E1, srcCHA, dstCHA);
+                }
+
+                hoNDArray<T> kIm(RO, E1, srcCHA, dstCHA, workOrder2DT->kernelIm_->begin()+usedS*RO*E1*srcCHA*dstCHA*refN);
+                hoNDArray<T> aliasedIm(RO, E1, srcCHA, N, buffer2DT_.begin()+usedS*RO*E1*srcCHA*N);
+                hoNDArray<T> unwarppedIm(RO, E1, dstCHA, N, workOrder2DT->fullkspace_.begin()+usedS*RO*E1*dstCHA*N);
 
-                    this->applyImageDomainKernelImage(aliasedIm, kIm, buffer2DT_unwrapping_, unwarppedIm);
+                this->applyImageDomainKernelImage(aliasedIm, kIm, buffer, unwarppedIm);
 
-                    if ( !debugFolder_.empty() )
+                if ( !debugFolder_.empty() )
+                {
                     {
-                        {
-                            std::ostringstream ostr;
-                            ostr << "kIm_" << usedS;
-                            if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(kIm, debugFolder_+ostr.str()); }
-                        }
-
-                        {
-                            std::ostringstream ostr;
-                            ostr << "aliasedIm_" << usedS;
-                            if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(aliasedIm, debugFolder_+ostr.str()); }
-                        }
+                        std::ostringstream ostr;
+                        ostr << "kIm_" << usedS;
+                        if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(kIm, debugFolder_+ostr.str()); }
+                    }
 
+                    {
                         std::ostringstream ostr;
-                        ostr << "unwarppedIm_" << usedS;
-                        if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(unwarppedIm, debugFolder_+ostr.str()); }
+                        ostr << "aliasedIm_" << usedS;
+                        if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(aliasedIm, debugFolder_+ostr.str()); }
                     }
+
+                    std::ostringstream ostr;
+                    ostr << "unwarppedIm_" << usedS;
+                    if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(unwarppedIm, debugFolder_+ostr.str()); }
                 }
-                else
+            }
+            else
+            {
+                #pragma omp parallel private(n)
                 {
-                    #pragma omp parallel private(n)
-                    {
-                        hoNDArray<T> complexIm(RO, E1, dstCHA);
+                    hoNDArray<T> complexIm(RO, E1, dstCHA);
 
-                        #pragma omp for
-                        for ( n=0; n<(int)N; n++ )
-                        {
-                            hoNDArray<T> kIm(RO, E1, srcCHA, dstCHA, workOrder2DT->kernelIm_->begin()+n*RO*E1*srcCHA*dstCHA+usedS*RO*E1*srcCHA*dstCHA*refN);
+                    #pragma omp for
+                    for ( n=0; n<(int)N; n++ )
+                    {
+                        hoNDArray<T> kIm(RO, E1, srcCHA, dstCHA, workOrder2DT->kernelIm_->begin()+n*RO*E1*srcCHA*dstCHA+usedS*RO*E1*srcCHA*dstCHA*refN);
 
-                            if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(kIm, debugFolder_+"kIm_n"); }
+                        if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(kIm, debugFolder_+"kIm_n"); }
 
-                            T* pIm2D = buffer2DT_.begin()+n*RO*E1*srcCHA+usedS*RO*E1*srcCHA*N;
-                            hoNDArray<T> aliasedIm(RO, E1, srcCHA, pIm2D);
+                        T* pIm2D = buffer2DT_.begin()+n*RO*E1*srcCHA+usedS*RO*E1*srcCHA*N;
+                        hoNDArray<T> aliasedIm(RO, E1, srcCHA, pIm2D);
 
-                            if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(aliasedIm, debugFolder_+"aliasedIm_n"); }
+                        if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(aliasedIm, debugFolder_+"aliasedIm_n"); }
 
-                            this->applyImageDomainKernelImage(aliasedIm, kIm, complexIm);
-                            if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(complexIm, debugFolder_+"complexIm_n"); }
+                        this->applyImageDomainKernelImage(aliasedIm, kIm, complexIm);
+                        if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(complexIm, debugFolder_+"complexIm_n"); }
 
-                            memcpy(workOrder2DT->fullkspace_.begin()+n*RO*E1*dstCHA+usedS*RO*E1*dstCHA*N, complexIm.begin(), sizeof(T)*RO*E1*dstCHA);
-                        }
+                        memcpy(workOrder2DT->fullkspace_.begin()+n*RO*E1*dstCHA+usedS*RO*E1*dstCHA*N, complexIm.begin(), sizeof(T)*RO*E1*dstCHA);
                     }
                 }
+            }
 
-                hoNDArray<T> unwarppedIm(RO, E1, dstCHA, N, workOrder2DT->fullkspace_.begin()+usedS*RO*E1*dstCHA*N);
-                hoNDArray<T> combined(RO, E1, N, workOrder2DT->complexIm_.begin()+usedS*RO*E1*N);
+            hoNDArray<T> unwarppedIm(RO, E1, dstCHA, N, workOrder2DT->fullkspace_.begin()+usedS*RO*E1*dstCHA*N);
+            hoNDArray<T> combined(RO, E1, N, workOrder2DT->complexIm_.begin()+usedS*RO*E1*N);
 
-                if ( refN == N )
-                {
-                    hoNDArray<T> coilMap(RO, E1, dstCHA, refN, workOrder2DT->coilMap_->begin()+usedS*RO*E1*dstCHA*refN);
-                    gtPlusISMRMRDReconUtilComplex<T>().coilCombine(unwarppedIm, coilMap, combined);
-                }
-                else
-                {
-                    hoNDArray<T> coilMap(RO, E1, dstCHA, workOrder2DT->coilMap_->begin()+usedS*RO*E1*dstCHA*refN);
-                    gtPlusISMRMRDReconUtilComplex<T>().coilCombine(unwarppedIm, coilMap, combined);
-                }
+            if ( refN == N )
+            {
+                hoNDArray<T> coilMap(RO, E1, dstCHA, refN, workOrder2DT->coilMap_->begin()+usedS*RO*E1*dstCHA*refN);
+                gtPlusISMRMRDReconUtilComplex<T>().coilCombine(unwarppedIm, coilMap, combined);
+            }
+            else
+            {
+                hoNDArray<T> coilMap(RO, E1, dstCHA, workOrder2DT->coilMap_->begin()+usedS*RO*E1*dstCHA*refN);
+                gtPlusISMRMRDReconUtilComplex<T>().coilCombine(unwarppedIm, coilMap, combined);
+            }
 
-                if ( !debugFolder_.empty() )
-                {
-                    std::ostringstream ostr;
-                    ostr << "combined_" << usedS;
-                    if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(combined, debugFolder_+ostr.str()); }
-                }
+            if ( !debugFolder_.empty() )
+            {
+                std::ostringstream ostr;
+                ostr << "combined_" << usedS;
+                if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(combined, debugFolder_+ostr.str()); }
             }
 
-            Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->fft2c(workOrder2DT->fullkspace_);
+            Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->fft2c(unwarppedIm);
 
             if ( !debugFolder_.empty() )
             {
                 std::ostringstream ostr;
                 ostr << "fullkspace_" << usedS;
-                if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(workOrder2DT->fullkspace_, debugFolder_+ostr.str()); }
+                if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(unwarppedIm, debugFolder_+ostr.str()); }
             }
         }
         else
         {
-            size_t usedS;
-            for ( usedS=0; usedS<S; usedS++ )
+            if ( (refN<N) || (refN==1) )
             {
-                if ( (refN<N) || (refN==1) )
-                {
-                    hoNDArray<T> unmixCoeff(RO, E1, srcCHA, workOrder2DT->unmixingCoeffIm_->begin()+usedS*RO*E1*srcCHA*refN);
-                    hoNDArray<T> aliasedIm(RO, E1, srcCHA, N, buffer2DT_.begin()+usedS*RO*E1*srcCHA*N);
-                    hoNDArray<T> unwarppedIm(RO, E1, 1, N, workOrder2DT->complexIm_.begin()+usedS*RO*E1*N);
+                hoNDArray<T> unmixCoeff(RO, E1, srcCHA, workOrder2DT->unmixingCoeffIm_->begin()+usedS*RO*E1*srcCHA*refN);
+                hoNDArray<T> aliasedIm(RO, E1, srcCHA, N, buffer2DT_.begin()+usedS*RO*E1*srcCHA*N);
+                hoNDArray<T> unwarppedIm(RO, E1, 1, N, workOrder2DT->complexIm_.begin()+usedS*RO*E1*N);
 
-                    this->applyUnmixCoeffImage(aliasedIm, unmixCoeff, unwarppedIm);
+                this->applyUnmixCoeffImage(aliasedIm, unmixCoeff, unwarppedIm);
 
-                    if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(unwarppedIm, debugFolder_+"unwarppedIm"); }
-                }
-                else
+                if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(unwarppedIm, debugFolder_+"unwarppedIm"); }
+            }
+            else
+            {
+                // #pragma omp parallel for private(n)
+                for ( n=0; n<(int)N; n++ )
                 {
-                    // #pragma omp parallel for private(n)
-                    for ( n=0; n<(int)N; n++ )
-                    {
-                        hoNDArray<T> unmixCoeff(RO, E1, srcCHA, workOrder2DT->unmixingCoeffIm_->begin()+n*RO*E1*srcCHA+usedS*RO*E1*srcCHA*refN);
-                        hoNDArray<T> aliasedIm(RO, E1, srcCHA, buffer2DT_.begin()+n*RO*E1*srcCHA+usedS*RO*E1*srcCHA*N);
-                        hoNDArray<T> unwarppedIm(RO, E1, 1, workOrder2DT->complexIm_.begin()+n*RO*E1+usedS*RO*E1*N);
+                    hoNDArray<T> unmixCoeff(RO, E1, srcCHA, workOrder2DT->unmixingCoeffIm_->begin()+n*RO*E1*srcCHA+usedS*RO*E1*srcCHA*refN);
+                    hoNDArray<T> aliasedIm(RO, E1, srcCHA, buffer2DT_.begin()+n*RO*E1*srcCHA+usedS*RO*E1*srcCHA*N);
+                    hoNDArray<T> unwarppedIm(RO, E1, 1, workOrder2DT->complexIm_.begin()+n*RO*E1+usedS*RO*E1*N);
 
-                        this->applyUnmixCoeffImage(aliasedIm, unmixCoeff, unwarppedIm);
+                    this->applyUnmixCoeffImage(aliasedIm, unmixCoeff, unwarppedIm);
 
-                        if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(unwarppedIm, debugFolder_+"unwarppedIm"); }
-                    }
+                    if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(unwarppedIm, debugFolder_+"unwarppedIm"); }
                 }
             }
 
-            workOrder2DT->fullkspace_.create(RO, E1, 1, N, S);
-            memcpy(workOrder2DT->fullkspace_.begin(), workOrder2DT->complexIm_.begin(), workOrder2DT->complexIm_.get_number_of_bytes());
-            Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->fft2c(workOrder2DT->fullkspace_);
+            hoNDArray<T> fullkspace(RO, E1, 1, N, workOrder2DT->fullkspace_.begin()+usedS*RO*E1*N);
+            memcpy(fullkspace.begin(), workOrder2DT->complexIm_.begin()+usedS*RO*E1*N, sizeof(T)*RO*E1*N);
+            Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->fft2c(fullkspace);
         }
     }
     catch(...)
     {
-        GERROR_STREAM("Errors in gtPlusReconWorker2DTGRAPPA<T>::performUnwrapping(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& data) ... ");
+        GERROR_STREAM("Errors in gtPlusReconWorker2DTGRAPPA<T>::performUnwrappingImpl(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>& data, size_t usedS) ... ");
         return false;
     }
 
@@ -15,6 +15,7 @@
 
 #include "GadgetCloudController.h"
 #include "GadgetCloudJobMessageReadWrite.h"
+#include "GadgetThreadPool.h"
 
 namespace Gadgetron { namespace gtPlus {
 
@@ -311,6 +312,9 @@ performUnwarppingImpl(gtPlusReconWorkOrder<T>* workOrder2DT, hoNDArray<T>& kspac
                     continue;
                 }
 
+                // temporaries of the solver for this N come from the thread arena and are released at once
+                hoMemoryArenaScope arenaScope;
+
                 long long kernelN = n;
                 if ( kernelN >= (long long)refN ) kernelN = (long long)refN-1;
 
@@ -357,6 +361,9 @@ performUnwarppingImpl(gtPlusReconWorkOrder<T>* workOrder2DT, hoNDArray<T>& kspac
 
                 if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(unwarppedKSpace, debugFolder_+"unwarppedKSpace_n_setAcq"); }
             }
+
+            // do not keep the solver temporaries resident on this thread after the recon
+            hoMemoryArena::thread_arena()->reset();
         }
 
         if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(res, debugFolder_+"res_Shifted"); }
@@ -521,7 +528,24 @@ performUnwrapping(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>&
                     std::vector<gtPlusReconJob2DT<T>* > completedJobListCloud(numOfJobRunOnCloud);
                     std::vector<int> node_ids(numOfJobRunOnCloud);
 
-                    GADGET_CHECK_RETURN_FALSE(this->scheduleJobForNodes(workOrder2DT, numOfJobRunOnCloud, node_ids));
+                    std::vector<size_t> jobSizes(numOfJobRunOnCloud);
+                    for ( j=0; j<numOfJobRunOnCloud; j++ )
+                    {
+                        jobSizes[j] = jobList[j].kspace.get_number_of_bytes() + jobList[j].ker.get_number_of_bytes();
+                    }
+
+                    GADGET_CHECK_RETURN_FALSE(this->scheduleJobForNodes(workOrder2DT, jobSizes, node_ids));
+
+                    // a job late against the measured node throughput is sent again to an idle node
+                    if ( this->cloud_scheduler_.hasNodeThroughput() )
+                    {
+                        double expectedSeconds = 0;
+                        for ( j=0; j<numOfJobRunOnCloud; j++ )
+                        {
+                            expectedSeconds += jobSizes[j] * this->cloud_scheduler_.getNodeSecondsPerByte(node_ids[j]);
+                        }
+                        controller.expected_job_seconds_ = expectedSeconds/numOfJobRunOnCloud;
+                    }
 
                     for ( j=0; j<numOfJobRunOnCloud; j++ )
                     {
@@ -579,8 +603,20 @@ performUnwrapping(gtPlusReconWorkOrder2DT<T>* workOrder2DT, const hoNDArray<T>&
                                 if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(jobList[j].res, debugFolder_+ostr.str()); }
                             }
 
-                            // wait the cloud job to complete
-                            controller.waitForJobToComplete();
+                            // wait the cloud job to complete, on a pool thread a spare thread runs the other gadgets meanwhile
+                            {
+                                GadgetPoolBlockingScope blocking;
+                                controller.waitForJobToComplete();
+                            }
+
+                            // update the measured seconds per byte of the nodes
+                            for ( j=0; j<numOfJobRunOnCloud; j++ )
+                            {
+                                if ( controller.job_seconds_[j] > 0 )
+                                {
+                                    this->cloud_scheduler_.updateNodeThroughput(controller.node_id_completed_[j], jobSizes[j], controller.job_seconds_[j]);
+                                }
+                            }
 
                             // combine results from cloud and local run
                             for ( j=0; j<numOfJobRunOnCloud; j++ )
@@ -1840,60 +1840,23 @@ bool gtPlusReconWorker3DT<T>::performPartialFourierFilter(gtPlusReconWorkOrder3D
 
         if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(kspace, debugFolder_+"kspace_before_PF_Filter"); }
 
-        hoNDArray<T> buffer3DT_partial_fourier(kspace.get_dimensions());
-
         if ( workOrder3DT.filterROE1E2_partialfourier_.get_size(0)==RO 
                 && workOrder3DT.filterROE1E2_partialfourier_.get_size(1)==E1
                 && workOrder3DT.filterROE1E2_partialfourier_.get_size(2)==E2 )
         {
-            Gadgetron::apply_kspace_filter_ROE1E2(kspace, workOrder3DT.filterROE1E2_partialfourier_, buffer3DT_partial_fourier);
-            kspace = buffer3DT_partial_fourier;
+            Gadgetron::apply_kspace_filter_ROE1E2(kspace, workOrder3DT.filterROE1E2_partialfourier_, kspace);
         }
-
-        else if ( (workOrder3DT.filterRO_partialfourier_.get_number_of_elements() == RO) 
-                && (workOrder3DT.filterE1_partialfourier_.get_number_of_elements() == E1) 
-                && (workOrder3DT.filterE2_partialfourier_.get_number_of_elements() == E2) )
-        {
-            Gadgetron::apply_kspace_filter_ROE1E2(kspace, workOrder3DT.filterRO_partialfourier_,
-                    workOrder3DT.filterE1_partialfourier_, workOrder3DT.filterE2_partialfourier_, buffer3DT_partial_fourier);
-
-            kspace = buffer3DT_partial_fourier;
-        }
-
         else
         {
-            hoNDArray<T>* pSrc = &kspace;
-            hoNDArray<T>* pDst = &buffer3DT_partial_fourier;
-
-            bool filterPerformed = false;
-
-            if ( workOrder3DT.filterRO_partialfourier_.get_number_of_elements() == RO )
-            {
-                // GADGET_CHECK_RETURN_FALSE(gtPlusISMRMRDReconUtil<T>().kspacefilterRO(*pSrc, workOrder3DT.filterRO_partialfourier_, *pDst));
-                Gadgetron::apply_kspace_filter_RO(*pSrc, workOrder3DT.filterRO_partialfourier_, *pDst);
-                std::swap(pSrc, pDst);
-                filterPerformed = true;
-            }
-
-            if ( workOrder3DT.filterE1_partialfourier_.get_number_of_elements() == E1 )
-            {
-                // GADGET_CHECK_RETURN_FALSE(gtPlusISMRMRDReconUtil<T>().kspacefilterE1(*pSrc, workOrder3DT.filterE1_partialfourier_, *pDst));
-                Gadgetron::apply_kspace_filter_E1(*pSrc, workOrder3DT.filterE1_partialfourier_, *pDst);
-                std::swap(pSrc, pDst);
-                filterPerformed = true;
-            }
-
-            if ( workOrder3DT.filterE2_partialfourier_.get_number_of_elements() == E2 )
-            {
-                // GADGET_CHECK_RETURN_FALSE(gtPlusISMRMRDReconUtil<T>().kspace3DfilterE2(*pSrc, workOrder3DT.filterE2_partialfourier_, *pDst));
-                Gadgetron::apply_kspace_filter_E2(*pSrc, workOrder3DT.filterE2_partialfourier_, *pDst);
-                std::swap(pSrc, pDst);
-                filterPerformed = true;
-            }
+            // the 1D filters are applied together in place, the ones not matching the data size are passed empty
+            hoNDArray<T> noFilter;
+            const hoNDArray<T>& fRO = (workOrder3DT.filterRO_partialfourier_.get_number_of_elements() == RO) ? workOrder3DT.filterRO_partialfourier_ : noFilter;
+            const hoNDArray<T>& fE1 = (workOrder3DT.filterE1_partialfourier_.get_number_of_elements() == E1) ? workOrder3DT.filterE1_partialfourier_ : noFilter;
+            const hoNDArray<T>& fE2 = (workOrder3DT.filterE2_partialfourier_.get_number_of_elements() == E2) ? workOrder3DT.filterE2_partialfourier_ : noFilter;
 
-            if ( filterPerformed && pDst != &kspace )
+            if ( fRO.get_number_of_elements()>0 || fE1.get_number_of_elements()>0 || fE2.get_number_of_elements()>0 )
             {
-                kspace = *pDst;
+                Gadgetron::apply_kspace_filter_separable(kspace, fRO, fE1, fE2, kspace);
             }
 
             if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(kspace, debugFolder_+"kspace_after_PF_Filter"); }
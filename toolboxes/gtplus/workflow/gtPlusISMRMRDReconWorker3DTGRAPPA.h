@@ -34,8 +34,16 @@ public:
 
     virtual bool performUnwrapping(gtPlusReconWorkOrder3DT<T>* workOrder3DT, const hoNDArray<T>& data);
 
+    // kspace unwrapping in chunks of jobN along RO, after the RO ifft
+    // the image domain kernel is only computed for one chunk at a time, [E1 E2 jobN srcCHA dstCHA]
+    virtual bool performUnwrappingROChunk(gtPlusReconWorkOrder3DT<T>* workOrder3DT, const hoNDArray<T>& data, size_t jobN);
+
     virtual bool computeKSpace(gtPlusReconWorkOrder3DT<T>* workOrder3DT);
 
+    // whether to unwrap the kspace in chunks along RO, jobN is the number of RO in every chunk
+    // the chunk is sized to keep the image domain kernel and images of a chunk within kernelIm_max_Megabytes_
+    // the unmixing coefficients are computed per channel pair and are not split
+    // the RO ifft copy of the aliased kspace [RO E1 E2 srcCHA N] and fullkspace_ are full size and not covered by the budget
     virtual bool splitJob(gtPlusReconWorkOrder3DT<T>* workOrder3DT, size_t& jobN);
 
     using BaseClass::gt_timer1_;
@@ -91,7 +99,12 @@ template <typename T>
 bool gtPlusReconWorker3DTGRAPPA<T>::
 splitJob(gtPlusReconWorkOrder3DT<T>* workOrder3DT, size_t& jobN)
 {
-    return false;
+    jobN = 0;
+
+    size_t maxMegaBytes = workOrder3DT->kernelIm_max_Megabytes_;
+    if ( maxMegaBytes == 0 ) return false;
+
+    if ( !this->computeKSpace(workOrder3DT) ) return false;
 
     size_t RO = workOrder3DT->data_.get_size(0);
     size_t E1 = workOrder3DT->data_.get_size(1);
@@ -100,27 +113,22 @@ splitJob(gtPlusReconWorkOrder3DT<T>* workOrder3DT, size_t& jobN)
     size_t srcCHA = workOrder3DT->kernel_->get_size(3);
     size_t dstCHA = workOrder3DT->kernel_->get_size(4);
 
-    jobN = workOrder3DT->job_num_of_N_;
-    size_t jobMegaBytes = workOrder3DT->job_max_Megabytes_;
+    // image domain kernel [E1 E2 srcCHA dstCHA], aliased [E1 E2 srcCHA] and unwrapped [E1 E2 dstCHA] images for every RO
+    size_t numOfBytesPerRO = sizeof(T)*E1*E2*(srcCHA*dstCHA + srcCHA + dstCHA);
+    if ( numOfBytesPerRO == 0 ) return false;
 
-    bool splitJobs = (jobN>0 && RO>jobN);
-    if ( !splitJobs )
-    {
-        if ( jobMegaBytes>0 )
-        {
-            size_t jobN = jobMegaBytes/(E1*E2*srcCHA*dstCHA*sizeof(T)/1024/1024);
-            if ( jobN < RO ) splitJobs = true;
-            GDEBUG_STREAM("grappa - 3DT - size of largest job : " << jobN);
-        }
-    }
+    jobN = (maxMegaBytes*1024*1024)/numOfBytesPerRO;
 
-    bool reconKSpace = this->computeKSpace(workOrder3DT);
-    if ( !reconKSpace )
+    // if one RO is already over the budget, still go one RO at a time
+    if ( jobN < 1 ) jobN = 1;
+
+    if ( jobN >= RO )
     {
-        splitJobs = false;
+        jobN = RO;
+        return false;
     }
 
-    return splitJobs;
+    return true;
 }
 
 template <typename T> 
@@ -280,6 +288,13 @@ performUnwrapping(gtPlusReconWorkOrder3DT<T>* workOrder3DT, const hoNDArray<T>&
 
         workOrder3DT->complexIm_.create(RO, E1, E2, 1, N);
 
+        size_t jobN;
+        if ( this->splitJob(workOrder3DT, jobN) )
+        {
+            GADGET_CHECK_RETURN_FALSE(this->performUnwrappingROChunk(workOrder3DT, data_dst, jobN));
+            return true;
+        }
+
         hoNDArray<T> aliasedIm;
 
         if ( performTiming_ ) { gt_timer3_.start("grappa 3D compute aliased image ... "); }
@@ -400,6 +415,95 @@ performUnwrapping(gtPlusReconWorkOrder3DT<T>* workOrder3DT, const hoNDArray<T>&
     return true;
 }
 
+template <typename T> 
+bool gtPlusReconWorker3DTGRAPPA<T>::
+performUnwrappingROChunk(gtPlusReconWorkOrder3DT<T>* workOrder3DT, const hoNDArray<T>& data_dst, size_t jobN)
+{
+    try
+    {
+        size_t RO = workOrder3DT->data_.get_size(0);
+        size_t E1 = workOrder3DT->data_.get_size(1);
+        size_t E2 = workOrder3DT->data_.get_size(2);
+        size_t N = workOrder3DT->data_.get_size(4);
+
+        size_t kRO = workOrder3DT->kernel_->get_size(0);
+        size_t kNE1 = workOrder3DT->kernel_->get_size(1);
+        size_t kNE2 = workOrder3DT->kernel_->get_size(2);
+
+        size_t srcCHA = workOrder3DT->kernel_->get_size(3);
+        size_t dstCHA = workOrder3DT->kernel_->get_size(4);
+
+        size_t refN = workOrder3DT->kernel_->get_size(5);
+
+        GDEBUG_STREAM("grappa - 3DT - unwrapping in chunks of " << jobN << " RO - image domain kernel of every chunk : " << sizeof(T)*E1*E2*srcCHA*dstCHA*jobN/1024.0/1024 << " MBytes ... ");
+
+        const hoNDArray<T>& kspace = (workOrder3DT->downstream_coil_compression_ ? workOrder3DT->data_ : data_dst);
+        GADGET_CHECK_RETURN_FALSE(kspace.get_size(3)==srcCHA);
+
+        typename realType<T>::Type fftCompensationRatio = (typename realType<T>::Type)(1.0/std::sqrt( (double)workOrder3DT->acceFactorE1_ * (double)workOrder3DT->acceFactorE2_ ));
+
+        // if the image data is scaled and ref lines are going to be filled back to the data, 
+        // the reference lines should be scaled too
+        if ( workOrder3DT->CalibMode_ == ISMRMRD_embedded )
+        {
+            if ( workOrder3DT->embedded_ref_fillback_ )
+            {
+                Gadgetron::scal( fftCompensationRatio, workOrder3DT->ref_);
+            }
+        }
+
+        workOrder3DT->fullkspace_.create(RO, E1, E2, dstCHA, N);
+
+        if ( performTiming_ ) { gt_timer3_.start("grappa 3D apply image domain kernel for every channel in RO chunks ... "); }
+        if ( (refN<N) || (refN==1) )
+        {
+            hoNDArray<T> convKer(kRO, kNE1, kNE2, srcCHA, dstCHA, workOrder3DT->kernel_->begin());
+            Gadgetron::grappa3d_image_domain_unwrapping_ro_chunk(convKer, kspace, workOrder3DT->acceFactorE1_, workOrder3DT->acceFactorE2_, jobN, workOrder3DT->fullkspace_);
+        }
+        else
+        {
+            size_t n;
+            for ( n=0; n<N; n++ )
+            {
+                hoNDArray<T> convKer(kRO, kNE1, kNE2, srcCHA, dstCHA, workOrder3DT->kernel_->begin() + n*kRO*kNE1*kNE2*srcCHA*dstCHA);
+                hoNDArray<T> kspaceN(RO, E1, E2, srcCHA, const_cast<T*>(kspace.begin())+n*RO*E1*E2*srcCHA);
+                hoNDArray<T> unwrappedIm(RO, E1, E2, dstCHA, workOrder3DT->fullkspace_.begin()+n*RO*E1*E2*dstCHA);
+
+                Gadgetron::grappa3d_image_domain_unwrapping_ro_chunk(convKer, kspaceN, workOrder3DT->acceFactorE1_, workOrder3DT->acceFactorE2_, jobN, unwrappedIm);
+            }
+        }
+
+        // the scaling of the aliased images is applied to the unwrapped images
+        Gadgetron::scal( fftCompensationRatio, workOrder3DT->fullkspace_);
+        if ( performTiming_ ) { gt_timer3_.stop(); }
+
+        if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(workOrder3DT->fullkspace_, debugFolder_+"unwarppedIm"); }
+
+        if ( (workOrder3DT->coilMap_->get_size(0)==RO) 
+            && (workOrder3DT->coilMap_->get_size(1)==E1) 
+            && (workOrder3DT->coilMap_->get_size(2)==E2) 
+            && (workOrder3DT->coilMap_->get_size(3)==dstCHA) )
+        {
+            if ( performTiming_ ) { gt_timer3_.start("grappa 3D coil combination ... "); }
+            gtPlusISMRMRDReconUtilComplex<T>().coilCombine3D(workOrder3DT->fullkspace_, *workOrder3DT->coilMap_, workOrder3DT->complexIm_);
+            if ( performTiming_ ) { gt_timer3_.stop(); }
+
+            if ( !debugFolder_.empty() ) { gt_exporter_.exportArrayComplex(workOrder3DT->complexIm_, debugFolder_+"combined"); }
+        }
+
+        if ( performTiming_ ) { gt_timer3_.start("grappa 3D go back to kspace ... "); }
+        Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->fft3c(workOrder3DT->fullkspace_);
+        if ( performTiming_ ) { gt_timer3_.stop(); }
+    }
+    catch(...)
+    {
+        GERROR_STREAM("Errors in gtPlusReconWorker3DTGRAPPA<T>::performUnwrappingROChunk(gtPlusReconWorkOrder3DT<T>* workOrder3DT, const hoNDArray<T>& data, size_t jobN) ... ");
+        return false;
+    }
+
+    return true;
+}
+
 template <typename T> 
 bool gtPlusReconWorker3DTGRAPPA<T>::performRecon(gtPlusReconWorkOrder3DT<T>* workOrder3DT)
 {
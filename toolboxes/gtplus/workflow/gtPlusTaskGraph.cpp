@@ -0,0 +1,268 @@
+/** \file   gtPlusTaskGraph.cpp
+    \brief  Define and implement a dependency-aware task graph for the GtPlus workers
+*/
+
+#include "gtPlusTaskGraph.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+
+namespace Gadgetron { namespace gtPlus {
+
+gtPlusTaskGraph::gtPlusTaskGraph() : wall_seconds_(0)
+{
+}
+
+gtPlusTaskGraph::~gtPlusTaskGraph()
+{
+}
+
+void gtPlusTaskGraph::printInfo(std::ostream& os) const
+{
+    using namespace std;
+
+    os << "-------------- GTPlus task graph ---------------" << endl;
+    os << "Number of tasks : " << tasks_.size() << endl;
+
+    std::vector<std::string> stages;
+    std::vector<double> busySeconds, wallSeconds;
+    this->getStageTiming(stages, busySeconds, wallSeconds);
+
+    for ( size_t ii=0; ii<stages.size(); ii++ )
+    {
+        os << "Stage " << stages[ii] << " : busy " << busySeconds[ii] << " s, wall " << wallSeconds[ii] << " s" << endl;
+    }
+
+    os << "Total wall time : " << wall_seconds_ << " s" << endl;
+    os << "------------------------------------------------" << endl;
+}
+
+void gtPlusTaskGraph::clear()
+{
+    stages_.clear();
+    tasks_.clear();
+    wall_seconds_ = 0;
+}
+
+size_t gtPlusTaskGraph::addTask(const std::string& stage, const TaskType& task)
+{
+    size_t s;
+    for ( s=0; s<stages_.size(); s++ )
+    {
+        if ( stages_[s] == stage ) break;
+    }
+
+    if ( s == stages_.size() ) stages_.push_back(stage);
+
+    TaskInfo info;
+    info.stage_ = s;
+    info.task_ = task;
+    info.num_of_dependencies_ = 0;
+    info.start_ = 0;
+    info.end_ = 0;
+    info.done_ = false;
+
+    tasks_.push_back(info);
+
+    return tasks_.size()-1;
+}
+
+void gtPlusTaskGraph::addDependency(size_t taskID, size_t dependencyID)
+{
+    GADGET_CHECK_THROW(taskID<tasks_.size());
+    GADGET_CHECK_THROW(dependencyID<tasks_.size());
+
+    tasks_[dependencyID].dependents_.push_back(taskID);
+    tasks_[taskID].num_of_dependencies_++;
+}
+
+size_t gtPlusTaskGraph::getNumOfTasks() const
+{
+    return tasks_.size();
+}
+
+bool gtPlusTaskGraph::checkDependencies() const
+{
+    // every task must be reachable from the tasks without dependencies
+    size_t numOfTasks = tasks_.size();
+
+    std::vector<size_t> remaining(numOfTasks);
+    std::vector<size_t> ready;
+
+    size_t ii;
+    for ( ii=0; ii<numOfTasks; ii++ )
+    {
+        remaining[ii] = tasks_[ii].num_of_dependencies_;
+        if ( remaining[ii] == 0 ) ready.push_back(ii);
+    }
+
+    size_t numOfVisited = 0;
+    while ( !ready.empty() )
+    {
+        size_t id = ready.back();
+        ready.pop_back();
+        numOfVisited++;
+
+        for ( ii=0; ii<tasks_[id].dependents_.size(); ii++ )
+        {
+            size_t d = tasks_[id].dependents_[ii];
+            if ( --remaining[d] == 0 ) ready.push_back(d);
+        }
+    }
+
+    return (numOfVisited == numOfTasks);
+}
+
+bool gtPlusTaskGraph::run(size_t numOfThreads, bool nested)
+{
+    try
+    {
+        wall_seconds_ = 0;
+
+        size_t numOfTasks = tasks_.size();
+        if ( numOfTasks == 0 ) return true;
+
+        if ( !this->checkDependencies() )
+        {
+            GERROR_STREAM("gtPlusTaskGraph::run(...), the task dependencies have a cycle ... ");
+            return false;
+        }
+
+        std::vector<size_t> remaining(numOfTasks);
+        std::set<size_t> ready;
+
+        size_t ii;
+        for ( ii=0; ii<numOfTasks; ii++ )
+        {
+            remaining[ii] = tasks_[ii].num_of_dependencies_;
+            tasks_[ii].start_ = 0;
+            tasks_[ii].end_ = 0;
+            tasks_[ii].done_ = false;
+
+            if ( remaining[ii] == 0 ) ready.insert(ii);
+        }
+
+        size_t numOfFinished = 0;
+        bool failed = false;
+
+        if ( numOfThreads < 1 ) numOfThreads = 1;
+        if ( numOfThreads > numOfTasks ) numOfThreads = numOfTasks;
+
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+        // idle threads wait on cond until a finished task makes another one ready, or the run ends
+        std::mutex mutex;
+        std::condition_variable cond;
+
+        // with one thread, the region is inactive and the openmp regions inside the tasks are not serialized
+        #pragma omp parallel default(shared) num_threads((int)numOfThreads) if (numOfThreads>1)
+        {
+            // the nesting is a per-thread setting, it ends with the team
+            #ifdef USE_OMP
+                if ( nested && numOfThreads>1 ) omp_set_nested(1);
+            #endif // USE_OMP
+
+            while ( true )
+            {
+                size_t id = 0;
+
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    while ( !failed && numOfFinished<numOfTasks && ready.empty() ) cond.wait(lock);
+
+                    if ( failed || numOfFinished==numOfTasks ) break;
+
+                    id = *ready.begin();
+                    ready.erase(ready.begin());
+                }
+
+                double start = std::chrono::duration<double>(std::chrono::steady_clock::now()-startTime).count();
+
+                bool succeeded = false;
+                try
+                {
+                    succeeded = tasks_[id].task_();
+                }
+                catch(...)
+                {
+                    succeeded = false;
+                }
+
+                double end = std::chrono::duration<double>(std::chrono::steady_clock::now()-startTime).count();
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+
+                    tasks_[id].start_ = start;
+                    tasks_[id].end_ = end;
+                    tasks_[id].done_ = true;
+
+                    if ( !succeeded )
+                    {
+                        GERROR_STREAM("gtPlusTaskGraph::run(...), task " << id << " of stage " << stages_[tasks_[id].stage_] << " failed ... ");
+                        failed = true;
+                    }
+                    else
+                    {
+                        for ( size_t d=0; d<tasks_[id].dependents_.size(); d++ )
+                        {
+                            size_t dependent = tasks_[id].dependents_[d];
+                            if ( --remaining[dependent] == 0 ) ready.insert(dependent);
+                        }
+                    }
+
+                    numOfFinished++;
+                }
+
+                // wake the waiting threads for the new ready tasks, or to leave once the run has ended
+                cond.notify_all();
+            }
+        }
+
+        wall_seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now()-startTime).count();
+
+        if ( failed ) return false;
+    }
+    catch(...)
+    {
+        GERROR_STREAM("Errors in gtPlusTaskGraph::run(...) ... ");
+        return false;
+    }
+
+    return true;
+}
+
+void gtPlusTaskGraph::getStageTiming(std::vector<std::string>& stages, std::vector<double>& busySeconds, std::vector<double>& wallSeconds) const
+{
+    stages = stages_;
+    busySeconds.clear();
+    busySeconds.resize(stages_.size(), 0);
+    wallSeconds.clear();
+    wallSeconds.resize(stages_.size(), 0);
+
+    std::vector<double> firstStart(stages_.size(), -1), lastEnd(stages_.size(), 0);
+
+    for ( size_t ii=0; ii<tasks_.size(); ii++ )
+    {
+        if ( !tasks_[ii].done_ ) continue;
+
+        size_t s = tasks_[ii].stage_;
+        busySeconds[s] += tasks_[ii].end_ - tasks_[ii].start_;
+
+        if ( firstStart[s]<0 || tasks_[ii].start_<firstStart[s] ) firstStart[s] = tasks_[ii].start_;
+        if ( tasks_[ii].end_ > lastEnd[s] ) lastEnd[s] = tasks_[ii].end_;
+    }
+
+    for ( size_t s=0; s<stages_.size(); s++ )
+    {
+        if ( firstStart[s] >= 0 ) wallSeconds[s] = lastEnd[s] - firstStart[s];
+    }
+}
+
+double gtPlusTaskGraph::getWallSeconds() const
+{
+    return wall_seconds_;
+}
+
+}}
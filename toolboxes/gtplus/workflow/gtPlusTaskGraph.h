@@ -0,0 +1,82 @@
+/** \file   gtPlusTaskGraph.h
+    \brief  Define and implement a dependency-aware task graph for the GtPlus workers
+
+            Every task belongs to a stage (e.g. calib, unwrapping) and runs once all tasks it depends on have finished.
+            The tasks are run by a team of openmp threads; among the ready tasks, the one added first is run first.
+            So if the tasks of every S are added together, the later stages of one S can start while the earlier
+            stages of the next S are still running.
+
+            The busy and wall time of every stage are recorded for the last run.
+*/
+
+#pragma once
+
+#include "GtPlusExport.h"
+#include "gtPlusISMRMRDReconUtil.h"
+#include <boost/function.hpp>
+
+namespace Gadgetron { namespace gtPlus {
+
+class EXPORTGTPLUS gtPlusTaskGraph
+{
+public:
+
+    // a task returns false if it failed
+    // a task may use omp_get_thread_num() to pick per-thread buffers, it is in [0 numOfThreads)
+    typedef boost::function<bool ()> TaskType;
+
+    gtPlusTaskGraph();
+    virtual ~gtPlusTaskGraph();
+
+    virtual void printInfo(std::ostream& os) const;
+
+    // remove all tasks and timing
+    void clear();
+
+    // add a task to a stage, the task ID is returned
+    size_t addTask(const std::string& stage, const TaskType& task);
+
+    // the task will only start after the dependency has finished
+    void addDependency(size_t taskID, size_t dependencyID);
+
+    size_t getNumOfTasks() const;
+
+    // run all tasks
+    // if numOfThreads is 1, the tasks run in order on the calling thread and may use all cores themselves
+    // if any task fails or the dependencies have a cycle, false is returned and no more tasks are started
+    // if nested is true, the openmp regions inside the tasks get their own threads; this is only set for the threads of the team
+    bool run(size_t numOfThreads, bool nested=false);
+
+    // timing of the last run, in seconds
+    // busySeconds is summed over all tasks of a stage
+    // wallSeconds is from the first start to the last finish of a stage
+    // stages are listed in the order they were first added
+    void getStageTiming(std::vector<std::string>& stages, std::vector<double>& busySeconds, std::vector<double>& wallSeconds) const;
+
+    // wall time of the last run, in seconds
+    double getWallSeconds() const;
+
+protected:
+
+    struct TaskInfo
+    {
+        size_t stage_;
+        TaskType task_;
+        std::vector<size_t> dependents_;
+        size_t num_of_dependencies_;
+
+        // seconds from the start of the run
+        double start_;
+        double end_;
+        bool done_;
+    };
+
+    bool checkDependencies() const;
+
+    std::vector<std::string> stages_;
+    std::vector<TaskInfo> tasks_;
+
+    double wall_seconds_;
+};
+
+}}
@@ -10,204 +10,313 @@
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_reductions.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace Gadgetron
 {
 
-template<typename T> 
-void coil_map_2d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t power)
+// pixels along RO and E1 of one tile of the coil map, the local covariances of a tile are box filtered together
+#define INATI_TILE_SIZE 32
+// planes along E2 of one work item, the box sums slide along E2 within the item
+#define INATI_SLAB_SIZE 32
+
+/// Inati coil map with the local covariance computed by box filtering instead of forming the data matrix of every pixel
+/// pData: [RO E1 E2 CHA], pSen has the same size; the covariance of every pixel is the sum over a ks*ks*kz neighbourhood with periodic boundaries
+/// the Hermitian outer products are box filtered along RO and E1 with running sums and slide along E2, so the cost per
+/// pixel is independent of the kernel size; the dominant eigenvector is found with batched power iterations
+/// work items of tile*slab are distributed over the threads
+/// the per thread buffers grow with the square of CHA: the ring of kz planes alone holds nE*32*32*kz elements, with the row
+/// and plane sums about nE*32*(32*(kz+1) + 32 + ks - 1); for 32 channels and ks = kz = 7 that is ~40 MB per thread in
+/// complex<float>, ~30 MB of it the plane ring, and ~9 MB in 2D (kz = 1)
+template<typename T>
+void coil_map_Inati_box_filter(const T* pData, T* pSen, long long RO, long long E1, long long E2, long long CHA, size_t ks, size_t kz, size_t power)
 {
-    try
-    {
-        typedef typename realType<T>::Type value_type;
+    typedef typename realType<T>::Type value_type;
 
-        long long RO = data.get_size(0);
-        long long E1 = data.get_size(1);
-        long long CHA = data.get_size(2);
+    long long halfKs = (long long)ks / 2;
+    long long halfKz = (long long)kz / 2;
 
-        long long N = data.get_number_of_elements() / (RO*E1*CHA);
-        GADGET_CHECK_THROW(N == 1);
+    // the covariance is stored as its packed lower triangle, column by column, with the real and imaginary parts split
+    // the box filters only add and subtract, so they treat the nE complex entries of a pixel as 2*nE reals
+    long long nE = CHA*(CHA + 1) / 2;
 
-        const T* pData = data.begin();
+    long long numTilesRO = (RO + INATI_TILE_SIZE - 1) / INATI_TILE_SIZE;
+    long long numTilesE1 = (E1 + INATI_TILE_SIZE - 1) / INATI_TILE_SIZE;
+    long long numSlabs = (E2 + INATI_SLAB_SIZE - 1) / INATI_SLAB_SIZE;
+    long long numItems = numTilesRO*numTilesE1*numSlabs;
 
-        if (!data.dimensions_equal(&coilMap))
-        {
-            coilMap = data;
-        }
-        T* pSen = coilMap.begin();
+    long long maxRO = std::min(RO, (long long)INATI_TILE_SIZE);
+    long long maxE1 = std::min(E1, (long long)INATI_TILE_SIZE);
+    long long maxPix = maxRO*maxE1;
+    long long extRO = maxRO + 2 * halfKs;
+    long long extE1 = maxE1 + 2 * halfKs;
 
-        if (ks % 2 != 1)
-        {
-            ks++;
-        }
+    long long item;
 
-        size_t kss = ks*ks;
-        long long halfKs = (long long)ks / 2;
+#pragma omp parallel default(none) private(item) shared(pData, pSen, RO, E1, E2, CHA, halfKs, halfKz, kz, power, nE, numTilesRO, numTilesE1, numItems, maxRO, maxPix, extRO, extE1)
+    {
+        // one extended row of the tile, channels of a pixel are contiguous
+        hoNDArray<T> x(CHA, extRO);
+        hoNDArray<T> outer(nE, extRO);
 
-        int e1;
+        // sums along RO of every extended row of the tile
+        hoNDArray<T> rowCov(nE, maxRO, extE1);
+        hoNDArray<T> rowSum(CHA, maxRO, extE1);
 
-        #pragma omp parallel private(e1) shared(ks, RO, E1, CHA, pSen, pData, halfKs, power, kss)
+        // ring of the kz box filtered planes in the E2 window and their sum, a single plane is filtered in place
+        hoNDArray<T> planeCov, planeSum;
+        if (kz > 1)
         {
-            hoNDArray<T> D(ks*ks, CHA);
-            T* pD = D.begin();
-
-            hoNDArray<T> DC(ks*ks, CHA);
-            T* pDC = DC.begin();
-
-            hoNDArray<T> DH_D(CHA, CHA);
-            Gadgetron::clear(DH_D);
+            planeCov.create(nE, maxPix, kz);
+            planeSum.create(CHA, maxPix, kz);
+        }
 
-            hoNDArray<T> U1(ks*ks, 1);
-            T* pU1 = U1.begin();
+        hoNDArray<T> cov(nE, maxPix), sum(CHA, maxPix);
 
-            hoNDArray<T> V1(CHA, 1);
-            T* pV1 = V1.begin();
+        hoNDArray<value_type> Vr(CHA), Vi(CHA), Yr(CHA), Yi(CHA);
 
-            hoNDArray<T> V(CHA, 1);
+#pragma omp for
+        for (item = 0; item < numItems; item++)
+        {
+            long long tRO = item % numTilesRO;
+            long long tE1 = (item / numTilesRO) % numTilesE1;
+            long long slab = item / (numTilesRO*numTilesE1);
+
+            long long ro0 = tRO*INATI_TILE_SIZE, nRO = std::min((long long)INATI_TILE_SIZE, RO - ro0);
+            long long e10 = tE1*INATI_TILE_SIZE, nE1 = std::min((long long)INATI_TILE_SIZE, E1 - e10);
+            long long z0 = slab*INATI_SLAB_SIZE, z1 = std::min(z0 + INATI_SLAB_SIZE, E2);
+            long long nPix = nRO*nE1;
+
+            long long nExtRO = nRO + 2 * halfKs;
+            long long nExtE1 = nE1 + 2 * halfKs;
+
+            T* pX = x.begin();
+            T* pOuter = outer.begin();
+            T* pRowCov = rowCov.begin();
+            T* pRowSum = rowSum.begin();
+            T* pCov = cov.begin();
+            T* pSum = sum.begin();
+
+            for (long long z = z0; z < z1; z++)
+            {
+                // planes entering the window, the whole window for the first plane of the slab
+                long long zStart = (z == z0) ? z - halfKz : z + halfKz;
 
-            Gadgetron::clear(D);
-            Gadgetron::clear(DC);
-            Gadgetron::clear(DH_D);
-            Gadgetron::clear(U1);
-            Gadgetron::clear(V1);
-            Gadgetron::clear(V);
+                if (z == z0)
+                {
+                    memset(pCov, 0, sizeof(T)*nE*nPix);
+                    memset(pSum, 0, sizeof(T)*CHA*nPix);
+                }
 
-            T phaseU1;
+                for (long long zz = zStart; zz <= z + halfKz; zz++)
+                {
+                    long long slot = ((zz % (long long)kz) + (long long)kz) % (long long)kz;
+                    T* pPlaneCov = (kz > 1) ? planeCov.begin() + slot*nE*maxPix : pCov;
+                    T* pPlaneSum = (kz > 1) ? planeSum.begin() + slot*CHA*maxPix : pSum;
 
-            value_type v1Norm(1), u1Norm(1);
+                    // the plane leaving the window occupies the slot of the entering one
+                    if (z != z0 && kz > 1)
+                    {
+                        for (long long n = 0; n < nE*nPix; n++) pCov[n] -= pPlaneCov[n];
+                        for (long long n = 0; n < CHA*nPix; n++) pSum[n] -= pPlaneSum[n];
+                    }
 
-            long long cha, ro, kro, ke1, de1, dro;
-            size_t po;
+                    long long wz = ((zz % E2) + E2) % E2;
 
-            #pragma omp for
-            for (e1 = 0; e1<(int)E1; e1++)
-            {
-                for (ro = 0; ro<(long long)RO; ro++)
-                {
-                    // fill the data matrix D
-                    if (e1 >= halfKs && e1<E1 - halfKs && ro >= halfKs && ro<RO - halfKs)
+                    // box filter along RO for every extended row
+                    for (long long r = 0; r < nExtE1; r++)
                     {
-                        for (cha = 0; cha<CHA; cha++)
+                        long long we1 = ((e10 - halfKs + r) % E1 + E1) % E1;
+
+                        for (long long p = 0; p < nExtRO; p++)
                         {
-                            const T* pDataCurr = pData + cha*RO*E1;
-                            int ind = 0;
-                            for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
+                            long long wro = ((ro0 - halfKs + p) % RO + RO) % RO;
+                            const T* pD = pData + wz*RO*E1 + we1*RO + wro;
+                            for (long long cha = 0; cha < CHA; cha++)
                             {
-                                de1 = e1 + ke1;
-                                for (kro = -halfKs; kro <= halfKs; kro++)
+                                pX[p*CHA + cha] = pD[cha*RO*E1*E2];
+                            }
+
+                            // conj(x_i)*x_j for i >= j, the nE real parts are followed by the nE imaginary parts
+                            const value_type* pXp = reinterpret_cast<const value_type*>(pX + p*CHA);
+                            value_type* pOr = reinterpret_cast<value_type*>(pOuter + p*nE);
+                            value_type* pOi = pOr + nE;
+                            for (long long j = 0; j < CHA; j++)
+                            {
+                                const value_type c = pXp[2 * j], d = pXp[2 * j + 1];
+                                for (long long i = j; i < CHA; i++)
                                 {
-                                    pD[ind + cha*kss] = pDataCurr[de1*RO + ro + kro];
-                                    ind++;
+                                    const value_type a = pXp[2 * i], b = pXp[2 * i + 1];
+                                    *pOr++ = a*c + b*d;
+                                    *pOi++ = a*d - b*c;
                                 }
                             }
                         }
-                    }
-                    else
-                    {
-                        for (cha = 0; cha<CHA; cha++)
+
+                        T* pRC = pRowCov + r*nRO*nE;
+                        T* pRS = pRowSum + r*nRO*CHA;
+
+                        memset(pRC, 0, sizeof(T)*nE);
+                        memset(pRS, 0, sizeof(T)*CHA);
+                        for (long long p = 0; p < 2 * halfKs + 1; p++)
                         {
-                            const T* pDataCurr = pData + cha*RO*E1;
-                            int ind = 0;
-                            for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
-                            {
-                                de1 = e1 + ke1;
-                                if (de1 < 0) de1 += E1;
-                                if (de1 >= E1) de1 -= E1;
+                            for (long long n = 0; n < nE; n++) pRC[n] += pOuter[p*nE + n];
+                            for (long long n = 0; n < CHA; n++) pRS[n] += pX[p*CHA + n];
+                        }
 
-                                for (kro = -halfKs; kro <= halfKs; kro++)
-                                {
-                                    dro = ro + kro;
-                                    if (dro < 0) dro += RO;
-                                    if (dro >= RO) dro -= RO;
+                        for (long long q = 1; q < nRO; q++)
+                        {
+                            const T* pIn = pOuter + (q + 2 * halfKs)*nE;
+                            const T* pOut = pOuter + (q - 1)*nE;
+                            for (long long n = 0; n < nE; n++) pRC[q*nE + n] = pRC[(q - 1)*nE + n] + pIn[n] - pOut[n];
 
-                                    pD[ind + cha*kss] = pDataCurr[de1*RO + dro];
-                                    ind++;
-                                }
-                            }
+                            const T* pXIn = pX + (q + 2 * halfKs)*CHA;
+                            const T* pXOut = pX + (q - 1)*CHA;
+                            for (long long n = 0; n < CHA; n++) pRS[q*CHA + n] = pRS[(q - 1)*CHA + n] + pXIn[n] - pXOut[n];
                         }
                     }
 
-                    T* pTmp;
-                    for (cha = 0; cha<CHA; cha++)
+                    // box filter along E1
+                    memset(pPlaneCov, 0, sizeof(T)*nE*nRO);
+                    memset(pPlaneSum, 0, sizeof(T)*CHA*nRO);
+                    for (long long r = 0; r < 2 * halfKs + 1; r++)
                     {
-                        pTmp = pD + cha*kss;
-                        pV1[cha] = pTmp[0];
-                        for (po = 1; po<kss; po++)
-                        {
-                            pV1[cha] += pTmp[po];
-                        }
+                        for (long long n = 0; n < nE*nRO; n++) pPlaneCov[n] += pRowCov[r*nRO*nE + n];
+                        for (long long n = 0; n < CHA*nRO; n++) pPlaneSum[n] += pRowSum[r*nRO*CHA + n];
                     }
 
-                    value_type sum(0);
-                    for (cha = 0; cha<CHA; cha++)
+                    for (long long t = 1; t < nE1; t++)
                     {
-                        const T& c = pV1[cha];
-                        const value_type re = c.real();
-                        const value_type im = c.imag();
-                        sum += ((re*re) + (im * im));
+                        const T* pIn = pRowCov + (t + 2 * halfKs)*nRO*nE;
+                        const T* pOut = pRowCov + (t - 1)*nRO*nE;
+                        T* pP = pPlaneCov + t*nRO*nE;
+                        for (long long n = 0; n < nE*nRO; n++) pP[n] = pP[n - nRO*nE] + pIn[n] - pOut[n];
+
+                        const T* pSIn = pRowSum + (t + 2 * halfKs)*nRO*CHA;
+                        const T* pSOut = pRowSum + (t - 1)*nRO*CHA;
+                        T* pS = pPlaneSum + t*nRO*CHA;
+                        for (long long n = 0; n < CHA*nRO; n++) pS[n] = pS[n - nRO*CHA] + pSIn[n] - pSOut[n];
                     }
-                    v1Norm = std::sqrt(sum);
 
-                    value_type v1NormInv = (value_type)1.0 / v1Norm;
-                    for (cha = 0; cha<CHA; cha++)
+                    if (kz > 1)
                     {
-                        pV1[cha] *= v1NormInv;
+                        for (long long n = 0; n < nE*nPix; n++) pCov[n] += pPlaneCov[n];
+                        for (long long n = 0; n < CHA*nPix; n++) pSum[n] += pPlaneSum[n];
                     }
+                }
 
-                    memcpy(pDC, pD, sizeof(T)*ks*ks*CHA);
-                    gemm(DH_D, DC, true, D, false);
+                value_type* pVr = Vr.begin();
+                value_type* pVi = Vi.begin();
+                value_type* pYr = Yr.begin();
+                value_type* pYi = Yi.begin();
 
-                    for (po = 0; po<power; po++)
+                for (long long p = 0; p < nPix; p++)
+                {
+                    const value_type* pCr = reinterpret_cast<const value_type*>(pCov + p*nE);
+                    const value_type* pCi = pCr + nE;
+                    const T* pSp = pSum + p*CHA;
+
+                    // the normalized local sum is the starting vector of the power iterations
+                    for (long long cha = 0; cha < CHA; cha++)
                     {
-                        gemm(V, DH_D, false, V1, false);
-                        memcpy(V1.begin(), V.begin(), V.get_number_of_bytes());
+                        pVr[cha] = pSp[cha].real();
+                        pVi[cha] = pSp[cha].imag();
+                    }
 
-                        sum = 0;
-                        for (cha = 0; cha<CHA; cha++)
+                    for (size_t po = 0; po <= power; po++)
+                    {
+                        if (po > 0)
                         {
-                            const T& c = pV1[cha];
-                            const value_type re = c.real();
-                            const value_type im = c.imag();
-                            sum += ((re*re) + (im * im));
+                            // V = DH_D*V1 from the lower triangle L, DH_D = L + L' - diag(L)
+                            memset(pYr, 0, sizeof(value_type)*CHA);
+                            memset(pYi, 0, sizeof(value_type)*CHA);
+
+                            long long off = 0;
+                            for (long long j = 0; j < CHA; j++)
+                            {
+                                const value_type* lr = pCr + off - j;
+                                const value_type* li = pCi + off - j;
+                                const value_type vr = pVr[j], vi = pVi[j];
+
+                                // diagonal is real
+                                value_type accR = lr[j] * vr, accI = lr[j] * vi;
+
+#ifdef USE_OMP
+                                #pragma omp simd reduction(+:accR, accI)
+#endif // USE_OMP
+                                for (long long i = j + 1; i < CHA; i++)
+                                {
+                                    pYr[i] += lr[i] * vr - li[i] * vi;
+                                    pYi[i] += lr[i] * vi + li[i] * vr;
+                                    accR += lr[i] * pVr[i] + li[i] * pVi[i];
+                                    accI += lr[i] * pVi[i] - li[i] * pVr[i];
+                                }
+
+                                pYr[j] += accR;
+                                pYi[j] += accI;
+                                off += CHA - j;
+                            }
+
+                            memcpy(pVr, pYr, sizeof(value_type)*CHA);
+                            memcpy(pVi, pYi, sizeof(value_type)*CHA);
                         }
-                        v1Norm = std::sqrt(sum);
 
-                        value_type v1NormInv = (value_type)1.0 / v1Norm;
-                        for (cha = 0; cha<CHA; cha++)
+                        value_type v1Norm(0);
+                        for (long long cha = 0; cha < CHA; cha++) v1Norm += pVr[cha] * pVr[cha] + pVi[cha] * pVi[cha];
+                        v1Norm = (value_type)1.0 / std::sqrt(v1Norm);
+                        for (long long cha = 0; cha < CHA; cha++)
                         {
-                            pV1[cha] *= v1NormInv;
+                            pVr[cha] *= v1Norm;
+                            pVi[cha] *= v1Norm;
                         }
                     }
 
-                    gemm(U1, D, false, V1, false);
-
-                    phaseU1 = pU1[0];
-                    for (po = 1; po<kss; po++)
-                    {
-                        phaseU1 += pU1[po];
-                    }
+                    // the phase of the sum of U1 = D*V1 is the phase of the local data sum projected on V1
+                    T phaseU1(0);
+                    for (long long cha = 0; cha < CHA; cha++) phaseU1 += pSp[cha] * T(pVr[cha], pVi[cha]);
                     phaseU1 /= std::abs(phaseU1);
 
-                    const value_type c = phaseU1.real();
-                    const value_type d = phaseU1.imag();
-
-                    for (cha = 0; cha<CHA; cha++)
-                    {
-                        const T& v = pV1[cha];
-                        const value_type a = v.real();
-                        const value_type b = v.imag();
-
-                        reinterpret_cast< value_type(&)[2] >(pV1[cha])[0] = a*c + b*d;
-                        reinterpret_cast< value_type(&)[2] >(pV1[cha])[1] = a*d - b*c;
-                    }
+                    long long ro = ro0 + p % nRO;
+                    long long e1 = e10 + p / nRO;
 
-                    for (cha = 0; cha<CHA; cha++)
+                    // put the mean object phase to coil map
+                    for (long long cha = 0; cha < CHA; cha++)
                     {
-                        pSen[cha*RO*E1 + e1*RO + ro] = V1(cha, 0);
+                        pSen[cha*RO*E1*E2 + z*RO*E1 + e1*RO + ro] = T(pVr[cha], -pVi[cha]) * phaseU1;
                     }
                 }
             }
         }
     }
+}
+
+// ------------------------------------------------------------------------
+
+template<typename T> 
+void coil_map_2d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t power)
+{
+    try
+    {
+        long long RO = data.get_size(0);
+        long long E1 = data.get_size(1);
+        long long CHA = data.get_size(2);
+
+        long long N = data.get_number_of_elements() / (RO*E1*CHA);
+        GADGET_CHECK_THROW(N == 1);
+
+        if (!data.dimensions_equal(&coilMap))
+        {
+            coilMap = data;
+        }
+
+        if (ks % 2 != 1)
+        {
+            ks++;
+        }
+
+        coil_map_Inati_box_filter(data.begin(), coilMap.begin(), RO, E1, 1, CHA, ks, 1, power);
+    }
     catch (...)
     {
         GERROR_STREAM("Errors in coil_map_2d_Inati(...) ... ");
@@ -225,8 +334,6 @@ void coil_map_3d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t k
 {
     try
     {
-        typedef typename realType<T>::Type value_type;
-
         long long RO = data.get_size(0);
         long long E1 = data.get_size(1);
         long long E2 = data.get_size(2);
@@ -235,146 +342,17 @@ void coil_map_3d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t k
         long long N = data.get_number_of_elements() / (RO*E1*E2*CHA);
         GADGET_CHECK_THROW(N == 1);
 
-        const T* pData = data.begin();
-
         if (!data.dimensions_equal(&coilMap))
         {
             coilMap = data;
         }
-        T* pSen = coilMap.begin();
 
         if (ks % 2 != 1)
         {
             ks++;
         }
 
-        size_t kss = ks*ks*ks;
-        long long halfKs = (long long)ks / 2;
-
-        long long e2;
-
-        #pragma omp parallel default(none) private(e2) shared(ks, RO, E1, E2, CHA, pSen, pData, halfKs, power, kss)
-        {
-            hoMatrix<T> D(kss, CHA);
-            hoMatrix<T> DC(kss, CHA);
-            hoMatrix<T> DH_D(CHA, CHA);
-
-            hoMatrix<T> U1(kss, 1);
-            hoMatrix<T> V1(CHA, 1);
-            hoMatrix<T> V(CHA, 1);
-
-            Gadgetron::clear(D);
-            Gadgetron::clear(DC);
-            Gadgetron::clear(DH_D);
-            Gadgetron::clear(U1);
-            Gadgetron::clear(V1);
-            Gadgetron::clear(V);
-
-            T phaseU1;
-
-            value_type v1Norm(1);
-
-            long long cha, ro, e1, kro, dro, ke1, de1, ke2, de2;
-            size_t po;
-
-            #pragma omp for
-            for (e2 = 0; e2<(long long)E2; e2++)
-            {
-                for (e1 = 0; e1<(long long)E1; e1++)
-                {
-                    for (ro = 0; ro<(long long)RO; ro++)
-                    {
-                        // fill the data matrix D
-                        if (e2 >= halfKs && e2<E2 - halfKs && e1 >= halfKs && e1<E1 - halfKs && ro >= halfKs && ro<RO - halfKs)
-                        {
-                            for (cha = 0; cha<CHA; cha++)
-                            {
-                                const T* pDataCurr = pData + cha*RO*E1*E2;
-                                long long ind = 0;
-                                for (ke2 = -halfKs; ke2 <= halfKs; ke2++)
-                                {
-                                    de2 = e2 + ke2;
-                                    for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
-                                    {
-                                        de1 = e1 + ke1;
-                                        for (kro = -halfKs; kro <= halfKs; kro++)
-                                        {
-                                            D(ind++, cha) = pDataCurr[de2*RO*E1 + de1*RO + ro + kro];
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                        else
-                        {
-                            for (cha = 0; cha<CHA; cha++)
-                            {
-                                const T* pDataCurr = pData + cha*RO*E1*E2;
-                                long long ind = 0;
-                                for (ke2 = -halfKs; ke2 <= halfKs; ke2++)
-                                {
-                                    de2 = e2 + ke2;
-                                    if (de2 < 0) de2 += E2;
-                                    if (de2 >= E2) de2 -= E2;
-
-                                    for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
-                                    {
-                                        de1 = e1 + ke1;
-                                        if (de1 < 0) de1 += E1;
-                                        if (de1 >= E1) de1 -= E1;
-
-                                        for (kro = -halfKs; kro <= halfKs; kro++)
-                                        {
-                                            dro = ro + kro;
-                                            if (dro < 0) dro += RO;
-                                            if (dro >= RO) dro -= RO;
-
-                                            D(ind++, cha) = pDataCurr[de2*RO*E1 + de1*RO + dro];
-                                        }
-                                    }
-                                }
-                            }
-                        }
-
-                        // compute V1
-                        D.sumOverCol(V1);
-                        norm2(V1, v1Norm);
-                        scal((value_type)1.0 / v1Norm, V1);
-
-                        memcpy(DC.begin(), D.begin(), sizeof(T)*kss*CHA);
-                        gemm(DH_D, DC, true, D, false);
-                        // gemm(DH_D, D, true, D, false);
-
-                        for (po = 0; po<power; po++)
-                        {
-                            gemm(V, DH_D, false, V1, false);
-                            V1 = V;
-                            norm2(V1, v1Norm);
-                            scal((value_type)1.0 / v1Norm, V1);
-                        }
-
-                        // compute U1
-                        gemm(U1, D, false, V1, false);
-
-                        phaseU1 = U1(0, 0);
-                        for (po = 1; po<kss; po++)
-                        {
-                            phaseU1 += U1(po, 0);
-                        }
-                        phaseU1 /= std::abs(phaseU1);
-
-                        // put the mean object phase to coil map
-                        conjugate(V1, V1);
-                        scal(phaseU1, V1);
-
-                        for (cha = 0; cha<CHA; cha++)
-                        {
-                            pSen[cha*RO*E1*E2 + e2*RO*E1 + e1*RO + ro] = V1(cha, 0);
-                        }
-                    }
-                }
-            }
-        }
+        coil_map_Inati_box_filter(data.begin(), coilMap.begin(), RO, E1, E2, CHA, ks, ks, power);
     }
     catch (...)
     {
@@ -39,6 +39,52 @@ namespace Gadgetron
 	NONE
       };
     
+  /**
+      Set of encoding counter values, stored as a bitmap.
+
+      Inserting a value is a bit operation instead of a tree insertion, and the
+      smallest and largest values are kept up to date on insertion.
+   */
+  class IsmrmrdEncodingIndexSet
+  {
+    public:
+      IsmrmrdEncodingIndexSet() : count_(0), minimum_(0), maximum_(0) {}
+
+      void insert(uint16_t v)
+      {
+        size_t w = v >> 6;
+        uint64_t b = (uint64_t)1 << (v & 63);
+
+        if (w >= bits_.size()) bits_.resize(w+1, 0);
+        if (bits_[w] & b) return;
+        bits_[w] |= b;
+
+        if (count_ == 0 || v < minimum_) minimum_ = v;
+        if (count_ == 0 || v > maximum_) maximum_ = v;
+        count_++;
+      }
+
+      bool contains(uint16_t v) const
+      {
+        size_t w = v >> 6;
+        return (w < bits_.size()) && (bits_[w] & ((uint64_t)1 << (v & 63)));
+      }
+
+      // number of different values
+      size_t size() const { return count_; }
+      bool empty() const { return count_ == 0; }
+
+      // only valid if the set is not empty
+      uint16_t minimum() const { return minimum_; }
+      uint16_t maximum() const { return maximum_; }
+
+    protected:
+      std::vector<uint64_t> bits_;
+      size_t count_;
+      uint16_t minimum_;
+      uint16_t maximum_;
+  };
+
   /** 
       This class functions as a storage unit for statistics related to
       the @IsmrmrdAcquisitionData objects.
@@ -49,15 +95,15 @@ namespace Gadgetron
     public:
       // Set of labels found in the data or ref part of a bucket
       //11D, fixed order [RO, E1, E2, CHA, SLC, PHS, CON, REP, SET, SEG, AVE]
-      std::set<uint16_t> kspace_encode_step_1;
-      std::set<uint16_t> kspace_encode_step_2;
-      std::set<uint16_t> slice;
-      std::set<uint16_t> phase;
-      std::set<uint16_t> contrast;
-      std::set<uint16_t> repetition;
-      std::set<uint16_t> set;
-      std::set<uint16_t> segment;
-      std::set<uint16_t> average;
+      IsmrmrdEncodingIndexSet kspace_encode_step_1;
+      IsmrmrdEncodingIndexSet kspace_encode_step_2;
+      IsmrmrdEncodingIndexSet slice;
+      IsmrmrdEncodingIndexSet phase;
+      IsmrmrdEncodingIndexSet contrast;
+      IsmrmrdEncodingIndexSet repetition;
+      IsmrmrdEncodingIndexSet set;
+      IsmrmrdEncodingIndexSet segment;
+      IsmrmrdEncodingIndexSet average;
   };
 
   /** 
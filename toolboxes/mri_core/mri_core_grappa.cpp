@@ -24,12 +24,12 @@
 
 #include "mri_core_grappa.h"
 #include "mri_core_utility.h"
-#include "hoMatrix.h"
 #include "hoNDArray_linalg.h"
 #include "hoNDFFT.h"
 #include "hoNDArray_utils.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_reductions.h"
+#include "hoNDArray_simd.h"
 
 #ifdef USE_OMP
     #include "omp.h"
@@ -87,6 +87,161 @@ void grappa2d_kerPattern(std::vector<int>& kE1, std::vector<int>& oE1, size_t& c
     return;
 }
 
+// ------------------------------------------------------------------------
+
+/// the calibration equations are assembled and reduced in blocks of rows, so the calibration matrix A is never formed
+/// a block is large enough to amortize the reduction of its normal equations, but small enough to stay far below the size of A
+#define GRAPPA_CALIB_MIN_BLOCK_ROWS 256
+#define GRAPPA_CALIB_MAX_BLOCK_ROWS 2048
+
+/// compute the normal equations AHA = A'*A and AHB = A'*B of the grappa calibration directly from the acs data
+/// pSrc: [RO E1 E2 srcCHA], pDst: [RO E1 E2 dstCHA]; the 2D calibration has E2==1 and kE2==oE2==[0]
+/// rows of A are the kernel positions [sRO eRO]x[sE1 eE1]x[sE2 eE2]; columns of A are ordered [kRO kE1 kE2 srcCHA], columns of B [dstCHA oE1 oE2]
+/// every thread assembles blocks of rows and computes their normal equations in T with blas; the block results are summed in double precision
+/// a block is stored as A' and B', so the rows of A are gathered into contiguous memory
+/// only the lower triangle of AHA is computed
+template <typename T>
+void grappa_calib_normal_equations(const T* pSrc, const T* pDst, size_t RO, size_t E1, size_t E2, size_t srcCHA, size_t dstCHA,
+                                long long kROhalf, const std::vector<int>& kE1, const std::vector<int>& oE1,
+                                const std::vector<int>& kE2, const std::vector<int>& oE2,
+                                size_t sRO, size_t eRO, size_t sE1, size_t eE1, size_t sE2, size_t eE2,
+                                hoNDArray<T>& AHA, hoNDArray<T>& AHB)
+{
+    typedef std::complex<double> AccType;
+
+    size_t kRO = 2 * kROhalf + 1;
+    size_t kNE1 = kE1.size();
+    size_t oNE1 = oE1.size();
+    size_t kNE2 = kE2.size();
+    size_t oNE2 = oE2.size();
+
+    size_t lenRO = eRO - sRO + 1;
+    size_t lenE1 = eE1 - sE1 + 1;
+    size_t lenE2 = eE2 - sE2 + 1;
+
+    size_t rowA = lenRO*lenE1*lenE2;
+    size_t colA = kRO*kNE1*kNE2*srcCHA;
+    size_t colB = dstCHA*oNE1*oNE2;
+
+    int numThreads = 1;
+#ifdef USE_OMP
+    numThreads = omp_get_max_threads();
+#endif // USE_OMP
+
+    size_t blockRows = (rowA + numThreads - 1) / numThreads;
+    if (blockRows < GRAPPA_CALIB_MIN_BLOCK_ROWS) blockRows = GRAPPA_CALIB_MIN_BLOCK_ROWS;
+    if (blockRows > GRAPPA_CALIB_MAX_BLOCK_ROWS) blockRows = GRAPPA_CALIB_MAX_BLOCK_ROWS;
+    if (blockRows > rowA) blockRows = rowA;
+
+    long long numBlocks = (long long)((rowA + blockRows - 1) / blockRows);
+    if (numThreads > numBlocks) numThreads = (int)numBlocks;
+
+    std::vector<AccType> accAHA(colA*colA, AccType(0)), accAHB(colA*colB, AccType(0));
+
+    bool failed = false;
+
+#pragma omp parallel num_threads(numThreads) shared(failed, accAHA, accAHB)
+    {
+        hoNDArray<T> blockAH_mem(colA*blockRows), blockBH_mem(colB*blockRows);
+        hoNDArray<T> blockAHA, blockAHB;
+
+        long long b;
+#pragma omp for schedule(dynamic, 1)
+        for (b = 0; b < numBlocks; b++)
+        {
+            size_t r0 = b*blockRows;
+            size_t N = (r0 + blockRows <= rowA) ? blockRows : rowA - r0;
+
+            T* pAH = blockAH_mem.begin();
+            T* pBH = blockBH_mem.begin();
+
+            for (size_t n = 0; n < N; n++)
+            {
+                size_t r = r0 + n;
+                long long ro = (long long)(sRO + r%lenRO);
+                long long e1 = (long long)(sE1 + (r / lenRO) % lenE1);
+                long long e2 = (long long)(sE2 + r / (lenRO*lenE1));
+
+                // fill the column of A'
+                T* pA = pAH + n*colA;
+                size_t col = 0;
+                for (size_t src = 0; src < srcCHA; src++)
+                {
+                    for (size_t ke2 = 0; ke2 < kNE2; ke2++)
+                    {
+                        for (size_t ke1 = 0; ke1 < kNE1; ke1++)
+                        {
+                            const T* pS = pSrc + src*RO*E1*E2 + (e2 + kE2[ke2])*RO*E1 + (e1 + kE1[ke1])*RO + ro;
+                            for (long long kro = -kROhalf; kro <= kROhalf; kro++)
+                            {
+                                pA[col++] = std::conj(pS[kro]);
+                            }
+                        }
+                    }
+                }
+
+                // fill the column of B'
+                T* pB = pBH + n*colB;
+                col = 0;
+                for (size_t oe2 = 0; oe2 < oNE2; oe2++)
+                {
+                    for (size_t oe1 = 0; oe1 < oNE1; oe1++)
+                    {
+                        const T* pD = pDst + (e2 + oE2[oe2])*RO*E1 + (e1 + oE1[oe1])*RO + ro;
+                        for (size_t dst = 0; dst < dstCHA; dst++)
+                        {
+                            pB[col++] = std::conj(pD[dst*RO*E1*E2]);
+                        }
+                    }
+                }
+            }
+
+            try
+            {
+                hoNDArray<T> blockAH(colA, N, pAH), blockBH(colB, N, pBH);
+                Gadgetron::herk(blockAHA, blockAH, 'L', false);
+                Gadgetron::gemm(blockAHB, blockAH, false, blockBH, true);
+            }
+            catch (...)
+            {
+#pragma omp critical(grappa_calib_failed)
+                failed = true;
+                continue;
+            }
+
+            const T* pAHA = blockAHA.begin();
+            const T* pAHB = blockAHB.begin();
+
+#pragma omp critical(grappa_calib_reduction)
+            {
+                for (size_t c = 0; c < colA; c++)
+                {
+                    for (size_t r = c; r < colA; r++)
+                    {
+                        accAHA[r + c*colA] += AccType(pAHA[r + c*colA]);
+                    }
+                }
+
+                for (size_t i = 0; i < colA*colB; i++)
+                {
+                    accAHB[i] += AccType(pAHB[i]);
+                }
+            }
+        }
+    }
+
+    GADGET_CHECK_THROW(!failed);
+
+    AHA.create(colA, colA);
+    AHB.create(colA, colB);
+
+    T* pAHA = AHA.begin();
+    for (size_t i = 0; i < colA*colA; i++) pAHA[i] = T(accAHA[i]);
+
+    T* pAHB = AHB.begin();
+    for (size_t i = 0; i < colA*colB; i++) pAHB[i] = T(accAHB[i]);
+}
+
 template <typename T> 
 void grappa2d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, double thres, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray<T>& ker)
 {
@@ -117,72 +272,20 @@ void grappa2d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, doub
         /// allocate kernel
         ker.create(kRO, kNE1, srcCHA, dstCHA, oNE1);
 
-        /// loop over the calibration region and assemble the equation
-        /// Ax = b
+        /// loop over the calibration region and assemble the normal equation
+        /// A'A x = A'b
 
         size_t sRO = startRO + kROhalf;
         size_t eRO = endRO - kROhalf;
         size_t sE1 = std::abs(kE1[0]) + startE1;
         size_t eE1 = endE1 - kE1[kNE1-1];
 
-        size_t lenRO = eRO - sRO + 1;
-
-        size_t rowA = (eE1-sE1+1)*lenRO;
-        size_t colA = kRO*kNE1*srcCHA;
-        size_t colB = dstCHA*oNE1;
-
-        hoMatrix<T> A;
-        hoMatrix<T> B;
-        hoMatrix<T> x( colA, colB );
-
-        hoNDArray<T> A_mem(rowA, colA);
-        A.createMatrix( rowA, colA, A_mem.begin() );
-        T* pA = A.begin();
-
-        hoNDArray<T> B_mem(rowA, colB);
-        B.createMatrix( A.rows(), colB, B_mem.begin() );
-        T* pB = B.begin();
-
-        long long e1;
-        for ( e1=(long long)sE1; e1<=(long long)eE1; e1++ )
-        {
-            for ( long long ro=sRO; ro<=(long long)eRO; ro++ )
-            {
-                long long rInd = (e1-sE1)*lenRO+ro-kROhalf;
-
-                size_t src, dst, ke1, oe1;
-                long long kro;
+        std::vector<int> kE2(1, 0), oE2(1, 0);
 
-                /// fill matrix A
-                size_t col = 0;
-                size_t offset = 0;
-                for ( src=0; src<srcCHA; src++ )
-                {
-                    for ( ke1=0; ke1<kNE1; ke1++ )
-                    {
-                        offset = src*RO*E1 + (e1+kE1[ke1])*RO;
-                        for ( kro=-kROhalf; kro<=kROhalf; kro++ )
-                        {
-                            /// A(rInd, col++) = acsSrc(ro+kro, e1+kE1[ke1], src);
-                            pA[rInd + col*rowA] = pSrc[ro+kro+offset];
-                            col++;
-                        }
-                    }
-                }
-
-                /// fill matrix B
-                col = 0;
-                for ( oe1=0; oe1<oNE1; oe1++ )
-                {
-                    for ( dst=0; dst<dstCHA; dst++ )
-                    {
-                        B(rInd, col++) = acsDst(ro, e1+oE1[oe1], dst);
-                    }
-                }
-            }
-        }
+        hoNDArray<T> AHA, x;
+        grappa_calib_normal_equations(pSrc, pDst, RO, E1, (size_t)1, srcCHA, dstCHA, kROhalf, kE1, oE1, kE2, oE2, sRO, eRO, sE1, eE1, (size_t)0, (size_t)0, AHA, x);
 
-        SolveLinearSystem_Tikhonov(A, B, x, thres);
+        SolveNormalEquation_Tikhonov(AHA, x, thres);
         memcpy(ker.begin(), x.begin(), ker.get_number_of_bytes());
     }
     catch(...)
@@ -322,6 +425,87 @@ template EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray< s
 
 // ------------------------------------------------------------------------
 
+template <typename T>
+void grappa2d_calib_convolution_kernel_batch(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray<T>& convKer)
+{
+    try
+    {
+        GADGET_CHECK_THROW(acsSrc.get_size(0)==acsDst.get_size(0));
+        GADGET_CHECK_THROW(acsSrc.get_size(1)==acsDst.get_size(1));
+        GADGET_CHECK_THROW(acsSrc.get_size(2)>=acsDst.get_size(2));
+
+        size_t RO = acsSrc.get_size(0);
+        size_t E1 = acsSrc.get_size(1);
+        size_t srcCHA = acsSrc.get_size(2);
+        size_t dstCHA = acsDst.get_size(2);
+        size_t N = acsSrc.get_number_of_elements() / (RO*E1*srcCHA);
+
+        GADGET_CHECK_THROW(acsDst.get_number_of_elements()==RO*E1*dstCHA*N);
+
+        std::vector<int> kE1, oE1;
+
+        bool fitItself = false;
+        if (&acsSrc != &acsDst) fitItself = true;
+
+        size_t convkRO, convkE1;
+        grappa2d_kerPattern(kE1, oE1, convkRO, convkE1, accelFactor, kRO, kNE1, fitItself);
+
+        long long kROhalf = kRO/2;
+        if ( 2*kROhalf == kRO )
+        {
+            GWARN_STREAM("grappa2d_calib_convolution_kernel_batch(...) - 2*kROhalf == kRO " << kRO);
+        }
+        kRO = 2*kROhalf + 1;
+
+        size_t oNE1 = oE1.size();
+        kNE1 = kE1.size();
+
+        size_t sRO = kROhalf;
+        size_t eRO = RO - kROhalf - 1;
+        size_t sE1 = std::abs(kE1[0]);
+        size_t eE1 = E1 - 1 - kE1[kNE1-1];
+
+        std::vector<int> kE2(1, 0), oE2(1, 0);
+
+        // the normal equations of every N, [colA colA N] and [colA colB N]
+        size_t colA = kRO*kNE1*srcCHA;
+        size_t colB = dstCHA*oNE1;
+
+        hoNDArray<T> AHA(colA, colA, N), x(colA, colB, N);
+        hoNDArray<T> AHAn, xn;
+
+        for (size_t n = 0; n < N; n++)
+        {
+            grappa_calib_normal_equations(acsSrc.begin() + n*RO*E1*srcCHA, acsDst.begin() + n*RO*E1*dstCHA, RO, E1, (size_t)1, srcCHA, dstCHA, kROhalf, kE1, oE1, kE2, oE2, sRO, eRO, sE1, eE1, (size_t)0, (size_t)0, AHAn, xn);
+
+            memcpy(AHA.begin() + n*colA*colA, AHAn.begin(), AHAn.get_number_of_bytes());
+            memcpy(x.begin() + n*colA*colB, xn.begin(), xn.get_number_of_bytes());
+        }
+
+        SolveNormalEquation_Tikhonov_batch(AHA, x, thres);
+
+        convKer.create(convkRO, convkE1, srcCHA, dstCHA, N);
+
+        hoNDArray<T> convKerN;
+        for (size_t n = 0; n < N; n++)
+        {
+            hoNDArray<T> ker(kRO, kNE1, srcCHA, dstCHA, oNE1, x.begin() + n*colA*colB);
+            grappa2d_convert_to_convolution_kernel(ker, kRO, kE1, oE1, convKerN);
+
+            memcpy(convKer.begin() + n*convKerN.get_number_of_elements(), convKerN.begin(), convKerN.get_number_of_bytes());
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in grappa2d_calib_convolution_kernel_batch(...) ... ");
+    }
+}
+
+template EXPORTMRICORE void grappa2d_calib_convolution_kernel_batch(const hoNDArray< std::complex<float> >& acsSrc, const hoNDArray< std::complex<float> >& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray< std::complex<float> >& convKer);
+template EXPORTMRICORE void grappa2d_calib_convolution_kernel_batch(const hoNDArray< std::complex<double> >& acsSrc, const hoNDArray< std::complex<double> >& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray< std::complex<double> >& convKer);
+
+// ------------------------------------------------------------------------
+
 template <typename T> 
 void grappa2d_calib_convolution_kernel(const hoNDArray<T>& dataSrc, const hoNDArray<T>& dataDst, hoNDArray<unsigned short>& dataMask, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray<T>& convKer)
 {
@@ -484,6 +668,52 @@ template EXPORTMRICORE void grappa2d_unmixing_coeff(const hoNDArray< std::comple
 
 // ------------------------------------------------------------------------
 
+// pixels of one unmixing tile; the accumulator and one coil of the image and coefficient tiles stay in the L1 cache
+#define GRAPPA_UNMIX_TILE_SIZE 512
+
+/// complexIm(:, n) = sum over cha of aliasedIm(:, cha, n) .* unmixCoeff(:, cha, n % unmixN)
+/// the arrays are [pixels CHA N], complexIm must already hold pixels*N elements
+/// the coefficients are broadcasted over N as in Gadgetron::multiply
+/// every (tile, n) item walks through the coils on a contiguous tile, instead of one pass over the whole image per coil
+template <typename T>
+void grappa_unmix_tiled(const hoNDArray<T>& aliasedIm, const hoNDArray<T>& unmixCoeff, size_t pixels, size_t CHA, hoNDArray<T>& complexIm)
+{
+    size_t N = aliasedIm.get_number_of_elements() / (pixels*CHA);
+    size_t unmixN = unmixCoeff.get_number_of_elements() / (pixels*CHA);
+
+    GADGET_CHECK_THROW(unmixN > 0 && N % unmixN == 0);
+    GADGET_CHECK_THROW(unmixCoeff.get_number_of_elements() == pixels*CHA*unmixN);
+    GADGET_CHECK_THROW(complexIm.get_number_of_elements() == pixels*N);
+
+    const T* pIm = aliasedIm.begin();
+    const T* pCoeff = unmixCoeff.begin();
+    T* pRes = complexIm.begin();
+
+    size_t numTiles = (pixels + GRAPPA_UNMIX_TILE_SIZE - 1) / GRAPPA_UNMIX_TILE_SIZE;
+    long long numItems = (long long)(numTiles*N);
+
+    long long item;
+#pragma omp parallel for default(none) private(item) shared(pIm, pCoeff, pRes, pixels, CHA, unmixN, numTiles, numItems) if (numItems > 1 && pixels*CHA*N > 64*1024)
+    for (item = 0; item < numItems; item++)
+    {
+        size_t n = (size_t)item / numTiles;
+        size_t start = ((size_t)item % numTiles) * GRAPPA_UNMIX_TILE_SIZE;
+        size_t len = std::min((size_t)GRAPPA_UNMIX_TILE_SIZE, pixels - start);
+
+        const T* im = pIm + n*pixels*CHA + start;
+        const T* coeff = pCoeff + (n%unmixN)*pixels*CHA + start;
+        T* res = pRes + n*pixels + start;
+
+        memset(res, 0, len*sizeof(T));
+        for (size_t cha = 0; cha < CHA; cha++)
+        {
+            simd::multiplyAdd(len, im + cha*pixels, coeff + cha*pixels, res);
+        }
+    }
+}
+
+// ------------------------------------------------------------------------
+
 template <typename T>
 void apply_unmix_coeff_kspace(const hoNDArray<T>& kspace, const hoNDArray<T>& unmixCoeff, hoNDArray<T>& complexIm)
 {
@@ -505,8 +735,7 @@ void apply_unmix_coeff_kspace(const hoNDArray<T>& kspace, const hoNDArray<T>& un
             complexIm.create(&dim);
         }
 
-        Gadgetron::multiply(buffer2DT, unmixCoeff, buffer2DT);
-        Gadgetron::sum_over_dimension(buffer2DT, complexIm, 2);
+        grappa_unmix_tiled(buffer2DT, unmixCoeff, kspace.get_size(0)*kspace.get_size(1), kspace.get_size(2), complexIm);
     }
     catch (...)
     {
@@ -537,10 +766,7 @@ void apply_unmix_coeff_aliased_image(const hoNDArray<T>& aliasedIm, const hoNDAr
             complexIm.create(&dim);
         }
 
-        hoNDArray<T> buffer2DT(aliasedIm);
-
-        Gadgetron::multiply(aliasedIm, unmixCoeff, buffer2DT);
-        Gadgetron::sum_over_dimension(buffer2DT, complexIm, 2);
+        grappa_unmix_tiled(aliasedIm, unmixCoeff, aliasedIm.get_size(0)*aliasedIm.get_size(1), aliasedIm.get_size(2), complexIm);
     }
     catch (...)
     {
@@ -603,8 +829,8 @@ void grappa3d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst,
         // allocate kernel
         ker.create(kRO, kNE1, kNE2, srcCHA, dstCHA, oNE1, oNE2);
 
-        // loop over the calibration region and assemble the equation
-        // Ax = b
+        // loop over the calibration region and assemble the normal equation
+        // A'A x = A'b
 
         size_t sRO = kROhalf;
         size_t eRO = RO - kROhalf - 1;
@@ -620,7 +846,6 @@ void grappa3d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst,
         size_t lenE2 = eE2 - sE2 + 1;
 
         size_t colA = kRO*kNE1*kNE2*srcCHA;
-        size_t colB = dstCHA*oNE1*oNE2;
 
         if (overDetermineRatio > 1.0)
         {
@@ -678,68 +903,10 @@ void grappa3d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst,
             }
         }
 
-        size_t rowA = lenRO*lenE1*lenE2;
-
-        hoMatrix<T> A, B, x(colA, colB);
-
-        hoNDArray<T> A_mem(rowA, colA);
-        A.createMatrix(rowA, colA, A_mem.begin());
-        T* pA = A.begin();
-
-        hoNDArray<T> B_mem(rowA, colB);
-        B.createMatrix(rowA, colB, B_mem.begin());
-        T* pB = B.begin();
-
-        long long e2;
+        hoNDArray<T> AHA, x;
+        grappa_calib_normal_equations(pSrc, pDst, RO, E1, E2, srcCHA, dstCHA, kROhalf, kE1, oE1, kE2, oE2, sRO, eRO, sE1, eE1, sE2, eE2, AHA, x);
 
-#pragma omp parallel for default(none) private(e2) shared(sE2, eE2, sE1, eE1, kROhalf, sRO, eRO, lenRO, lenE1, srcCHA, kNE2, kNE1, A, rowA, pA, acsSrc, kE1, kE2, oNE2, oNE1, dstCHA, B, pB, acsDst, oE1, oE2)
-        for (e2 = (long long)sE2; e2 <= (long long)eE2; e2++)
-        {
-            long long e1;
-            for (e1 = (long long)sE1; e1 <= (long long)eE1; e1++)
-            {
-                for (long long ro = (long long)sRO; ro <= (long long)eRO; ro++)
-                {
-                    size_t rInd = (e2 - sE2)*lenRO*lenE1 + (e1 - sE1)*lenRO + ro - sRO;
-
-                    size_t src, dst, ke1, ke2, oe1, oe2;
-                    long long kro;
-
-                    // fill matrix A
-                    size_t col = 0;
-                    for (src = 0; src<srcCHA; src++)
-                    {
-                        for (ke2 = 0; ke2<kNE2; ke2++)
-                        {
-                            for (ke1 = 0; ke1<kNE1; ke1++)
-                            {
-                                for (kro = -kROhalf; kro <= kROhalf; kro++)
-                                {
-                                    pA[rInd + col*rowA] = acsSrc(ro + kro, e1 + kE1[ke1], e2 + kE2[ke2], src);
-                                    col++;
-                                }
-                            }
-                        }
-                    }
-
-                    // fill matrix B
-                    col = 0;
-                    for (oe2 = 0; oe2<oNE2; oe2++)
-                    {
-                        for (oe1 = 0; oe1<oNE1; oe1++)
-                        {
-                            for (dst = 0; dst<dstCHA; dst++)
-                            {
-                                pB[rInd + col*rowA] = acsDst(ro, e1 + oE1[oe1], e2 + oE2[oe2], dst);
-                                col++;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-        SolveLinearSystem_Tikhonov(A, B, x, thres);
+        SolveNormalEquation_Tikhonov(AHA, x, thres);
 
         memcpy(ker.begin(), x.begin(), ker.get_number_of_bytes());
     }
@@ -1036,6 +1203,13 @@ void grappa3d_image_domain_kernel(const hoNDArray<T>& convKer, size_t RO, size_t
         Gadgetron::scal((typename realType<T>::Type)(std::sqrt((double)(RO*E1*E2))), convKerScaled);
         Gadgetron::pad(RO, E1, E2, &convKerScaled, &kIm, preset_kIm_with_zeros);
 
+        if (RO % 2 == 0 && E1 % 2 == 0 && E2 % 2 == 0)
+        {
+            // the centered transform of even sizes runs in place, all coil pairs go through one batched plan
+            Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->ifft3c(kIm);
+            return;
+        }
+
         long long n;
 
     #pragma omp parallel default(none) private(n) shared(RO, E1, E2, srcCHA, dstCHA, kIm)
@@ -1354,6 +1528,170 @@ template EXPORTMRICORE void grappa3d_image_domain_unwrapping_aliasedImage(const
 
 // ------------------------------------------------------------------------
 
+template <typename T> 
+void grappa3d_image_domain_unwrapping_ro_chunk(const hoNDArray<T>& convKer, const hoNDArray<T>& kspace,
+                                        size_t acceFactorE1, size_t acceFactorE2, size_t chunkRO,
+                                        hoNDArray<T>& complexIm)
+{
+    try
+    {
+        size_t kE1 = convKer.get_size(1);
+        size_t kE2 = convKer.get_size(2);
+        size_t srcCHA = convKer.get_size(3);
+        size_t dstCHA = convKer.get_size(4);
+
+        size_t RO = kspace.get_size(0);
+        size_t E1 = kspace.get_size(1);
+        size_t E2 = kspace.get_size(2);
+
+        GADGET_CHECK_THROW(kspace.get_size(3) == srcCHA);
+
+        size_t N = kspace.get_number_of_elements() / (RO*E1*E2*srcCHA);
+
+        if (chunkRO == 0 || chunkRO > RO) chunkRO = RO;
+
+        if (complexIm.get_size(0) != RO
+            || complexIm.get_size(1) != E1
+            || complexIm.get_size(2) != E2
+            || complexIm.get_size(3) != dstCHA
+            || complexIm.get_number_of_elements() != RO*E1*E2*dstCHA*N)
+        {
+            complexIm.create(RO, E1, E2, dstCHA, N);
+        }
+
+        // the ifft3c is done as ifft1c along RO for the whole data, then ifft2c along E1 and E2 for every chunk
+        std::vector<size_t> dim;
+        kspace.get_dimensions(dim);
+
+        hoNDArray<T> aliasedRO;
+        aliasedRO.create(dim);
+        Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->ifft1c(kspace, aliasedRO);
+
+        // kernel in image domain along RO, [RO kE1 kE2 srcCHA dstCHA]
+        hoNDArray<T> convKerScaled;
+        convKerScaled = convKer;
+        Gadgetron::scal((typename realType<T>::Type)(std::sqrt((double)(RO*E1*E2))), convKerScaled);
+
+        hoNDArray<T> convKerRO;
+        Gadgetron::pad(RO, kE1, kE2, &convKerScaled, &convKerRO, true);
+        Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->ifft1c(convKerRO);
+
+        // buffers of a chunk, E1 and E2 first
+        hoNDArray<T> kerChunk, kImChunk, aliasedChunk, resChunk;
+
+        size_t startRO;
+        for (startRO = 0; startRO < RO; startRO += chunkRO)
+        {
+            size_t cRO = chunkRO;
+            if (startRO + cRO > RO) cRO = RO - startRO;
+
+            long long ii;
+
+            // image domain kernel of the chunk, [E1 E2 cRO srcCHA dstCHA]
+            kerChunk.create(kE1, kE2, cRO, srcCHA, dstCHA);
+            T* pKerChunk = kerChunk.begin();
+            const T* pKerRO = convKerRO.begin();
+
+            long long numOfKerLines = (long long)(kE1*kE2*srcCHA*dstCHA);
+
+#pragma omp parallel for default(none) private(ii) shared(numOfKerLines, kE1, kE2, cRO, RO, startRO, pKerChunk, pKerRO)
+            for (ii = 0; ii < numOfKerLines; ii++)
+            {
+                size_t k = (size_t)ii % (kE1*kE2);
+                size_t sd = (size_t)ii / (kE1*kE2);
+
+                for (size_t ro = 0; ro < cRO; ro++)
+                {
+                    pKerChunk[(sd*cRO + ro)*kE1*kE2 + k] = pKerRO[(sd*kE1*kE2 + k)*RO + startRO + ro];
+                }
+            }
+
+            Gadgetron::pad(E1, E2, cRO, &kerChunk, &kImChunk, true);
+            Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->ifft2c(kImChunk);
+
+            aliasedChunk.create(E1, E2, cRO, srcCHA);
+            resChunk.create(E1, E2, cRO, dstCHA);
+
+            for (size_t n = 0; n < N; n++)
+            {
+                // aliased images of the chunk, [E1 E2 cRO srcCHA]
+                T* pAliasedChunk = aliasedChunk.begin();
+                const T* pAliasedRO = aliasedRO.begin() + n*RO*E1*E2*srcCHA;
+
+                long long numOfLines = (long long)(E1*E2*srcCHA);
+
+#pragma omp parallel for default(none) private(ii) shared(numOfLines, E1, E2, cRO, RO, startRO, pAliasedChunk, pAliasedRO)
+                for (ii = 0; ii < numOfLines; ii++)
+                {
+                    size_t e = (size_t)ii % (E1*E2);
+                    size_t cha = (size_t)ii / (E1*E2);
+
+                    for (size_t ro = 0; ro < cRO; ro++)
+                    {
+                        pAliasedChunk[(cha*cRO + ro)*E1*E2 + e] = pAliasedRO[ii*RO + startRO + ro];
+                    }
+                }
+
+                Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->ifft2c(aliasedChunk);
+
+                // unwrapping for every RO and dst channel
+                long long numOfImages = (long long)(cRO*dstCHA);
+
+#pragma omp parallel default(none) private(ii) shared(numOfImages, E1, E2, cRO, srcCHA, kImChunk, aliasedChunk, resChunk)
+                {
+                    hoNDArray<T> buf(E1, E2);
+
+#pragma omp for 
+                    for (ii = 0; ii < numOfImages; ii++)
+                    {
+                        size_t ro = (size_t)ii % cRO;
+                        size_t dcha = (size_t)ii / cRO;
+
+                        hoNDArray<T> res(E1, E2, resChunk.begin() + ii*E1*E2);
+                        Gadgetron::clear(res);
+
+                        for (size_t scha = 0; scha < srcCHA; scha++)
+                        {
+                            hoNDArray<T> kImCha(E1, E2, kImChunk.begin() + ((dcha*srcCHA + scha)*cRO + ro)*E1*E2);
+                            hoNDArray<T> aliasedCha(E1, E2, aliasedChunk.begin() + (scha*cRO + ro)*E1*E2);
+
+                            Gadgetron::multiply(kImCha, aliasedCha, buf);
+                            Gadgetron::add(res, buf, res);
+                        }
+                    }
+                }
+
+                // back to [RO E1 E2 dstCHA N]
+                const T* pResChunk = resChunk.begin();
+                T* pComplexIm = complexIm.begin() + n*RO*E1*E2*dstCHA;
+
+                numOfLines = (long long)(E1*E2*dstCHA);
+
+#pragma omp parallel for default(none) private(ii) shared(numOfLines, E1, E2, cRO, RO, startRO, pResChunk, pComplexIm)
+                for (ii = 0; ii < numOfLines; ii++)
+                {
+                    size_t e = (size_t)ii % (E1*E2);
+                    size_t cha = (size_t)ii / (E1*E2);
+
+                    for (size_t ro = 0; ro < cRO; ro++)
+                    {
+                        pComplexIm[ii*RO + startRO + ro] = pResChunk[(cha*cRO + ro)*E1*E2 + e];
+                    }
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in grappa3d_image_domain_unwrapping_ro_chunk(...) ... ");
+    }
+}
+
+template EXPORTMRICORE void grappa3d_image_domain_unwrapping_ro_chunk(const hoNDArray< std::complex<float> >& convKer, const hoNDArray< std::complex<float> >& kspace, size_t acceFactorE1, size_t acceFactorE2, size_t chunkRO, hoNDArray< std::complex<float> >& complexIm);
+template EXPORTMRICORE void grappa3d_image_domain_unwrapping_ro_chunk(const hoNDArray< std::complex<double> >& convKer, const hoNDArray< std::complex<double> >& kspace, size_t acceFactorE1, size_t acceFactorE2, size_t chunkRO, hoNDArray< std::complex<double> >& complexIm);
+
+// ------------------------------------------------------------------------
+
 template <typename T> 
 void apply_unmix_coeff_kspace_3D(const hoNDArray<T>& kspace, const hoNDArray<T>& unmixCoeff, hoNDArray<T>& complexIm)
 {
@@ -1387,12 +1725,7 @@ void apply_unmix_coeff_kspace_3D(const hoNDArray<T>& kspace, const hoNDArray<T>&
         buffer.create(dim);
         Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->ifft3c(kspace, aliasedIm, buffer);
 
-        Gadgetron::multiply(aliasedIm, unmixCoeff, buffer);
-
-        hoNDArray<T> bufferIm;
-        bufferIm.create(RO, E1, E2, 1, N, complexIm.begin());
-
-        Gadgetron::sum_over_dimension(buffer, bufferIm, 3);
+        grappa_unmix_tiled(aliasedIm, unmixCoeff, RO*E1*E2, srcCHA, complexIm);
     }
     catch (...)
     {
@@ -1417,9 +1750,6 @@ void apply_unmix_coeff_aliased_image_3D(const hoNDArray<T>& aliasedIm, const hoN
 
         size_t N = aliasedIm.get_size(4);
 
-        std::vector<size_t> dim;
-        aliasedIm.get_dimensions(dim);
-
         GADGET_CHECK_THROW(unmixCoeff.get_size(0) == RO);
         GADGET_CHECK_THROW(unmixCoeff.get_size(1) == E1);
         GADGET_CHECK_THROW(unmixCoeff.get_size(2) == E2);
@@ -1433,15 +1763,7 @@ void apply_unmix_coeff_aliased_image_3D(const hoNDArray<T>& aliasedIm, const hoN
             complexIm.create(RO, E1, E2, N);
         }
 
-        hoNDArray<T> buffer;
-        buffer.create(dim);
-
-        Gadgetron::multiply(aliasedIm, unmixCoeff, buffer);
-
-        hoNDArray<T> bufferIm;
-        bufferIm.create(RO, E1, E2, 1, N, complexIm.begin());
-
-        Gadgetron::sum_over_dimension(buffer, bufferIm, 3);
+        grappa_unmix_tiled(aliasedIm, unmixCoeff, RO*E1*E2, srcCHA, complexIm);
     }
     catch (...)
     {
@@ -1454,4 +1776,87 @@ template EXPORTMRICORE void apply_unmix_coeff_aliased_image_3D(const hoNDArray<
 
 // ------------------------------------------------------------------------
 
+template <typename T>
+size_t grappa_checksum(const hoNDArray<T>& x)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(x.begin());
+    size_t N = x.get_number_of_bytes();
+
+    // 64 bit words mixed in one pass, the tail byte by byte
+    unsigned long long h = 14695981039346656037ULL ^ (unsigned long long)N;
+
+    size_t numOfWords = N / sizeof(unsigned long long);
+    for (size_t i = 0; i < numOfWords; i++)
+    {
+        unsigned long long w;
+        memcpy(&w, p + i*sizeof(unsigned long long), sizeof(unsigned long long));
+
+        h ^= w * 0x9E3779B97F4A7C15ULL;
+        h = (h << 31) | (h >> 33);
+        h *= 0xBF58476D1CE4E5B9ULL;
+    }
+
+    for (size_t i = numOfWords*sizeof(unsigned long long); i < N; i++)
+    {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+
+    h ^= h >> 29;
+    return (size_t)h;
+}
+
+template EXPORTMRICORE size_t grappa_checksum(const hoNDArray< std::complex<float> >& x);
+template EXPORTMRICORE size_t grappa_checksum(const hoNDArray< std::complex<double> >& x);
+
+// ------------------------------------------------------------------------
+
+template <typename T>
+GrappaImageDomainKernelCache<T>::GrappaImageDomainKernelCache() : hits_(0), misses_(0)
+{
+}
+
+template <typename T>
+GrappaImageDomainKernelCache<T>::~GrappaImageDomainKernelCache()
+{
+}
+
+template <typename T>
+typename GrappaImageDomainKernelCache<T>::KernelPtr GrappaImageDomainKernelCache<T>::find(size_t slot, const GrappaImageDomainKernelKey& key)
+{
+    typename std::map<size_t, Entry>::iterator it = entries_.find(slot);
+    if (it == entries_.end() || it->second.key != key)
+    {
+        misses_++;
+        return KernelPtr();
+    }
+
+    hits_++;
+    return it->second.kIm;
+}
+
+template <typename T>
+typename GrappaImageDomainKernelCache<T>::KernelPtr GrappaImageDomainKernelCache<T>::insert(size_t slot, const GrappaImageDomainKernelKey& key, boost::shared_ptr< hoNDArray<T> > kIm)
+{
+    Entry& entry = entries_[slot];
+    entry.key = key;
+    entry.kIm = kIm;
+    return entry.kIm;
+}
+
+template <typename T>
+void GrappaImageDomainKernelCache<T>::erase(size_t slot)
+{
+    entries_.erase(slot);
+}
+
+template <typename T>
+void GrappaImageDomainKernelCache<T>::clear()
+{
+    entries_.clear();
+}
+
+template class EXPORTMRICORE GrappaImageDomainKernelCache< std::complex<float> >;
+template class EXPORTMRICORE GrappaImageDomainKernelCache< std::complex<double> >;
+
 }
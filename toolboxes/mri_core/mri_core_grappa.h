@@ -9,6 +9,9 @@
 #include "mri_core_export.h"
 #include "hoNDArray.h"
 
+#include <boost/shared_ptr.hpp>
+#include <map>
+
 namespace Gadgetron {
     /// ---------------------------------------------------------------------
     /// 2D grappa
@@ -28,6 +31,10 @@ namespace Gadgetron {
     template <typename T> EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray<T>& convKer);
     /// dataMask : [RO E1] array, marking fully rectangular sampled region with 1
     template <typename T> EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray<T>& dataSrc, const hoNDArray<T>& dataDst, hoNDArray<unsigned short>& dataMask, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray<T>& convKer);
+    /// calibration of a stack of acs data, acsSrc: [RO E1 srcCHA N], acsDst: [RO E1 dstCHA N], entire data is used
+    /// the normal equations of all N are solved together with SolveNormalEquation_Tikhonov_batch
+    /// convKer: [convKRO convKE1 srcCHA dstCHA N]
+    template <typename T> EXPORTMRICORE void grappa2d_calib_convolution_kernel_batch(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray<T>& convKer);
 
     /// compute image domain kernel from 2d grappd convolution kernel
     /// RO, E1: the size of image domain kernel
@@ -70,8 +77,10 @@ namespace Gadgetron {
     /// grappa calibration for 2D case
     /// kE1: the kernel pattern along E1
     /// oE1: the output kernel pattern along E1
+    /// startRO, endRO, startE1, endE1: the data region used for calibration
     /// ker : kernel array [kRO kE1 srcCHA dstCHA oE1]
-    template <typename T> EXPORTMRICORE void grappa2d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, double thres, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, hoNDArray<T>& ker);
+    /// the calibration equations are reduced to their normal equations block by block in parallel, the calibration matrix is not formed
+    template <typename T> EXPORTMRICORE void grappa2d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, double thres, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray<T>& ker);
 
     /// convert the grappa multiplication kernel computed from grappa2d_calib to convolution kernel
     /// convKer : [convRO convE1 srcCHA dstCHA]
@@ -143,6 +152,14 @@ namespace Gadgetron {
                                                                         size_t acceFactorE1, size_t acceFactorE2,
                                                                         hoNDArray<T>& complexIm);
 
+    /// the same as grappa3d_image_domain_unwrapping, computed in chunks of chunkRO along RO after the RO ifft
+    /// the image domain kernel is only held for one chunk, [E1 E2 chunkRO srcCHA dstCHA], instead of a full [RO E1 E2] volume per thread and channel pair
+    /// if chunkRO==0 or chunkRO>=RO, the whole RO is one chunk
+    /// the RO ifft of kspace is still computed into a full size [RO E1 E2 srcCHA N] buffer, only the kernel and images of a chunk are bounded by chunkRO
+    template <typename T> EXPORTMRICORE void grappa3d_image_domain_unwrapping_ro_chunk(const hoNDArray<T>& convKer, const hoNDArray<T>& kspace,
+                                                                        size_t acceFactorE1, size_t acceFactorE2, size_t chunkRO,
+                                                                        hoNDArray<T>& complexIm);
+
     /// apply unmixing coefficient on undersampled kspace
     /// kspace: [RO E1 E2 srcCHA ...]
     /// unmixCoeff : [RO E1 E2 srcCHA]
@@ -181,6 +198,7 @@ namespace Gadgetron {
     /// oE1: the output kernel pattern along E1
     /// oE2: the output kernel pattern along E2
     /// ker : kernel array [kRO kE1 kE2 srcCHA dstCHA oE1 oE2]
+    /// as for the 2D case, the calibration matrix is not formed
     template <typename T> EXPORTMRICORE void grappa3d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, 
                                                     double thres, double overDetermineRatio, size_t kRO, 
                                                     const std::vector<int>& kE1, const std::vector<int>& oE1, 
@@ -191,4 +209,72 @@ namespace Gadgetron {
     /// convKer : [convRO convE1 convE2 srcCHA dstCHA]
     template <typename T> EXPORTMRICORE void grappa3d_convert_to_convolution_kernel(const hoNDArray<T>& ker, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, const std::vector<int>& kE2, const std::vector<int>& oE2, hoNDArray<T>& convKer);
 
+    /// ---------------------------------------------------------------------
+    /// image domain kernel cache
+    /// ---------------------------------------------------------------------
+
+    /// checksum of the content of an array, one pass over the data without copying it
+    template <typename T> EXPORTMRICORE size_t grappa_checksum(const hoNDArray<T>& x);
+
+    /// calibration an image domain kernel was computed from
+    struct GrappaImageDomainKernelKey
+    {
+        GrappaImageDomainKernelKey() : RO(0), E1(0), E2(1), calibRO(0), calibE1(0), calibE2(1), acceFactorE1(1), acceFactorE2(1),
+                                        kRO(0), kNE1(0), kNE2(1), srcCHA(0), dstCHA(0), checksum(0) {}
+
+        size_t RO, E1, E2;                  // image size
+        size_t calibRO, calibE1, calibE2;   // size of the calibration region
+        size_t acceFactorE1, acceFactorE2;
+        size_t kRO, kNE1, kNE2;             // kernel size
+        size_t srcCHA, dstCHA;
+        size_t checksum;                    // grappa_checksum of the acs data
+
+        bool operator==(const GrappaImageDomainKernelKey& k) const
+        {
+            return RO==k.RO && E1==k.E1 && E2==k.E2 && calibRO==k.calibRO && calibE1==k.calibE1 && calibE2==k.calibE2
+                && acceFactorE1==k.acceFactorE1 && acceFactorE2==k.acceFactorE2 && kRO==k.kRO && kNE1==k.kNE1 && kNE2==k.kNE2
+                && srcCHA==k.srcCHA && dstCHA==k.dstCHA && checksum==k.checksum;
+        }
+
+        bool operator!=(const GrappaImageDomainKernelKey& k) const { return !(*this==k); }
+    };
+
+    /// keeps the image domain kernel of the last calibration of every slot, e.g. one slot per destination, slice and encoding
+    /// a kernel calibrated again with the same key is neither calibrated nor transformed to the image domain again
+    /// the cache is not thread safe, every consumer keeps its own
+    template <typename T> class EXPORTMRICORE GrappaImageDomainKernelCache
+    {
+    public:
+
+        typedef boost::shared_ptr< const hoNDArray<T> > KernelPtr;
+
+        GrappaImageDomainKernelCache();
+        ~GrappaImageDomainKernelCache();
+
+        /// the kernel of the slot if it was computed with this key, otherwise null
+        KernelPtr find(size_t slot, const GrappaImageDomainKernelKey& key);
+
+        /// record the kernel of the slot, replacing the previous one
+        KernelPtr insert(size_t slot, const GrappaImageDomainKernelKey& key, boost::shared_ptr< hoNDArray<T> > kIm);
+
+        void erase(size_t slot);
+        void clear();
+
+        size_t size() const { return entries_.size(); }
+        size_t hits() const { return hits_; }
+        size_t misses() const { return misses_; }
+
+    protected:
+
+        struct Entry
+        {
+            GrappaImageDomainKernelKey key;
+            KernelPtr kIm;
+        };
+
+        std::map<size_t, Entry> entries_;
+        size_t hits_;
+        size_t misses_;
+    };
+
 }
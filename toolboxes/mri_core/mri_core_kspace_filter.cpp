@@ -7,6 +7,9 @@
 #include "mri_core_kspace_filter.h"
 #include "hoNDArray_elemwise.h"
 #include <boost/algorithm/string.hpp>
+#include <map>
+#include <mutex>
+#include <tuple>
 
 #ifdef M_PI
     #undef M_PI
@@ -83,13 +86,14 @@ std::string get_kspace_filter_name(ISMRMRDKSPACEFILTER v)
     return name;
 }
 
+// number of generated filters kept per value type, the cache is cleared once it is full
+#define KSPACE_FILTER_CACHE_SIZE 64
+
 template<typename T>
-void generate_symmetric_filter(size_t len, hoNDArray<T>& filter, ISMRMRDKSPACEFILTER filterType, double sigma, size_t width)
+void generate_symmetric_filter_impl(size_t len, hoNDArray<T>& filter, ISMRMRDKSPACEFILTER filterType, double sigma, size_t width)
 {
     try
     {
-        if (len == 0) return;
-
         filter.create(len);
 
         if (width == 0 || width >= len) width = 1;
@@ -135,6 +139,8 @@ void generate_symmetric_filter(size_t len, hoNDArray<T>& filter, ISMRMRDKSPACEFI
         }
         else if (filterType == ISMRMRD_FILTER_TAPERED_HANNING)
         {
+            Gadgetron::fill(filter, T(1.0));
+
             hoNDArray<T> w(width);
 
             for (ii = 1; ii <= width; ii++)
@@ -215,6 +221,42 @@ void generate_symmetric_filter(size_t len, hoNDArray<T>& filter, ISMRMRDKSPACEFI
         }
     }
     catch (...)
+    {
+        GADGET_THROW("Errors in generate_symmetric_filter_impl(...) ... ");
+    }
+}
+
+template<typename T>
+void generate_symmetric_filter(size_t len, hoNDArray<T>& filter, ISMRMRDKSPACEFILTER filterType, double sigma, size_t width)
+{
+    try
+    {
+        if (len == 0) return;
+
+        // the same few filters are requested for every slice and repetition
+        typedef std::tuple<size_t, int, double, size_t> KeyType;
+        static std::map< KeyType, hoNDArray<T> > cache;
+        static std::mutex cache_mutex;
+
+        KeyType key(len, (int)filterType, sigma, width);
+
+        {
+            std::lock_guard<std::mutex> guard(cache_mutex);
+            typename std::map< KeyType, hoNDArray<T> >::const_iterator iter = cache.find(key);
+            if (iter != cache.end())
+            {
+                filter = iter->second;
+                return;
+            }
+        }
+
+        generate_symmetric_filter_impl(len, filter, filterType, sigma, width);
+
+        std::lock_guard<std::mutex> guard(cache_mutex);
+        if (cache.size() >= KSPACE_FILTER_CACHE_SIZE) cache.clear();
+        cache[key] = filter;
+    }
+    catch (...)
     {
         GADGET_THROW("Errors in generate_symmetric_filter(...) ... ");
     }
@@ -715,6 +757,74 @@ void compute_3d_filter(const hoNDArray<double>& fx, const hoNDArray<double>& fy,
 
 // ------------------------------------------------------------------------
 
+template <typename T>
+void apply_kspace_filter_separable(const hoNDArray<T>& data, const hoNDArray<T>& fRO, const hoNDArray<T>& fE1, const hoNDArray<T>& fE2, hoNDArray<T>& dataFiltered)
+{
+    try
+    {
+        size_t RO = data.get_size(0);
+        size_t E1 = data.get_size(1);
+        size_t E2 = data.get_size(2);
+
+        GADGET_CHECK_THROW(fRO.get_number_of_elements() == 0 || fRO.get_number_of_elements() == RO);
+        GADGET_CHECK_THROW(fE1.get_number_of_elements() == 0 || fE1.get_number_of_elements() == E1);
+        GADGET_CHECK_THROW(fE2.get_number_of_elements() == 0 || fE2.get_number_of_elements() == E2);
+
+        if (dataFiltered.get_number_of_elements() != data.get_number_of_elements())
+        {
+            dataFiltered.create(data.get_dimensions());
+        }
+
+        if (data.get_number_of_elements() == 0) return;
+
+        const T* pData = data.begin();
+        T* pRes = dataFiltered.begin();
+
+        const T* pRO = (fRO.get_number_of_elements() > 0) ? fRO.begin() : NULL;
+        const T* pE1 = (fE1.get_number_of_elements() > 0) ? fE1.begin() : NULL;
+        const T* pE2 = (fE2.get_number_of_elements() > 0) ? fE2.begin() : NULL;
+
+        // every RO line is read and written once, scaled by its E1 and E2 filter values
+        long long num = (long long)(data.get_number_of_elements() / RO);
+
+        long long n;
+#pragma omp parallel for default(none) private(n) shared(num, RO, E1, E2, pData, pRes, pRO, pE1, pE2) if(num*RO > 64*1024)
+        for (n = 0; n < num; n++)
+        {
+            size_t e1 = (size_t)n % E1;
+            size_t e2 = ((size_t)n / E1) % E2;
+
+            T s = T(1.0);
+            if (pE1) s *= pE1[e1];
+            if (pE2) s *= pE2[e2];
+
+            const T* pIn = pData + n*RO;
+            T* pOut = pRes + n*RO;
+
+            size_t ro;
+            if (pRO)
+            {
+                for (ro = 0; ro < RO; ro++) pOut[ro] = pIn[ro] * (pRO[ro] * s);
+            }
+            else
+            {
+                for (ro = 0; ro < RO; ro++) pOut[ro] = pIn[ro] * s;
+            }
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in apply_kspace_filter_separable(...) ... ");
+    }
+}
+
+template EXPORTMRICORE void apply_kspace_filter_separable(const hoNDArray<float>& data, const hoNDArray<float>& fRO, const hoNDArray<float>& fE1, const hoNDArray<float>& fE2, hoNDArray<float>& dataFiltered);
+template EXPORTMRICORE void apply_kspace_filter_separable(const hoNDArray<double>& data, const hoNDArray<double>& fRO, const hoNDArray<double>& fE1, const hoNDArray<double>& fE2, hoNDArray<double>& dataFiltered);
+template EXPORTMRICORE void apply_kspace_filter_separable(const hoNDArray< std::complex<float> >& data, const hoNDArray< std::complex<float> >& fRO, const hoNDArray< std::complex<float> >& fE1, const hoNDArray< std::complex<float> >& fE2, hoNDArray< std::complex<float> >& dataFiltered);
+template EXPORTMRICORE void apply_kspace_filter_separable(const hoNDArray< std::complex<double> >& data, const hoNDArray< std::complex<double> >& fRO, const hoNDArray< std::complex<double> >& fE1, const hoNDArray< std::complex<double> >& fE2, hoNDArray< std::complex<double> >& dataFiltered);
+
+// ------------------------------------------------------------------------
+
 template <typename T>
 void apply_kspace_filter_RO(hoNDArray<T>& data, const hoNDArray<T>& fRO)
 {
@@ -762,13 +872,8 @@ void apply_kspace_filter_E1(const hoNDArray<T>& data, const hoNDArray<T>& fE1, h
     {
         GADGET_CHECK_THROW(data.get_size(1) == fE1.get_number_of_elements());
 
-        hoNDArray<T> fRO(data.get_size(0));
-        fRO.fill(T(1.0));
-
-        hoNDArray<T> fxy;
-        compute_2d_filter(fRO, fE1, fxy);
-
-        Gadgetron::multiply(data, fxy, dataFiltered);
+        hoNDArray<T> fRO, fE2;
+        apply_kspace_filter_separable(data, fRO, fE1, fE2, dataFiltered);
     }
     catch (...)
     {
@@ -814,10 +919,8 @@ void apply_kspace_filter_ROE1(const hoNDArray<T>& data, const hoNDArray<T>& fRO,
         GADGET_CHECK_THROW(data.get_size(0) == fRO.get_size(0));
         GADGET_CHECK_THROW(data.get_size(1) == fE1.get_size(0));
 
-        hoNDArray<T> fROE1;
-        compute_2d_filter(fRO, fE1, fROE1);
-
-        Gadgetron::multiply(data, fROE1, dataFiltered);
+        hoNDArray<T> fE2;
+        apply_kspace_filter_separable(data, fRO, fE1, fE2, dataFiltered);
     }
     catch (...)
     {
@@ -839,16 +942,8 @@ void apply_kspace_filter_E2(const hoNDArray<T>& data, const hoNDArray<T>& fE2, h
     {
         GADGET_CHECK_THROW(data.get_size(2) == fE2.get_number_of_elements());
 
-        hoNDArray<T> fRO(data.get_size(0));
-        fRO.fill(T(1.0));
-
-        hoNDArray<T> fE1(data.get_size(1));
-        fE1.fill(T(1.0));
-
-        hoNDArray<T> fxyz;
-        compute_3d_filter(fRO, fE1, fE2, fxyz);
-
-        Gadgetron::multiply(data, fxyz, dataFiltered);
+        hoNDArray<T> fRO, fE1;
+        apply_kspace_filter_separable(data, fRO, fE1, fE2, dataFiltered);
     }
     catch (...)
     {
@@ -871,13 +966,8 @@ void apply_kspace_filter_ROE2(const hoNDArray<T>& data, const hoNDArray<T>& fRO,
         GADGET_CHECK_THROW(data.get_size(0) == fRO.get_number_of_elements());
         GADGET_CHECK_THROW(data.get_size(2) == fE2.get_number_of_elements());
 
-        hoNDArray<T> fE1(data.get_size(1));
-        fE1.fill(T(1.0));
-
-        hoNDArray<T> fxyz;
-        compute_3d_filter(fRO, fE1, fE2, fxyz);
-
-        Gadgetron::multiply(data, fxyz, dataFiltered);
+        hoNDArray<T> fE1;
+        apply_kspace_filter_separable(data, fRO, fE1, fE2, dataFiltered);
     }
     catch (...)
     {
@@ -900,13 +990,8 @@ void apply_kspace_filter_E1E2(const hoNDArray<T>& data, const hoNDArray<T>& fE1,
         GADGET_CHECK_THROW(data.get_size(1) == fE1.get_number_of_elements());
         GADGET_CHECK_THROW(data.get_size(2) == fE2.get_number_of_elements());
 
-        hoNDArray<T> fRO(data.get_size(0));
-        fRO.fill(T(1.0));
-
-        hoNDArray<T> fxyz;
-        compute_3d_filter(fRO, fE1, fE2, fxyz);
-
-        Gadgetron::multiply(data, fxyz, dataFiltered);
+        hoNDArray<T> fRO;
+        apply_kspace_filter_separable(data, fRO, fE1, fE2, dataFiltered);
     }
     catch (...)
     {
@@ -954,10 +1039,7 @@ void apply_kspace_filter_ROE1E2(const hoNDArray<T>& data, const hoNDArray<T>& fR
         GADGET_CHECK_THROW(data.get_size(1) == fE1.get_number_of_elements());
         GADGET_CHECK_THROW(data.get_size(2) == fE2.get_number_of_elements());
 
-        hoNDArray<T> fxyz;
-        compute_3d_filter(fRO, fE1, fE2, fxyz);
-
-        Gadgetron::multiply(data, fxyz, dataFiltered);
+        apply_kspace_filter_separable(data, fRO, fE1, fE2, dataFiltered);
     }
     catch (...)
     {
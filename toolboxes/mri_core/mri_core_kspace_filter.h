@@ -34,6 +34,7 @@ namespace Gadgetron
     /// sigma: for Gaussian, in the unit of pixel
     /// width: for TaperedHanning filter etc., the length of transition band
     /// filterType: "Gaussian" or "Hanning" or "TaperedHanning" or "None"
+    /// generated filters are cached by (len, filterType, sigma, width) and copied out on later calls
     template <typename T> EXPORTMRICORE void generate_symmetric_filter(size_t len, hoNDArray<T>& filter, ISMRMRDKSPACEFILTER filterType, double sigma = 1.5, size_t width = 15);
 
     /// generate asymmetric filter, used for partial fourier/asymmetric echo filtering
@@ -67,6 +68,12 @@ namespace Gadgetron
     /// apply kspace filter
     /// data: in kspace, [RO E1 E2 ...]
     /// all functions support in-place operation
+    /// the versions taking 1D filters do not form the 2D or 3D filter and filter the data in one pass
+
+    /// apply the separable filter fRO x fE1 x fE2 in one pass
+    /// an empty filter leaves its dimension unfiltered, e.g. apply_kspace_filter_separable(data, fRO, hoNDArray<T>(), fE2, data)
+    template <typename T> EXPORTMRICORE void apply_kspace_filter_separable(const hoNDArray<T>& data, const hoNDArray<T>& fRO, const hoNDArray<T>& fE1, const hoNDArray<T>& fE2, hoNDArray<T>& dataFiltered);
+
     template <typename T> EXPORTMRICORE void apply_kspace_filter_RO(hoNDArray<T>& data, const hoNDArray<T>& fRO);
     template <typename T> EXPORTMRICORE void apply_kspace_filter_RO(const hoNDArray<T>& data, const hoNDArray<T>& fRO, hoNDArray<T>& dataFiltered);
 
@@ -1,4 +1,3 @@
-
 /** \file   mri_core_utility.cpp
     \brief  Implementation useful utility functionalities for 2D and 3D MRI parallel imaging
     \author Hui Xue
@@ -6,8 +5,186 @@
 
 #include "mri_core_utility.h"
 #include "hoNDArray_elemwise.h"
+#include <algorithm>
+
+#ifdef M_PI
+    #undef M_PI
+#endif // M_PI
+#define M_PI 3.14159265358979323846
+
+// number of columns filtered together by remove_ro_oversampling, e.g. all coils of a readout
+#define RO_DECIMATION_BLOCK_SIZE 32
 
 namespace Gadgetron
 {
 
+template <typename T>
+void compute_ro_decimation_filter(size_t RO, size_t factor, size_t halfLength, hoNDArray<T>& filter)
+{
+    try
+    {
+        GADGET_CHECK_THROW(factor > 0);
+        GADGET_CHECK_THROW(RO % (2 * factor) == 0);
+
+        size_t M = RO / factor;
+        if (2 * halfLength + 1 > RO) halfLength = (RO - 1) / 2;
+
+        long long L = (long long)halfLength;
+        filter.create(2 * halfLength + 1);
+
+        double scale = 1.0 / std::sqrt((double)RO*M);
+
+        long long m, x;
+        for (m = -L; m <= L; m++)
+        {
+            // kernel value at the distance m between the input sample and the input position of an output sample
+            std::complex<double> v(0);
+            for (x = -(long long)M / 2; x < (long long)M / 2; x++)
+            {
+                v += std::polar(1.0, 2.0*M_PI*x*m / RO);
+            }
+            v *= scale;
+
+            double t = (double)m / (L + 1);
+            double w = 0.42 + 0.5*std::cos(M_PI*t) + 0.08*std::cos(2.0*M_PI*t);
+
+            // the zeros of the half-band kernel are made exact, so they are skipped when filtering
+            if (std::abs(v) < 1e-9*scale*M) v = 0;
+
+            filter(m + L) = T((typename realType<T>::Type)(w*v.real()), (typename realType<T>::Type)(w*v.imag()));
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in compute_ro_decimation_filter(...) ... ");
+    }
+}
+
+template EXPORTMRICORE void compute_ro_decimation_filter(size_t RO, size_t factor, size_t halfLength, hoNDArray< std::complex<float> >& filter);
+template EXPORTMRICORE void compute_ro_decimation_filter(size_t RO, size_t factor, size_t halfLength, hoNDArray< std::complex<double> >& filter);
+
+// ------------------------------------------------------------------------
+
+template <typename T>
+void remove_ro_oversampling(const hoNDArray<T>& data, const hoNDArray<T>& filter, size_t factor, hoNDArray<T>& dataDecimated)
+{
+    try
+    {
+        typedef typename realType<T>::Type value_type;
+
+        size_t RO = data.get_size(0);
+        GADGET_CHECK_THROW(factor > 0);
+        GADGET_CHECK_THROW(RO % (2 * factor) == 0);
+        GADGET_CHECK_THROW(filter.get_number_of_elements() % 2 == 1);
+        GADGET_CHECK_THROW(filter.get_number_of_elements() <= RO);
+
+        size_t M = RO / factor;
+        size_t N = data.get_number_of_elements() / RO;
+
+        std::vector<size_t> dim;
+        data.get_dimensions(dim);
+        dim[0] = M;
+        if (!dataDecimated.dimensions_equal(&dim))
+        {
+            dataDecimated.create(dim);
+        }
+
+        // nonzero taps only, as offsets from the input position factor*q of the output sample q
+        long long L = (long long)filter.get_number_of_elements() / 2;
+        std::vector<long long> tapOffset;
+        std::vector<value_type> tapRe, tapIm;
+
+        long long m;
+        for (m = -L; m <= L; m++)
+        {
+            T h = filter(m + L);
+            if (h == T(0)) continue;
+
+            tapOffset.push_back(m);
+            tapRe.push_back(h.real());
+            tapIm.push_back(h.imag());
+        }
+
+        size_t numTaps = tapOffset.size();
+        const long long* pOffset = &tapOffset[0];
+        const value_type* pTapRe = &tapRe[0];
+        const value_type* pTapIm = &tapIm[0];
+
+        const T* pData = data.begin();
+        T* pRes = dataDecimated.begin();
+
+        long long numBlocks = (long long)((N + RO_DECIMATION_BLOCK_SIZE - 1) / RO_DECIMATION_BLOCK_SIZE);
+
+        long long block;
+#pragma omp parallel default(none) private(block) shared(numBlocks, N, RO, M, factor, numTaps, pOffset, pTapRe, pTapIm, pData, pRes) if (numBlocks > 1)
+        {
+            // the columns of a block are stored interleaved, split into real and imaginary parts,
+            // so every tap is applied to all columns with contiguous vector operations
+            std::vector<value_type> bufRe(RO*RO_DECIMATION_BLOCK_SIZE), bufIm(RO*RO_DECIMATION_BLOCK_SIZE);
+            std::vector<value_type> accRe(RO_DECIMATION_BLOCK_SIZE), accIm(RO_DECIMATION_BLOCK_SIZE);
+
+#pragma omp for
+            for (block = 0; block < numBlocks; block++)
+            {
+                size_t n0 = (size_t)block * RO_DECIMATION_BLOCK_SIZE;
+                size_t B = std::min((size_t)RO_DECIMATION_BLOCK_SIZE, N - n0);
+
+                size_t ro, b, q, t;
+                for (b = 0; b < B; b++)
+                {
+                    const T* pCol = pData + (n0 + b)*RO;
+                    for (ro = 0; ro < RO; ro++)
+                    {
+                        bufRe[ro*B + b] = pCol[ro].real();
+                        bufIm[ro*B + b] = pCol[ro].imag();
+                    }
+                }
+
+                value_type* pAccRe = &accRe[0];
+                value_type* pAccIm = &accIm[0];
+
+                for (q = 0; q < M; q++)
+                {
+                    for (b = 0; b < B; b++)
+                    {
+                        pAccRe[b] = 0;
+                        pAccIm[b] = 0;
+                    }
+
+                    for (t = 0; t < numTaps; t++)
+                    {
+                        // the readout is periodic for the fft path, so are the taps at both ends
+                        long long i = (long long)(factor*q) + pOffset[t];
+                        if (i < 0) i += RO;
+                        if (i >= (long long)RO) i -= RO;
+
+                        const value_type* pRe = &bufRe[i*B];
+                        const value_type* pIm = &bufIm[i*B];
+                        value_type hr = pTapRe[t];
+                        value_type hi = pTapIm[t];
+
+                        for (b = 0; b < B; b++)
+                        {
+                            pAccRe[b] += hr*pRe[b] - hi*pIm[b];
+                            pAccIm[b] += hr*pIm[b] + hi*pRe[b];
+                        }
+                    }
+
+                    for (b = 0; b < B; b++)
+                    {
+                        pRes[(n0 + b)*M + q] = T(pAccRe[b], pAccIm[b]);
+                    }
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in remove_ro_oversampling(...) ... ");
+    }
+}
+
+template EXPORTMRICORE void remove_ro_oversampling(const hoNDArray< std::complex<float> >& data, const hoNDArray< std::complex<float> >& filter, size_t factor, hoNDArray< std::complex<float> >& dataDecimated);
+template EXPORTMRICORE void remove_ro_oversampling(const hoNDArray< std::complex<double> >& data, const hoNDArray< std::complex<double> >& filter, size_t factor, hoNDArray< std::complex<double> >& dataDecimated);
+
 }
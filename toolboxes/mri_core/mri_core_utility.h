@@ -11,4 +11,18 @@
 
 namespace Gadgetron
 {
+    /// ------------------------------------------------------------------------
+    /// readout oversampling removal
+    /// ------------------------------------------------------------------------
+    /// removing the readout oversampling by ifft, keeping the central RO/factor samples and fft is a periodic convolution
+    /// of the kspace readout with a Dirichlet kernel, evaluated at every factor-th sample
+    /// compute_ro_decimation_filter truncates this kernel to 2*halfLength+1 taps with a Blackman window; for factor 2 it is
+    /// a half-band filter and every other tap is zero
+    /// RO: oversampled readout length, a multiple of factor
+    template <typename T> EXPORTMRICORE void compute_ro_decimation_filter(size_t RO, size_t factor, size_t halfLength, hoNDArray<T>& filter);
+
+    /// remove the readout oversampling in kspace with the decimation filter, only the retained samples are computed
+    /// data: [RO N ...], dataDecimated: [RO/factor N ...]
+    /// all columns of data, e.g. the coils of several readouts, are filtered together in one call
+    template <typename T> EXPORTMRICORE void remove_ro_oversampling(const hoNDArray<T>& data, const hoNDArray<T>& filter, size_t factor, hoNDArray<T>& dataDecimated);
 }